@@ -7,7 +7,9 @@
 // Web:         http://slade.mancubus.net
 // Filename:    App.cpp
 // Description: The App namespace, with various general application related
-//              functions
+//              functions. Full (GUI) application startup and shutdown is in
+//              AppUI.cpp, everything here is part of the core library and
+//              usable without any UI
 //
 // This program is free software; you can redistribute it and/or modify it
 // under the terms of the GNU General Public License as published by the Free
@@ -33,35 +35,25 @@
 #include "Main.h"
 #include "App.h"
 #include "Archive/ArchiveManager.h"
-#include "Dialogs/SetupWizard/SetupWizardDialog.h"
-#include "Game/Configuration.h"
+#include "Archive/EntryType/EntryDataFormat.h"
+#include "Archive/EntryType/EntryType.h"
 #include "General/Clipboard.h"
-#include "General/ColourConfiguration.h"
 #include "General/Console/Console.h"
 #include "General/Executables.h"
 #include "General/KeyBind.h"
 #include "General/Misc.h"
 #include "General/ResourceManager.h"
-#include "General/SAction.h"
 #include "General/UI.h"
-#include "Graphics/Icons.h"
 #include "Graphics/Palette/PaletteManager.h"
 #include "Graphics/SImage/SIFormat.h"
-#include "MainEditor/MainEditor.h"
 #include "MapEditor/NodeBuilders.h"
-#include "OpenGL/Drawing.h"
-#include "OpenGL/GLTexture.h"
-#include "SLADEWxApp.h"
-#include "Scripting/Lua.h"
-#include "Scripting/ScriptManager.h"
-#include "TextEditor/TextLanguage.h"
-#include "TextEditor/TextStyle.h"
-#include "UI/SBrush.h"
-#include "UI/WxUtils.h"
 #include "Utility/StringUtils.h"
+#include "Utility/TaskGraph.h"
 #include "Utility/Tokenizer.h"
-#include "thirdparty/dumb/dumb.h"
-#include <filesystem>
+
+#ifdef UPDATEREVISION
+#include "gitinfo.h"
+#endif
 
 
 // -----------------------------------------------------------------------------
@@ -69,6 +61,26 @@
 // Variables
 //
 // -----------------------------------------------------------------------------
+namespace Global
+{
+thread_local std::string error;
+
+#ifdef GIT_DESCRIPTION
+string sc_rev = GIT_DESCRIPTION;
+#else
+std::string sc_rev = sc_rev;
+#endif
+
+#ifdef DEBUG
+bool debug = true;
+#else
+bool        debug  = false;
+#endif
+
+int win_version_major = 0;
+int win_version_minor = 0;
+} // namespace Global
+
 namespace App
 {
 wxStopWatch     timer;
@@ -102,7 +114,6 @@ ResourceManager resource_manager;
 
 CVAR(Int, temp_location, 0, CVar::Flag::Save)
 CVAR(String, temp_location_custom, "", CVar::Flag::Save)
-CVAR(Bool, setup_wizard_run, false, CVar::Flag::Save)
 
 
 // -----------------------------------------------------------------------------
@@ -165,7 +176,7 @@ namespace App
 // -----------------------------------------------------------------------------
 // Checks for and creates necessary application directories. Returns true
 // if all directories existed and were created successfully if needed,
-// false otherwise
+// false otherwise (with the reason in Global::error)
 // -----------------------------------------------------------------------------
 bool initDirectories()
 {
@@ -199,7 +210,7 @@ bool initDirectories()
 	{
 		if (!wxMkdir(dir_user))
 		{
-			wxMessageBox(wxString::Format("Unable to create user directory \"%s\"", dir_user), "Error", wxICON_ERROR);
+			Global::error = fmt::format("Unable to create user directory \"{}\"", dir_user);
 			return false;
 		}
 	}
@@ -210,7 +221,7 @@ bool initDirectories()
 	{
 		if (!wxMkdir(dir_temp))
 		{
-			wxMessageBox(wxString::Format("Unable to create temp directory \"%s\"", dir_temp), "Error", wxICON_ERROR);
+			Global::error = fmt::format("Unable to create temp directory \"{}\"", dir_temp);
 			return false;
 		}
 	}
@@ -245,7 +256,7 @@ void readConfigFile()
 			// Keep reading name/value pairs until we hit the ending '}'
 			while (!tz.checkOrEnd("}"))
 			{
-				CVar::set(tz.current().text, tz.peek().text);
+				CVar::set(tz.current().text(), tz.peek().text());
 				tz.adv(2);
 			}
 
@@ -257,7 +268,7 @@ void readConfigFile()
 		{
 			while (!tz.checkOrEnd("}"))
 			{
-				archive_manager.addBaseResourcePath(tz.current().text);
+				archive_manager.addBaseResourcePath(tz.current().text());
 				tz.adv();
 			}
 
@@ -269,7 +280,7 @@ void readConfigFile()
 		{
 			while (!tz.checkOrEnd("}"))
 			{
-				archive_manager.addRecentFile(tz.current().text);
+				archive_manager.addRecentFile(tz.current().text());
 				tz.adv();
 			}
 
@@ -285,7 +296,7 @@ void readConfigFile()
 		{
 			while (!tz.checkOrEnd("}"))
 			{
-				NodeBuilders::addBuilderPath(tz.current().text, tz.peek().text);
+				NodeBuilders::addBuilderPath(tz.current().text(), tz.peek().text());
 				tz.adv(2);
 			}
 
@@ -297,7 +308,7 @@ void readConfigFile()
 		{
 			while (!tz.checkOrEnd("}"))
 			{
-				Executables::setGameExePath(tz.current().text, tz.peek().text);
+				Executables::setGameExePath(tz.current().text(), tz.peek().text());
 				tz.adv(2);
 			}
 
@@ -313,38 +324,6 @@ void readConfigFile()
 	}
 }
 
-// -----------------------------------------------------------------------------
-// Processes command line [args]
-// -----------------------------------------------------------------------------
-vector<std::string> processCommandLine(vector<std::string>& args)
-{
-	vector<std::string> to_open;
-
-	// Process command line args (except the first as it is normally the executable name)
-	for (auto& arg : args)
-	{
-		// -nosplash: Disable splash window
-		if (StrUtil::equalCI(arg, "-nosplash"))
-			UI::enableSplash(false);
-
-		// -debug: Enable debug mode
-		else if (StrUtil::equalCI(arg, "-debug"))
-		{
-			Global::debug = true;
-			Log::info("Debugging stuff enabled");
-		}
-
-		// Other (no dash), open as archive
-		else if (!StrUtil::startsWith(arg, '-'))
-			to_open.push_back(arg);
-
-		// Unknown parameter
-		else
-			Log::warning("Unknown command line parameter: \"{}\"", arg);
-	}
-
-	return to_open;
-}
 } // namespace App
 
 // -----------------------------------------------------------------------------
@@ -412,144 +391,74 @@ bool App::isExiting()
 }
 
 // -----------------------------------------------------------------------------
-// Application initialisation
+// Initialises only the core (non-UI) subsystems - application directories, the
+// log, configuration, program resources, palettes, image formats and entry
+// types. This is for tools that use SLADE's archive, graphics and map handling
+// without the GUI, and doesn't need a display. wxWidgets must already be
+// initialised (eg. via wxInitializer).
+// Returns false if initialisation failed (with the reason in Global::error)
 // -----------------------------------------------------------------------------
-bool App::init(vector<std::string>& args, double ui_scale)
+bool App::initHeadless()
 {
 	// Get the id of the current thread (should be the main one)
 	main_thread_id = std::this_thread::get_id();
 
 	// Set locale to C so that the tokenizer will work properly
-	// even in locales where the decimal separator is a comma.
 	setlocale(LC_ALL, "C");
 
-	// Init application directories
+	// Use the same application name (and therefore user directory) as the GUI
+#ifdef __WINDOWS__
+	wxTheApp->SetAppName("SLADE3");
+#else
+	wxTheApp->SetAppName("slade3");
+#endif
+
+	// No splash window without the UI
+	UI::enableSplash(false);
+
+	// Init application directories and log
 	if (!initDirectories())
 		return false;
-
-	// Init log
 	Log::init();
 
-	// Process the command line arguments
-	auto paths_to_open = processCommandLine(args);
-
-	// Init keybinds
-	KeyBind::initBinds();
-
 	// Load configuration file
-	Log::info("Loading configuration");
 	readConfigFile();
 
-	// Check that SLADE.pk3 can be found
-	Log::info("Loading resources");
+	// Load program resources
 	archive_manager.init();
 	if (!archive_manager.resArchiveOK())
 	{
-		wxMessageBox(
-			"Unable to find slade.pk3, make sure it exists in the same directory as the "
-			"SLADE executable",
-			"Error",
-			wxICON_ERROR);
+		Global::error = "Unable to find slade.pk3";
 		return false;
 	}
-
-	// Init SActions
-	SAction::initWxId(26000);
-	SAction::initActions();
-
-	// Init lua
-	Lua::init();
-
-	// Init UI
-	UI::init(ui_scale);
-
-	// Show splash screen
-	UI::showSplash("Starting up...");
-
-	// Init palettes
-	if (!palette_manager.init())
+	// Only load the resources the core subsystems need up-front (anything else
+	// is loaded on first use), to keep headless startup quick
+	auto res_archive = archive_manager.programResourceArchive();
+	for (auto path : { "palettes", "config/entry_types" })
+		if (auto dir = res_archive->dir(path))
+			res_archive->preloadEntries(dir);
+
+	// Init the remaining core subsystems in parallel (see App::init)
+	TaskGraph core;
+	core.add("palettes", TaskGraph::Thread::Any, {}, []() { return palette_manager.init(); });
+	core.add("image_formats", TaskGraph::Thread::Any, {}, []() {
+		SIFormat::initFormats();
+		return true;
+	});
+	core.add("entry_types", TaskGraph::Thread::Any, {}, []() {
+		EntryDataFormat::initBuiltinFormats();
+		EntryType::loadEntryTypes();
+		return true;
+	});
+	bool core_ok = core.run();
+	core.logTimings("Core initialisation");
+	if (!core_ok)
 	{
-		Log::error("Failed to initialise palettes");
+		Global::error = "Failed to initialise palettes";
 		return false;
 	}
 
-	// Init SImage formats
-	SIFormat::initFormats();
-
-	// Init brushes
-	SBrush::initBrushes();
-
-	// Load program icons
-	Log::info("Loading icons");
-	Icons::loadIcons();
-
-	// Load program fonts
-	Drawing::initFonts();
-
-	// Load entry types
-	Log::info("Loading entry types");
-	EntryDataFormat::initBuiltinFormats();
-	EntryType::loadEntryTypes();
-
-	// Load text languages
-	Log::info("Loading text languages");
-	TextLanguage::loadLanguages();
-
-	// Init text stylesets
-	Log::info("Loading text style sets");
-	StyleSet::loadResourceStyles();
-	StyleSet::loadCustomStyles();
-
-	// Init colour configuration
-	Log::info("Loading colour configuration");
-	ColourConfiguration::init();
-
-	// Init nodebuilders
-	NodeBuilders::init();
-
-	// Init game executables
-	Executables::init();
-
-	// Init main editor
-	MainEditor::init();
-
-	// Init base resource
-	Log::info("Loading base resource");
-	archive_manager.initBaseResource();
-	Log::info("Base resource loaded");
-
-	// Init game configuration
-	Log::info("Loading game configurations");
-	Game::init();
-
-	// Init script manager
-	ScriptManager::init();
-
-	// Show the main window
-	MainEditor::windowWx()->Show(true);
-	wxGetApp().SetTopWindow(MainEditor::windowWx());
-	UI::showSplash("Starting up...", false, MainEditor::windowWx());
-
-	// Open any archives from the command line
-	for (auto& path : paths_to_open)
-		archive_manager.openArchive(path);
-
-	// Hide splash screen
-	UI::hideSplash();
-
 	init_ok = true;
-	Log::info("SLADE Initialisation OK");
-
-	// Show Setup Wizard if needed
-	if (!setup_wizard_run)
-	{
-		SetupWizardDialog dlg(MainEditor::windowWx());
-		dlg.ShowModal();
-		setup_wizard_run = true;
-		MainEditor::windowWx()->Update();
-		MainEditor::windowWx()->Refresh();
-	}
-
 	return true;
 }
 
@@ -617,69 +526,6 @@ void App::saveConfigFile()
 	file.Write("\n// End Configuration File\n\n");
 }
 
-// -----------------------------------------------------------------------------
-// Application exit, shuts down and cleans everything up.
-// If [save_config] is true, saves all configuration related files
-// -----------------------------------------------------------------------------
-void App::exit(bool save_config)
-{
-	exiting = true;
-
-	if (save_config)
-	{
-		// Save configuration
-		saveConfigFile();
-
-		// Save text style configuration
-		StyleSet::saveCurrent();
-
-		// Save colour configuration
-		MemChunk ccfg;
-		ColourConfiguration::writeConfiguration(ccfg);
-		ccfg.exportFile(App::path("colours.cfg", App::Dir::User));
-
-		// Save game exes
-		wxFile f;
-		f.Open(App::path("executables.cfg", App::Dir::User), wxFile::write);
-		f.Write(Executables::writeExecutables());
-		f.Close();
-
-		// Save custom special presets
-		Game::saveCustomSpecialPresets();
-
-		// Save custom scripts
-		ScriptManager::saveUserScripts();
-	}
-
-	// Close all open archives
-	archive_manager.closeAll();
-
-	// Clean up
-	EntryType::cleanupEntryTypes();
-	Drawing::cleanupFonts();
-	OpenGL::Texture::clearAll();
-
-	// Clear temp folder
-	std::error_code error;
-	for (auto& item : std::filesystem::directory_iterator{ App::path("", App::Dir::Temp) })
-	{
-		if (!item.is_regular_file())
-			continue;
-
-		if (!std::filesystem::remove(item, error))
-			Log::warning("Could not clean up temporary file \"{}\": {}", item.path().string(), error.message());
-	}
-
-	// Close lua
-	Lua::close();
-
-	// Close DUMB
-	dumb_exit();
-
-	// Exit wx Application
-	wxGetApp().Exit();
-}
-
 
 // ----------------------------------------------------------------------------
 // Returns the current version of SLADE
@@ -751,10 +597,3 @@ std::thread::id App::mainThreadId()
 {
 	return main_thread_id;
 }
-
-
-CONSOLE_COMMAND(setup_wizard, 0, false)
-{
-	SetupWizardDialog dlg(MainEditor::windowWx());
-	dlg.ShowModal();
-}
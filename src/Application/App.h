@@ -20,6 +20,7 @@ Clipboard&       clipboard();
 ResourceManager& resources();
 
 bool init(vector<std::string>& args, double ui_scale = 1.);
+bool initHeadless();
 void saveConfigFile();
 void exit(bool save_config);
 
@@ -0,0 +1,441 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2019 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    AppUI.cpp
+// Description: App namespace functions for starting up and shutting down the
+//              full (GUI) application. These aren't part of the core library,
+//              see App::initHeadless for using it without any UI
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "App.h"
+#include "Archive/ArchiveManager.h"
+#include "Archive/EntryType/EntryDataFormat.h"
+#include "Archive/EntryType/EntryType.h"
+#include "Dialogs/SetupWizard/SetupWizardDialog.h"
+#include "Game/Configuration.h"
+#include "General/ColourConfiguration.h"
+#include "General/Console/Console.h"
+#include "General/Executables.h"
+#include "General/KeyBind.h"
+#include "General/SAction.h"
+#include "General/UI.h"
+#include "Graphics/Icons.h"
+#include "Graphics/Palette/PaletteManager.h"
+#include "Graphics/SImage/SIFormat.h"
+#include "MainEditor/MainEditor.h"
+#include "MapEditor/NodeBuilders.h"
+#include "OpenGL/Drawing.h"
+#include "OpenGL/GLTexture.h"
+#include "SLADEWxApp.h"
+#include "Scripting/Lua.h"
+#include "Scripting/ScriptManager.h"
+#include "TextEditor/TextLanguage.h"
+#include "TextEditor/TextStyle.h"
+#include "UI/SBrush.h"
+#include "Utility/StringUtils.h"
+#include "Utility/TaskGraph.h"
+#include "thirdparty/dumb/dumb.h"
+#include <filesystem>
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Bool, setup_wizard_run, false, CVar::Flag::Save)
+
+
+// -----------------------------------------------------------------------------
+//
+// External Variables
+//
+// -----------------------------------------------------------------------------
+namespace App
+{
+extern bool            init_ok;
+extern bool            exiting;
+extern std::thread::id main_thread_id;
+extern PaletteManager  palette_manager;
+extern ArchiveManager  archive_manager;
+
+bool initDirectories();
+void readConfigFile();
+} // namespace App
+
+
+// -----------------------------------------------------------------------------
+//
+// App Namespace Functions
+//
+// -----------------------------------------------------------------------------
+namespace App
+{
+// -----------------------------------------------------------------------------
+// Processes command line [args]
+// -----------------------------------------------------------------------------
+vector<std::string> processCommandLine(vector<std::string>& args)
+{
+	vector<std::string> to_open;
+
+	// Process command line args (except the first as it is normally the executable name)
+	for (auto& arg : args)
+	{
+		// -nosplash: Disable splash window
+		if (StrUtil::equalCI(arg, "-nosplash"))
+			UI::enableSplash(false);
+
+		// -debug: Enable debug mode
+		else if (StrUtil::equalCI(arg, "-debug"))
+		{
+			Global::debug = true;
+			Log::info("Debugging stuff enabled");
+		}
+
+		// Other (no dash), open as archive
+		else if (!StrUtil::startsWith(arg, '-'))
+			to_open.push_back(arg);
+
+		// Unknown parameter
+		else
+			Log::warning("Unknown command line parameter: \"{}\"", arg);
+	}
+
+	return to_open;
+}
+} // namespace App
+
+// -----------------------------------------------------------------------------
+// Application initialisation
+// -----------------------------------------------------------------------------
+bool App::init(vector<std::string>& args, double ui_scale)
+{
+	// Get the id of the current thread (should be the main one)
+	main_thread_id = std::this_thread::get_id();
+
+	// Set locale to C so that the tokenizer will work properly
+	// even in locales where the decimal separator is a comma.
+	setlocale(LC_ALL, "C");
+
+	// Init application directories
+	if (!initDirectories())
+	{
+		wxMessageBox(Global::error, "Error", wxICON_ERROR);
+		return false;
+	}
+
+	// Init log
+	Log::init();
+
+	// Process the command line arguments
+	auto paths_to_open = processCommandLine(args);
+
+	// Init keybinds
+	KeyBind::initBinds();
+
+	// Load configuration file
+	Log::info("Loading configuration");
+	readConfigFile();
+
+	// Check that SLADE.pk3 can be found
+	Log::info("Loading resources");
+	archive_manager.init();
+	if (!archive_manager.resArchiveOK())
+	{
+		wxMessageBox(
+			"Unable to find slade.pk3, make sure it exists in the same directory as the "
+			"SLADE executable",
+			"Error",
+			wxICON_ERROR);
+		return false;
+	}
+
+	// Load all program resource data up-front so it can be read from multiple
+	// threads during startup
+	archive_manager.programResourceArchive()->preloadEntries();
+
+	// Setup startup tasks. Anything that creates UI or OpenGL-related resources
+	// (or depends on something that does) must run on the main thread, the rest
+	// only read from slade.pk3 and user config files and can run in parallel
+	typedef TaskGraph::Thread Thread;
+	TaskGraph                 startup;
+	bool                      tasks_ok = true;
+
+	// Init SActions
+	tasks_ok &= startup.add("sactions", Thread::Main, {}, []() {
+		SAction::initWxId(26000);
+		SAction::initActions();
+		return true;
+	});
+
+	// Init lua
+	tasks_ok &= startup.add("lua", Thread::Main, { "sactions" }, []() {
+		Lua::init();
+		return true;
+	});
+
+	// Init UI and show splash screen
+	tasks_ok &= startup.add("ui", Thread::Main, { "lua" }, [ui_scale]() {
+		UI::init(ui_scale);
+		UI::showSplash("Starting up...");
+		return true;
+	});
+
+	// Load program icons
+	tasks_ok &= startup.add("icons", Thread::Main, { "ui" }, []() {
+		Log::info("Loading icons");
+		Icons::loadIcons();
+		return true;
+	});
+
+	// Load program fonts
+	tasks_ok &= startup.add("fonts", Thread::Main, { "icons" }, []() {
+		Drawing::initFonts();
+		return true;
+	});
+
+	// Init palettes
+	tasks_ok &= startup.add("palettes", Thread::Any, {}, []() {
+		if (!palette_manager.init())
+		{
+			Log::error("Failed to initialise palettes");
+			return false;
+		}
+		return true;
+	});
+
+	// Init SImage formats
+	tasks_ok &= startup.add("image_formats", Thread::Any, {}, []() {
+		SIFormat::initFormats();
+		return true;
+	});
+
+	// Init brushes (these read the same icon entries as the icons task)
+	tasks_ok &= startup.add(
+		"brushes", Thread::Any, { "image_formats", "icons" }, []() { return SBrush::initBrushes(); });
+
+	// Load entry types
+	tasks_ok &= startup.add("entry_types", Thread::Any, {}, []() {
+		Log::info("Loading entry types");
+		EntryDataFormat::initBuiltinFormats();
+		EntryType::loadEntryTypes();
+		return true;
+	});
+
+	// Load text languages
+	tasks_ok &= startup.add("text_languages", Thread::Any, {}, []() {
+		Log::info("Loading text languages");
+		TextLanguage::loadLanguages();
+		return true;
+	});
+
+	// Init text stylesets (on the main thread since each StyleSet creates a
+	// wxFont)
+	tasks_ok &= startup.add("text_styles", Thread::Main, {}, []() {
+		Log::info("Loading text style sets");
+		StyleSet::loadResourceStyles();
+		StyleSet::loadCustomStyles();
+		return true;
+	});
+
+	// Init colour configuration
+	tasks_ok &= startup.add("colours", Thread::Any, {}, []() {
+		Log::info("Loading colour configuration");
+		ColourConfiguration::init();
+		return true;
+	});
+
+	// Init nodebuilders
+	tasks_ok &= startup.add("nodebuilders", Thread::Any, {}, []() {
+		NodeBuilders::init();
+		return true;
+	});
+
+	// Init game executables
+	tasks_ok &= startup.add("executables", Thread::Any, {}, []() {
+		Executables::init();
+		return true;
+	});
+
+	// Init main editor
+	tasks_ok &= startup.add(
+		"main_editor",
+		Thread::Main,
+		{ "fonts",
+		  "palettes",
+		  "brushes",
+		  "entry_types",
+		  "text_languages",
+		  "text_styles",
+		  "colours",
+		  "nodebuilders",
+		  "executables" },
+		[]() {
+			MainEditor::init();
+			return true;
+		});
+
+	// Init base resource
+	tasks_ok &= startup.add("base_resource", Thread::Main, { "main_editor" }, []() {
+		Log::info("Loading base resource");
+		archive_manager.initBaseResource();
+		Log::info("Base resource loaded");
+		return true;
+	});
+
+	// Init game configuration
+	tasks_ok &= startup.add("game", Thread::Main, { "base_resource" }, []() {
+		Log::info("Loading game configurations");
+		Game::init();
+		return true;
+	});
+
+	// Init script manager
+	tasks_ok &= startup.add("scripts", Thread::Main, { "game" }, []() {
+		ScriptManager::init();
+		return true;
+	});
+
+	// A misspelled or missing dependency would otherwise just leave some tasks
+	// out of the graph
+	if (!tasks_ok || !startup.validate())
+	{
+		Log::error("Unable to initialise, the startup task graph is invalid");
+		return false;
+	}
+
+	// Run startup tasks
+	bool startup_ok = startup.run();
+	startup.logTimings("Startup");
+	if (!startup_ok)
+		return false;
+
+	// Show the main window
+	MainEditor::windowWx()->Show(true);
+	wxGetApp().SetTopWindow(MainEditor::windowWx());
+	UI::showSplash("Starting up...", false, MainEditor::windowWx());
+
+	// Open any archives from the command line
+	for (auto& path : paths_to_open)
+		archive_manager.openArchive(path);
+
+	// Hide splash screen
+	UI::hideSplash();
+
+	init_ok = true;
+	Log::info("SLADE Initialisation OK");
+
+	// Show Setup Wizard if needed
+	if (!setup_wizard_run)
+	{
+		SetupWizardDialog dlg(MainEditor::windowWx());
+		dlg.ShowModal();
+		setup_wizard_run = true;
+		MainEditor::windowWx()->Update();
+		MainEditor::windowWx()->Refresh();
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Application exit, shuts down and cleans everything up.
+// If [save_config] is true, saves all configuration related files
+// -----------------------------------------------------------------------------
+void App::exit(bool save_config)
+{
+	exiting = true;
+
+	if (save_config)
+	{
+		// Save configuration
+		saveConfigFile();
+
+		// Save text style configuration
+		StyleSet::saveCurrent();
+
+		// Save colour configuration
+		MemChunk ccfg;
+		ColourConfiguration::writeConfiguration(ccfg);
+		ccfg.exportFile(App::path("colours.cfg", App::Dir::User));
+
+		// Save game exes
+		wxFile f;
+		f.Open(App::path("executables.cfg", App::Dir::User), wxFile::write);
+		f.Write(Executables::writeExecutables());
+		f.Close();
+
+		// Save custom special presets
+		Game::saveCustomSpecialPresets();
+
+		// Save custom scripts
+		ScriptManager::saveUserScripts();
+	}
+
+	// Close all open archives
+	archive_manager.closeAll();
+
+	// Clean up
+	EntryType::cleanupEntryTypes();
+	Drawing::cleanupFonts();
+	OpenGL::Texture::clearAll();
+
+	// Clear temp folder
+	std::error_code error;
+	for (auto& item : std::filesystem::directory_iterator{ App::path("", App::Dir::Temp) })
+	{
+		if (!item.is_regular_file())
+			continue;
+
+		if (!std::filesystem::remove(item, error))
+			Log::warning("Could not clean up temporary file \"{}\": {}", item.path().string(), error.message());
+	}
+
+	// Close lua
+	Lua::close();
+
+	// Close DUMB
+	dumb_exit();
+
+	// Exit wx Application
+	wxGetApp().Exit();
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+
+CONSOLE_COMMAND(setup_wizard, 0, false)
+{
+	SetupWizardDialog dlg(MainEditor::windowWx());
+	dlg.ShowModal();
+}
@@ -49,11 +49,11 @@ using std::vector;
 // Namespace to hold 'global' variables
 namespace Global
 {
-extern std::string error;
-extern std::string sc_rev;
-extern bool        debug;
-extern int         win_version_major;
-extern int         win_version_minor;
+extern thread_local std::string error; // Per-thread, so worker threads don't clobber each other's errors
+extern std::string              sc_rev;
+extern bool                     debug;
+extern int                      win_version_major;
+extern int                      win_version_minor;
 }; // namespace Global
 
 // Global internal includes
@@ -49,39 +49,14 @@
 
 #undef BOOL
 
-#ifdef UPDATEREVISION
-#include "gitinfo.h"
-#endif
-
 
 // -----------------------------------------------------------------------------
 //
 // Variables
 //
 // -----------------------------------------------------------------------------
-namespace Global
-{
-std::string error = error;
-
-#ifdef GIT_DESCRIPTION
-string sc_rev = GIT_DESCRIPTION;
-#else
-std::string sc_rev = sc_rev;
-#endif
-
-#ifdef DEBUG
-bool debug = true;
-#else
-bool        debug  = false;
-#endif
-
-int win_version_major = 0;
-int win_version_minor = 0;
-} // namespace Global
-
 std::string current_action           = current_action;
 bool        update_check_message_box = false;
-CVAR(String, dir_last, "", CVar::Flag::Save)
 CVAR(Bool, update_check, true, CVar::Flag::Save)
 CVAR(Bool, update_check_beta, false, CVar::Flag::Save)
 
@@ -243,9 +218,8 @@ public:
 
 		// Last 10 log lines
 		trace_ += "\nLast Log Messages:\n";
-		auto& log = Log::history();
-		for (auto a = log.size() - 10; a < log.size(); a++)
-			trace_ += log[a].message + "\n";
+		for (auto& msg : Log::history(10))
+			trace_ += msg.message + "\n";
 
 		// Add stack trace text area
 		text_stack_ = new wxTextCtrl(
@@ -33,6 +33,7 @@
 #include "Archive.h"
 #include "General/UndoRedo.h"
 #include "Utility/Parser.h"
+#include "Utility/Profiler.h"
 #include "Utility/StringUtils.h"
 #include <filesystem>
 
@@ -399,6 +400,8 @@ std::string Archive::filename(bool full) const
 // -----------------------------------------------------------------------------
 bool Archive::open(std::string_view filename)
 {
+	PROFILE_ZONE("Archive::open");
+
 	// Read the file into a MemChunk
 	MemChunk mc;
 	if (!mc.importFile(filename))
@@ -432,6 +435,8 @@ bool Archive::open(std::string_view filename)
 // -----------------------------------------------------------------------------
 bool Archive::open(ArchiveEntry* entry)
 {
+	PROFILE_ZONE("Archive::open (entry)");
+
 	// Load from entry's data
 	if (entry && open(entry->data()))
 	{
@@ -568,6 +573,8 @@ ArchiveEntry::SPtr Archive::entryAtPathShared(std::string_view path)
 // -----------------------------------------------------------------------------
 bool Archive::write(std::string_view filename, bool update)
 {
+	PROFILE_ZONE("Archive::write");
+
 	// Write to a MemChunk, then export it to a file
 	MemChunk mc;
 	if (write(mc, true))
@@ -586,6 +593,8 @@ bool Archive::write(std::string_view filename, bool update)
 // -----------------------------------------------------------------------------
 bool Archive::save(std::string_view filename)
 {
+	PROFILE_ZONE("Archive::save");
+
 	bool success = false;
 
 	// Check if the archive is read-only
@@ -595,6 +604,9 @@ bool Archive::save(std::string_view filename)
 		return false;
 	}
 
+	// Writing sets the state of every entry
+	Announcer::Batch batch;
+
 	// If the archive has a parent ArchiveEntry, just write it to that
 	if (parent_)
 	{
@@ -699,6 +711,27 @@ void Archive::entryStateChanged(ArchiveEntry* entry)
 	setModified(true);
 }
 
+// -----------------------------------------------------------------------------
+// Loads the data of all entries in the directory structure starting from
+// [start], and builds their directories' name indexes.
+// Afterwards, the archive can be read from multiple threads at once, as long as
+// nothing modifies it
+// -----------------------------------------------------------------------------
+void Archive::preloadEntries(ArchiveTreeNode* start)
+{
+	// If no start dir is specified, use the root dir
+	if (!start)
+		start = &dir_root_;
+
+	start->buildNameIndex();
+	for (unsigned a = 0; a < start->numEntries(); a++)
+		start->entryAt(a)->data();
+
+	// Go through subdirectories
+	for (unsigned a = 0; a < start->nChildren(); a++)
+		preloadEntries((ArchiveTreeNode*)start->child(a));
+}
+
 // -----------------------------------------------------------------------------
 // Adds the directory structure starting from [start] to [list]
 // -----------------------------------------------------------------------------
@@ -1236,6 +1269,7 @@ bool Archive::importDir(std::string_view directory)
 			files.push_back(item.path().string());
 
 	// Go through files
+	Announcer::Batch batch;
 	for (const auto& file : files)
 	{
 		StrUtil::Path fn{ StrUtil::replace(file, directory, "") }; // Remove directory from entry name
@@ -90,6 +90,7 @@ public:
 	void             entryStateChanged(ArchiveEntry* entry);
 	void             putEntryTreeAsList(vector<ArchiveEntry*>& list, ArchiveTreeNode* start = nullptr);
 	void             putEntryTreeAsList(vector<ArchiveEntry::SPtr>& list, ArchiveTreeNode* start = nullptr);
+	void             preloadEntries(ArchiveTreeNode* start = nullptr);
 	bool             canSave() const { return parent_ || on_disk_; }
 	virtual bool     paste(ArchiveTreeNode* tree, unsigned position = 0xFFFFFFFF, ArchiveTreeNode* base = nullptr);
 	virtual bool     importDir(std::string_view directory);
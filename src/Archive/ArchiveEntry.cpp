@@ -200,8 +200,13 @@ ArchiveEntry::SPtr ArchiveEntry::getShared()
 // -----------------------------------------------------------------------------
 void ArchiveEntry::setName(std::string_view name)
 {
-	name_       = name;
-	upper_name_ = StrUtil::upper(name);
+	auto old_upper_name = upper_name_;
+	name_               = name;
+	upper_name_         = StrUtil::upper(name);
+
+	// Update parent directory's name index
+	if (parent_ && upper_name_ != old_upper_name)
+		parent_->entryRenamed(this, old_upper_name);
 }
 
 // -----------------------------------------------------------------------------
@@ -272,17 +277,12 @@ void ArchiveEntry::unlock()
 // -----------------------------------------------------------------------------
 void ArchiveEntry::formatName(const ArchiveFormat& format)
 {
-	bool changed = false;
-
 	// Perform character substitution if needed
 	name_ = Misc::fileNameToLumpName(name_);
 
 	// Max length
 	if (format.max_name_length > 0 && (int)name_.size() > format.max_name_length)
-	{
 		StrUtil::truncateIP(name_, format.max_name_length);
-		changed = true;
-	}
 
 	// Uppercase
 	if (format.prefer_uppercase && wad_force_uppercase)
@@ -290,19 +290,18 @@ void ArchiveEntry::formatName(const ArchiveFormat& format)
 
 	// Remove \ or / if the format supports folders
 	if (format.supports_dirs && name_.find('/') != std::string::npos || name_.find('\\') != std::string::npos)
-	{
-		name_   = Misc::lumpNameToFileName(name_).ToStdString();
-		changed = true;
-	}
+		name_ = Misc::lumpNameToFileName(name_).ToStdString();
 
 	// Remove extension if the format doesn't have them
 	if (!format.names_extensions)
 		if (auto pos = name_.find('.'); pos != std::string::npos)
 			StrUtil::truncateIP(name_, pos);
 
-	// Update upper name
-	if (changed)
-		upper_name_ = StrUtil::upper(name_);
+	// Update upper name (and parent directory's name index)
+	auto old_upper_name = upper_name_;
+	upper_name_         = StrUtil::upper(name_);
+	if (parent_ && upper_name_ != old_upper_name)
+		parent_->entryRenamed(this, old_upper_name);
 }
 
 // -----------------------------------------------------------------------------
@@ -169,6 +169,27 @@ vector<ArchiveEntry::SPtr> ArchiveTreeNode::allEntries()
 	return entries;
 }
 
+// -----------------------------------------------------------------------------
+// Returns all entries matching [name] (case-insensitive, ignoring extensions if
+// [cut_ext] is true) in this directory, in order
+// -----------------------------------------------------------------------------
+const vector<ArchiveEntry*>& ArchiveTreeNode::entriesNamed(std::string_view name, bool cut_ext)
+{
+	static vector<ArchiveEntry*> no_entries;
+
+	// Check name was given
+	if (name.empty())
+		return no_entries;
+
+	// Build name index if needed
+	if (!name_index_built_)
+		buildNameIndex();
+
+	auto& index = cut_ext ? name_index_noext_ : name_index_;
+	auto  found = index.find(StrUtil::upper(name));
+	return found == index.end() ? no_entries : found->second;
+}
+
 // -----------------------------------------------------------------------------
 // Returns the entry at [index] in this directory, or null if [index] is out of
 // bounds
@@ -196,47 +217,33 @@ ArchiveEntry::SPtr ArchiveTreeNode::sharedEntryAt(unsigned index)
 }
 
 // -----------------------------------------------------------------------------
-// Returns the entry matching [name] in this directory, or null if no entries
-// match
+// Returns the first entry matching [name] in this directory, or null if no
+// entries match
 // -----------------------------------------------------------------------------
 ArchiveEntry* ArchiveTreeNode::entry(std::string_view name, bool cut_ext)
 {
-	// Check name was given
-	if (name.empty())
-		return nullptr;
-
-	// Go through entries
-	for (auto& entry : entries_)
-	{
-		// Check for (non-case-sensitive) name match
-		if (StrUtil::equalCI(cut_ext ? entry->nameNoExt() : entry->name(), name))
-			return entry.get();
-	}
+	auto& matches = entriesNamed(name, cut_ext);
+	return matches.empty() ? nullptr : matches.front();
+}
 
-	// Not found
-	return nullptr;
+// -----------------------------------------------------------------------------
+// Returns the last entry matching [name] in this directory, or null if no
+// entries match
+// -----------------------------------------------------------------------------
+ArchiveEntry* ArchiveTreeNode::lastEntry(std::string_view name, bool cut_ext)
+{
+	auto& matches = entriesNamed(name, cut_ext);
+	return matches.empty() ? nullptr : matches.back();
 }
 
 // -----------------------------------------------------------------------------
-// Returns a shared pointer to the entry matching [name] in this directory, or
-// null if no entries match
+// Returns a shared pointer to the first entry matching [name] in this
+// directory, or null if no entries match
 // -----------------------------------------------------------------------------
 ArchiveEntry::SPtr ArchiveTreeNode::sharedEntry(std::string_view name, bool cut_ext)
 {
-	// Check name was given
-	if (name.empty())
-		return nullptr;
-
-	// Go through entries
-	for (auto& entry : entries_)
-	{
-		// Check for (non-case-sensitive) name match
-		if (StrUtil::equalCI(cut_ext ? entry->nameNoExt() : entry->name(), name))
-			return entry;
-	}
-
-	// Not found
-	return nullptr;
+	auto index = entryIndex(entry(name, cut_ext));
+	return index >= 0 ? entries_[index] : nullptr;
 }
 
 // -----------------------------------------------------------------------------
@@ -307,6 +314,7 @@ bool ArchiveTreeNode::addEntry(ArchiveEntry* entry, unsigned index)
 
 		// Add it to end
 		entries_.push_back(ArchiveEntry::SPtr(entry));
+		index = entries_.size() - 1;
 	}
 	else
 	{
@@ -324,7 +332,9 @@ bool ArchiveTreeNode::addEntry(ArchiveEntry* entry, unsigned index)
 	}
 
 	// Set entry's parent to this node
-	entry->parent_ = this;
+	entry->parent_      = this;
+	entry->index_guess_ = index;
+	indexEntry(entry, index);
 
 	// Check entry name if duplicate names aren't allowed
 	if (!allow_duplicate_names_)
@@ -358,6 +368,7 @@ bool ArchiveTreeNode::addEntry(ArchiveEntry::SPtr& entry, unsigned index)
 
 		// Add it to end
 		entries_.push_back(ArchiveEntry::SPtr(entry));
+		index = entries_.size() - 1;
 	}
 	else
 	{
@@ -375,7 +386,9 @@ bool ArchiveTreeNode::addEntry(ArchiveEntry::SPtr& entry, unsigned index)
 	}
 
 	// Set entry's parent to this node
-	entry->parent_ = this;
+	entry->parent_      = this;
+	entry->index_guess_ = index;
+	indexEntry(entry.get(), index);
 
 	// Check entry name if duplicate names aren't allowed
 	if (!allow_duplicate_names_)
@@ -395,6 +408,7 @@ bool ArchiveTreeNode::removeEntry(unsigned index)
 		return false;
 
 	// De-parent entry
+	unindexEntry(entries_[index].get(), entries_[index]->upperName());
 	entries_[index]->parent_ = nullptr;
 
 	// De-link entry
@@ -434,6 +448,12 @@ bool ArchiveTreeNode::swapEntries(unsigned index1, unsigned index2)
 	linkEntries(entryAt(index2 - 1), entry1);
 	linkEntries(entry1, entryAt(index2 + 1));
 
+	// Update name index
+	if (unindexEntry(entry1, entry1->upperName()))
+		indexEntry(entry1, index2);
+	if (unindexEntry(entry2, entry2->upperName()))
+		indexEntry(entry2, index1);
+
 	return true;
 }
 
@@ -444,6 +464,9 @@ void ArchiveTreeNode::clear()
 {
 	// Clear entries
 	entries_.clear();
+	name_index_.clear();
+	name_index_noext_.clear();
+	name_index_built_ = false;
 
 	// Clear subdirs
 	for (auto& subdir : children_)
@@ -569,3 +592,180 @@ void ArchiveTreeNode::ensureUniqueName(ArchiveEntry* entry)
 	if (number > 0)
 		entry->rename(name);
 }
+
+// -----------------------------------------------------------------------------
+// (Re)builds the name index from all entries in this directory
+// -----------------------------------------------------------------------------
+void ArchiveTreeNode::buildNameIndex()
+{
+	name_index_.clear();
+	name_index_noext_.clear();
+	name_index_.reserve(entries_.size());
+	name_index_noext_.reserve(entries_.size());
+
+	for (unsigned a = 0; a < entries_.size(); a++)
+	{
+		auto entry          = entries_[a].get();
+		entry->index_guess_ = a;
+		name_index_[entry->upperName()].push_back(entry);
+		name_index_noext_[std::string{ entry->upperNameNoExt() }].push_back(entry);
+	}
+
+	name_index_built_ = true;
+}
+
+// -----------------------------------------------------------------------------
+// Adds [entry] (at [index] in this directory) to the name index, if it has
+// been built
+// -----------------------------------------------------------------------------
+void ArchiveTreeNode::indexEntry(ArchiveEntry* entry, unsigned index)
+{
+	if (!name_index_built_)
+		return;
+
+	auto insert = [this, entry, index](vector<ArchiveEntry*>& list) {
+		// Keep the list in directory order (the entry is usually last)
+		auto pos = list.size();
+		while (pos > 0 && entryIndex(list[pos - 1]) > (int)index)
+			pos--;
+		list.insert(list.begin() + pos, entry);
+	};
+
+	insert(name_index_[entry->upperName()]);
+	insert(name_index_noext_[std::string{ entry->upperNameNoExt() }]);
+}
+
+// -----------------------------------------------------------------------------
+// Removes [entry] from the name index, where [upper_name] is the (uppercase)
+// name it was indexed under.
+// Returns false if the entry wasn't in the index
+// -----------------------------------------------------------------------------
+bool ArchiveTreeNode::unindexEntry(ArchiveEntry* entry, std::string_view upper_name)
+{
+	if (!name_index_built_)
+		return false;
+
+	auto remove = [entry](NameIndex& index, const std::string& name) {
+		auto found = index.find(name);
+		if (found == index.end())
+			return false;
+
+		auto& list = found->second;
+		auto  pos  = std::find(list.begin(), list.end(), entry);
+		if (pos == list.end())
+			return false;
+
+		list.erase(pos);
+		if (list.empty())
+			index.erase(found);
+
+		return true;
+	};
+
+	bool found = remove(name_index_, std::string{ upper_name });
+	remove(name_index_noext_, std::string{ upper_name.substr(0, upper_name.find('.')) });
+
+	return found;
+}
+
+// -----------------------------------------------------------------------------
+// Called when [entry] has been renamed from [old_upper_name], updates the name
+// index if the entry is in this directory
+// -----------------------------------------------------------------------------
+void ArchiveTreeNode::entryRenamed(ArchiveEntry* entry, std::string_view old_upper_name)
+{
+	if (unindexEntry(entry, old_upper_name))
+		indexEntry(entry, entryIndex(entry));
+}
+
+
+// Testing
+
+#include "General/Console/Console.h"
+
+CONSOLE_COMMAND(test_entry_lookup, 0, false)
+{
+	// Times looking up entries by name in a large directory via the name index,
+	// compared to a linear search, and checks the results match
+	unsigned n_entries = args.empty() ? 30000 : StrUtil::toInt(args[0]);
+	unsigned n_lookups = args.size() < 2 ? 10000 : StrUtil::toInt(args[1]);
+	if (n_entries == 0 || n_lookups == 0)
+		return;
+
+	// Create entries (with some duplicate names)
+	auto random_name = [](unsigned max_length) {
+		std::string name;
+		auto        length = 1 + rand() % max_length;
+		for (unsigned a = 0; a < length; a++)
+			name += "abcdefghijklmnopqrstuvwxyz0123456789_"[rand() % 37];
+		return name;
+	};
+	ArchiveTreeNode dir;
+	for (unsigned a = 0; a < n_entries; a++)
+		dir.addEntry(new ArchiveEntry(random_name(8) + (a % 3 == 0 ? ".lmp" : "")));
+
+	// Pick names to look up (some existing, some not)
+	vector<std::string> names;
+	for (unsigned a = 0; a < n_lookups; a++)
+	{
+		if (a % 4 == 0)
+			names.push_back(random_name(8));
+		else
+			names.push_back(StrUtil::upper(dir.entryAt(rand() % n_entries)->name()));
+	}
+
+	auto linear = [&dir](std::string_view name, bool cut_ext, bool last) {
+		ArchiveEntry* found = nullptr;
+		for (auto& entry : dir.entries())
+			if (StrUtil::equalCI(cut_ext ? entry->nameNoExt() : entry->name(), name))
+			{
+				found = entry.get();
+				if (!last)
+					break;
+			}
+		return found;
+	};
+
+	for (int pass = 0; pass < 2; pass++)
+	{
+		bool cut_ext = pass == 1;
+		if (cut_ext)
+			for (auto& name : names)
+				name = name.substr(0, name.find('.'));
+
+		// Indexed
+		vector<ArchiveEntry*> found_index;
+		auto                  start = App::runTimer();
+		for (auto& name : names)
+		{
+			found_index.push_back(dir.entry(name, cut_ext));
+			found_index.push_back(dir.lastEntry(name, cut_ext));
+		}
+		auto time_index = App::runTimer() - start;
+
+		// Linear
+		vector<ArchiveEntry*> found_linear;
+		start = App::runTimer();
+		for (auto& name : names)
+		{
+			found_linear.push_back(linear(name, cut_ext, false));
+			found_linear.push_back(linear(name, cut_ext, true));
+		}
+		auto time_linear = App::runTimer() - start;
+
+		Log::console(wxString::Format(
+			"%d lookups in %d entries%s: indexed %dms, linear %dms, results %s",
+			n_lookups * 2,
+			n_entries,
+			cut_ext ? " (no extension)" : "",
+			(int)time_index,
+			(int)time_linear,
+			found_index == found_linear ? "match" : "DIFFER"));
+
+		// Rename and remove some entries before the next pass to test index updates
+		for (unsigned a = 0; a < n_entries / 10; a++)
+			dir.entryAt(rand() % dir.numEntries())->setName(random_name(8));
+		for (unsigned a = 0; a < n_entries / 10; a++)
+			dir.removeEntry(rand() % dir.numEntries());
+	}
+}
@@ -2,10 +2,12 @@
 
 #include "ArchiveEntry.h"
 #include "Utility/Tree.h"
+#include <unordered_map>
 
 class ArchiveTreeNode : public STreeNode
 {
 	friend class Archive;
+	friend class ArchiveEntry;
 
 public:
 	ArchiveTreeNode(ArchiveTreeNode* parent = nullptr, Archive* archive = nullptr);
@@ -25,12 +27,14 @@ public:
 	ArchiveEntry*      entryAt(unsigned index);
 	ArchiveEntry::SPtr sharedEntryAt(unsigned index);
 	ArchiveEntry*      entry(std::string_view name, bool cut_ext = false);
+	ArchiveEntry*      lastEntry(std::string_view name, bool cut_ext = false);
 	ArchiveEntry::SPtr sharedEntry(std::string_view name, bool cut_ext = false);
 	ArchiveEntry::SPtr sharedEntry(ArchiveEntry* entry);
 	unsigned           numEntries(bool inc_subdirs = false);
 	int                entryIndex(ArchiveEntry* entry, size_t startfrom = 0);
 
-	vector<ArchiveEntry::SPtr> allEntries();
+	vector<ArchiveEntry::SPtr>   allEntries();
+	const vector<ArchiveEntry*>& entriesNamed(std::string_view name, bool cut_ext = false);
 
 	// Entry Operations
 	bool addEntry(ArchiveEntry* entry, unsigned index = 0xFFFFFFFF);
@@ -67,6 +71,17 @@ private:
 	vector<ArchiveEntry::SPtr> entries_;
 	bool                       allow_duplicate_names_ = true;
 
+	// Name index (uppercase name -> matching entries in directory order), built on
+	// first lookup and kept up to date as entries are added, removed or renamed
+	typedef std::unordered_map<std::string, vector<ArchiveEntry*>> NameIndex;
+	NameIndex name_index_;
+	NameIndex name_index_noext_;
+	bool      name_index_built_ = false;
+
 	void        ensureUniqueName(ArchiveEntry* entry);
+	void        buildNameIndex();
+	void        indexEntry(ArchiveEntry* entry, unsigned index);
+	bool        unindexEntry(ArchiveEntry* entry, std::string_view upper_name);
+	void        entryRenamed(ArchiveEntry* entry, std::string_view old_upper_name);
 	static void linkEntries(ArchiveEntry* first, ArchiveEntry* second);
 };
@@ -37,6 +37,7 @@
 #include "General/Console/Console.h"
 #include "MainEditor/MainEditor.h"
 #include "Utility/Parser.h"
+#include "Utility/Profiler.h"
 #include "Utility/StringUtils.h"
 #include <filesystem>
 
@@ -585,6 +586,8 @@ bool EntryType::loadEntryTypes()
 // -----------------------------------------------------------------------------
 bool EntryType::detectEntryType(ArchiveEntry* entry)
 {
+	PROFILE_ZONE("EntryType::detectEntryType");
+
 	// Do nothing if the entry is a folder or a map marker
 	if (!entry || entry->type() == &etype_folder || entry->type() == &etype_map)
 		return false;
@@ -118,6 +118,28 @@ bool isNamespaceEntry(ArchiveEntry* entry)
 {
 	return StrUtil::endsWith(entry->upperName(), "_START") || StrUtil::endsWith(entry->upperName(), "_END");
 }
+
+// -----------------------------------------------------------------------------
+// Returns true if [entry] is of [type] (or [type] is null)
+// -----------------------------------------------------------------------------
+bool matchesType(ArchiveEntry* entry, EntryType* type)
+{
+	if (!type)
+		return true;
+
+	if (entry->type() == EntryType::unknownType())
+		return type->isThisType(entry);
+
+	return entry->type() == type;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [name] is an exact name to search for (no wildcards)
+// -----------------------------------------------------------------------------
+bool isExactName(const std::string& name)
+{
+	return !name.empty() && name.find_first_of("*?") == std::string::npos;
+}
 } // namespace
 
 
@@ -1247,7 +1269,7 @@ void WadArchive::detectIncludes()
 					{
 						if (i >= 3) // skip '=' or '('
 							tz.adv();
-						auto name = tz.next().text;
+						auto name = tz.next().text();
 						if (i == 5) // skip ')'
 							tz.adv();
 						opt.match_name = name;
@@ -1300,6 +1322,22 @@ ArchiveEntry* WadArchive::findFirst(SearchOptions& options)
 			return nullptr;
 	}
 
+	// If searching for an exact name, only check entries with that name (via the
+	// directory name index), the first within the search range wins
+	if (isExactName(options.match_name))
+	{
+		int first = start ? entryIndex(start) : (int)numEntries();
+		int last  = end ? entryIndex(end) : (int)numEntries();
+		for (auto entry : rootDir()->entriesNamed(options.match_name))
+		{
+			int index = entryIndex(entry);
+			if (index >= first && index < last && matchesType(entry, options.match_type))
+				return entry;
+		}
+
+		return nullptr;
+	}
+
 	// Begin search
 	auto entry = start;
 	while (entry != end)
@@ -1380,6 +1418,23 @@ ArchiveEntry* WadArchive::findLast(SearchOptions& options)
 			return nullptr;
 	}
 
+	// If searching for an exact name, only check entries with that name (via the
+	// directory name index), the last within the search range wins
+	if (isExactName(options.match_name))
+	{
+		int   first   = end ? entryIndex(end) + 1 : 0;
+		int   last    = start ? entryIndex(start) : -1;
+		auto& matches = rootDir()->entriesNamed(options.match_name);
+		for (auto it = matches.rbegin(); it != matches.rend(); ++it)
+		{
+			int index = entryIndex(*it);
+			if (index >= first && index <= last && matchesType(*it, options.match_type))
+				return *it;
+		}
+
+		return nullptr;
+	}
+
 	// Begin search
 	auto entry = start;
 	while (entry != end)
@@ -0,0 +1,310 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2019 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    Bench.cpp
+// Description: slade_bench - runs benchmarks of the core (non-UI) parts of
+//              SLADE against synthetic data, and reports the timings.
+//
+//              Usage: slade_bench [options] [filter...]
+//              Only benchmarks with a name containing one of the filters are
+//              run (all benchmarks if no filters are given).
+//              Options:
+//                -i <n>        Timed iterations per measurement (default 10)
+//                -w <n>        Untimed warmup iterations (default 2)
+//                --json <file> Also write results to <file> as JSON lines
+//                --list        List benchmarks and exit
+//
+//              Heap allocations are counted (by replacing the global operator
+//              new) and reported per iteration along with the timings.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "Bench.h"
+#include "App.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <wx/init.h>
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+std::atomic<uint64_t> n_allocs{ 0 };
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Allocation Counting
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Global operator new/delete replacements, counting the number of allocations.
+// The other (array, nothrow) forms use these by default
+// -----------------------------------------------------------------------------
+void* operator new(std::size_t size)
+{
+	n_allocs.fetch_add(1, std::memory_order_relaxed);
+	if (auto ptr = malloc(size ? size : 1))
+		return ptr;
+	throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept
+{
+	free(ptr);
+}
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	free(ptr);
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Bench::Context Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Runs [func] for the configured number of warmup and timed iterations, and
+// records the timings as a result named [name] (within the current benchmark).
+// [items] is the number of items (entries, lines, etc.) processed by each call
+// to [func], for reference. If given, [reset] is called (untimed) before each
+// iteration
+// -----------------------------------------------------------------------------
+void Bench::Context::measure(
+	std::string_view             name,
+	const std::function<void()>& func,
+	unsigned                     items,
+	const std::function<void()>& reset)
+{
+	typedef std::chrono::steady_clock Clock;
+
+	// Warmup
+	for (unsigned a = 0; a < warmup_; ++a)
+	{
+		if (reset)
+			reset();
+		func();
+	}
+
+	// Timed iterations
+	vector<double> times;
+	uint64_t       allocs = 0;
+	for (unsigned a = 0; a < iterations_; ++a)
+	{
+		if (reset)
+			reset();
+
+		auto allocs_start = n_allocs.load(std::memory_order_relaxed);
+		auto start        = Clock::now();
+		func();
+		times.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+		allocs += n_allocs.load(std::memory_order_relaxed) - allocs_start;
+	}
+
+	// Record result
+	Result result;
+	result.name       = fmt::format("{}/{}", benchmark_, name);
+	result.iterations = iterations_;
+	result.items      = items;
+	result.allocs     = iterations_ > 0 ? allocs / iterations_ : 0;
+	if (!times.empty())
+	{
+		std::sort(times.begin(), times.end());
+		result.min_ms    = times.front();
+		result.max_ms    = times.back();
+		result.median_ms = times.size() % 2 == 0 ? (times[times.size() / 2 - 1] + times[times.size() / 2]) * 0.5 :
+												   times[times.size() / 2];
+		for (auto time : times)
+			result.mean_ms += time;
+		result.mean_ms /= times.size();
+	}
+	results_.push_back(result);
+
+	// Report progress
+	printf(
+		"%-40s %10.3fms %10.3fms %10.3fms %10.3fms %8u %10llu\n",
+		result.name.c_str(),
+		result.min_ms,
+		result.median_ms,
+		result.mean_ms,
+		result.max_ms,
+		result.items,
+		(unsigned long long)result.allocs);
+	fflush(stdout);
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Bench::Registrar Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Bench::Registrar class constructor - adds the benchmark [name] running [func]
+// to the list of benchmarks
+// -----------------------------------------------------------------------------
+Bench::Registrar::Registrar(std::string_view name, Func func)
+{
+	benchmarks().push_back({ std::string{ name }, func });
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Bench Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the list of all registered benchmarks
+// -----------------------------------------------------------------------------
+vector<Bench::Benchmark>& Bench::benchmarks()
+{
+	static vector<Benchmark> list;
+	return list;
+}
+
+// -----------------------------------------------------------------------------
+// Returns [result] as a single-line JSON object
+// -----------------------------------------------------------------------------
+std::string Bench::resultJson(const Result& result)
+{
+	return fmt::format(
+		"{{\"name\": \"{}\", \"iterations\": {}, \"items\": {}, \"min_ms\": {:.4f}, \"median_ms\": {:.4f}, "
+		"\"mean_ms\": {:.4f}, \"max_ms\": {:.4f}, \"allocs\": {}}}",
+		result.name,
+		result.iterations,
+		result.items,
+		result.min_ms,
+		result.median_ms,
+		result.mean_ms,
+		result.max_ms,
+		result.allocs);
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Main
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// slade_bench entry point
+// -----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+	// Parse command line
+	unsigned            iterations = 10;
+	unsigned            warmup     = 2;
+	std::string         json_file;
+	vector<std::string> filters;
+	for (int a = 1; a < argc; ++a)
+	{
+		std::string arg = argv[a];
+		if (arg == "-i" && a + 1 < argc)
+			iterations = std::max(1, atoi(argv[++a]));
+		else if (arg == "-w" && a + 1 < argc)
+			warmup = std::max(0, atoi(argv[++a]));
+		else if (arg == "--json" && a + 1 < argc)
+			json_file = argv[++a];
+		else if (arg == "--list")
+		{
+			for (auto& benchmark : Bench::benchmarks())
+				printf("%s\n", benchmark.name.c_str());
+			return 0;
+		}
+		else
+			filters.push_back(arg);
+	}
+
+	// Init wx (as a console app, no display needed)
+	wxInitializer wx_init(argc, argv);
+	if (!wx_init.IsOk())
+	{
+		fprintf(stderr, "Failed to initialise wxWidgets\n");
+		return 1;
+	}
+
+	// Init core subsystems
+	if (!App::initHeadless())
+	{
+		fprintf(stderr, "Initialisation failed: %s\n", Global::error.c_str());
+		return 1;
+	}
+
+	// Open json output file
+	FILE* json = nullptr;
+	if (!json_file.empty())
+	{
+		json = fopen(json_file.c_str(), "w");
+		if (!json)
+		{
+			fprintf(stderr, "Unable to open %s for writing\n", json_file.c_str());
+			return 1;
+		}
+	}
+
+	// Run benchmarks
+	printf("%-40s %12s %12s %12s %12s %8s %10s\n", "Benchmark", "Min", "Median", "Mean", "Max", "Items", "Allocs");
+	for (auto& benchmark : Bench::benchmarks())
+	{
+		// Check filters
+		bool run = filters.empty();
+		for (auto& filter : filters)
+			if (benchmark.name.find(filter) != std::string::npos)
+				run = true;
+		if (!run)
+			continue;
+
+		Bench::Context ctx(benchmark.name, iterations, warmup);
+		benchmark.func(ctx);
+
+		if (json)
+			for (auto& result : ctx.results())
+				fprintf(json, "%s\n", Bench::resultJson(result).c_str());
+	}
+
+	if (json)
+		fclose(json);
+
+	return 0;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <random>
+
+// Benchmark registration
+// -----------------------------------------------------------------------------
+// BENCHMARK(name) { ... } defines a benchmark function taking a Bench::Context
+// (ctx), which is registered automatically and run by slade_bench. Within it,
+// set up any data needed then call ctx.measure for each timed operation.
+// Synthetic data should be generated with ctx.rng() (or ctx.randomInt) so
+// results are reproducible between runs
+// -----------------------------------------------------------------------------
+#define BENCHMARK(name)                                      \
+	void             bench_##name(Bench::Context& ctx);      \
+	Bench::Registrar bench_reg_##name(#name, &bench_##name); \
+	void             bench_##name(Bench::Context& ctx)
+
+namespace Bench
+{
+struct Result
+{
+	std::string name;
+	unsigned    iterations = 0;
+	unsigned    items      = 0; // Number of items processed per iteration
+	double      min_ms     = 0.;
+	double      median_ms  = 0.;
+	double      mean_ms    = 0.;
+	double      max_ms     = 0.;
+	uint64_t    allocs     = 0; // Number of heap allocations per iteration (mean)
+};
+
+class Context
+{
+public:
+	Context(std::string_view benchmark, unsigned iterations, unsigned warmup) :
+		benchmark_{ benchmark },
+		iterations_{ iterations },
+		warmup_{ warmup },
+		rng_{ 0x5eed }
+	{
+	}
+	~Context() = default;
+
+	const vector<Result>& results() const { return results_; }
+	std::mt19937&         rng() { return rng_; }
+	unsigned              iterations() const { return iterations_; }
+
+	// Returns a random integer in the range [min, max]
+	int randomInt(int min, int max) { return std::uniform_int_distribution<int>(min, max)(rng_); }
+
+	void measure(
+		std::string_view             name,
+		const std::function<void()>& func,
+		unsigned                     items = 0,
+		const std::function<void()>& reset = {});
+
+private:
+	std::string    benchmark_;
+	unsigned       iterations_;
+	unsigned       warmup_;
+	std::mt19937   rng_;
+	vector<Result> results_;
+};
+
+typedef void (*Func)(Context&);
+
+class Registrar
+{
+public:
+	Registrar(std::string_view name, Func func);
+	~Registrar() = default;
+};
+
+struct Benchmark
+{
+	std::string name;
+	Func        func;
+};
+
+vector<Benchmark>& benchmarks();
+std::string        resultJson(const Result& result);
+} // namespace Bench
@@ -0,0 +1,759 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2019 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    Benchmarks.cpp
+// Description: Benchmarks run by slade_bench. Each generates its data from a
+//              fixed seed, so the results of different builds can be compared
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "Bench.h"
+#include "App.h"
+#include "Archive/ArchiveManager.h"
+#include "Archive/EntryType/EntryType.h"
+#include "Archive/Formats/WadArchive.h"
+#include "Archive/Formats/ZipArchive.h"
+#include "General/ResourceManager.h"
+#include "Graphics/CTexture/CTexture.h"
+#include "Graphics/ImageDecodeQueue.h"
+#include "Graphics/Palette/PaletteManager.h"
+#include "Graphics/Palette/PaletteTables.h"
+#include "Graphics/SImage/SIFormat.h"
+#include "Graphics/SImage/SImage.h"
+#include "MapEditor/Renderer/MapBuffers2D.h"
+#include "SLADEMap/SLADEMap.h"
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Fills [mc] with [size] bytes of random data
+// -----------------------------------------------------------------------------
+void randomData(Bench::Context& ctx, MemChunk& mc, unsigned size)
+{
+	vector<uint8_t> data(size);
+	for (auto& byte : data)
+		byte = ctx.randomInt(0, 255);
+	mc.importMem(data.data(), size);
+}
+
+// -----------------------------------------------------------------------------
+// Adds [count] entries of random data (64b-4kb each) to [archive], spread
+// across [n_dirs] directories (if the archive supports them)
+// -----------------------------------------------------------------------------
+void addRandomEntries(Bench::Context& ctx, Archive& archive, unsigned count, unsigned n_dirs = 1)
+{
+	MemChunk mc;
+	for (unsigned a = 0; a < count; ++a)
+	{
+		ArchiveTreeNode* dir = nullptr;
+		if (n_dirs > 1)
+			dir = archive.createDir(fmt::format("dir{:02d}", a % n_dirs));
+
+		auto entry = archive.addNewEntry(fmt::format("ENT{:05d}", a), 0xFFFFFFFF, dir);
+		randomData(ctx, mc, ctx.randomInt(64, 4096));
+		entry->importMemChunk(mc);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns UDMF TEXTMAP data for a grid of [size]x[size] square sectors, with a
+// thing in the middle of each sector
+// -----------------------------------------------------------------------------
+std::string udmfGrid(Bench::Context& ctx, int size)
+{
+	std::string textmap = "namespace = \"doom\";\n";
+	std::string lines;
+	std::string sides;
+	int         n_sides = 0;
+	const int   cell    = 64;
+
+	// Vertices
+	auto vertex_index = [size](int x, int y) { return y * (size + 1) + x; };
+	for (int y = 0; y <= size; ++y)
+		for (int x = 0; x <= size; ++x)
+			textmap += fmt::format("vertex {{ x = {:.3f}; y = {:.3f}; }}\n", (double)x * cell, (double)y * cell);
+
+	// Adds a line from v1 to v2 with the sector index [front] on the right and
+	// [back] (if not -1) on the left
+	auto add_line = [&](int v1, int v2, int front, int back) {
+		lines += fmt::format("linedef {{ v1 = {}; v2 = {}; sidefront = {}; ", v1, v2, n_sides++);
+		sides += fmt::format("sidedef {{ sector = {}; texturemiddle = \"STARTAN2\"; }}\n", front);
+		if (back >= 0)
+		{
+			lines += fmt::format("sideback = {}; twosided = true; }}\n", n_sides++);
+			sides += fmt::format("sidedef {{ sector = {}; }}\n", back);
+		}
+		else
+			lines += "blocking = true; }\n";
+	};
+
+	// Lines (horizontal then vertical)
+	auto sector_index = [size](int x, int y) { return y * size + x; };
+	for (int y = 0; y <= size; ++y)
+		for (int x = 0; x < size; ++x)
+		{
+			if (y == 0)
+				add_line(vertex_index(x + 1, y), vertex_index(x, y), sector_index(x, y), -1);
+			else if (y == size)
+				add_line(vertex_index(x, y), vertex_index(x + 1, y), sector_index(x, y - 1), -1);
+			else
+				add_line(vertex_index(x, y), vertex_index(x + 1, y), sector_index(x, y - 1), sector_index(x, y));
+		}
+	for (int x = 0; x <= size; ++x)
+		for (int y = 0; y < size; ++y)
+		{
+			if (x == 0)
+				add_line(vertex_index(x, y), vertex_index(x, y + 1), sector_index(x, y), -1);
+			else if (x == size)
+				add_line(vertex_index(x, y + 1), vertex_index(x, y), sector_index(x - 1, y), -1);
+			else
+				add_line(vertex_index(x, y), vertex_index(x, y + 1), sector_index(x, y), sector_index(x - 1, y));
+		}
+
+	textmap += lines;
+	textmap += sides;
+
+	// Sectors and things
+	for (int a = 0; a < size * size; ++a)
+		textmap += fmt::format(
+			"sector {{ heightfloor = {}; heightceiling = 128; texturefloor = \"FLOOR0_1\"; "
+			"textureceiling = \"CEIL1_1\"; lightlevel = {}; }}\n",
+			ctx.randomInt(0, 4) * 8,
+			ctx.randomInt(8, 32) * 8);
+	for (int y = 0; y < size; ++y)
+		for (int x = 0; x < size; ++x)
+			textmap += fmt::format(
+				"thing {{ x = {:.3f}; y = {:.3f}; type = {}; angle = {}; }}\n",
+				(double)x * cell + cell / 2,
+				(double)y * cell + cell / 2,
+				ctx.randomInt(2001, 2014),
+				ctx.randomInt(0, 7) * 45);
+
+	return textmap;
+}
+
+// -----------------------------------------------------------------------------
+// Adds a UDMF map (MAP01) of [size]x[size] sectors to [wad], and writes its
+// description to [map]. Returns false if the map wasn't detected
+// -----------------------------------------------------------------------------
+bool createUdmfMap(Bench::Context& ctx, WadArchive& wad, int size, Archive::MapDesc& map)
+{
+	auto textmap = udmfGrid(ctx, size);
+	wad.addNewEntry("MAP01");
+	wad.addNewEntry("TEXTMAP")->importMem(textmap.data(), textmap.size());
+	wad.addNewEntry("ENDMAP");
+
+	auto maps = wad.detectMaps();
+	if (maps.empty())
+	{
+		Log::error("Generated benchmark map not detected");
+		return false;
+	}
+
+	map = maps[0];
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Creates [image] as a [width]x[height] paletted image of random pixels
+// -----------------------------------------------------------------------------
+void randomPalettedImage(Bench::Context& ctx, SImage& image, int width, int height)
+{
+	image.create(width, height, SImage::Type::PalMask);
+	for (int y = 0; y < height; ++y)
+		for (int x = 0; x < width; ++x)
+			image.setPixel(x, y, ctx.randomInt(0, 255), 255);
+}
+
+// -----------------------------------------------------------------------------
+// Listener that counts the announcements it receives
+// -----------------------------------------------------------------------------
+class CountingListener : public Listener
+{
+public:
+	unsigned count = 0;
+
+	void onAnnouncement(Announcer* announcer, const wxString& event_name, MemChunk& event_data) override { ++count; }
+};
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Benchmarks
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Opening and saving a wad with 2000 entries
+// -----------------------------------------------------------------------------
+BENCHMARK(archive_wad)
+{
+	WadArchive wad;
+	addRandomEntries(ctx, wad, 2000);
+
+	MemChunk data;
+	ctx.measure("write", [&]() { wad.write(data); }, 2000);
+	ctx.measure("open", [&]() { WadArchive().open(data); }, 2000);
+}
+
+// -----------------------------------------------------------------------------
+// Opening and saving a zip with 2000 entries in 20 directories
+// -----------------------------------------------------------------------------
+BENCHMARK(archive_zip)
+{
+	ZipArchive zip;
+	addRandomEntries(ctx, zip, 2000, 20);
+
+	MemChunk data;
+	ctx.measure("write", [&]() { zip.write(data); }, 2000);
+	ctx.measure("open", [&]() { ZipArchive().open(data); }, 2000);
+}
+
+// -----------------------------------------------------------------------------
+// Entry type detection, for the contents of slade.pk3 and random data
+// -----------------------------------------------------------------------------
+BENCHMARK(entry_type_detection)
+{
+	vector<ArchiveEntry*> entries;
+	App::archiveManager().programResourceArchive()->putEntryTreeAsList(entries);
+	ctx.measure(
+		"slade_pk3",
+		[&]() {
+			for (auto entry : entries)
+				EntryType::detectEntryType(entry);
+		},
+		entries.size());
+
+	WadArchive wad;
+	addRandomEntries(ctx, wad, 2000);
+	entries.clear();
+	wad.putEntryTreeAsList(entries);
+	ctx.measure(
+		"random",
+		[&]() {
+			for (auto entry : entries)
+				EntryType::detectEntryType(entry);
+		},
+		entries.size());
+}
+
+// -----------------------------------------------------------------------------
+// Loading and saving a UDMF map of 64x64 sectors
+// -----------------------------------------------------------------------------
+BENCHMARK(map_udmf)
+{
+	const int size = 64;
+
+	// Create map in a wad
+	WadArchive       wad;
+	Archive::MapDesc map_desc;
+	if (!createUdmfMap(ctx, wad, size, map_desc))
+		return;
+
+	SLADEMap map;
+	ctx.measure("read", [&]() { map.readMap(map_desc); }, size * size, [&]() { map.clearMap(); });
+	ctx.measure(
+		"write",
+		[&]() {
+			vector<ArchiveEntry*> map_entries;
+			map.writeMap(map_entries);
+			for (auto entry : map_entries)
+				delete entry;
+		},
+		size * size);
+}
+
+// -----------------------------------------------------------------------------
+// Loading and clearing a UDMF map of 128x128 sectors, and creating/clearing
+// 500k map objects directly (without parsing)
+// -----------------------------------------------------------------------------
+BENCHMARK(map_objects)
+{
+	const int size      = 128;
+	const int n_objects = 500000;
+
+	WadArchive       wad;
+	Archive::MapDesc map_desc;
+	if (!createUdmfMap(ctx, wad, size, map_desc))
+		return;
+
+	SLADEMap map;
+	map.readMap(map_desc);
+	unsigned n_map_objects = map.nVertices() + map.nLines() + map.nSides() + map.nSectors() + map.nThings();
+	ctx.measure("load", [&]() { map.readMap(map_desc); }, n_map_objects, [&]() { map.clearMap(); });
+	ctx.measure("clear", [&]() { map.clearMap(); }, n_map_objects, [&]() { map.readMap(map_desc); });
+
+	// Vertices joined by lines (each with a side and sector), and things
+	MapObjectCollection objects;
+
+	auto create = [&]() {
+		auto prev = objects.createVertex(Vec2d{ 0., 0. });
+		for (int a = 1; a <= n_objects / 5; ++a)
+		{
+			auto vertex = objects.createVertex(Vec2d{ (double)a, 0. });
+			objects.createLine(prev, vertex, objects.createSide(objects.createSector()), nullptr);
+			objects.createThing(Vec3d{ (double)a, 8., 0. }, 1);
+			prev = vertex;
+		}
+	};
+	ctx.measure("create", create, n_objects, [&]() { objects.clear(); });
+	ctx.measure("clear_created", [&]() { objects.clear(); }, n_objects, create);
+}
+
+// -----------------------------------------------------------------------------
+// Spatial queries on a map of 64x64 sectors, through the map objects and the
+// map geometry cache
+// -----------------------------------------------------------------------------
+BENCHMARK(map_queries)
+{
+	const int size    = 64;
+	const int queries = 1000;
+
+	WadArchive       wad;
+	Archive::MapDesc map_desc;
+	if (!createUdmfMap(ctx, wad, size, map_desc))
+		return;
+	SLADEMap map;
+	map.readMap(map_desc);
+
+	// Random query points within the map bounds
+	vector<Vec2d> points(queries);
+	for (auto& point : points)
+		point = { (double)ctx.randomInt(0, size * 64), (double)ctx.randomInt(0, size * 64) };
+
+	ctx.measure(
+		"nearest_vertex",
+		[&]() {
+			for (auto& point : points)
+				map.vertices().nearest(point);
+		},
+		queries);
+	ctx.measure(
+		"nearest_line",
+		[&]() {
+			for (auto& point : points)
+				map.lines().nearest(point);
+		},
+		queries);
+	ctx.measure(
+		"nearest_thing",
+		[&]() {
+			for (auto& point : points)
+				map.things().nearest(point);
+		},
+		queries);
+	ctx.measure(
+		"sector_at",
+		[&]() {
+			for (auto& point : points)
+				map.sectors().atPos(point);
+		},
+		queries);
+
+	// The same queries using the map geometry cache
+	auto& geometry = map.mapData().geometry();
+	ctx.measure(
+		"nearest_line_geometry",
+		[&]() {
+			for (auto& point : points)
+				geometry.nearestLine(point);
+		},
+		queries);
+	ctx.measure(
+		"sector_at_geometry",
+		[&]() {
+			for (auto& point : points)
+				geometry.sectorAt(point);
+		},
+		queries);
+
+	// Distance from a point to every line
+	vector<double> distances(map.nLines());
+	ctx.measure(
+		"line_distances",
+		[&]() {
+			for (unsigned a = 0; a < map.nLines(); ++a)
+				distances[a] = map.line(a)->distanceTo(points[0]);
+		},
+		map.nLines());
+	ctx.measure(
+		"line_distances_geometry", [&]() { geometry.lineDistances(points[0], distances.data()); }, map.nLines());
+
+	// Rebuilding the geometry cache
+	ctx.measure(
+		"geometry_build", [&]() { map.mapData().geometry(); }, map.nLines(), [&]() { map.invalidateGeometry(); });
+}
+
+// -----------------------------------------------------------------------------
+// Generating 2d map view vertex/line data for a map of 128x128 sectors, both
+// from scratch and after moving a single vertex
+// -----------------------------------------------------------------------------
+BENCHMARK(map_buffers_2d)
+{
+	const int size = 128;
+
+	WadArchive       wad;
+	Archive::MapDesc map_desc;
+	if (!createUdmfMap(ctx, wad, size, map_desc))
+		return;
+	SLADEMap map;
+	map.readMap(map_desc);
+
+	// Simple line colour, the map editor uses the colour configuration
+	auto colour = [](MapLine* line) { return line->s2() ? ColRGBA(200, 200, 200, 128) : ColRGBA(255, 255, 255, 255); };
+
+	MapBuffers2D buffers(&map);
+	ctx.measure(
+		"full",
+		[&]() {
+			buffers.invalidate();
+			buffers.updateVertices();
+			buffers.updateLines(true, 1.0f, colour);
+		},
+		map.nLines());
+	ctx.measure(
+		"unchanged",
+		[&]() {
+			buffers.updateVertices();
+			buffers.updateLines(true, 1.0f, colour);
+		},
+		map.nLines());
+	ctx.measure(
+		"move_vertex",
+		[&]() {
+			auto vertex = map.vertex(ctx.randomInt(0, map.nVertices() - 1));
+			vertex->move(vertex->xPos() + 1, vertex->yPos());
+			buffers.updateVertices();
+			buffers.updateLines(true, 1.0f, colour);
+		},
+		map.nLines());
+}
+
+// -----------------------------------------------------------------------------
+// Palette colour matching and conversion of a 256x256 RGBA image to paletted
+// -----------------------------------------------------------------------------
+BENCHMARK(palette)
+{
+	auto pal = App::paletteManager()->globalPalette();
+
+	vector<ColRGBA> colours(65536);
+	for (auto& colour : colours)
+		colour = ColRGBA(ctx.randomInt(0, 255), ctx.randomInt(0, 255), ctx.randomInt(0, 255));
+	ctx.measure(
+		"nearest_colour",
+		[&]() {
+			for (auto& colour : colours)
+				pal->nearestColour(colour);
+		},
+		colours.size());
+
+	SImage source;
+	randomPalettedImage(ctx, source, 256, 256);
+	source.convertRGBA(pal);
+	SImage image;
+	ctx.measure(
+		"convert_paletted",
+		[&]() { image.convertPaletted(pal); },
+		256 * 256,
+		[&]() { image.copyImage(&source); });
+}
+
+// -----------------------------------------------------------------------------
+// Generating palette lookup tables (bulk colour matching, COLORMAP and
+// TRANMAP), on all threads and on one
+// -----------------------------------------------------------------------------
+BENCHMARK(palette_tables)
+{
+	auto pal = App::paletteManager()->globalPalette();
+
+	vector<uint32_t> colours(65536);
+	for (auto& colour : colours)
+		colour = PaletteTables::ColourMatcher::pack(
+			ctx.randomInt(0, 255), ctx.randomInt(0, 255), ctx.randomInt(0, 255));
+	vector<uint8_t> indices(colours.size());
+	ctx.measure(
+		"match",
+		[&]() { PaletteTables::ColourMatcher(*pal, Palette::ColourMatch::Old).match(colours, indices.data()); },
+		colours.size());
+
+	MemChunk mc;
+	ctx.measure("colormap", [&]() { PaletteTables::generateColormap(*pal, mc); }, 34 * 256);
+	ctx.measure(
+		"tranmap",
+		[&]() { PaletteTables::generateBlendTable(*pal, PaletteTables::Blend::Translucent, 0.66f, mc); },
+		256 * 256);
+	ctx.measure(
+		"tranmap_1_thread",
+		[&]() { PaletteTables::generateBlendTable(*pal, PaletteTables::Blend::Translucent, 0.66f, mc, 1); },
+		256 * 256);
+}
+
+// -----------------------------------------------------------------------------
+// Translating a set of 100 64x64 sprites (with transparent areas), as the map
+// editor does for translated things
+// -----------------------------------------------------------------------------
+BENCHMARK(translation)
+{
+	auto pal = App::paletteManager()->globalPalette();
+
+	vector<SImage> sources(100);
+	for (auto& source : sources)
+	{
+		source.create(64, 64, SImage::Type::PalMask);
+		for (int y = 0; y < 64; ++y)
+			for (int x = 0; x < 64; ++x)
+				source.setPixel(x, y, ctx.randomInt(0, 255), ctx.randomInt(0, 3) == 0 ? 0 : 255);
+	}
+
+	wxString       def = "\"112:127=96:111\", \"160:167=[255,0,0]:[0,0,0]\", \"208:223=%[0.0,0.0,0.0]:[1.0,1.0,1.0]\"";
+	vector<SImage> images(sources.size());
+	auto           reset = [&]() {
+		for (unsigned a = 0; a < sources.size(); ++a)
+			images[a].copyImage(&sources[a]);
+	};
+
+	ctx.measure(
+		"sprites_truecolor",
+		[&]() {
+			for (auto& image : images)
+				image.applyTranslation(def, pal, true);
+		},
+		images.size(),
+		reset);
+
+	Translation translation;
+	translation.parse(def);
+	ctx.measure(
+		"sprites_paletted",
+		[&]() {
+			for (auto& image : images)
+				image.applyTranslation(&translation, pal);
+		},
+		images.size(),
+		reset);
+
+	for (auto& source : sources)
+		source.convertRGBA(pal);
+	ctx.measure(
+		"sprites_rgba",
+		[&]() {
+			for (auto& image : images)
+				image.applyTranslation(&translation, pal);
+		},
+		images.size(),
+		reset);
+}
+
+// -----------------------------------------------------------------------------
+// Reading and writing 100 64x128 PNG images, paletted and RGBA (as in a
+// typical pk3), and reading just their info
+// -----------------------------------------------------------------------------
+BENCHMARK(png)
+{
+	auto pal     = App::paletteManager()->globalPalette();
+	auto fmt_png = SIFormat::getFormat("png");
+
+	for (auto rgba : { false, true })
+	{
+		vector<SImage>   images(100);
+		vector<MemChunk> pngs(images.size());
+		for (unsigned a = 0; a < images.size(); ++a)
+		{
+			randomPalettedImage(ctx, images[a], 64, 128);
+			if (rgba)
+				images[a].convertRGBA(pal);
+			images[a].setXOffset(32);
+			images[a].setYOffset(120);
+			fmt_png->saveImage(images[a], pngs[a], pal);
+		}
+
+		auto   suffix = rgba ? "_rgba" : "_paletted";
+		SImage image;
+		ctx.measure(
+			fmt::format("read{}", suffix),
+			[&]() {
+				for (auto& png : pngs)
+					fmt_png->loadImage(image, png);
+			},
+			pngs.size());
+		ctx.measure(
+			fmt::format("info{}", suffix),
+			[&]() {
+				for (auto& png : pngs)
+					fmt_png->info(png);
+			},
+			pngs.size());
+		ctx.measure(
+			fmt::format("write{}", suffix),
+			[&]() {
+				MemChunk out;
+				for (auto& img : images)
+					fmt_png->saveImage(img, out, pal);
+			},
+			images.size());
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Composing a 256x128 texture from 8 patches
+// -----------------------------------------------------------------------------
+BENCHMARK(texture_compose)
+{
+	auto pal = App::paletteManager()->globalPalette();
+
+	// Create patches (in a wad, so they are in the patches namespace)
+	WadArchive wad;
+	wad.addNewEntry("P_START");
+	SImage   image;
+	MemChunk mc;
+	for (unsigned a = 0; a < 8; ++a)
+	{
+		randomPalettedImage(ctx, image, 64, 128);
+		SIFormat::getFormat("doom")->saveImage(image, mc, pal);
+		wad.addNewEntry(fmt::format("BNCHP{:03d}", a))->importMemChunk(mc);
+	}
+	wad.addNewEntry("P_END");
+
+	// Reopen so namespaces and types are detected, then add as a resource
+	MemChunk   data;
+	WadArchive patches;
+	wad.write(data);
+	patches.open(data);
+	App::resources().addArchive(&patches);
+
+	// Create texture, with patches overlapping
+	CTexture texture("BNCHTEX");
+	texture.setSize({ 256, 128 });
+	for (unsigned a = 0; a < 8; ++a)
+		texture.addPatch(fmt::format("BNCHP{:03d}", a), a * 32, ctx.randomInt(-16, 16));
+
+	SImage tex_image;
+	ctx.measure("to_image", [&]() { texture.toImage(tex_image, &patches, pal); }, 8);
+	ctx.measure("to_image_rgba", [&]() { texture.toImage(tex_image, &patches, pal, true); }, 8);
+
+	// Resolving patches for composing in the background
+	ctx.measure("resolve", [&]() { texture.resolvedCopy(&patches); }, 8);
+
+	// Composing 64 resolved textures, on this thread then with ImageDecodeQueue
+	vector<std::unique_ptr<CTexture>> resolved;
+	for (unsigned a = 0; a < 64; ++a)
+		resolved.push_back(texture.resolvedCopy(&patches));
+	ctx.measure(
+		"compose_64",
+		[&]() {
+			for (auto& tex : resolved)
+				tex->toImage(tex_image, nullptr, pal, true);
+		},
+		resolved.size());
+	ImageDecodeQueue queue;
+	ctx.measure(
+		"compose_64_queued",
+		[&]() {
+			for (unsigned a = 0; a < resolved.size(); ++a)
+				queue.request(a, a, [&, a](SImage& image) { return resolved[a]->toImage(image, nullptr, pal, true); });
+			queue.waitIdle();
+			queue.takeResults();
+		},
+		resolved.size());
+
+	App::resources().removeArchive(&patches);
+}
+
+// -----------------------------------------------------------------------------
+// Logging 10000 messages (console only, so the log file isn't flooded), from
+// one and from 4 threads, and messages filtered out by verbosity level
+// -----------------------------------------------------------------------------
+BENCHMARK(log)
+{
+	const unsigned count = 10000;
+
+	ctx.measure(
+		"message",
+		[&]() {
+			for (unsigned a = 0; a < count; ++a)
+				Log::message(Log::MessageType::Console, "Benchmark message {}", fmt::make_format_args(a));
+			Log::flush();
+		},
+		count);
+
+	ctx.measure(
+		"message_4_threads",
+		[&]() {
+			vector<std::thread> threads;
+			for (unsigned t = 0; t < 4; ++t)
+				threads.emplace_back([&]() {
+					for (unsigned a = 0; a < count / 4; ++a)
+						Log::message(Log::MessageType::Console, "Benchmark message {}", fmt::make_format_args(a));
+				});
+			for (auto& thread : threads)
+				thread.join();
+			Log::flush();
+		},
+		count);
+
+	ctx.measure(
+		"filtered",
+		[&]() {
+			for (unsigned a = 0; a < count; ++a)
+				Log::info(Log::verbosity() + 1, "Benchmark message {}", a);
+		},
+		count);
+}
+
+// -----------------------------------------------------------------------------
+// Adding 2000 entries to a wad in the resource manager, with and without an
+// announcement batch
+// -----------------------------------------------------------------------------
+BENCHMARK(announcer)
+{
+	CountingListener listener;
+	listener.listenTo(&App::resources());
+
+	auto add_entries = [&](bool batch) {
+		WadArchive wad;
+		App::resources().addArchive(&wad);
+		{
+			std::unique_ptr<Announcer::Batch> scope;
+			if (batch)
+				scope = std::make_unique<Announcer::Batch>();
+			for (unsigned a = 0; a < 2000; ++a)
+				wad.addNewEntry(fmt::format("ENTRY{}", a));
+		}
+		App::resources().removeArchive(&wad);
+	};
+
+	ctx.measure("add_entries", [&]() { add_entries(false); }, 2000);
+	ctx.measure("add_entries_batched", [&]() { add_entries(true); }, 2000);
+}
@@ -0,0 +1,239 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2019 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    Cli.cpp
+// Description: slade_cli - runs an operation (see Operations.cpp) on a number
+//              of archives without the GUI, for use in scripts and build
+//              pipelines. Only the core subsystems are initialised, and the
+//              archives are processed concurrently.
+//
+//              Usage: slade_cli [options] <operation> [args] <archive...>
+//              Options:
+//                -j <n>      Max. archives to process at once (default is one
+//                            per hardware thread)
+//                -o <dir>    Save modified archives to <dir> rather than
+//                            overwriting them
+//                -n          Don't save modified archives
+//                -g <game>   Game configuration for map operations (default
+//                            is the last one used in SLADE)
+//                -p <port>   Port configuration for map operations
+//
+//              Exits with 0 if the operation succeeded on all archives, 1 if
+//              it failed on any, or 2 if the command line was invalid
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "Operations.h"
+#include "App.h"
+#include "Archive/ArchiveManager.h"
+#include "Game/Configuration.h"
+#include "Game/Game.h"
+#include "General/ColourConfiguration.h"
+#include "MainEditor/MainEditor.h"
+#include "Scripting/Lua.h"
+#include "Utility/Parallel.h"
+#include "Utility/StringUtils.h"
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <wx/init.h>
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Prints command line usage
+// -----------------------------------------------------------------------------
+void printUsage()
+{
+	printf("Usage: slade_cli [options] <operation> [args] <archive...>\n\n");
+	printf("Options:\n");
+	printf("  -j <n>      Max. archives to process at once (default: one per hardware thread)\n");
+	printf("  -o <dir>    Save modified archives to <dir> rather than overwriting them\n");
+	printf("  -n          Don't save modified archives\n");
+	printf("  -g <game>   Game configuration for map operations\n");
+	printf("  -p <port>   Port configuration for map operations\n\n");
+	printf("Operations:\n");
+	for (auto& op : Cli::operations())
+	{
+		auto name = op.args.empty() ? op.name : op.name + " " + op.args;
+		printf("  %-24s %s\n", name.c_str(), op.description.c_str());
+	}
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Main
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// slade_cli entry point
+// -----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+	// Parse options
+	unsigned    n_threads = 0;
+	std::string output_dir;
+	bool        save = true;
+	std::string game;
+	std::string port;
+	int         arg  = 1;
+	for (; arg < argc && argv[arg][0] == '-'; ++arg)
+	{
+		std::string option = argv[arg];
+		if (option == "-n")
+			save = false;
+		else if (arg + 1 < argc && option == "-j")
+			n_threads = std::max(1, atoi(argv[++arg]));
+		else if (arg + 1 < argc && option == "-o")
+			output_dir = argv[++arg];
+		else if (arg + 1 < argc && option == "-g")
+			game = argv[++arg];
+		else if (arg + 1 < argc && option == "-p")
+			port = argv[++arg];
+		else
+		{
+			printUsage();
+			return 2;
+		}
+	}
+
+	// Get operation and its arguments
+	auto op = arg < argc ? Cli::operation(argv[arg++]) : nullptr;
+	if (!op || arg + (int)op->n_args >= argc)
+	{
+		printUsage();
+		return 2;
+	}
+	vector<std::string> op_args(argv + arg, argv + arg + op->n_args);
+	arg += op->n_args;
+
+	// Init wx (as a console app, no display needed)
+	wxInitializer wx_init(argc, argv);
+	if (!wx_init.IsOk())
+	{
+		fprintf(stderr, "Failed to initialise wxWidgets\n");
+		return 1;
+	}
+
+	// Init core subsystems, and anything else the operation needs
+	auto start = std::chrono::steady_clock::now();
+	if (!App::initHeadless())
+	{
+		fprintf(stderr, "Initialisation failed: %s\n", Global::error.c_str());
+		return 1;
+	}
+	ColourConfiguration::init(); // Map image colours, same as configured in SLADE
+	if (op->uses_game)
+	{
+		Game::init();
+		if (!game.empty() && !Game::configuration().openConfig(game, port))
+		{
+			fprintf(stderr, "Unable to open game configuration \"%s\"\n", game.c_str());
+			return 1;
+		}
+	}
+	if (op->uses_lua)
+		Lua::init();
+
+	// Create jobs
+	vector<Cli::Job> jobs;
+	for (; arg < argc; ++arg)
+	{
+		jobs.emplace_back();
+		jobs.back().filename = argv[arg];
+	}
+
+	// Runs the operation on the archive for [job], then saves it if modified
+	std::mutex print_mutex;
+	auto       process = [&](Cli::Job& job) {
+		std::unique_ptr<Archive> archive(App::archiveManager().openArchive(job.filename, false, true));
+		if (!archive)
+		{
+			job.print("Unable to open archive: {}", Global::error);
+			job.ok = false;
+		}
+		else
+		{
+			// Start each job with its own archive's palette, since the global
+			// palette is per-thread and the previous job on this thread may have
+			// set it to a different archive's
+			job.archive = archive.get();
+			MainEditor::setGlobalPaletteFromArchive(job.archive);
+			if (!op->func(job, op_args))
+				job.ok = false;
+			else if (save && archive->isModified())
+			{
+				auto out_file = job.filename;
+				if (!output_dir.empty())
+					out_file = output_dir + "/" + std::string{ StrUtil::Path::fileNameOf(job.filename) };
+				if (archive->save(output_dir.empty() ? "" : out_file))
+					job.print("Saved {}", out_file);
+				else
+				{
+					job.print("Unable to save {}: {}", out_file, Global::error);
+					job.ok = false;
+				}
+			}
+			job.archive = nullptr;
+		}
+
+		// Print report for the archive all at once
+		std::lock_guard<std::mutex> lock(print_mutex);
+		printf("%s: %s\n%s", job.filename.c_str(), job.ok ? "OK" : "FAILED", job.output.c_str());
+		fflush(stdout);
+	};
+
+	// Process jobs, each thread taking the next unprocessed job until done
+	parallelFor(jobs.size(), 1, n_threads, [&](unsigned start, unsigned end) {
+		for (auto index = start; index < end; ++index)
+			process(jobs[index]);
+	});
+
+	// Summary
+	unsigned n_failed = 0;
+	for (auto& job : jobs)
+		if (!job.ok)
+			++n_failed;
+	fprintf(
+		stderr,
+		"Processed %u archives (%u failed) in %.0fms\n",
+		(unsigned)jobs.size(),
+		n_failed,
+		std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+	return n_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,447 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2019 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    Operations.cpp
+// Description: Operations that slade_cli can run on archives. Each operation
+//              is run on one archive (Job) at a time, possibly with other jobs
+//              running concurrently on other threads, so operations should
+//              only touch their own archive (script operations are the
+//              exception, and are serialised since there is one Lua state)
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "Operations.h"
+#include "App.h"
+#include "Archive/EntryType/EntryDataFormat.h"
+#include "Archive/EntryType/EntryType.h"
+#include "Archive/Formats/WadArchive.h"
+#include "General/Misc.h"
+#include "Graphics/PNGOptimizer.h"
+#include "Graphics/Palette/PaletteManager.h"
+#include "Graphics/SImage/SIFormat.h"
+#include "Graphics/SImage/SImage.h"
+#include "MapEditor/MapChecks.h"
+#include "SLADEMap/MapPreviewData.h"
+#include "SLADEMap/SLADEMap.h"
+#include "Scripting/Lua.h"
+#include "Utility/StringUtils.h"
+#include <mutex>
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace Cli
+{
+std::mutex lua_mutex;
+} // namespace Cli
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace Cli
+{
+// -----------------------------------------------------------------------------
+// Returns the text of the lua script file [filename], or an empty string if it
+// couldn't be read
+// -----------------------------------------------------------------------------
+wxString readScript(Job& job, const std::string& filename)
+{
+	MemChunk mc;
+	if (!mc.importFile(filename))
+	{
+		job.print("Unable to read script file \"{}\"", filename);
+		return "";
+	}
+
+	return wxString::FromUTF8((const char*)mc.data(), mc.size());
+}
+
+// -----------------------------------------------------------------------------
+// Writes [map] back to the entries of the map described by [map_desc].
+// Existing map entries are updated in place (so any entries SLADEMap doesn't
+// write, eg. nodes, are left as they are), and any new ones are added after
+// the map header
+// -----------------------------------------------------------------------------
+bool writeMapEntries(const Archive::MapDesc& map_desc, const SLADEMap& map)
+{
+	// Maps in zips are wads within the zip, so open that
+	Archive::UPtr map_wad;
+	auto          desc = map_desc;
+	if (desc.archive)
+	{
+		map_wad = std::make_unique<WadArchive>();
+		if (!map_wad->open(desc.head))
+			return false;
+		auto maps = map_wad->detectMaps();
+		if (maps.empty())
+			return false;
+		desc = maps[0];
+	}
+
+	vector<ArchiveEntry*> map_entries;
+	if (!map.writeMap(map_entries))
+		return false;
+
+	auto archive = desc.head->parent();
+	for (auto new_entry : map_entries)
+	{
+		// Find existing entry with the same name
+		ArchiveEntry* existing = nullptr;
+		for (auto entry = desc.head->nextEntry(); entry; entry = entry->nextEntry())
+		{
+			if (entry->upperName() == new_entry->upperName())
+			{
+				existing = entry;
+				break;
+			}
+			if (entry == desc.end)
+				break;
+		}
+
+		if (existing)
+			existing->importMemChunk(new_entry->data());
+		else
+			archive->addEntry(new_entry, archive->entryIndex(desc.head) + 1, nullptr, true);
+
+		delete new_entry;
+	}
+
+	if (map_wad)
+		return map_wad->save();
+
+	return true;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Operations
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Reports the number of entries of each detected type
+// -----------------------------------------------------------------------------
+bool reportTypes(Job& job, const vector<std::string>& args)
+{
+	vector<ArchiveEntry*> entries;
+	job.archive->putEntryTreeAsList(entries);
+
+	std::map<std::string, unsigned> counts;
+	unsigned                        n_entries = 0;
+	for (auto entry : entries)
+	{
+		if (entry->type() == EntryType::folderType())
+			continue;
+
+		++counts[entry->type()->id()];
+		++n_entries;
+	}
+
+	// Sort by count (descending), then type id
+	vector<std::pair<std::string, unsigned>> sorted(counts.begin(), counts.end());
+	std::sort(sorted.begin(), sorted.end(), [](const auto& left, const auto& right) {
+		return left.second != right.second ? left.second > right.second : left.first < right.first;
+	});
+
+	job.print("{} entries, {} types", n_entries, sorted.size());
+	for (auto& type : sorted)
+		job.print("  {:<24} {}", type.first, type.second);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Runs all standard map checks on all maps, and reports any problems found.
+// The job fails if there were any problems.
+// The unknown texture/flat checks need the map editor, so aren't run
+// -----------------------------------------------------------------------------
+bool checkMaps(Job& job, const vector<std::string>& args)
+{
+	auto maps = job.archive->detectMaps();
+	if (maps.empty())
+		job.print("No maps found");
+
+	for (auto& map_desc : maps)
+	{
+		SLADEMap map;
+		if (!map.readMap(map_desc))
+		{
+			job.print("{}: Unable to read map", map_desc.name);
+			job.ok = false;
+			continue;
+		}
+
+		unsigned n_problems = 0;
+		for (int type = 0; type < MapCheck::NumStandardChecks; ++type)
+		{
+			auto check = MapCheck::standardCheck((MapCheck::StandardCheck)type, &map);
+			if (!check)
+				continue;
+
+			check->doCheck();
+			for (unsigned a = 0; a < check->nProblems(); ++a)
+				job.print("{}: {}", map_desc.name, check->problemDesc(a).ToStdString());
+			n_problems += check->nProblems();
+		}
+
+		job.print("{}: {} problem{}", map_desc.name, n_problems, n_problems == 1 ? "" : "s");
+		if (n_problems > 0)
+			job.ok = false;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Renders an image of each map (as in the map entry panel's 'Save Map Image')
+// and writes it to the directory [args[0]] as <archive>_<map>.png
+// -----------------------------------------------------------------------------
+bool writeMapImages(Job& job, const vector<std::string>& args)
+{
+	auto maps = job.archive->detectMaps();
+	if (maps.empty())
+		job.print("No maps found");
+
+	auto archive_name = std::string{ StrUtil::Path::fileNameOf(job.filename, false) };
+	auto fmt_png      = SIFormat::getFormat("png");
+	for (auto& map_desc : maps)
+	{
+		MapPreviewData map;
+		SImage         image;
+		MemChunk       png;
+		if (!map.open(map_desc) || !map.createImage(image, 0, 0) || !fmt_png->saveImage(image, png))
+		{
+			job.print("{}: Unable to create map image", map_desc.name);
+			job.ok = false;
+			continue;
+		}
+
+		auto filename = fmt::format("{}/{}_{}.png", args[0], archive_name, map_desc.name);
+		if (!png.exportFile(filename))
+		{
+			job.print("{}: Unable to write {}", map_desc.name, filename);
+			job.ok = false;
+			continue;
+		}
+
+		job.print("{}: Wrote {} ({}x{})", map_desc.name, filename, image.width(), image.height());
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Optimizes all PNG entries, keeping the optimized data only if it's smaller
+// -----------------------------------------------------------------------------
+bool optimizePngs(Job& job, const vector<std::string>& args)
+{
+	vector<ArchiveEntry*> entries;
+	job.archive->putEntryTreeAsList(entries);
+
+	auto     fmt_png = EntryDataFormat::format("img_png");
+	unsigned n_pngs  = 0;
+	size_t   saved   = 0;
+	for (auto entry : entries)
+	{
+		if (entry->type() == EntryType::folderType() || !fmt_png->isThisFormat(entry->data()))
+			continue;
+
+		MemChunk optimized;
+		wxString error;
+		if (!PNGOptimizer::optimize(entry->data(), optimized, error))
+		{
+			job.print("Unable to optimize {}: {}", entry->path(true), error.ToStdString());
+			continue;
+		}
+
+		++n_pngs;
+		if (optimized.size() < entry->size())
+		{
+			saved += entry->size() - optimized.size();
+			entry->importMemChunk(optimized);
+		}
+	}
+
+	job.print("Optimized {} PNGs, {} saved", n_pngs, Misc::sizeAsString(saved).ToStdString());
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Converts all (non-font) images that aren't already PNG to PNG, using the
+// archive's palette (or the default global palette if it doesn't have one)
+// -----------------------------------------------------------------------------
+bool convertToPng(Job& job, const vector<std::string>& args)
+{
+	Palette pal;
+	if (!Misc::loadPaletteFromArchive(&pal, job.archive))
+		pal.copyPalette(App::paletteManager()->globalPalette());
+
+	vector<ArchiveEntry*> entries;
+	job.archive->putEntryTreeAsList(entries);
+
+	auto     fmt_png     = SIFormat::getFormat("png");
+	unsigned n_converted = 0;
+	for (auto entry : entries)
+	{
+		auto type = entry->type();
+		if (!type->extraProps().propertyExists("image") || type->formatId() == "img_png"
+			|| StrUtil::startsWith(type->formatId(), "font_"))
+			continue;
+
+		SImage   image;
+		MemChunk png;
+		if (!Misc::loadImageFromEntry(&image, entry) || !fmt_png->saveImage(image, png, &pal))
+		{
+			job.print("Unable to convert {}: {}", entry->path(true), Global::error);
+			continue;
+		}
+
+		entry->importMemChunk(png);
+		EntryType::detectEntryType(entry);
+		entry->setExtensionByType();
+		++n_converted;
+	}
+
+	job.print("Converted {} images to PNG", n_converted);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Runs the 'execute(archive)' function in the lua script file [args[0]]
+// -----------------------------------------------------------------------------
+bool runArchiveScript(Job& job, const vector<std::string>& args)
+{
+	auto script = readScript(job, args[0]);
+	if (script.empty())
+		return false;
+
+	std::lock_guard<std::mutex> lock(lua_mutex);
+	if (!Lua::runArchiveScript(script, job.archive))
+	{
+		job.print(
+			"Script error: {} Error: {}: {}",
+			Lua::error().type.ToStdString(),
+			Lua::error().line_no,
+			Lua::error().message.ToStdString());
+		return false;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Runs the 'execute(map)' function in the lua script file [args[0]] on each
+// map in the archive. Any maps modified by the script are written back to the
+// archive
+// -----------------------------------------------------------------------------
+bool runMapScript(Job& job, const vector<std::string>& args)
+{
+	auto script = readScript(job, args[0]);
+	if (script.empty())
+		return false;
+
+	for (auto& map_desc : job.archive->detectMaps())
+	{
+		SLADEMap map;
+		if (!map.readMap(map_desc))
+		{
+			job.print("{}: Unable to read map", map_desc.name);
+			return false;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(lua_mutex);
+			if (!Lua::runMapScript(script, &map))
+			{
+				job.print(
+					"{}: Script error: {} Error: {}: {}",
+					map_desc.name,
+					Lua::error().type.ToStdString(),
+					Lua::error().line_no,
+					Lua::error().message.ToStdString());
+				return false;
+			}
+		}
+
+		if (map.isModified() && !writeMapEntries(map_desc, map))
+		{
+			job.print("{}: Unable to write map", map_desc.name);
+			return false;
+		}
+	}
+
+	return true;
+}
+} // namespace Cli
+
+
+// -----------------------------------------------------------------------------
+//
+// Cli Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns a list of all available operations
+// -----------------------------------------------------------------------------
+const vector<Cli::Operation>& Cli::operations()
+{
+	static vector<Operation> ops = {
+		{ "types", "", "Report the number of entries of each type", 0, false, false, &reportTypes },
+		{ "mapcheck", "", "Run map checks on all maps (fails if any problems are found)", 0, true, false, &checkMaps },
+		{ "mapimage", "<dir>", "Write an image of each map to <dir>", 1, false, false, &writeMapImages },
+		{ "optimize-png", "", "Optimize all PNG entries", 0, false, false, &optimizePngs },
+		{ "convert-png", "", "Convert all images to PNG", 0, false, false, &convertToPng },
+		{ "script", "<file.lua>", "Run execute(archive) from a Lua script", 1, true, true, &runArchiveScript },
+		{ "mapscript", "<file.lua>", "Run execute(map) from a Lua script on each map", 1, true, true, &runMapScript },
+	};
+
+	return ops;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the operation [name], or nullptr if it doesn't exist
+// -----------------------------------------------------------------------------
+const Cli::Operation* Cli::operation(std::string_view name)
+{
+	for (auto& op : operations())
+		if (op.name == name)
+			return &op;
+
+	return nullptr;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+class Archive;
+
+namespace Cli
+{
+// A single archive being processed by an operation
+struct Job
+{
+	std::string filename;
+	Archive*    archive = nullptr;
+	std::string output; // Report text, printed in one go once the job is done
+	bool        ok = true;
+
+	template<typename... Args> void print(std::string_view format, const Args&... args)
+	{
+		output += fmt::format(format, args...);
+		output += '\n';
+	}
+};
+
+struct Operation
+{
+	typedef bool (*Func)(Job&, const vector<std::string>&);
+
+	std::string name;
+	std::string args; // Argument names, for usage text
+	std::string description;
+	unsigned    n_args;    // Number of arguments taken
+	bool        uses_game; // Needs game configurations (map operations)
+	bool        uses_lua;  // Needs the Lua state (script operations)
+	Func        func;
+};
+
+const vector<Operation>& operations();
+const Operation*         operation(std::string_view name);
+} // namespace Cli
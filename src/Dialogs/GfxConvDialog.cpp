@@ -52,7 +52,6 @@
 // -----------------------------------------------------------------------------
 wxString GfxConvDialog::current_palette_name_ = "";
 wxString GfxConvDialog::target_palette_name_  = "";
-CVAR(Bool, gfx_extraconv, false, CVar::Flag::Save)
 
 
 // -----------------------------------------------------------------------------
@@ -56,7 +56,6 @@
 #include "MapEditorPrefsPanel.h"
 #include "NodesPrefsPanel.h"
 #include "OpenGLPrefsPanel.h"
-#include "PNGPrefsPanel.h"
 #include "TextEditorPrefsPanel.h"
 #include "TextStylePrefsPanel.h"
 
@@ -144,7 +143,6 @@ PreferencesDialog::PreferencesDialog(wxWindow* parent) : SDialog(parent, "SLADE
 	addPrefsPage<TextEditorPrefsPanel>("Text Editor");
 	addPrefsPage<TextStylePrefsPanel>("Fonts & Colours", true);
 	addPrefsPage<GraphicsPrefsPanel>("Graphics");
-	addPrefsPage<PNGPrefsPanel>("PNG", true);
 	addPrefsPage<ColorimetryPrefsPanel>("Colorimetry", true);
 	addPrefsPage<HudOffsetsPrefsPanel>("HUD Offsets View", true);
 	addPrefsPage<AudioPrefsPanel>("Audio");
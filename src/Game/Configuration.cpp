@@ -39,6 +39,7 @@
 #include "Decorate.h"
 #include "GenLineSpecial.h"
 #include "General/Console/Console.h"
+#include "General/Misc.h"
 #include "SLADEMap/SLADEMap.h"
 #include "Utility/Parser.h"
 #include "Utility/StringUtils.h"
@@ -55,6 +56,113 @@ using namespace Game;
 EXTERN_CVAR(String, game_configuration)
 EXTERN_CVAR(String, port_configuration)
 CVAR(Bool, debug_configuration, false, CVar::Flag::Save)
+CVAR(Bool, game_config_cache, true, CVar::Flag::Save)
+namespace
+{
+const uint32_t CACHE_MAGIC   = 0x47464353; // 'SCFG'
+const uint32_t CACHE_VERSION = 1;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the path to the parse tree cache file for [game]+[port] in [format]
+// -----------------------------------------------------------------------------
+wxString cacheFilename(const wxString& game, const wxString& port, MapFormat format)
+{
+	return App::path(
+		fmt::format("cache/gamecfg_{}_{}_{}.bin", game.ToStdString(), port.ToStdString(), static_cast<int>(format)),
+		App::Dir::User);
+}
+
+// -----------------------------------------------------------------------------
+// Writes the cache header for config text [cfg] parsed with [format] to [out].
+// The text is fully include-processed so this also covers any changes to
+// included files
+// -----------------------------------------------------------------------------
+void writeCacheHeader(std::string& out, const std::string& cfg, MapFormat format)
+{
+	uint32_t header[4] = { CACHE_MAGIC,
+						   CACHE_VERSION,
+						   Misc::crc(reinterpret_cast<const uint8_t*>(cfg.data()), cfg.size()),
+						   static_cast<uint32_t>(cfg.size()) };
+	out.append(reinterpret_cast<const char*>(header), sizeof(header));
+	out += static_cast<char>(format);
+
+	auto     version = App::version().toString();
+	uint32_t len     = version.size();
+	out.append(reinterpret_cast<const char*>(&len), 4);
+	out += version;
+}
+
+// -----------------------------------------------------------------------------
+// Reads the parse tree for config text [cfg] parsed with [format] from the
+// cache file [filename] into [root].
+// Returns false if the cache file doesn't exist, is out of date or is invalid,
+// in which case [root] is left unchanged
+// -----------------------------------------------------------------------------
+bool readCachedParseTree(const wxString& filename, const std::string& cfg, MapFormat format, ParseTreeNode* root)
+{
+	if (!wxFileExists(filename))
+		return false;
+
+	MemChunk mc;
+	if (!mc.importFile(filename.ToStdString()))
+		return false;
+
+	// Check header matches
+	std::string header;
+	writeCacheHeader(header, cfg, format);
+	if (mc.size() < header.size() || memcmp(mc.data(), header.data(), header.size()) != 0)
+		return false;
+
+	// Read parse tree into a separate tree first, since an invalid file can
+	// fail partway through
+	ParseTreeNode cached;
+	mc.seek(header.size(), SEEK_SET);
+	if (!cached.readBinary(mc))
+	{
+		Log::warning(wxString::Format("Game configuration cache file \"%s\" is invalid", filename));
+		return false;
+	}
+
+	// Move the cached nodes to [root]
+	while (cached.nChildren() > 0)
+	{
+		auto child = cached.child(0);
+		cached.removeChild(child);
+		root->addChild(child);
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the parse tree [root] for config text [cfg] parsed with [format] to
+// the cache file [filename]
+// -----------------------------------------------------------------------------
+void writeCachedParseTree(const wxString& filename, const std::string& cfg, MapFormat format, ParseTreeNode* root)
+{
+	// Create cache directory if needed
+	auto cache_dir = App::path("cache", App::Dir::User);
+	if (!wxDirExists(cache_dir))
+		wxMkdir(cache_dir);
+
+	std::string data;
+	writeCacheHeader(data, cfg, format);
+	root->writeBinary(data);
+
+	wxFile file(filename, wxFile::write);
+	if (!file.IsOpened() || !file.Write(data.data(), data.size()))
+		Log::warning(wxString::Format("Unable to write game configuration cache file \"%s\"", filename));
+}
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -513,14 +621,17 @@ void Configuration::readGameSection(ParseTreeNode* node_game, bool port_section)
 #undef READ_BOOL
 
 // -----------------------------------------------------------------------------
-// Reads a full game configuration from [cfg]
+// Reads a full game configuration from [cfg].
+// If [cache_file] is given, the parsed configuration is read from it instead
+// if it is up to date, otherwise it is (re)written after parsing
 // -----------------------------------------------------------------------------
 bool Configuration::readConfiguration(
 	wxString&       cfg,
 	const wxString& source,
 	MapFormat       format,
 	bool            ignore_game,
-	bool            clear)
+	bool            clear,
+	const wxString& cache_file)
 {
 	// Clear current configuration
 	if (clear)
@@ -549,7 +660,14 @@ bool Configuration::readConfiguration(
 	case MapFormat::UDMF: parser.define("MAP_UDMF"); break;
 	default: parser.define("MAP_UNKNOWN"); break;
 	}
-	parser.parseText(cfg.ToStdString(), source.ToStdString());
+	auto cfg_text  = cfg.ToStdString();
+	bool use_cache = game_config_cache && !cache_file.empty();
+	if (!use_cache || !readCachedParseTree(cache_file, cfg_text, format, parser.parseTreeRoot()))
+	{
+		parser.parseText(cfg_text, source.ToStdString());
+		if (use_cache)
+			writeCachedParseTree(cache_file, cfg_text, format, parser.parseTreeRoot());
+	}
 
 	// Process parsed data
 	auto base = parser.parseTreeRoot();
@@ -937,9 +1055,9 @@ bool Configuration::openConfig(const wxString& game, const wxString& port, MapFo
 		test.Close();
 	}
 
-	// Read fully built configuration
+	// Read fully built configuration (cached per game/port/format)
 	bool ok = true;
-	if (readConfiguration(full_config, "full.cfg", format))
+	if (readConfiguration(full_config, "full.cfg", format, false, true, cacheFilename(game, port, format)))
 	{
 		current_game_      = game;
 		current_port_      = port;
@@ -978,14 +1096,14 @@ bool Configuration::openConfig(const wxString& game, const wxString& port, MapFo
 // -----------------------------------------------------------------------------
 const ActionSpecial& Configuration::actionSpecial(unsigned id)
 {
-	auto& as = action_specials_[id];
-
 	// Defined Action Special
-	if (as.defined())
-		return as;
+	// (use find so that looking up an unknown special doesn't modify the map)
+	auto as = action_specials_.find(id);
+	if (as != action_specials_.end() && as->second.defined())
+		return as->second;
 
 	// Boom Generalised Special
-	if (supported_features_[Feature::Boom] && id >= 0x2f80)
+	if (featureSupported(Feature::Boom) && id >= 0x2f80)
 	{
 		if ((id & 7) >= 6)
 			return ActionSpecial::generalManual();
@@ -1008,9 +1126,10 @@ wxString Configuration::actionSpecialName(int special)
 	else if (special == 0)
 		return "None";
 
-	if (action_specials_[special].defined())
-		return action_specials_[special].name();
-	else if (special >= 0x2F80 && supported_features_[Feature::Boom])
+	auto as = action_specials_.find(special);
+	if (as != action_specials_.end() && as->second.defined())
+		return as->second.name();
+	else if (special >= 0x2F80 && featureSupported(Feature::Boom))
 		return BoomGenLineSpecial::parseLineType(special);
 	else
 		return "Unknown";
@@ -1021,9 +1140,9 @@ wxString Configuration::actionSpecialName(int special)
 // -----------------------------------------------------------------------------
 const ThingType& Configuration::thingType(unsigned type)
 {
-	auto& ttype = thing_types_[type];
-	if (ttype.defined())
-		return ttype;
+	auto ttype = thing_types_.find(type);
+	if (ttype != thing_types_.end() && ttype->second.defined())
+		return ttype->second;
 	else
 		return ThingType::unknown();
 }
@@ -1120,7 +1239,7 @@ bool Configuration::thingBasicFlagSet(const wxString& flag, MapThing* thing, Map
 		if (hexen)
 			return thing->flagSet(512);
 		// *Not* Not In Coop
-		else if (supported_features_[Feature::Boom])
+		else if (featureSupported(Feature::Boom))
 			return !thing->flagSet(64);
 		else
 			return true;
@@ -1131,7 +1250,7 @@ bool Configuration::thingBasicFlagSet(const wxString& flag, MapThing* thing, Map
 		if (hexen)
 			return thing->flagSet(1024);
 		// *Not* Not In DM
-		else if (supported_features_[Feature::Boom])
+		else if (featureSupported(Feature::Boom))
 			return !thing->flagSet(32);
 		else
 			return true;
@@ -1283,7 +1402,7 @@ void Configuration::setThingBasicFlag(const wxString& flag, MapThing* thing, Map
 		if (hexen)
 			flag_val = 512;
 		// *Not* Not In Coop
-		else if (supported_features_[Feature::Boom])
+		else if (featureSupported(Feature::Boom))
 		{
 			flag_val = 64;
 			set      = !set;
@@ -1298,7 +1417,7 @@ void Configuration::setThingBasicFlag(const wxString& flag, MapThing* thing, Map
 		if (hexen)
 			flag_val = 1024;
 		// *Not* Not In DM
-		else if (supported_features_[Feature::Boom])
+		else if (featureSupported(Feature::Boom))
 		{
 			flag_val = 32;
 			set      = !set;
@@ -1363,11 +1482,12 @@ void Configuration::clearDecorateDefs()
 // -----------------------------------------------------------------------------
 // Configuration::importZScriptDefs
 //
-// Imports parsed classes from ZScript [defs] as thing types
+// Imports parsed classes from ZScript [defs] as thing types. Classes can
+// inherit from classes in [base] (eg. the base zdoom.pk3 definitions)
 // -----------------------------------------------------------------------------
-void Configuration::importZScriptDefs(ZScript::Definitions& defs)
+void Configuration::importZScriptDefs(ZScript::Definitions& defs, const ZScript::Definitions* base)
 {
-	defs.exportThingTypes(thing_types_, parsed_types_);
+	defs.exportThingTypes(thing_types_, parsed_types_, base);
 }
 
 // -----------------------------------------------------------------------------
@@ -1876,7 +1996,8 @@ wxString Configuration::sectorTypeName(int type)
 	}
 
 	// Get base type name
-	wxString name = sector_types_[type];
+	auto     i    = sector_types_.find(type);
+	wxString name = i != sector_types_.end() ? i->second : wxString{};
 	if (name.empty())
 		name = "Unknown";
 
@@ -2310,3 +2431,30 @@ CONSOLE_COMMAND(dumpspecialpresets, 0, false)
 	for (auto& preset : Game::configuration().specialPresets())
 		Log::console(wxString::Format("%s/%s", preset.group, preset.name));
 }
+
+CONSOLE_COMMAND(test_gamecfg_cache, 0, false)
+{
+	auto game   = Game::configuration().currentGame();
+	auto port   = Game::configuration().currentPort();
+	auto format = MapFormat::Unknown;
+	if (!args.empty())
+		format = static_cast<MapFormat>(wxAtoi(args[0]));
+
+	// Parse without the cache, then write and read it
+	bool        use_cache = game_config_cache;
+	const char* runs[]    = { "Parsed", "Parsed + wrote cache", "Read from cache" };
+	for (unsigned a = 0; a < 3; a++)
+	{
+		game_config_cache = a > 0;
+
+		// Remove any existing cache file to force a rewrite
+		auto filename = cacheFilename(game, port, format);
+		if (a == 1 && wxFileExists(filename))
+			wxRemoveFile(filename);
+
+		auto start = App::runTimer();
+		Game::configuration().openConfig(game, port, format);
+		Log::console(wxString::Format("%s in %ldms", runs[a], App::runTimer() - start));
+	}
+	game_config_cache = use_cache;
+}
@@ -92,8 +92,16 @@ public:
 	const std::map<int, wxString>&      allSectorTypes() const { return sector_types_; }
 
 	// Feature Support
-	bool featureSupported(Feature feature) { return supported_features_[feature]; }
-	bool featureSupported(UDMFFeature feature) { return udmf_features_[feature]; }
+	bool featureSupported(Feature feature) const
+	{
+		auto i = supported_features_.find(feature);
+		return i != supported_features_.end() && i->second;
+	}
+	bool featureSupported(UDMFFeature feature) const
+	{
+		auto i = udmf_features_.find(feature);
+		return i != udmf_features_.end() && i->second;
+	}
 
 	// Configuration reading
 	void readActionSpecials(ParseTreeNode* node, Arg::SpecialMap& shared_args, ActionSpecial* group_defaults = nullptr);
@@ -105,7 +113,8 @@ public:
 		const wxString& source      = "",
 		MapFormat       format      = MapFormat::Unknown,
 		bool            ignore_game = false,
-		bool            clear       = true);
+		bool            clear       = true,
+		const wxString& cache_file  = "");
 	bool openConfig(const wxString& game, const wxString& port = "", MapFormat format = MapFormat::Unknown);
 
 	// Action specials
@@ -132,7 +141,7 @@ public:
 	void clearDecorateDefs();
 
 	// ZScript
-	void importZScriptDefs(ZScript::Definitions& defs);
+	void importZScriptDefs(ZScript::Definitions& defs, const ZScript::Definitions* base = nullptr);
 
 	// MapInfo
 	bool parseMapInfo(Archive* archive);
@@ -34,7 +34,9 @@
 #include "Archive/Archive.h"
 #include "Configuration.h"
 #include "Game.h"
+#include "IncludeParser.h"
 #include "ThingType.h"
+#include "Utility/Profiler.h"
 #include "Utility/StringUtils.h"
 #include "Utility/Tokenizer.h"
 
@@ -49,7 +51,27 @@ using namespace Game;
 namespace
 {
 EntryType* etype_decorate = nullptr;
-}
+
+// A DECORATE definition parsed from an entry, which is added to the thing types
+// afterwards (since that depends on any previous definitions)
+struct DecorateDef
+{
+	bool         actor = true; // Old-style (non-actor) definition if false
+	wxString     name;
+	wxString     actor_name;
+	wxString     parent;
+	wxString     group;
+	int          ednum           = -1;
+	bool         valid           = true;
+	bool         available       = false;
+	bool         filters_present = false;
+	PropertyList props;
+};
+
+// A DECORATE entry parsed into definitions, with the positions of any #includes
+// within it (to be resolved and expanded afterwards)
+typedef IncludeParser<DecorateDef>::Entry ParsedEntry;
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -78,9 +100,9 @@ void parseStates(Tokenizer& tz, PropertyList& props)
 		if (tz.checkNext(":"))
 		{
 			// Add to list of current states
-			states.emplace_back(StrUtil::lower(tz.current().text));
+			states.emplace_back(StrUtil::lower(tz.current().text()));
 			if (state_first.empty())
-				state_first = StrUtil::lower(tz.current().text);
+				state_first = StrUtil::lower(tz.current().text());
 
 			tz.adv();
 		}
@@ -97,9 +119,9 @@ void parseStates(Tokenizer& tz, PropertyList& props)
 			}
 
 			// Set sprite for current states (if it is defined)
-			if (!(StrUtil::contains(tz.current().text, '#') || StrUtil::contains(tz.current().text, '-')))
+			if (!(StrUtil::contains(tz.current().text(), '#') || StrUtil::contains(tz.current().text(), '-')))
 				for (auto& state : states)
-					state_sprites[state] = tz.current().text + tz.peek().text[0];
+					state_sprites[state] = tz.current().text() + tz.peek().text()[0];
 
 			states.clear();
 			tz.adv();
@@ -235,19 +257,19 @@ void parseStates(Tokenizer& tz, PropertyList& props)
 }
 
 // -----------------------------------------------------------------------------
-// Parses a DECORATE 'actor' definition
+// Parses a DECORATE 'actor' definition into [actor]
 // -----------------------------------------------------------------------------
-void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<ThingType>& parsed)
+void parseDecorateActor(Tokenizer& tz, DecorateDef& actor)
 {
 	// Get actor name
-	wxString name       = tz.next().text;
+	wxString name       = tz.next().text();
 	wxString actor_name = name;
 	wxString parent;
 
 	// Check for inheritance
 	// string next = tz.peekToken();
 	if (tz.advIfNext(":"))
-		parent = tz.next().text;
+		parent = tz.next().text();
 
 	// Check for replaces
 	if (tz.checkNextNC("replaces"))
@@ -298,13 +320,13 @@ void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<T
 			else if (tz.checkNC("game"))
 			{
 				filters_present = true;
-				if (gameDef(configuration().currentGame()).supportsFilter(tz.next().text))
+				if (gameDef(configuration().currentGame()).supportsFilter(tz.next().text()))
 					available = true;
 			}
 
 			// Tag
 			else if (!title_given && tz.checkNC("tag"))
-				name = tz.next().text;
+				name = tz.next().text();
 
 			// Category
 			else if (tz.checkNC("//$Group") || tz.checkNC("//$Category"))
@@ -316,7 +338,7 @@ void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<T
 			// Sprite
 			else if (tz.checkNC("//$EditorSprite") || tz.checkNC("//$Sprite"))
 			{
-				found_props["sprite"] = tz.next().text;
+				found_props["sprite"] = tz.next().text();
 				sprite_given          = true;
 			}
 
@@ -363,11 +385,11 @@ void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<T
 
 			// Icon
 			else if (tz.checkNC("//$Icon"))
-				found_props["icon"] = tz.next().text;
+				found_props["icon"] = tz.next().text();
 
 			// DB2 Color
 			else if (tz.checkNC("//$Color"))
-				found_props["color"] = tz.next().text;
+				found_props["color"] = tz.next().text();
 
 			// SLADE 3 Colour (overrides DB2 color)
 			// Good thing US spelling differs from ABC (Aussie/Brit/Canuck) spelling! :p
@@ -385,11 +407,11 @@ void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<T
 			else if (tz.checkNC("translation"))
 			{
 				std::string translation = "\"";
-				translation += tz.next().text;
+				translation += tz.next().text();
 				while (tz.checkNext(","))
 				{
-					translation += tz.next().text; // ,
-					translation += tz.next().text; // next range
+					translation += tz.next().text(); // ,
+					translation += tz.next().text(); // next range
 				}
 				translation += "\"";
 				found_props["translation"] = translation;
@@ -400,7 +422,7 @@ void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<T
 				found_props["solid"] = true;
 
 			// Unrecognised DB comment prop
-			else if (StrUtil::startsWith(tz.current().text, "//$"))
+			else if (StrUtil::startsWith(tz.current().text(), "//$"))
 			{
 				tz.advToNextLine();
 				continue;
@@ -415,24 +437,42 @@ void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<T
 
 			tz.adv();
 		}
-
-		Log::info(3, wxString::Format("Parsed actor %s: %d", name, ednum));
 	}
 	else
-		Log::warning(wxString::Format("Warning: Invalid actor definition for %s", name));
+		actor.valid = false;
+
+	actor.name            = name;
+	actor.actor_name      = actor_name;
+	actor.parent          = parent;
+	actor.group           = group;
+	actor.ednum           = ednum;
+	actor.available       = available;
+	actor.filters_present = filters_present;
+	actor.props           = found_props;
+}
+
+// -----------------------------------------------------------------------------
+// Adds the parsed DECORATE 'actor' definition [actor] to [types]
+// -----------------------------------------------------------------------------
+void addDecorateActor(DecorateDef& actor, std::map<int, ThingType>& types, vector<ThingType>& parsed)
+{
+	if (actor.valid)
+		Log::info(3, wxString::Format("Parsed actor %s: %d", actor.name, actor.ednum));
+	else
+		Log::warning(wxString::Format("Warning: Invalid actor definition for %s", actor.name));
 
 	// Ignore actors filtered for other games,
 	// and actors with a negative or null type
-	if (available || !filters_present)
+	if (actor.available || !actor.filters_present)
 	{
-		wxString group_path = group.empty() ? "Decorate" : "Decorate/" + group;
+		wxString group_path = actor.group.empty() ? "Decorate" : "Decorate/" + actor.group;
 
 		// Find existing definition or create it
 		ThingType* def = nullptr;
-		if (ednum <= 0)
+		if (actor.ednum <= 0)
 		{
 			for (auto& ptype : parsed)
-				if (S_CMPNOCASE(ptype.className(), actor_name))
+				if (S_CMPNOCASE(ptype.className(), actor.actor_name))
 				{
 					def = &ptype;
 					break;
@@ -440,42 +480,42 @@ void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<T
 
 			if (!def)
 			{
-				parsed.emplace_back(name, group_path, actor_name);
+				parsed.emplace_back(actor.name, group_path, actor.actor_name);
 				def = &parsed.back();
 			}
 		}
 		else
-			def = &types[ednum];
+			def = &types[actor.ednum];
 
 		// Add/update definition
-		def->define(ednum, name, group_path);
+		def->define(actor.ednum, actor.name, group_path);
 
 		// Set group defaults (if any)
-		if (!group.empty())
+		if (!actor.group.empty())
 		{
-			auto& group_defaults = configuration().thingTypeGroupDefaults(group);
+			auto& group_defaults = configuration().thingTypeGroupDefaults(actor.group);
 			if (!group_defaults.group().empty())
 				def->copy(group_defaults);
 		}
 
 		// Inherit from parent
-		if (!parent.empty())
+		if (!actor.parent.empty())
 			for (auto& ptype : parsed)
-				if (S_CMPNOCASE(ptype.className(), parent))
+				if (S_CMPNOCASE(ptype.className(), actor.parent))
 				{
 					def->copy(ptype);
 					break;
 				}
 
 		// Set parsed properties
-		def->loadProps(found_props);
+		def->loadProps(actor.props);
 	}
 }
 
 // -----------------------------------------------------------------------------
-// Parses an old-style (non-actor) DECORATE definition
+// Parses an old-style (non-actor) DECORATE definition into [old]
 // -----------------------------------------------------------------------------
-void parseDecorateOld(Tokenizer& tz, std::map<int, ThingType>& types)
+void parseDecorateOld(Tokenizer& tz, DecorateDef& old)
 {
 	std::string  name, sprite, group;
 	bool         spritefound = false;
@@ -484,12 +524,12 @@ void parseDecorateOld(Tokenizer& tz, std::map<int, ThingType>& types)
 	int          type        = -1;
 	PropertyList found_props;
 	if (tz.checkNext("{"))
-		name = tz.current().text;
+		name = tz.current().text();
 	// DamageTypes aren't old DECORATE format, but we handle them here to skip over them
 	else if (tz.checkNC("pickup") || tz.checkNC("breakable") || tz.checkNC("projectile") || tz.checkNC("damagetype"))
 	{
-		group = tz.current().text;
-		name  = tz.next().text;
+		group = tz.current().text();
+		name  = tz.next().text();
 	}
 	tz.adv(); // skip '{'
 	do
@@ -505,13 +545,13 @@ void parseDecorateOld(Tokenizer& tz, std::map<int, ThingType>& types)
 		// else if (S_CMPNOCASE(token, "Sprite"))
 		else if (tz.checkNC("sprite"))
 		{
-			sprite      = tz.next().text;
+			sprite      = tz.next().text();
 			spritefound = true;
 		}
 		// else if (S_CMPNOCASE(token, "Frames"))
 		else if (tz.checkNC("frames"))
 		{
-			wxString frames = tz.next().text;
+			wxString frames = tz.next().text();
 			unsigned pos    = 0;
 			if (frames.length() > 0)
 			{
@@ -544,36 +584,56 @@ void parseDecorateOld(Tokenizer& tz, std::map<int, ThingType>& types)
 			found_props["translation"] = fmt::format("doom{}", tz.next().asInt());
 	} while (!tz.check("}") && !tz.atEnd());
 
+	// Determine sprite
+	if (type > 0 && spritefound && framefound)
+		found_props["sprite"] = sprite + frame + '?';
+
+	old.actor = false;
+	old.name  = name;
+	old.group = group;
+	old.ednum = type;
+	old.props = found_props;
+}
+
+// -----------------------------------------------------------------------------
+// Adds the parsed old-style DECORATE definition [old] to [types]
+// -----------------------------------------------------------------------------
+void addDecorateOld(DecorateDef& old, std::map<int, ThingType>& types)
+{
 	// Add only if a DoomEdNum is present
-	if (type > 0)
+	if (old.ednum > 0)
 	{
-		// Determine sprite
-		if (spritefound && framefound)
-			found_props["sprite"] = sprite + frame + '?';
-
 		// Add type
-		types[type].define(type, name, group.empty() ? "Decorate" : "Decorate/" + group);
+		types[old.ednum].define(old.ednum, old.name, old.group.empty() ? "Decorate" : "Decorate/" + old.group);
 
 		// Set parsed properties
-		types[type].loadProps(found_props);
+		types[old.ednum].loadProps(old.props);
 
-		Log::info(3, wxString::Format("Parsed %s %s: %d", group.length() ? group : "decoration", name, type));
+		Log::info(
+			3,
+			wxString::Format(
+				"Parsed %s %s: %d", old.group.length() ? old.group : "decoration", old.name, old.ednum));
 	}
 	else
 		Log::info(
-			3, wxString::Format("Not adding %s %s, no editor number", group.length() ? group : "decoration", name));
+			3,
+			wxString::Format(
+				"Not adding %s %s, no editor number", old.group.length() ? old.group : "decoration", old.name));
 }
 
 // -----------------------------------------------------------------------------
-// Parses all DECORATE thing definitions in [entry] and adds them to [types]
+// Parses all DECORATE definitions in [pe]'s entry data, without following any
+// #includes. Doesn't access the entry or archive, so can be run in parallel
 // -----------------------------------------------------------------------------
-void parseDecorateEntry(ArchiveEntry* entry, std::map<int, ThingType>& types, vector<ThingType>& parsed)
+void parseEntryDefs(ParsedEntry& pe)
 {
+	PROFILE_ZONE("Game::parseEntryDefs");
+
 	// Init tokenizer
 	Tokenizer tz;
 	tz.setSpecialCharacters(":,{}");
 	tz.enableDecorate(true);
-	tz.openMem(entry->data(), entry->name());
+	tz.openMem(*pe.data, pe.entry->name());
 
 	// --- Parse ---
 	while (!tz.atEnd())
@@ -581,36 +641,59 @@ void parseDecorateEntry(ArchiveEntry* entry, std::map<int, ThingType>& types, ve
 		// Check for #include
 		if (tz.checkNC("#include"))
 		{
-			auto inc_entry = entry->relativeEntry(tz.next().text);
-
-			// Check #include path could be resolved
-			if (!inc_entry)
-			{
-				Log::warning(
-					"Warning parsing DECORATE entry {}: "
-					"Unable to find #included entry \"{}\" at line {}, skipping",
-					entry->name(),
-					tz.current().text,
-					tz.current().line_no);
-			}
-			else
-				parseDecorateEntry(inc_entry, types, parsed);
-
+			auto& path = tz.next();
+			pe.includes.push_back({ (unsigned)pe.items.size(), path.text(), path.line_no });
 			tz.adv();
 		}
 
 		// Check for actor definition
 		else if (tz.checkNC("actor"))
-			parseDecorateActor(tz, types, parsed);
+		{
+			pe.items.emplace_back();
+			parseDecorateActor(tz, pe.items.back());
+		}
 		else
-			parseDecorateOld(tz, types); // Old DECORATE definitions might be found
+		{
+			pe.items.emplace_back();
+			parseDecorateOld(tz, pe.items.back()); // Old DECORATE definitions might be found
+		}
 
 		tz.advIf("}");
 	}
+}
+
+// -----------------------------------------------------------------------------
+// Parses all DECORATE thing definitions in [entries] (and any entries they
+// #include) and adds them to [types]. Entries are parsed in parallel (see
+// IncludeParser), then the definitions are added on this thread in the same
+// order as parsing them serially would
+// -----------------------------------------------------------------------------
+void parseDecorateEntries(
+	const vector<ArchiveEntry*>& entries,
+	std::map<int, ThingType>&    types,
+	vector<ThingType>&           parsed)
+{
+	PROFILE_ZONE("Game::parseDecorateEntries");
+
+	IncludeParser<DecorateDef> parser("DECORATE", etype_decorate);
+	parser.parse(entries, parseEntryDefs);
+
+	// Add definitions
+	for (auto entry : entries)
+		parser.expand(entry, [&](DecorateDef&& def) {
+			if (def.actor)
+				addDecorateActor(def, types, parsed);
+			else
+				addDecorateOld(def, types);
+		});
+}
 
-	// Set entry type
-	if (etype_decorate && entry->type() != etype_decorate)
-		entry->setType(etype_decorate);
+// -----------------------------------------------------------------------------
+// Parses all DECORATE thing definitions in [entry] and adds them to [types]
+// -----------------------------------------------------------------------------
+void parseDecorateEntry(ArchiveEntry* entry, std::map<int, ThingType>& types, vector<ThingType>& parsed)
+{
+	parseDecorateEntries({ entry }, types, parsed);
 }
 
 } // namespace
@@ -647,8 +730,7 @@ bool Game::readDecorateDefs(Archive* archive, std::map<int, ThingType>& types, v
 		etype_decorate = nullptr;
 
 	// Parse DECORATE entries
-	for (auto entry : decorate_entries)
-		parseDecorateEntry(entry, types, parsed);
+	parseDecorateEntries(decorate_entries, types, parsed);
 
 	return true;
 }
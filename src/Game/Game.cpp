@@ -39,8 +39,8 @@
 #include "TextEditor/TextLanguage.h"
 #include "Utility/Parser.h"
 #include "ZScript.h"
-#include <thread>
 #include "Utility/StringUtils.h"
+#include <future>
 
 using namespace Game;
 
@@ -59,11 +59,153 @@ std::map<wxString, PortDef> port_defs;
 PortDef                     port_def_unknown;
 ZScript::Definitions        zscript_base;
 ZScript::Definitions        zscript_custom;
+std::shared_future<void>    zscript_base_job; // zscript_base is only written by this until it completes
 std::unique_ptr<Listener>   listener;
 } // namespace Game
 CVAR(String, game_configuration, "", CVar::Flag::Save)
 CVAR(String, port_configuration, "", CVar::Flag::Save)
 CVAR(String, zdoom_pk3_path, "", CVar::Flag::Save)
+namespace
+{
+const uint32_t ZSCRIPT_CACHE_MAGIC   = 0x43535A53; // 'SZSC'
+const uint32_t ZSCRIPT_CACHE_VERSION = 1;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the header for the ZScript cache of the zdoom pk3 at [pk3_path].
+// The cache is only valid while the pk3 path, size and modification time (and
+// the program version) all match
+// -----------------------------------------------------------------------------
+std::string zscriptCacheHeader(const wxString& pk3_path)
+{
+	auto key = fmt::format(
+		"{}|{}|{}|{}",
+		pk3_path.ToStdString(),
+		wxFileName::GetSize(pk3_path).ToString().ToStdString(),
+		static_cast<int64_t>(wxFileModificationTime(pk3_path)),
+		App::version().toString());
+
+	std::string header;
+	uint32_t    values[3] = { ZSCRIPT_CACHE_MAGIC, ZSCRIPT_CACHE_VERSION, static_cast<uint32_t>(key.size()) };
+	header.append(reinterpret_cast<const char*>(values), sizeof(values));
+	header += key;
+	return header;
+}
+
+// -----------------------------------------------------------------------------
+// Reads cached ZScript statements for the zdoom pk3 at [pk3_path] into
+// [parsed]. Returns false if there is no valid cache for the pk3
+// -----------------------------------------------------------------------------
+bool readZScriptCache(const wxString& pk3_path, vector<ZScript::ParsedStatement>& parsed)
+{
+	auto filename = App::path("cache/zscript_base.bin", App::Dir::User);
+	if (!wxFileExists(filename))
+		return false;
+
+	MemChunk mc;
+	if (!mc.importFile(filename))
+		return false;
+
+	// Check header matches
+	auto header = zscriptCacheHeader(pk3_path);
+	if (mc.size() < header.size() + 4 || memcmp(mc.data(), header.data(), header.size()) != 0)
+		return false;
+
+	// Read statements
+	uint32_t count;
+	mc.seek(header.size(), SEEK_SET);
+	if (!mc.read(&count, 4) || count > mc.size())
+		return false;
+	parsed.resize(count);
+	for (auto& statement : parsed)
+		if (!statement.readBinary(mc))
+		{
+			Log::warning(wxString::Format("ZScript cache file \"%s\" is invalid", filename));
+			parsed.clear();
+			return false;
+		}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Writes [parsed] ZScript statements to the cache for the zdoom pk3 at
+// [pk3_path]
+// -----------------------------------------------------------------------------
+void writeZScriptCache(const wxString& pk3_path, const vector<ZScript::ParsedStatement>& parsed)
+{
+	// Create cache directory if needed
+	auto cache_dir = App::path("cache", App::Dir::User);
+	if (!wxDirExists(cache_dir))
+		wxMkdir(cache_dir);
+
+	auto     data  = zscriptCacheHeader(pk3_path);
+	uint32_t count = parsed.size();
+	data.append(reinterpret_cast<const char*>(&count), 4);
+	for (auto& statement : parsed)
+		statement.writeBinary(data);
+
+	auto   filename = App::path("cache/zscript_base.bin", App::Dir::User);
+	wxFile file(filename, wxFile::write);
+	if (!file.IsOpened() || !file.Write(data.data(), data.size()))
+		Log::warning(wxString::Format("Unable to write ZScript cache file \"%s\"", filename));
+}
+
+// -----------------------------------------------------------------------------
+// Reads the base ZScript definitions from the zdoom pk3 at [pk3_path] into
+// zscript_base, from the cache if possible
+// -----------------------------------------------------------------------------
+void readZScriptBase(const wxString& pk3_path)
+{
+	auto start = App::runTimer();
+
+	// Use cached statements if the pk3 hasn't changed
+	vector<ZScript::ParsedStatement> parsed;
+	if (readZScriptCache(pk3_path, parsed))
+	{
+		Game::zscript_base.parseZScript(parsed);
+		Log::info(2, wxString::Format("Read base ZScript definitions from cache in %ldms", App::runTimer() - start));
+		return;
+	}
+
+	// Otherwise parse zscript.txt in the pk3
+	ZipArchive zdoom_pk3;
+	if (!zdoom_pk3.open(pk3_path))
+		return;
+	auto zscript_entry = zdoom_pk3.entryAtPath("zscript.txt");
+	if (!zscript_entry)
+	{
+		// Bail out if no entry is found.
+		Log::warning(1, "Could not find \'zscript.txt\' in " + pk3_path);
+		return;
+	}
+	ZScript::parseBlocks(zscript_entry, parsed);
+	writeZScriptCache(pk3_path, parsed);
+	Game::zscript_base.parseZScript(parsed);
+	Log::info(2, wxString::Format("Parsed base ZScript definitions in %ldms", App::runTimer() - start));
+}
+
+// -----------------------------------------------------------------------------
+// Background job to load the base ZScript definitions from the zdoom pk3 at
+// [pk3_path], which mustn't touch anything other than zscript_base.
+// Once done, the definitions are made available on the main thread
+// -----------------------------------------------------------------------------
+void loadZScriptBase(const wxString& pk3_path)
+{
+	readZScriptBase(pk3_path);
+
+	if (wxTheApp)
+		wxTheApp->CallAfter([]() { Game::zscriptBaseDefinitions(); });
+}
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -255,6 +397,35 @@ Configuration& Game::configuration()
 	return config_current;
 }
 
+// -----------------------------------------------------------------------------
+// Returns the base ZScript definitions (from zdoom_pk3_path), waiting for them
+// to finish loading in the background first if needed.
+// Must only be called from the main thread
+// -----------------------------------------------------------------------------
+const ZScript::Definitions& Game::zscriptBaseDefinitions()
+{
+	if (zscript_base_job.valid())
+	{
+		zscript_base_job.wait();
+		zscript_base_job = {};
+
+		auto lang = TextLanguage::fromId("zscript");
+		if (lang)
+			lang->loadZScript(zscript_base);
+	}
+
+	return zscript_base;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the base ZScript definitions have finished loading, ie.
+// zscriptBaseDefinitions won't have to wait
+// -----------------------------------------------------------------------------
+bool Game::zscriptBaseLoaded()
+{
+	return !zscript_base_job.valid() || zscript_base_job.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
 // -----------------------------------------------------------------------------
 // Clears and re-parses custom definitions in all open archives
 // (DECORATE, *MAPINFO, ZScript etc.)
@@ -295,8 +466,10 @@ void Game::updateCustomDefinitions()
 		config_current.parseMapInfo(archive);
 	}
 
-	// Process custom definitions
-	config_current.importZScriptDefs(zscript_custom);
+	// Process custom definitions (custom ZScript classes can inherit from base
+	// classes, so wait for those to finish loading if needed)
+	config_current.importZScriptDefs(
+		zscript_custom, zscript_custom.classes().empty() ? nullptr : &zscriptBaseDefinitions());
 	config_current.linkDoomEdNums();
 
 	auto lang = TextLanguage::fromId("zscript");
@@ -443,36 +616,10 @@ void Game::init()
 	if (!loadCustomSpecialPresets())
 		Log::warning("An error occurred loading user special_presets.cfg");
 
-	// Load zdoom.pk3 stuff
+	// Load zdoom.pk3 ZScript definitions in the background, and make them
+	// available on the main thread when done
 	if (wxFileExists(zdoom_pk3_path))
-	{
-		std::thread thread([=]() {
-			ZipArchive zdoom_pk3;
-			if (!zdoom_pk3.open(zdoom_pk3_path))
-				return;
-
-			// ZScript
-			auto zscript_entry = zdoom_pk3.entryAtPath("zscript.txt");
-
-			if (!zscript_entry)
-			{
-				// Bail out if no entry is found.
-				Log::warning(1, "Could not find \'zscript.txt\' in " + zdoom_pk3_path);
-			}
-			else
-			{
-				zscript_base.parseZScript(zscript_entry);
-
-				auto lang = TextLanguage::fromId("zscript");
-				if (lang)
-					lang->loadZScript(zscript_base);
-
-				// MapInfo
-				config_current.parseMapInfo(&zdoom_pk3);
-			}
-		});
-		thread.detach();
-	}
+		zscript_base_job = std::async(std::launch::async, loadZScriptBase, wxString(zdoom_pk3_path.value)).share();
 
 	// Init game listener
 	listener = std::make_unique<GameListener>();
@@ -2,6 +2,10 @@
 
 enum class MapFormat;
 class ParseTreeNode;
+namespace ZScript
+{
+class Definitions;
+}
 
 namespace Game
 {
@@ -96,6 +100,10 @@ Configuration& configuration();
 // Tagging
 TagType parseTagged(ParseTreeNode* tagged);
 
+// Base ZScript definitions (from zdoom_pk3_path, loaded in the background)
+const ZScript::Definitions& zscriptBaseDefinitions();
+bool                        zscriptBaseLoaded();
+
 // Custom definitions (ZScript, DECORATE, EDF, etc.)
 void updateCustomDefinitions();
 
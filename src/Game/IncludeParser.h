@@ -0,0 +1,184 @@
+#pragma once
+
+#include "Archive/ArchiveEntry.h"
+#include "Archive/EntryType/EntryType.h"
+#include "Utility/Parallel.h"
+#include <unordered_map>
+
+// Parses a set of text entries (ZScript, DECORATE, etc.) that can #include
+// other entries, into items of type [T] (statements, definitions, etc.).
+//
+// Entries are parsed in waves - each entry in a wave is parsed on its own,
+// spread across all available hardware threads, then any newly found #included
+// entries become the next wave. Anything touching the entries/archives
+// (loading data, resolving #includes, setting types and logging) is done on
+// the calling thread. The parsed items are then visited with #includes
+// expanded in place, in the same order as parsing them serially would
+template<typename T> class IncludeParser
+{
+public:
+	// A single entry parsed into items, with the positions of any #includes
+	// within it (to be resolved and expanded afterwards)
+	struct Entry
+	{
+		struct Include
+		{
+			unsigned      index; // Insert before this item
+			std::string   path;
+			unsigned      line;
+			ArchiveEntry* entry = nullptr;
+		};
+
+		ArchiveEntry*   entry = nullptr;
+		MemChunk*       data  = nullptr;
+		vector<T>       items;
+		vector<Include> includes;
+		unsigned        refs = 0; // Number of times this entry will be expanded
+	};
+
+	typedef std::function<void(Entry&)> ParseFunc;
+	typedef std::function<void(T&&)>    AddFunc;
+
+	// [language] is used in warning messages, and all parsed entries are set to
+	// [type] (if given)
+	IncludeParser(std::string_view language, EntryType* type) : language_{ language }, type_{ type } {}
+	~IncludeParser() = default;
+
+	// -------------------------------------------------------------------------
+	// Parses [entries] and any entries they #include with [parse_entry], which
+	// must fill in the items and includes of the given Entry from its data. It
+	// is called from multiple threads and must not access the entry or archive
+	// -------------------------------------------------------------------------
+	void parse(const vector<ArchiveEntry*>& entries, const ParseFunc& parse_entry)
+	{
+		vector<Entry*> wave;
+		for (auto entry : entries)
+		{
+			auto& pe = entries_[entry];
+			if (!pe.entry)
+			{
+				pe.entry = entry;
+				wave.push_back(&pe);
+			}
+		}
+		while (!wave.empty())
+		{
+			// Load entry data
+			for (auto pe : wave)
+				pe->data = &pe->entry->data();
+
+			// Parse (in parallel if there's enough to do)
+			parallelFor(wave.size(), 1, 0, [&](unsigned start, unsigned end) {
+				for (auto index = start; index < end; ++index)
+					parse_entry(*wave[index]);
+			});
+
+			// Resolve #includes
+			vector<Entry*> next_wave;
+			for (auto pe : wave)
+				for (auto& inc : pe->includes)
+				{
+					inc.entry = pe->entry->relativeEntry(inc.path);
+					if (!inc.entry)
+						continue;
+
+					auto& inc_pe = entries_[inc.entry];
+					if (!inc_pe.entry)
+					{
+						inc_pe.entry = inc.entry;
+						next_wave.push_back(&inc_pe);
+					}
+				}
+			wave.swap(next_wave);
+		}
+
+		// Count expansions of each entry, so the last one can move its items
+		vector<ArchiveEntry*> stack;
+		for (auto entry : entries)
+			countExpansions(entries_[entry], stack);
+	}
+
+	// -------------------------------------------------------------------------
+	// Calls [add] for each item parsed from [entry], with its #includes
+	// expanded in place. Items are moved out on the last expansion of their
+	// entry, and copied otherwise
+	// -------------------------------------------------------------------------
+	void expand(ArchiveEntry* entry, const AddFunc& add)
+	{
+		vector<ArchiveEntry*> stack;
+		expand(entries_[entry], stack, add);
+	}
+
+private:
+	std::string                              language_;
+	EntryType*                               type_ = nullptr;
+	std::unordered_map<ArchiveEntry*, Entry> entries_;
+
+	// -------------------------------------------------------------------------
+	// Counts the number of times [pe] (and any entries it #includes) will be
+	// expanded. [stack] is the chain of entries currently being counted, used
+	// to skip recursive #includes
+	// -------------------------------------------------------------------------
+	void countExpansions(Entry& pe, vector<ArchiveEntry*>& stack)
+	{
+		++pe.refs;
+		stack.push_back(pe.entry);
+		for (auto& inc : pe.includes)
+			if (inc.entry && !(VECTOR_EXISTS(stack, inc.entry)))
+				countExpansions(entries_[inc.entry], stack);
+		stack.pop_back();
+	}
+
+	// -------------------------------------------------------------------------
+	// Calls [add] for each item in [pe], expanding its #includes in place.
+	// [stack] is the chain of entries currently being expanded, used to skip
+	// recursive #includes
+	// -------------------------------------------------------------------------
+	void expand(Entry& pe, vector<ArchiveEntry*>& stack, const AddFunc& add)
+	{
+		bool last     = pe.refs == 0 || --pe.refs == 0;
+		auto add_from = [&](unsigned from, unsigned to) {
+			for (auto a = from; a < to; ++a)
+			{
+				if (last)
+					add(std::move(pe.items[a]));
+				else
+					add(T(pe.items[a]));
+			}
+		};
+
+		stack.push_back(pe.entry);
+		unsigned index = 0;
+		for (auto& inc : pe.includes)
+		{
+			add_from(index, inc.index);
+			index = inc.index;
+
+			// Check #include path could be resolved
+			if (!inc.entry)
+			{
+				Log::warning(
+					"Warning parsing {} entry {}: Unable to find #included entry \"{}\" at line {}, skipping",
+					language_,
+					pe.entry->name(),
+					inc.path,
+					inc.line);
+			}
+			else if (VECTOR_EXISTS(stack, inc.entry))
+				Log::warning(
+					"Warning parsing {} entry {}: Recursive #include \"{}\" at line {}, skipping",
+					language_,
+					pe.entry->name(),
+					inc.path,
+					inc.line);
+			else
+				expand(entries_[inc.entry], stack, add);
+		}
+		add_from(index, pe.items.size());
+		stack.pop_back();
+
+		// Set entry type
+		if (type_ && pe.entry->type() != type_)
+			pe.entry->setType(type_);
+	}
+};
@@ -142,7 +142,7 @@ bool MapInfo::checkEqualsToken(Tokenizer& tz, const wxString& parsing) const
 	if (tz.next() != "=")
 	{
 		Log::error(
-			"Error Parsing {}: Expected \"=\", got \"{}\" at line {}", CHR(parsing), tz.current().text, tz.lineNo());
+			"Error Parsing {}: Expected \"=\", got \"{}\" at line {}", CHR(parsing), tz.current().text(), tz.lineNo());
 		return false;
 	}
 
@@ -198,14 +198,14 @@ bool MapInfo::parseZMapInfo(ArchiveEntry* entry)
 		if (tz.check("include"))
 		{
 			// Get entry at include path
-			auto include_entry = entry->parent()->entryAtPath(tz.next().text);
+			auto include_entry = entry->parent()->entryAtPath(tz.next().text());
 
 			if (!include_entry)
 			{
 				Log::warning(
 					"Warning - Parsing ZMapInfo \"{}\": Unable to include \"{}\" at line {}",
 					entry->name(),
-					tz.current().text,
+					tz.current().text(),
 					tz.lineNo());
 			}
 			else if (!parseZMapInfo(include_entry))
@@ -215,7 +215,7 @@ bool MapInfo::parseZMapInfo(ArchiveEntry* entry)
 		// Map
 		else if (tz.check("map") || tz.check("defaultmap") || tz.check("adddefaultmap"))
 		{
-			if (!parseZMap(tz, tz.current().text))
+			if (!parseZMap(tz, tz.current().text()))
 				return false;
 		}
 
@@ -240,7 +240,7 @@ bool MapInfo::parseZMapInfo(ArchiveEntry* entry)
 		else
 		{
 			Log::warning(
-				2, R"(Warning - Parsing ZMapInfo "{}": Unknown token "{}")", entry->name(), tz.current().text);
+				2, R"(Warning - Parsing ZMapInfo "{}": Unknown token "{}")", entry->name(), tz.current().text());
 		}
 
 		tz.adv();
@@ -265,19 +265,19 @@ bool MapInfo::parseZMap(Tokenizer& tz, const wxString& type)
 	if (type == "map")
 	{
 		// Entry name should be just after map keyword
-		map.entry_name = tz.current().text;
+		map.entry_name = tz.current().text();
 
 		// Parse map name
 		tz.adv();
 		if (tz.check("lookup"))
 		{
 			map.lookup_name = true;
-			map.name        = tz.next().text;
+			map.name        = tz.next().text();
 		}
 		else
 		{
 			map.lookup_name = false;
-			map.name        = tz.current().text;
+			map.name        = tz.current().text();
 		}
 
 		tz.adv();
@@ -285,7 +285,7 @@ bool MapInfo::parseZMap(Tokenizer& tz, const wxString& type)
 
 	if (!tz.advIf("{"))
 	{
-		Log::error("Error Parsing ZMapInfo: Expecting \"{\", got \"{}\" at line {}", tz.current().text, tz.lineNo());
+		Log::error("Error Parsing ZMapInfo: Expecting \"{\", got \"{}\" at line {}", tz.current().text(), tz.lineNo());
 		return false;
 	}
 
@@ -312,7 +312,7 @@ bool MapInfo::parseZMap(Tokenizer& tz, const wxString& type)
 			if (!checkEqualsToken(tz, "ZMapInfo"))
 				return false;
 
-			map.sky1 = tz.next().text;
+			map.sky1 = tz.next().text();
 
 			// Scroll speed
 			// TODO: Checks
@@ -326,7 +326,7 @@ bool MapInfo::parseZMap(Tokenizer& tz, const wxString& type)
 			if (!checkEqualsToken(tz, "ZMapInfo"))
 				return false;
 
-			map.sky2 = tz.next().text;
+			map.sky2 = tz.next().text();
 
 			// Scroll speed
 			// TODO: Checks
@@ -340,7 +340,7 @@ bool MapInfo::parseZMap(Tokenizer& tz, const wxString& type)
 			if (!checkEqualsToken(tz, "ZMapInfo"))
 				return false;
 
-			map.sky1 = tz.next().text;
+			map.sky1 = tz.next().text();
 		}
 
 		// DoubleSky
@@ -361,7 +361,7 @@ bool MapInfo::parseZMap(Tokenizer& tz, const wxString& type)
 			if (!checkEqualsToken(tz, "ZMapInfo"))
 				return false;
 
-			if (!strToCol(tz.next().text, map.fade))
+			if (!strToCol(tz.next().text(), map.fade))
 				return false;
 		}
 
@@ -371,7 +371,7 @@ bool MapInfo::parseZMap(Tokenizer& tz, const wxString& type)
 			if (!checkEqualsToken(tz, "ZMapInfo"))
 				return false;
 
-			if (!strToCol(tz.next().text, map.fade_outside))
+			if (!strToCol(tz.next().text(), map.fade_outside))
 				return false;
 		}
 
@@ -445,7 +445,7 @@ bool MapInfo::parseDoomEdNums(Tokenizer& tz)
 	// Opening brace
 	if (!tz.advIfNext("{", 2))
 	{
-		Log::error("Error Parsing ZMapInfo: Expecting \"{\", got \"{}\" at line {}", tz.peek().text, tz.lineNo());
+		Log::error("Error Parsing ZMapInfo: Expecting \"{\", got \"{}\" at line {}", tz.peek().text(), tz.lineNo());
 		return false;
 	}
 
@@ -456,7 +456,7 @@ bool MapInfo::parseDoomEdNums(Tokenizer& tz)
 		{
 			Log::error(
 				"Error Parsing ZMapInfo DoomEdNums: Expecting editor number, got \"{}\" at line {}",
-				tz.current().text,
+				tz.current().text(),
 				tz.lineNo());
 			return false;
 		}
@@ -472,13 +472,13 @@ bool MapInfo::parseDoomEdNums(Tokenizer& tz)
 		{
 			Log::error(
 				"Error Parsing ZMapInfo DoomEdNums: Expecting \"=\", got \"{}\" at line {}",
-				tz.current().text,
+				tz.current().text(),
 				tz.lineNo());
 			return false;
 		}
 
 		// Actor Class
-		editor_nums_[number].actor_class = tz.next().text;
+		editor_nums_[number].actor_class = tz.next().text();
 
 		// Check for special/args definition
 		if (tz.advIfNext(",", 2))
@@ -487,7 +487,7 @@ bool MapInfo::parseDoomEdNums(Tokenizer& tz)
 
 			// Check if special or arg
 			if (!tz.current().isInteger())
-				editor_nums_[number].special = tz.current().text;
+				editor_nums_[number].special = tz.current().text();
 			else
 				editor_nums_[number].args[arg++] = tz.current().asInt();
 
@@ -498,7 +498,7 @@ bool MapInfo::parseDoomEdNums(Tokenizer& tz)
 				{
 					Log::error(wxString::Format(
 						"Error Parsing ZMapInfo DoomEdNums: Expecting arg value, got \"{}\" at line {}",
-						tz.current().text,
+						tz.current().text(),
 						tz.current().line_no));
 					return false;
 				}
@@ -548,7 +548,7 @@ MapInfo::Format MapInfo::detectMapInfoType(ArchiveEntry* entry) const
 				return Format::ZDoomNew;
 		}
 
-		prev = tz.current().text;
+		prev = tz.current().text();
 		tz.adv();
 	}
 
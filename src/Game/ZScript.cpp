@@ -33,6 +33,8 @@
 #include "ZScript.h"
 #include "Archive/Archive.h"
 #include "Archive/ArchiveManager.h"
+#include "IncludeParser.h"
+#include "Utility/Profiler.h"
 #include "Utility/Tokenizer.h"
 #include "Utility/StringUtils.h"
 
@@ -184,39 +186,34 @@ bool checkKeywordValueStatement(const vector<wxString>& tokens, unsigned index,
 }
 
 // -----------------------------------------------------------------------------
-// Parses all statements/blocks in [entry], adding them to [parsed]
+// A single ZScript entry parsed into statements/blocks, with the positions of
+// any #includes within it (to be resolved and expanded afterwards)
 // -----------------------------------------------------------------------------
-void parseBlocks(ArchiveEntry* entry, vector<ParsedStatement>& parsed)
+typedef IncludeParser<ParsedStatement>::Entry ParsedEntry;
+
+// -----------------------------------------------------------------------------
+// Parses all statements/blocks in [pe]'s entry data, without following any
+// #includes. Doesn't access the entry or archive, so can be run in parallel
+// -----------------------------------------------------------------------------
+void parseEntryBlocks(ParsedEntry& pe)
 {
+	PROFILE_ZONE("ZScript::parseEntryBlocks");
+
 	Tokenizer tz;
 	tz.setSpecialCharacters(Tokenizer::DEFAULT_SPECIAL_CHARACTERS + "()+-[]&!?.");
 	tz.enableDecorate(true);
 	tz.setCommentTypes(Tokenizer::CommentTypes::CPPStyle | Tokenizer::CommentTypes::CStyle);
-	tz.openMem(entry->data(), "ZScript");
-
-	// Log::info(2, wxString::Format("Parsing ZScript entry \"%s\"", entry->getPath(true)));
+	tz.openMem(*pe.data, "ZScript");
 
 	while (!tz.atEnd())
 	{
 		// Preprocessor
-		if (StrUtil::startsWith(tz.current().text, '#'))
+		if (StrUtil::startsWith(tz.current().text(), '#'))
 		{
 			if (tz.checkNC("#include"))
 			{
-				auto inc_entry = entry->relativeEntry(tz.next().text);
-
-				// Check #include path could be resolved
-				if (!inc_entry)
-				{
-					Log::warning(
-						"Warning parsing ZScript entry {}: "
-						"Unable to find #included entry \"{}\" at line {}, skipping",
-						entry->name(),
-						tz.current().text,
-						tz.current().line_no);
-				}
-				else
-					parseBlocks(inc_entry, parsed);
+				auto& path = tz.next();
+				pe.includes.push_back({ (unsigned)pe.items.size(), path.text(), path.line_no });
 			}
 
 			tz.advToNextLine();
@@ -231,15 +228,45 @@ void parseBlocks(ArchiveEntry* entry, vector<ParsedStatement>& parsed)
 		}
 
 		// ZScript
-		parsed.push_back({});
-		parsed.back().entry = entry;
-		if (!parsed.back().parse(tz))
-			parsed.pop_back();
+		pe.items.push_back({});
+		pe.items.back().entry = pe.entry;
+		if (!pe.items.back().parse(tz))
+			pe.items.pop_back();
 	}
+}
+
+// -----------------------------------------------------------------------------
+// Parses all statements/blocks in [entries] and any entries they #include,
+// adding them to the matching vector in [parsed]. Entries are parsed in
+// parallel (see IncludeParser), with #includes expanded in the same order as
+// parsing them serially would
+// -----------------------------------------------------------------------------
+void parseBlocks(const vector<ArchiveEntry*>& entries, vector<vector<ParsedStatement>>& parsed)
+{
+	PROFILE_ZONE("ZScript::parseBlocks");
+
+	IncludeParser<ParsedStatement> parser("ZScript", etype_zscript);
+	parser.parse(entries, parseEntryBlocks);
+
+	parsed.resize(entries.size());
+	for (unsigned a = 0; a < entries.size(); ++a)
+		parser.expand(entries[a], [&](ParsedStatement&& statement) { parsed[a].push_back(std::move(statement)); });
+}
+
+// -----------------------------------------------------------------------------
+// Parses all statements/blocks in [entry] and any entries it #includes, adding
+// them to [parsed]
+// -----------------------------------------------------------------------------
+void parseBlocks(ArchiveEntry* entry, vector<ParsedStatement>& parsed)
+{
+	vector<vector<ParsedStatement>> entry_parsed;
+	parseBlocks({ entry }, entry_parsed);
 
-	// Set entry type
-	if (etype_zscript && entry->type() != etype_zscript)
-		entry->setType(etype_zscript);
+	if (parsed.empty())
+		parsed = std::move(entry_parsed[0]);
+	else
+		for (auto& statement : entry_parsed[0])
+			parsed.push_back(std::move(statement));
 }
 
 // -----------------------------------------------------------------------------
@@ -677,8 +704,10 @@ bool Class::parse(ParsedStatement& class_statement)
 		return false;
 	}
 
-	// Set editor sprite from parsed states
-	default_properties_["sprite"] = states_.editorSprite().ToStdString();
+	// Set editor sprite from parsed states (if any, otherwise it's inherited)
+	auto sprite = states_.editorSprite();
+	if (!sprite.empty())
+		default_properties_["sprite"] = sprite.ToStdString();
 
 	// Add DB comment props to default properties
 	for (auto& i : db_properties_)
@@ -729,9 +758,13 @@ bool Class::extend(ParsedStatement& block)
 
 // -----------------------------------------------------------------------------
 // Adds this class as a ThingType to [parsed], or updates an existing ThingType
-// definition in [types] or [parsed]
+// definition in [types] or [parsed]. Default properties from the [inherited]
+// classes (nearest first) are applied before this class's own
 // -----------------------------------------------------------------------------
-void Class::toThingType(std::map<int, Game::ThingType>& types, vector<Game::ThingType>& parsed)
+void Class::toThingType(
+	std::map<int, Game::ThingType>& types,
+	vector<Game::ThingType>&        parsed,
+	const vector<const Class*>&     inherited)
 {
 	// Find existing definition
 	Game::ThingType* def = nullptr;
@@ -773,6 +806,13 @@ void Class::toThingType(std::map<int, Game::ThingType>& types, vector<Game::Thin
 	}
 	def->define(def->number(), title, group);
 
+	// Inherit default properties from parent classes
+	for (auto a = inherited.rbegin(); a != inherited.rend(); ++a)
+	{
+		auto props = (*a)->default_properties_;
+		def->loadProps(props, true, true);
+	}
+
 	// Set properties from defaults section
 	def->loadProps(default_properties_, true, true);
 }
@@ -923,8 +963,18 @@ bool Definitions::parseZScript(ArchiveEntry* entry)
 	vector<ParsedStatement> parsed;
 	parseBlocks(entry, parsed);
 	Log::debug(2, wxString::Format("parseBlocks: %ldms", App::runTimer() - start));
-	start = App::runTimer();
 
+	return parseZScript(parsed);
+}
+
+// -----------------------------------------------------------------------------
+// Parses ZScript from the already parsed tree of statements/blocks [parsed]
+// -----------------------------------------------------------------------------
+bool Definitions::parseZScript(vector<ParsedStatement>& parsed)
+{
+	PROFILE_ZONE("ZScript::Definitions::parseZScript");
+
+	auto start = App::runTimer();
 	for (auto& block : parsed)
 	{
 		if (block.tokens.empty())
@@ -1004,23 +1054,60 @@ bool Definitions::parseZScript(Archive* archive)
 	if (etype_zscript == EntryType::unknownType())
 		etype_zscript = nullptr;
 
-	// Parse ZScript entries
+	// Parse ZScript entries (all statements/blocks in parallel first)
+	auto                            start = App::runTimer();
+	vector<vector<ParsedStatement>> parsed;
+	parseBlocks(zscript_enries, parsed);
+	Log::debug(2, wxString::Format("parseBlocks: %ldms", App::runTimer() - start));
 	bool ok = true;
-	for (auto entry : zscript_enries)
-		if (!parseZScript(entry))
+	for (auto& entry_parsed : parsed)
+		if (!parseZScript(entry_parsed))
 			ok = false;
 
 	return ok;
 }
 
+// -----------------------------------------------------------------------------
+// Returns the class named [name] (case-insensitive), or nullptr if not found
+// -----------------------------------------------------------------------------
+const Class* Definitions::findClass(const wxString& name) const
+{
+	for (auto& cdef : classes_)
+		if (S_CMPNOCASE(cdef.name(), name))
+			return &cdef;
+
+	return nullptr;
+}
+
 // -----------------------------------------------------------------------------
 // Exports all classes to ThingTypes in [types] and [parsed] (from a
-// Game::Configuration object)
+// Game::Configuration object). Parent classes are looked up in these
+// definitions first, then in [base] (if given)
 // -----------------------------------------------------------------------------
-void Definitions::exportThingTypes(std::map<int, Game::ThingType>& types, vector<Game::ThingType>& parsed)
+void Definitions::exportThingTypes(
+	std::map<int, Game::ThingType>& types,
+	vector<Game::ThingType>&        parsed,
+	const Definitions*              base)
 {
 	for (auto& cdef : classes_)
-		cdef.toThingType(types, parsed);
+	{
+		// Find inherited classes, stopping at any recursive inheritance
+		vector<const Class*> inherited;
+		auto                 parent_name = cdef.inherits();
+		while (!parent_name.empty())
+		{
+			auto parent = findClass(parent_name);
+			if (!parent && base)
+				parent = base->findClass(parent_name);
+			if (!parent || parent == &cdef || VECTOR_EXISTS(inherited, parent))
+				break;
+
+			inherited.push_back(parent);
+			parent_name = parent->inherits();
+		}
+
+		cdef.toThingType(types, parsed, inherited);
+	}
 }
 
 
@@ -1067,9 +1154,9 @@ bool ParsedStatement::parse(Tokenizer& tz)
 			return true;
 
 		// DB comment
-		if (StrUtil::startsWith(tz.current().text, db_comment))
+		if (StrUtil::startsWith(tz.current().text(), db_comment))
 		{
-			tokens.emplace_back(tz.current().text);
+			tokens.emplace_back(tz.current().text());
 			tokens.emplace_back(tz.getLine());
 			return true;
 		}
@@ -1109,7 +1196,7 @@ bool ParsedStatement::parse(Tokenizer& tz)
 			continue;
 		}
 
-		tokens.emplace_back(tz.current().text);
+		tokens.emplace_back(tz.current().text());
 		tz.adv();
 	}
 
@@ -1132,6 +1219,66 @@ bool ParsedStatement::parse(Tokenizer& tz)
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Writes this statement (and its block) to [out] in a compact binary format,
+// that can be read back with readBinary. The source entry isn't written
+// -----------------------------------------------------------------------------
+void ParsedStatement::writeBinary(std::string& out) const
+{
+	auto write_u32 = [&out](uint32_t value) { out.append(reinterpret_cast<const char*>(&value), 4); };
+
+	write_u32(line);
+	write_u32(tokens.size());
+	for (auto& token : tokens)
+	{
+		auto utf8 = token.ToUTF8();
+		write_u32(utf8.length());
+		out.append(utf8.data(), utf8.length());
+	}
+
+	write_u32(block.size());
+	for (auto& statement : block)
+		statement.writeBinary(out);
+}
+
+// -----------------------------------------------------------------------------
+// Reads this statement (and its block) from [mc] at its current position, as
+// written by writeBinary.
+// Returns false if the data is invalid or incomplete
+// -----------------------------------------------------------------------------
+bool ParsedStatement::readBinary(MemChunk& mc)
+{
+	// Reads a count, checking it can't be larger than the remaining data
+	auto read_count = [&mc](uint32_t& count) { return mc.read(&count, 4) && count <= mc.size() - mc.currentPos(); };
+
+	uint32_t count;
+	if (!mc.read(&line, 4) || !read_count(count))
+		return false;
+
+	tokens.clear();
+	tokens.reserve(count);
+	std::string utf8;
+	for (unsigned a = 0; a < count; a++)
+	{
+		uint32_t len;
+		if (!read_count(len))
+			return false;
+		utf8.resize(len);
+		if (len > 0 && !mc.read(&utf8[0], len))
+			return false;
+		tokens.push_back(wxString::FromUTF8(utf8.data(), len));
+	}
+
+	if (!read_count(count))
+		return false;
+	block.resize(count);
+	for (auto& statement : block)
+		if (!statement.readBinary(mc))
+			return false;
+
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Dumps this statement to the log (debug), indenting by 2*[indent] spaces
 // -----------------------------------------------------------------------------
@@ -19,6 +19,8 @@ struct ParsedStatement
 
 	bool parse(Tokenizer& tz);
 	void dump(int indent = 0);
+	void writeBinary(std::string& out) const;
+	bool readBinary(MemChunk& mc);
 };
 
 class Enumerator
@@ -147,10 +149,15 @@ public:
 	virtual ~Class() = default;
 
 	const vector<Function>& functions() const { return functions_; }
+	const wxString&         inherits() const { return inherits_class_; }
+	const PropertyList&     defaultProperties() const { return default_properties_; }
 
 	bool parse(ParsedStatement& class_statement);
 	bool extend(ParsedStatement& block);
-	void toThingType(std::map<int, Game::ThingType>& types, vector<Game::ThingType>& parsed);
+	void toThingType(
+		std::map<int, Game::ThingType>& types,
+		vector<Game::ThingType>&        parsed,
+		const vector<const Class*>&     inherited = {});
 
 private:
 	Type               type_;
@@ -174,12 +181,17 @@ public:
 	~Definitions() = default;
 
 	const vector<Class>& classes() const { return classes_; }
+	const Class*         findClass(const wxString& name) const;
 
 	void clear();
 	bool parseZScript(ArchiveEntry* entry);
 	bool parseZScript(Archive* archive);
+	bool parseZScript(vector<ParsedStatement>& parsed);
 
-	void exportThingTypes(std::map<int, Game::ThingType>& types, vector<Game::ThingType>& parsed);
+	void exportThingTypes(
+		std::map<int, Game::ThingType>& types,
+		vector<Game::ThingType>&        parsed,
+		const Definitions*              base = nullptr);
 
 private:
 	vector<Class>      classes_;
@@ -187,4 +199,7 @@ private:
 	vector<Variable>   variables_;
 	vector<Function>   functions_; // needed? dunno if global functions are a thing
 };
+
+void parseBlocks(const vector<ArchiveEntry*>& entries, vector<vector<ParsedStatement>>& parsed);
+void parseBlocks(ArchiveEntry* entry, vector<ParsedStatement>& parsed);
 } // namespace ZScript
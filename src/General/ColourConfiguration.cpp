@@ -62,13 +62,15 @@ ColourHashMap cc_colours;
 
 
 // -----------------------------------------------------------------------------
-// Returns the colour [name]
+// Returns the colour [name].
+// Doesn't add [name] if it isn't defined, so this can be called from multiple
+// threads at once (eg. rendering map images in slade_cli)
 // -----------------------------------------------------------------------------
 ColRGBA ColourConfiguration::colour(const wxString& name)
 {
-	auto& col = cc_colours[name];
-	if (col.exists)
-		return col.colour;
+	auto col = cc_colours.find(name);
+	if (col != cc_colours.end() && col->second.exists)
+		return col->second.colour;
 	else
 		return ColRGBA::WHITE;
 }
@@ -77,12 +77,12 @@ void Console::execute(std::string_view command)
 	tz.openString(command);
 
 	// Get the command name
-	auto cmd_name = tz.current().text;
+	auto cmd_name = tz.current().text();
 
 	// Get all args
 	vector<std::string> args;
 	while (!tz.atEnd())
-		args.push_back(tz.next().text);
+		args.push_back(tz.next().text());
 
 	// Check that it is a valid command
 	for (auto& cmd : commands_)
@@ -773,13 +773,13 @@ bool KeyBind::readBinds(Tokenizer& tz)
 	while (!tz.checkOrEnd("}"))
 	{
 		// Clear any current binds for the key
-		wxString name = tz.current().text;
+		wxString name = tz.current().text();
 		bind(name).keys_.clear();
 
 		// Read keys
 		while (true)
 		{
-			wxString keystr = tz.next().text;
+			wxString keystr = tz.next().text();
 
 			// Finish if no keys are bound
 			if (keystr == "unbound")
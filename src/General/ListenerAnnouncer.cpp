@@ -33,6 +33,52 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "General/ListenerAnnouncer.h"
+#include <deque>
+#include <mutex>
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Event names and ids. These are never destroyed, since announcements can be
+// made by static objects on shutdown
+struct EventRegistry
+{
+	std::mutex                                              mutex;
+	std::map<std::string, Announcer::EventId, std::less<>> ids;
+	std::deque<wxString>                                    names; // Deque so references stay valid
+};
+EventRegistry& registry()
+{
+	static auto registry = new EventRegistry;
+	return *registry;
+}
+
+// An announcement held by a batch. Events with data are held (with the data of
+// each time they were announced joined together) only for listeners that take
+// batches
+struct PendingEvent
+{
+	Announcer*                announcer;
+	Announcer::EventId        event;
+	std::unique_ptr<MemChunk> data; // Null for events with no data
+	unsigned                  count = 0;
+};
+
+// Announcements held by the current batch on this thread, along with any outer
+// list that is still being announced (if a batch began while announcing one)
+struct PendingList
+{
+	vector<PendingEvent> events;
+	PendingList*         outer;
+};
+thread_local unsigned     batch_depth   = 0;
+thread_local PendingList* batch_pending = nullptr;
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -82,6 +128,21 @@ void Listener::stopListening(Announcer* a)
 // -----------------------------------------------------------------------------
 void Listener::onAnnouncement(Announcer* announcer, const wxString& event_name, MemChunk& event_data) {}
 
+// -----------------------------------------------------------------------------
+// Called at the end of a batch (see Announcer::Batch) for each event with data
+// that was announced [count] times during it, if this listener takes batches.
+// [event_data] is the data from each announcement, joined together in order.
+// By default just passes everything on to onAnnouncement as one announcement
+// -----------------------------------------------------------------------------
+void Listener::onBatchAnnouncement(
+	Announcer*      announcer,
+	const wxString& event_name,
+	MemChunk&       event_data,
+	unsigned        count)
+{
+	onAnnouncement(announcer, event_name, event_data);
+}
+
 
 // -----------------------------------------------------------------------------
 //
@@ -90,13 +151,68 @@ void Listener::onAnnouncement(Announcer* announcer, const wxString& event_name,
 // -----------------------------------------------------------------------------
 
 
+// -----------------------------------------------------------------------------
+// Announcer::Batch class constructor
+// -----------------------------------------------------------------------------
+Announcer::Batch::Batch()
+{
+	if (batch_depth++ == 0)
+		batch_pending = new PendingList{ {}, batch_pending };
+}
+
+// -----------------------------------------------------------------------------
+// Announcer::Batch class destructor. Makes the held announcements if this is
+// the outermost batch
+// -----------------------------------------------------------------------------
+Announcer::Batch::~Batch()
+{
+	if (--batch_depth > 0)
+		return;
+
+	// Announce held events (the list can change while announcing)
+	auto pending = batch_pending;
+	for (unsigned a = 0; a < pending->events.size(); ++a)
+	{
+		auto& held      = pending->events[a];
+		auto  announcer = held.announcer;
+		if (!announcer)
+			continue;
+
+		if (held.data)
+		{
+			auto data  = std::move(held.data);
+			auto event = held.event;
+			auto count = held.count;
+			data->seek(0, SEEK_SET);
+			announcer->dispatch(event, *data, To::Batch, count);
+		}
+		else
+			announcer->announce(held.event);
+	}
+
+	batch_pending = pending->outer;
+	delete pending;
+}
+
+
 // -----------------------------------------------------------------------------
 // Announcer class destructor
 // -----------------------------------------------------------------------------
 Announcer::~Announcer()
 {
+	// Let dispatch know if a listener destroyed this while announcing
+	if (destroyed_)
+		*destroyed_ = true;
+
 	for (auto& listener : listeners_)
-		listener->stopListening(this);
+		if (listener)
+			listener->stopListening(this);
+
+	// Remove any held announcements
+	for (auto pending = batch_pending; pending; pending = pending->outer)
+		for (auto& event : pending->events)
+			if (event.announcer == this)
+				event.announcer = nullptr;
 }
 
 // -----------------------------------------------------------------------------
@@ -116,36 +232,203 @@ void Announcer::removeListener(Listener* l)
 	{
 		if (listeners_[a] == l)
 		{
-			listeners_.erase(listeners_.begin() + a);
+			// Can't change the list while announcing, so just clear it and
+			// remove it afterwards
+			if (dispatch_depth_ > 0)
+			{
+				listeners_[a] = nullptr;
+				removed_      = true;
+			}
+			else
+				listeners_.erase(listeners_.begin() + a);
 			return;
 		}
 	}
 }
 
 // -----------------------------------------------------------------------------
-// 'Announces' an event to all listeners currently in the listeners list,
+// 'Announces' [event] to all listeners currently in the listeners list,
 // ie all Listeners that are 'listening' to this announcer.
+// If a batch is active, the announcement is held until the end of the batch if
+// there is no [event_data], otherwise only for listeners that take batches
+// (see Announcer::Batch)
 // -----------------------------------------------------------------------------
-void Announcer::announce(const wxString& event_name, MemChunk& event_data)
+void Announcer::announce(EventId event, MemChunk& event_data)
 {
-	if (isMuted())
+	if (isMuted() || listeners_.empty())
 		return;
 
-	auto listeners = listeners_;
-	for (auto& listener : listeners)
+	if (batch_depth > 0)
 	{
-		if (!listener->isDeaf())
-			listener->onAnnouncement(this, event_name, event_data);
+		auto& events = batch_pending->events;
+
+		// No data, hold it (once)
+		if (event_data.size() == 0)
+		{
+			for (auto& pending : events)
+				if (pending.announcer == this && pending.event == event && !pending.data)
+					return;
+
+			events.push_back({ this, event });
+			return;
+		}
+
+		// Has data, add it to the data held for listeners that take batches
+		// (if any), and announce it to the rest now
+		bool batch_listeners = false;
+		for (auto listener : listeners_)
+			if (listener && listener->takesBatches())
+			{
+				batch_listeners = true;
+				break;
+			}
+		if (batch_listeners)
+		{
+			PendingEvent* held = nullptr;
+			for (auto& pending : events)
+				if (pending.announcer == this && pending.event == event && pending.data)
+				{
+					held = &pending;
+					break;
+				}
+			if (!held)
+			{
+				events.push_back({ this, event, std::make_unique<MemChunk>() });
+				held = &events.back();
+			}
+
+			held->data->write(event_data.data(), event_data.size());
+			++held->count;
+			dispatch(event, event_data, To::Immediate);
+			return;
+		}
 	}
+
+	dispatch(event, event_data);
 }
 
 // -----------------------------------------------------------------------------
-// 'Announces' an event to all listeners currently in the listeners list,
-// ie all Listeners that are 'listening' to this announcer.
+// 'Announces' [event] to all listeners currently in the listeners list.
 // For announcements that don't require any extra data
 // -----------------------------------------------------------------------------
-void Announcer::announce(const wxString& event_name)
+void Announcer::announce(EventId event)
+{
+	MemChunk mc;
+	announce(event, mc);
+}
+
+// -----------------------------------------------------------------------------
+// 'Announces' the event [event_name] to all listeners currently in the
+// listeners list
+// -----------------------------------------------------------------------------
+void Announcer::announce(std::string_view event_name, MemChunk& event_data)
+{
+	if (isMuted() || listeners_.empty())
+		return;
+
+	announce(eventId(event_name), event_data);
+}
+
+// -----------------------------------------------------------------------------
+// 'Announces' the event [event_name] to all listeners currently in the
+// listeners list.
+// For announcements that don't require any extra data
+// -----------------------------------------------------------------------------
+void Announcer::announce(std::string_view event_name)
 {
 	MemChunk mc;
 	announce(event_name, mc);
 }
+
+// -----------------------------------------------------------------------------
+// Calls onAnnouncement (or onBatchAnnouncement with [count]) for [event] on the
+// listeners specified by [to].
+// A listener can destroy this announcer (eg. by closing an archive), in which
+// case nothing else (including any outer dispatch) touches it afterwards
+// -----------------------------------------------------------------------------
+void Announcer::dispatch(EventId event, MemChunk& event_data, To to, unsigned count)
+{
+	auto& event_name = eventName(event);
+
+	// Flag on the stack to be set by the destructor
+	bool  destroyed       = false;
+	auto* outer_destroyed = destroyed_;
+	destroyed_            = &destroyed;
+
+	// Listeners added while announcing don't get the announcement, and removed
+	// ones are only cleared from the list (see removeListener)
+	++dispatch_depth_;
+	auto n_listeners = listeners_.size();
+	for (unsigned a = 0; a < n_listeners; ++a)
+	{
+		auto listener = listeners_[a];
+		if (!listener || listener->isDeaf())
+			continue;
+
+		if (to == To::Batch)
+		{
+			if (listener->takesBatches())
+				listener->onBatchAnnouncement(this, event_name, event_data, count);
+		}
+		else if (to == To::All || !listener->takesBatches())
+			listener->onAnnouncement(this, event_name, event_data);
+
+		if (destroyed)
+		{
+			if (outer_destroyed)
+				*outer_destroyed = true;
+			return;
+		}
+	}
+	destroyed_ = outer_destroyed;
+
+	if (--dispatch_depth_ == 0 && removed_)
+	{
+		listeners_.erase(std::remove(listeners_.begin(), listeners_.end(), nullptr), listeners_.end());
+		removed_ = false;
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Announcer Class Static Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the id of the event [event_name], registering it if needed
+// -----------------------------------------------------------------------------
+Announcer::EventId Announcer::eventId(std::string_view event_name)
+{
+	auto&                       events = registry();
+	std::lock_guard<std::mutex> lock(events.mutex);
+
+	auto i = events.ids.find(event_name);
+	if (i != events.ids.end())
+		return i->second;
+
+	EventId id = events.names.size();
+	events.names.emplace_back(wxString::FromUTF8(event_name.data(), event_name.size()));
+	events.ids.emplace(std::string{ event_name }, id);
+	return id;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the name of [event]
+// -----------------------------------------------------------------------------
+const wxString& Announcer::eventName(EventId event)
+{
+	auto&                       events = registry();
+	std::lock_guard<std::mutex> lock(events.mutex);
+	return events.names[event];
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if a batch is active on the current thread
+// -----------------------------------------------------------------------------
+bool Announcer::batching()
+{
+	return batch_depth > 0;
+}
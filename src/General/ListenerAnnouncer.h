@@ -12,30 +12,79 @@ public:
 	void         stopListening(Announcer* a);
 	void         clearAnnouncers() { announcers_.clear(); }
 	virtual void onAnnouncement(Announcer* announcer, const wxString& event_name, MemChunk& event_data);
+	virtual void onBatchAnnouncement(
+		Announcer*      announcer,
+		const wxString& event_name,
+		MemChunk&       event_data,
+		unsigned        count);
 
 	bool isDeaf() const { return deaf_; }
 	void setDeaf(bool d) { deaf_ = d; }
+	bool takesBatches() const { return takes_batches_; }
+	void setTakesBatches(bool b) { takes_batches_ = b; }
 
 private:
 	vector<Announcer*> announcers_;
-	bool               deaf_ = false;
+	bool               deaf_          = false;
+	bool               takes_batches_ = false; // See Announcer::Batch
 };
 
 class Announcer
 {
 public:
+	// Events are identified by integer ids, given to each event name the first
+	// time it is used
+	typedef unsigned EventId;
+
+	// Batches announcements made (on the current thread) while it exists, for
+	// bulk operations such as importing or removing many entries. Events with no
+	// data are only announced once per announcer at the end of the (outermost)
+	// batch, no matter how many times they were announced during it.
+	//
+	// Events with data are still announced immediately to most listeners, since
+	// their data usually refers to things (eg. entries) that might not exist by
+	// the end of the batch. Listeners that take batches (see
+	// Listener::setTakesBatches) instead get each event once at the end of the
+	// batch, via onBatchAnnouncement, with the data of every time it was
+	// announced (in order) joined together
+	class Batch
+	{
+	public:
+		Batch();
+		~Batch();
+	};
+
 	Announcer() = default;
 	virtual ~Announcer();
 
 	void addListener(Listener* l);
 	void removeListener(Listener* l);
-	void announce(const wxString& event_name, MemChunk& event_data);
-	void announce(const wxString& event_name);
+	void announce(EventId event, MemChunk& event_data);
+	void announce(EventId event);
+	void announce(std::string_view event_name, MemChunk& event_data);
+	void announce(std::string_view event_name);
 
 	bool isMuted() const { return muted_; }
 	void setMuted(bool m) { muted_ = m; }
 
+	static EventId         eventId(std::string_view event_name);
+	static const wxString& eventName(EventId event);
+	static bool            batching();
+
 private:
 	vector<Listener*> listeners_;
-	bool              muted_ = false;
+	bool              muted_          = false;
+	unsigned          dispatch_depth_ = 0;
+	bool              removed_        = false;   // A listener was removed while dispatching
+	bool*             destroyed_      = nullptr; // Set if destroyed while dispatching (see dispatch)
+
+	// Which listeners to dispatch an event to
+	enum class To
+	{
+		All,       // All listeners
+		Immediate, // Listeners that don't take batches
+		Batch      // Listeners that take batches (via onBatchAnnouncement)
+	};
+
+	void dispatch(EventId event, MemChunk& event_data, To to = To::All, unsigned count = 0);
 };
@@ -32,7 +32,13 @@
 #include "Main.h"
 #include "App.h"
 #include "thirdparty/fmt/fmt/time.h"
+#include <atomic>
+#include <condition_variable>
 #include <fstream>
+#include <mutex>
+#include <thread>
+
+using namespace Log;
 
 
 // -----------------------------------------------------------------------------
@@ -40,12 +46,145 @@
 // Variables
 //
 // -----------------------------------------------------------------------------
-namespace Log
+CVAR(Int, log_verbosity, 1, CVar::Flag::Save)
+namespace
+{
+const unsigned QUEUE_SIZE   = 4096;  // Max pending messages, must be a power of 2
+const unsigned HISTORY_SIZE = 10000; // Max messages kept in the history
+
+
+// -----------------------------------------------------------------------------
+// A bounded multi-producer queue of log messages waiting to be written, based
+// on Dmitry Vyukov's bounded MPMC queue. Any thread can push messages without
+// locking, only one thread at a time may pop them
+// -----------------------------------------------------------------------------
+class MessageQueue
 {
-vector<Message> log;
+public:
+	MessageQueue()
+	{
+		for (unsigned a = 0; a < QUEUE_SIZE; ++a)
+			slots_[a].sequence.store(a, std::memory_order_relaxed);
+	}
+
+	unsigned size() const { return tail_.load(std::memory_order_relaxed) - head_.load(std::memory_order_relaxed); }
+
+	// Adds [message] to the queue, returns false if the queue is full
+	bool push(Message& message)
+	{
+		auto pos = tail_.load(std::memory_order_relaxed);
+		while (true)
+		{
+			auto& slot = slots_[pos & (QUEUE_SIZE - 1)];
+			auto  diff = (int64_t)slot.sequence.load(std::memory_order_acquire) - (int64_t)pos;
+			if (diff == 0)
+			{
+				// Slot is free, try to claim it
+				if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					slot.message = std::move(message);
+					slot.sequence.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0)
+				return false;
+			else
+				pos = tail_.load(std::memory_order_relaxed);
+		}
+	}
+
+	// Takes the next message into [message], returns false if there are none
+	// (or the next one hasn't finished being added yet)
+	bool pop(Message& message)
+	{
+		auto  head = head_.load(std::memory_order_relaxed);
+		auto& slot = slots_[head & (QUEUE_SIZE - 1)];
+		if (slot.sequence.load(std::memory_order_acquire) != head + 1)
+			return false;
+
+		message = std::move(slot.message);
+		slot.sequence.store(head + QUEUE_SIZE, std::memory_order_release);
+		head_.store(head + 1, std::memory_order_relaxed);
+		return true;
+	}
+
+private:
+	struct Slot
+	{
+		std::atomic<uint64_t> sequence;
+		Message               message;
+	};
+
+	Slot                  slots_[QUEUE_SIZE];
+	std::atomic<uint64_t> tail_{ 0 };
+	std::atomic<uint64_t> head_{ 0 };
+};
+
+
+// -----------------------------------------------------------------------------
+// Stream buffer for sf::err, which logs each line written to it as an error
+// message (so SFML never writes to the log file directly, which is only
+// written by the thread flushing the log)
+// -----------------------------------------------------------------------------
+class SFMLErrorBuffer : public std::streambuf
+{
+protected:
+	int overflow(int c) override
+	{
+		if (c == traits_type::eof())
+			return traits_type::not_eof(c);
+
+		if (c == '\n')
+			sync();
+		else
+			line_ += (char)c;
+		return c;
+	}
+
+	int sync() override
+	{
+		if (!line_.empty())
+			Log::error("SFML: " + line_);
+		line_.clear();
+		return 0;
+	}
+
+private:
+	std::string line_;
+};
+
+
+MessageQueue    pending;
+std::mutex      pending_mutex;   // Held while taking messages from the queue and using log_file
+vector<Message> message_history; // Circular, message n is at n % HISTORY_SIZE
+uint64_t        n_messages = 0;
+std::mutex      history_mutex;
 std::ofstream   log_file;
-} // namespace Log
-CVAR(Int, log_verbosity, 1, CVar::Flag::Save)
+SFMLErrorBuffer sfml_error_buffer;
+
+
+// -----------------------------------------------------------------------------
+// Background thread that writes pending messages to the history and log file
+// periodically, or when the queue is filling up
+// -----------------------------------------------------------------------------
+class WriterThread
+{
+public:
+	~WriterThread() { stop(); }
+
+	void start();
+	void stop();
+	void wake() { cv_.notify_one(); }
+
+private:
+	std::thread             thread_;
+	std::mutex              mutex_;
+	std::condition_variable cv_;
+	bool                    stop_ = false;
+};
+WriterThread writer; // Must be declared last, so it is destroyed (and stopped) first
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -100,6 +239,16 @@ void FreeImageErrorHandler(FREE_IMAGE_FORMAT fif, const char* message)
 // -----------------------------------------------------------------------------
 
 
+// -----------------------------------------------------------------------------
+// Log::Message struct constructor
+// -----------------------------------------------------------------------------
+Message::Message(std::string message, MessageType type, std::time_t time) :
+	message{ std::move(message) },
+	type{ type },
+	time{ time }
+{
+}
+
 // -----------------------------------------------------------------------------
 // Returns the log entry as a formatted string:
 // HH:MM:SS: <message>
@@ -110,6 +259,53 @@ std::string Log::Message::formattedMessageLine() const
 }
 
 
+// -----------------------------------------------------------------------------
+//
+// WriterThread Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Starts the writer thread
+// -----------------------------------------------------------------------------
+void WriterThread::start()
+{
+	if (thread_.joinable())
+		return;
+
+	stop_   = false;
+	thread_ = std::thread([this]() {
+		std::unique_lock<std::mutex> lock(mutex_);
+		while (!stop_)
+		{
+			cv_.wait_for(lock, std::chrono::milliseconds(50));
+			lock.unlock();
+			flush();
+			lock.lock();
+		}
+	});
+}
+
+// -----------------------------------------------------------------------------
+// Stops the writer thread, after writing any pending messages
+// -----------------------------------------------------------------------------
+void WriterThread::stop()
+{
+	if (!thread_.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	cv_.notify_one();
+	thread_.join();
+
+	flush();
+}
+
+
 // -----------------------------------------------------------------------------
 //
 // Log Namespace Functions
@@ -122,9 +318,18 @@ std::string Log::Message::formattedMessageLine() const
 // -----------------------------------------------------------------------------
 void Log::init()
 {
-	// Redirect sf::err output to the log file
-	log_file.open(App::path("slade3.log", App::Dir::User));
-	sf::err().rdbuf(log_file.rdbuf());
+	// Open the log file (messages logged before this can already be flushing
+	// from other threads)
+	{
+		std::lock_guard<std::mutex> lock(pending_mutex);
+		log_file.open(App::path("slade3.log", App::Dir::User));
+	}
+
+	// Log sf::err output
+	sf::err().rdbuf(&sfml_error_buffer);
+
+	// Start writing messages in the background
+	writer.start();
 
 	// Write logfile header
 	auto t  = std::time(nullptr);
@@ -153,11 +358,83 @@ void Log::init()
 }
 
 // -----------------------------------------------------------------------------
-// Returns the log message history
+// Writes all pending log messages to the history and log file now. This is
+// normally done in the background, but can be called from any thread
+// -----------------------------------------------------------------------------
+void Log::flush()
+{
+	std::lock_guard<std::mutex> lock(pending_mutex);
+
+	vector<Message> batch;
+	std::string     lines;
+	Message         msg;
+	while (true)
+	{
+		// Take pending messages (at most a queue's worth at a time, in case
+		// other threads keep adding more)
+		batch.clear();
+		lines.clear();
+		while (batch.size() < QUEUE_SIZE && pending.pop(msg))
+		{
+			msg.timestamp = *std::localtime(&msg.time);
+			if (log_file.is_open() && msg.type != MessageType::Console)
+			{
+				lines += msg.formattedMessageLine();
+				lines += '\n';
+			}
+			batch.push_back(std::move(msg));
+		}
+		if (batch.empty())
+			return;
+
+		// Add to history
+		{
+			std::lock_guard<std::mutex> h_lock(history_mutex);
+			if (message_history.empty())
+				message_history.resize(HISTORY_SIZE);
+			for (auto& message : batch)
+				message_history[n_messages++ % HISTORY_SIZE] = std::move(message);
+		}
+
+		// Write to log file
+		if (!lines.empty())
+			log_file.write(lines.data(), lines.size()).flush();
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the last [count] log messages
+// -----------------------------------------------------------------------------
+vector<Message> Log::history(unsigned count)
+{
+	flush();
+
+	std::lock_guard<std::mutex> lock(history_mutex);
+
+	auto            first = n_messages - std::min<uint64_t>({ count, n_messages, HISTORY_SIZE });
+	vector<Message> list;
+	for (auto a = first; a < n_messages; ++a)
+		list.push_back(message_history[a % HISTORY_SIZE]);
+	return list;
+}
+
+// -----------------------------------------------------------------------------
+// Returns any log messages added to the history since [cursor] (the number of
+// messages previously seen, start with 0), and updates [cursor] to the number
+// of messages now. Messages that are still pending are not included
 // -----------------------------------------------------------------------------
-const vector<Log::Message>& Log::history()
+vector<Message> Log::newMessages(uint64_t& cursor)
 {
-	return log;
+	std::lock_guard<std::mutex> lock(history_mutex);
+
+	// Skip any messages that have already dropped out of the history
+	if (n_messages > HISTORY_SIZE)
+		cursor = std::max<uint64_t>(cursor, n_messages - HISTORY_SIZE);
+
+	vector<Message> list;
+	for (; cursor < n_messages; ++cursor)
+		list.push_back(message_history[cursor % HISTORY_SIZE]);
+	return list;
 }
 
 // -----------------------------------------------------------------------------
@@ -178,22 +455,29 @@ void Log::setVerbosity(int verbosity)
 }
 
 // -----------------------------------------------------------------------------
-// Logs a message [text] of [type]
+// Logs a message [text] of [type].
+// The message is added to a queue without locking, and written to the history
+// and log file in the background
 // -----------------------------------------------------------------------------
 void Log::message(MessageType type, std::string_view text)
 {
-	// Add log message
-	auto t = std::time(nullptr);
-	log.emplace_back(text, type, *std::localtime(&t));
+	Message msg({ text.data(), text.size() }, type, std::time(nullptr));
 
-	// Write to log file
-	if (log_file.is_open() && type != MessageType::Console)
-		sf::err() << log.back().formattedMessageLine() << "\n";
+	// If the queue is full, write the pending messages here to make room
+	while (!pending.push(msg))
+		flush();
+
+	if (pending.size() > QUEUE_SIZE / 2)
+		writer.wake();
 }
 
 void Log::message(MessageType type, int level, std::string_view text, fmt::format_args args)
 {
-	message(type, level, fmt::vformat(text, args));
+	// Check the level before formatting anything
+	if (level > log_verbosity)
+		return;
+
+	message(type, fmt::vformat(text, args));
 }
 
 void Log::message(MessageType type, std::string_view text, fmt::format_args args)
@@ -204,12 +488,25 @@ void Log::message(MessageType type, std::string_view text, fmt::format_args args
 // -----------------------------------------------------------------------------
 // Returns a list of log messages of [type] that have been recorded since [time]
 // -----------------------------------------------------------------------------
-vector<Log::Message*> Log::since(time_t time, MessageType type)
+vector<Message> Log::since(time_t time, MessageType type)
 {
-	vector<Message*> list;
-	for (auto& msg : log)
-		if (mktime(&msg.timestamp) >= time && (type == MessageType::Any || msg.type == type))
-			list.push_back(&msg);
+	flush();
+
+	std::lock_guard<std::mutex> lock(history_mutex);
+
+	// Messages are in time order, so go back from the latest until one is
+	// older than [time]
+	auto            first = n_messages > HISTORY_SIZE ? n_messages - HISTORY_SIZE : 0;
+	vector<Message> list;
+	for (auto a = n_messages; a > first; --a)
+	{
+		auto& msg = message_history[(a - 1) % HISTORY_SIZE];
+		if (msg.time < time)
+			break;
+		if (type == MessageType::Any || msg.type == type)
+			list.push_back(msg);
+	}
+	std::reverse(list.begin(), list.end());
 	return list;
 }
 
@@ -251,11 +548,5 @@ void Log::message(MessageType type, int level, std::string_view text)
 	if (level > log_verbosity)
 		return;
 
-	// Add log message
-	auto t = std::time(nullptr);
-	log.emplace_back(text, type, *std::localtime(&t));
-
-	// Write to log file
-	if (log_file.is_open() && type != MessageType::Console)
-		sf::err() << log.back().formattedMessageLine() << "\n";
+	message(type, text);
 }
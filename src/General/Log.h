@@ -16,28 +16,27 @@ enum class MessageType
 struct Message
 {
 	std::string message;
-	MessageType type;
-	std::tm     timestamp;
+	MessageType type = MessageType::Info;
+	std::tm     timestamp{};
+	std::time_t time = 0;
 
-	Message(std::string_view message, MessageType type, std::tm timestamp) :
-		message{ message.data(), message.size() },
-		type{ type },
-		timestamp{ timestamp }
-	{
-	}
+	Message() = default;
+	Message(std::string message, MessageType type, std::time_t time);
 
 	std::string formattedMessageLine() const;
 };
 
-const vector<Message>& history();
-int                    verbosity();
-void                   setVerbosity(int verbosity);
-void                   init();
-void                   message(MessageType type, int level, std::string_view text);
-void                   message(MessageType type, std::string_view text);
-void                   message(MessageType type, int level, std::string_view text, fmt::format_args args);
-void                   message(MessageType type, std::string_view text, fmt::format_args args);
-vector<Message*>       since(time_t time, MessageType type = MessageType::Any);
+vector<Message> history(unsigned count);
+vector<Message> newMessages(uint64_t& cursor);
+int             verbosity();
+void            setVerbosity(int verbosity);
+void            init();
+void            flush();
+void            message(MessageType type, int level, std::string_view text);
+void            message(MessageType type, std::string_view text);
+void            message(MessageType type, int level, std::string_view text, fmt::format_args args);
+void            message(MessageType type, std::string_view text, fmt::format_args args);
+vector<Message> since(time_t time, MessageType type = MessageType::Any);
 
 
 // Message shortcuts by type
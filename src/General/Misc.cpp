@@ -602,7 +602,7 @@ void Misc::readWindowInfo(Tokenizer& tz)
 	tz.advIf("{");
 	while (!tz.check("}") && !tz.atEnd())
 	{
-		wxString id     = tz.current().text;
+		wxString id     = tz.current().text();
 		int      width  = tz.next().asInt();
 		int      height = tz.next().asInt();
 		int      left   = tz.next().asInt();
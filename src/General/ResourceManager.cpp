@@ -111,7 +111,8 @@ void EntryResource::remove(ArchiveEntry::SPtr& entry)
 }
 
 // ----------------------------------------------------------------------------
-// Removes any entries in the resource that are in [archive]
+// Removes any entries in the resource that are in [archive] (or are no longer
+// in any archive)
 // ----------------------------------------------------------------------------
 void EntryResource::removeArchive(Archive* archive)
 {
@@ -120,7 +121,7 @@ void EntryResource::removeArchive(Archive* archive)
 	{
 		if (entries_[a].expired())
 			entries_.erase(entries_.begin() + a);
-		else if (entries_[a].lock()->parent() == archive)
+		else if (auto parent = entries_[a].lock()->parent(); !parent || parent == archive)
 			entries_.erase(entries_.begin() + a);
 		else
 			++a;
@@ -140,6 +141,8 @@ ArchiveEntry* EntryResource::getEntry(Archive* priority, const wxString& nspace,
 	if (entries_.empty())
 		return nullptr;
 
+	auto ns = nspace.ToStdString();
+
 	ArchiveEntry::SPtr best;
 	auto               i = entries_.end();
 	while (i != entries_.begin())
@@ -158,8 +161,8 @@ ArchiveEntry* EntryResource::getEntry(Archive* priority, const wxString& nspace,
 			best = entry;
 
 		// Check namespace if required
-		if (ns_required && !nspace.IsEmpty())
-			if (!entry->isInNamespace(nspace.ToStdString()))
+		if (ns_required && !ns.empty())
+			if (!entry->isInNamespace(ns))
 				continue;
 
 		// Check if in priority archive (or its parent)
@@ -170,8 +173,7 @@ ArchiveEntry* EntryResource::getEntry(Archive* priority, const wxString& nspace,
 		}
 
 		// Check namespace
-		if (!ns_required && !nspace.IsEmpty() && !best->isInNamespace(nspace.ToStdString())
-			&& entry->isInNamespace(nspace.ToStdString()))
+		if (!ns_required && !ns.empty() && !best->isInNamespace(ns) && entry->isInNamespace(ns))
 		{
 			best = entry;
 			continue;
@@ -238,6 +240,9 @@ void ResourceManager::addArchive(Archive* archive)
 	if (!archive)
 		return;
 
+	// The archive's resources take priority over those in earlier archives
+	clearLookups();
+
 	// Go through entries
 	vector<ArchiveEntry::SPtr> entries;
 	archive->putEntryTreeAsList(entries);
@@ -260,6 +265,9 @@ void ResourceManager::removeArchive(Archive* archive)
 	if (!archive)
 		return;
 
+	// Lookups could have resolved to the archive's resources
+	clearLookups();
+
 	// Remove from palettes
 	removeArchiveFromMap(palettes_, archive);
 
@@ -328,6 +336,8 @@ void ResourceManager::addEntry(ArchiveEntry::SPtr& entry, bool log)
 	if (log)
 		Log::debug("Adding entry {} to resource manager", path);
 
+	clearLookups(entry.get(), name, path);
+
 	// Check for palette entry
 	if (type->id() == "palette")
 		palettes_[name].add(entry);
@@ -453,6 +463,8 @@ void ResourceManager::removeEntry(ArchiveEntry::SPtr& entry, bool log, bool full
 	if (log)
 		Log::debug("Removing entry {} from resource manager", path);
 
+	clearLookups(entry.get(), name, path);
+
 	// Remove from palettes
 	removeEntryFromMap(palettes_, name, entry, full_check);
 
@@ -618,7 +630,13 @@ void ResourceManager::putAllFlatNames(vector<wxString>& list)
 // -----------------------------------------------------------------------------
 ArchiveEntry* ResourceManager::getPaletteEntry(const wxString& palette, Archive* priority)
 {
-	return palettes_[palette.Upper()].getEntry(priority);
+	auto& cached = cachedLookups(entry_lookups_, palette);
+	if (auto result = cached.find('P', wxEmptyString, priority))
+		return result->entry;
+
+	auto entry = palettes_[palette.Upper()].getEntry(priority);
+	cached.results.push_back({ 'P', wxEmptyString, priority, nullptr, entry, nullptr });
+	return entry;
 }
 
 // -----------------------------------------------------------------------------
@@ -626,6 +644,21 @@ ArchiveEntry* ResourceManager::getPaletteEntry(const wxString& palette, Archive*
 // or nullptr if no match found
 // -----------------------------------------------------------------------------
 ArchiveEntry* ResourceManager::getPatchEntry(const wxString& patch, const wxString& nspace, Archive* priority)
+{
+	auto& cached = cachedLookups(entry_lookups_, patch);
+	if (auto result = cached.find('p', nspace, priority))
+		return result->entry;
+
+	auto entry = resolvePatchEntry(patch, nspace, priority);
+	cached.results.push_back({ 'p', nspace, priority, nullptr, entry, nullptr });
+	return entry;
+}
+
+// -----------------------------------------------------------------------------
+// Finds the most appropriate managed resource entry for [patch] (see
+// getPatchEntry)
+// -----------------------------------------------------------------------------
+ArchiveEntry* ResourceManager::resolvePatchEntry(const wxString& patch, const wxString& nspace, Archive* priority)
 {
 	// Are we wanting to use a flat as a patch?
 	if (!nspace.CmpNoCase("flats"))
@@ -651,6 +684,21 @@ ArchiveEntry* ResourceManager::getPatchEntry(const wxString& patch, const wxStri
 // if no match found
 // -----------------------------------------------------------------------------
 ArchiveEntry* ResourceManager::getFlatEntry(const wxString& flat, Archive* priority)
+{
+	auto& cached = cachedLookups(entry_lookups_, flat);
+	if (auto result = cached.find('f', wxEmptyString, priority))
+		return result->entry;
+
+	auto entry = resolveFlatEntry(flat, priority);
+	cached.results.push_back({ 'f', wxEmptyString, priority, nullptr, entry, nullptr });
+	return entry;
+}
+
+// -----------------------------------------------------------------------------
+// Finds the most appropriate managed resource entry for [flat] (see
+// getFlatEntry)
+// -----------------------------------------------------------------------------
+ArchiveEntry* ResourceManager::resolveFlatEntry(const wxString& flat, Archive* priority)
 {
 	// Check resource with matching name exists
 	auto& res = flats_[flat.Upper()];
@@ -672,6 +720,21 @@ ArchiveEntry* ResourceManager::getFlatEntry(const wxString& flat, Archive* prior
 // nullptr if no match found
 // -----------------------------------------------------------------------------
 ArchiveEntry* ResourceManager::getTextureEntry(const wxString& texture, const wxString& nspace, Archive* priority)
+{
+	auto& cached = cachedLookups(entry_lookups_, texture);
+	if (auto result = cached.find('t', nspace, priority))
+		return result->entry;
+
+	auto entry = resolveTextureEntry(texture, nspace, priority);
+	cached.results.push_back({ 't', nspace, priority, nullptr, entry, nullptr });
+	return entry;
+}
+
+// -----------------------------------------------------------------------------
+// Finds the most appropriate managed resource entry for [texture] (see
+// getTextureEntry)
+// -----------------------------------------------------------------------------
+ArchiveEntry* ResourceManager::resolveTextureEntry(const wxString& texture, const wxString& nspace, Archive* priority)
 {
 	auto entry = satextures_[texture.Upper()].getEntry(priority, nspace, true);
 	if (entry)
@@ -689,6 +752,20 @@ ArchiveEntry* ResourceManager::getTextureEntry(const wxString& texture, const wx
 // match found
 // -----------------------------------------------------------------------------
 CTexture* ResourceManager::getTexture(const wxString& texture, Archive* priority, Archive* ignore)
+{
+	auto& cached = cachedLookups(texture_lookups_, texture);
+	if (auto result = cached.find('T', wxEmptyString, priority, ignore))
+		return result->texture;
+
+	auto tex = resolveTexture(texture, priority, ignore);
+	cached.results.push_back({ 'T', wxEmptyString, priority, ignore, nullptr, tex });
+	return tex;
+}
+
+// -----------------------------------------------------------------------------
+// Finds the most appropriate managed texture for [texture] (see getTexture)
+// -----------------------------------------------------------------------------
+CTexture* ResourceManager::resolveTexture(const wxString& texture, Archive* priority, Archive* ignore)
 {
 	// Check texture resource with matching name exists
 	auto& res = textures_[texture.Upper()];
@@ -723,6 +800,94 @@ CTexture* ResourceManager::getTexture(const wxString& texture, Archive* priority
 		return nullptr;
 }
 
+// -----------------------------------------------------------------------------
+// Returns the cached result of a lookup of [type] in [nspace] with [priority]
+// and [ignore] archives, or nullptr if it hasn't been cached
+// -----------------------------------------------------------------------------
+ResourceManager::CachedLookups::Result* ResourceManager::CachedLookups::find(
+	char            type,
+	const wxString& nspace,
+	const Archive*  priority,
+	const Archive*  ignore)
+{
+	for (auto& result : results)
+		if (result.type == type && result.priority == priority && result.ignore == ignore && result.nspace == nspace)
+			return &result;
+
+	return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the cached lookup results for resource [name] in [lookups], adding
+// an empty set of results if there are none yet
+// -----------------------------------------------------------------------------
+ResourceManager::CachedLookups& ResourceManager::cachedLookups(LookupMap& lookups, const wxString& name)
+{
+	// Build the uppercase name in a reused buffer, so that finding already
+	// cached results doesn't allocate
+	lookup_name_.clear();
+	for (auto c : name)
+	{
+		auto ch = static_cast<unsigned>(static_cast<wxChar>(c));
+		if (ch > 127)
+		{
+			lookup_name_ = name.Upper().ToStdString();
+			break;
+		}
+		lookup_name_ += static_cast<char>(toupper(ch));
+	}
+
+	auto i = lookups.find(lookup_name_);
+	if (i != lookups.end())
+		return *i->second;
+
+	// The map key views the name owned by the results, which never move
+	auto  cached = std::make_unique<CachedLookups>();
+	auto& ref    = *cached;
+	ref.name     = lookup_name_;
+	lookups.emplace(ref.name, std::move(cached));
+	return ref;
+}
+
+// -----------------------------------------------------------------------------
+// Clears all cached lookup results, for when the resources (or their priority)
+// change
+// -----------------------------------------------------------------------------
+void ResourceManager::clearLookups()
+{
+	if (!entry_lookups_.empty())
+		entry_lookups_.clear();
+	if (!texture_lookups_.empty())
+		texture_lookups_.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Clears the cached lookup results that a change to [entry] can affect, where
+// [name] and [path] are the (uppercase) resource name and path of the entry
+// -----------------------------------------------------------------------------
+void ResourceManager::clearLookups(ArchiveEntry* entry, const wxString& name, const wxString& path)
+{
+	// Composite textures can have any name, so all texture lookups need to be
+	// resolved again if a TEXTUREx or TEXTURES entry changes
+	auto type = entry->type()->id();
+	if (type == "texturex" || type == "zdtextures")
+		texture_lookups_.clear();
+
+	if (entry_lookups_.empty())
+		return;
+
+	// Markers (empty entries) can move other entries in or out of a namespace
+	if (entry->size() == 0)
+	{
+		entry_lookups_.clear();
+		return;
+	}
+
+	// Otherwise only lookups by the entry's name or path can resolve to it
+	entry_lookups_.erase(name.ToStdString());
+	entry_lookups_.erase(path.ToStdString());
+}
+
 // -----------------------------------------------------------------------------
 // Called when an announcement is recieved from any managed archive
 // -----------------------------------------------------------------------------
@@ -730,6 +895,12 @@ void ResourceManager::onAnnouncement(Announcer* announcer, const wxString& event
 {
 	event_data.seek(0, SEEK_SET);
 
+	// Moving entries (eg. in or out of a namespace) or renaming a directory
+	// can change any lookup results. Other changes to entries are handled by
+	// addEntry and removeEntry
+	if (event_name == "entries_swapped" || event_name == "directory_modified")
+		clearLookups();
+
 	// An entry is modified
 	if (event_name == "entry_state_changed")
 	{
@@ -765,6 +936,37 @@ void ResourceManager::onAnnouncement(Announcer* announcer, const wxString& event
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Called at the end of a batch for each event with data that a managed archive
+// announced during it (see Announcer::Batch)
+// -----------------------------------------------------------------------------
+void ResourceManager::onBatchAnnouncement(
+	Announcer*      announcer,
+	const wxString& event_name,
+	MemChunk&       event_data,
+	unsigned        count)
+{
+	auto archive = dynamic_cast<Archive*>(announcer);
+	if (archive
+		&& (event_name == "entry_added" || event_name == "entry_removing" || event_name == "entry_renaming"
+			|| event_name == "entry_state_changed"))
+	{
+		// Entries could have been added, changed and removed in any order
+		// during the batch, so the announced entries might not exist any more.
+		// Just re-add all of the archive's entries instead
+		removeArchive(archive);
+		vector<ArchiveEntry::SPtr> entries;
+		archive->putEntryTreeAsList(entries);
+		for (auto& entry : entries)
+			addEntry(entry);
+
+		announce("resources_updated");
+		return;
+	}
+
+	Listener::onBatchAnnouncement(announcer, event_name, event_data, count);
+}
+
 
 // -----------------------------------------------------------------------------
 //
@@ -806,4 +1008,34 @@ CONSOLE_COMMAND(test_res_speed, 0, false)
 
 	float avg = float(times[0] + times[1] + times[2] + times[3] + times[4]) / 5.0f;
 	Log::console(wxString::Format("Test took %dms avg", (int)avg));
+
+	// Test lookups by name, as done for each texture by the map editor
+	vector<wxString> patches, flats, textures;
+	App::resources().putAllPatchEntries(list, nullptr);
+	for (auto entry : list)
+		patches.push_back(entry->upperNameNoExt());
+	App::resources().putAllFlatNames(flats);
+	App::resources().putAllTextureNames(textures);
+	auto priority = App::archiveManager().numArchives() > 0 ? App::archiveManager().getArchive(0) : nullptr;
+
+	for (long& time : times)
+	{
+		auto start = App::runTimer();
+		for (unsigned a = 0; a < 100; a++)
+		{
+			for (auto& name : patches)
+				App::resources().getPatchEntry(name, "patches", priority);
+			for (auto& name : flats)
+				App::resources().getFlatEntry(name, priority);
+			for (auto& name : textures)
+				App::resources().getTexture(name, priority);
+		}
+		time = App::runTimer() - start;
+	}
+
+	avg = float(times[0] + times[1] + times[2] + times[3] + times[4]) / 5.0f;
+	Log::console(wxString::Format(
+		"Lookup test (%lu names x100) took %dms avg",
+		(unsigned long)(patches.size() + flats.size() + textures.size()),
+		(int)avg));
 }
@@ -3,6 +3,7 @@
 #include "Archive/Archive.h"
 #include "General/ListenerAnnouncer.h"
 #include "Graphics/CTexture/CTexture.h"
+#include <unordered_map>
 
 class ResourceManager;
 
@@ -72,7 +73,7 @@ typedef std::map<wxString, TextureResource> TextureResourceMap;
 class ResourceManager : public Listener, public Announcer
 {
 public:
-	ResourceManager()  = default;
+	ResourceManager() { setTakesBatches(true); }
 	~ResourceManager() = default;
 
 	void addArchive(Archive* archive);
@@ -101,6 +102,11 @@ public:
 	uint16_t  getTextureHash(const wxString& name) const;
 
 	void onAnnouncement(Announcer* announcer, const wxString& event_name, MemChunk& event_data) override;
+	void onBatchAnnouncement(
+		Announcer*      announcer,
+		const wxString& event_name,
+		MemChunk&       event_data,
+		unsigned        count) override;
 
 	static wxString doom64TextureName(uint16_t hash) { return doom64_hash_table_[hash]; }
 
@@ -118,5 +124,38 @@ private:
 	// EntryResourceMap	satextures_fp_only_; // Probably not needed
 	TextureResourceMap textures_; // Composite textures (defined in a TEXTUREx/TEXTURES lump)
 
+	// Lookup results for a resource name, so that each lookup only needs to be
+	// resolved once until the resources with that name change
+	struct CachedLookups
+	{
+		struct Result
+		{
+			char           type;
+			wxString       nspace;
+			const Archive* priority;
+			const Archive* ignore;
+			ArchiveEntry*  entry;
+			CTexture*      texture;
+		};
+
+		std::string    name; // Owns the key in the lookup map
+		vector<Result> results;
+
+		Result* find(char type, const wxString& nspace, const Archive* priority, const Archive* ignore = nullptr);
+	};
+	typedef std::unordered_map<std::string_view, std::unique_ptr<CachedLookups>> LookupMap;
+
+	LookupMap   entry_lookups_;   // By uppercase resource name or path
+	LookupMap   texture_lookups_; // By uppercase composite texture name
+	std::string lookup_name_;     // Reused buffer for the uppercase name of a lookup
+
 	static wxString doom64_hash_table_[65536];
+
+	CachedLookups& cachedLookups(LookupMap& lookups, const wxString& name);
+	void           clearLookups();
+	void           clearLookups(ArchiveEntry* entry, const wxString& name, const wxString& path);
+	ArchiveEntry* resolvePatchEntry(const wxString& patch, const wxString& nspace, Archive* priority);
+	ArchiveEntry* resolveFlatEntry(const wxString& flat, Archive* priority);
+	ArchiveEntry* resolveTextureEntry(const wxString& texture, const wxString& nspace, Archive* priority);
+	CTexture*     resolveTexture(const wxString& texture, Archive* priority, Archive* ignore);
 };
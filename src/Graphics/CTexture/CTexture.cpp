@@ -35,8 +35,10 @@
 #include "Archive/ArchiveManager.h"
 #include "General/Misc.h"
 #include "General/ResourceManager.h"
+#include "Graphics/ImageDecodeQueue.h"
 #include "Graphics/SImage/SImage.h"
 #include "TextureXList.h"
+#include "Utility/Profiler.h"
 #include "Utility/Tokenizer.h"
 #include "Utility/StringUtils.h"
 
@@ -150,7 +152,7 @@ bool CTPatchEx::parse(Tokenizer& tz, Type type)
 {
 	// Read basic info
 	type_ = type;
-	name_ = StrUtil::upper(tz.next().text);
+	name_ = StrUtil::upper(tz.next().text());
 	tz.adv(); // Skip ,
 	offset_.x = tz.next().asInt();
 	tz.adv(); // Skip ,
@@ -183,14 +185,14 @@ bool CTPatchEx::parse(Tokenizer& tz, Type type)
 			{
 				// Build translation string
 				wxString translate;
-				wxString temp = tz.next().text;
+				wxString temp = tz.next().text();
 				if (temp.Contains("="))
 					temp = wxString::Format("\"%s\"", temp);
 				translate += temp;
 				while (tz.checkNext(","))
 				{
-					translate += tz.next().text; // add ','
-					temp = tz.next().text;
+					translate += tz.next().text(); // add ','
+					temp = tz.next().text();
 					if (temp.Contains("="))
 						temp = wxString::Format("\"%s\"", temp);
 					translate += temp;
@@ -208,7 +210,7 @@ bool CTPatchEx::parse(Tokenizer& tz, Type type)
 				blendtype_ = 2;
 
 				// Read first value
-				wxString first = tz.next().text;
+				wxString first = tz.next().text();
 
 				// If no second value, it's just a colour string
 				if (!tz.checkNext(","))
@@ -241,7 +243,7 @@ bool CTPatchEx::parse(Tokenizer& tz, Type type)
 						if (!tz.checkNext(","))
 						{
 							Log::error(wxString::Format(
-								"Invalid TEXTURES definition, expected ',', got '%s'", tz.peek().text));
+								"Invalid TEXTURES definition, expected ',', got '%s'", tz.peek().text()));
 							return false;
 						}
 						tz.adv(); // Skip ,
@@ -257,7 +259,7 @@ bool CTPatchEx::parse(Tokenizer& tz, Type type)
 
 			// Style
 			if (tz.checkNC("Style"))
-				style_ = tz.next().text;
+				style_ = tz.next().text();
 
 			// Read next property name
 			tz.adv();
@@ -598,7 +600,7 @@ bool CTexture::parse(Tokenizer& tz, const wxString& type)
 	type_     = type;
 	extended_ = true;
 	defined_  = false;
-	name_     = StrUtil::upper(tz.next().text);
+	name_     = StrUtil::upper(tz.next().text());
 	tz.adv(); // Skip ,
 	size_.x = tz.next().asInt();
 	tz.adv(); // Skip ,
@@ -677,7 +679,7 @@ bool CTexture::parseDefine(Tokenizer& tz)
 	type_       = "Define";
 	extended_   = true;
 	defined_    = true;
-	name_       = StrUtil::upper(tz.next().text);
+	name_       = StrUtil::upper(tz.next().text());
 	def_size_.x = tz.next().asInt();
 	def_size_.y = tz.next().asInt();
 	size_       = def_size_;
@@ -812,6 +814,8 @@ bool CTexture::convertRegular()
 // -----------------------------------------------------------------------------
 bool CTexture::toImage(SImage& image, Archive* parent, Palette* pal, bool force_rgba)
 {
+	PROFILE_ZONE("CTexture::toImage");
+
 	// Init image
 	image.clear();
 	image.resize(size_.x, size_.y);
@@ -914,9 +918,17 @@ bool CTexture::toImage(SImage& image, Archive* parent, Palette* pal, bool force_
 		// Normal texture
 
 		// Add each patch to image
-		for (auto& patch : patches_)
+		for (unsigned a = 0; a < patches_.size(); a++)
 		{
-			if (Misc::loadImageFromEntry(&p_img, patch->patchEntry(parent)))
+			auto patch = patches_[a].get();
+
+			bool loaded;
+			if (resolved_.empty())
+				loaded = Misc::loadImageFromEntry(&p_img, patch->patchEntry(parent));
+			else
+				loaded = resolved_[a].image && resolved_[a].image->load(p_img);
+
+			if (loaded)
 				image.drawImage(p_img, patch->xOffset(), patch->yOffset(), dp, pal, pal);
 		}
 	}
@@ -934,51 +946,103 @@ bool CTexture::loadPatchImage(unsigned pindex, SImage& image, Archive* parent, P
 	if (pindex >= patches_.size())
 		return false;
 
+	// Use the resolved patch if this is a resolved copy
+	if (!resolved_.empty())
+	{
+		auto& resolved = resolved_[pindex];
+		if (resolved.texture)
+			return resolved.texture->toImage(image, parent, pal);
+
+		return resolved.image && resolved.image->load(image);
+	}
+
+	// Texture-as-patch
+	auto tex = textureAsPatch(pindex, parent);
+	if (tex)
+		return tex->toImage(image, parent, pal);
+
+	// Load patch entry to image if valid
+	return Misc::loadImageFromEntry(&image, patchImageEntry(pindex, parent));
+}
+
+// -----------------------------------------------------------------------------
+// Returns a copy of this texture with all its patches resolved (using patches
+// from [parent] primarily) and copied from their archives, so that it can be
+// composed with toImage without accessing any archives or resources, eg. on a
+// worker thread. Must be called from the main thread
+// -----------------------------------------------------------------------------
+std::unique_ptr<CTexture> CTexture::resolvedCopy(Archive* parent)
+{
+	auto copy = std::make_unique<CTexture>();
+	copy->copyTexture(*this);
+
+	for (unsigned a = 0; a < patches_.size(); a++)
+	{
+		ResolvedPatch resolved;
+
+		// Normal textures only use patch entries (see toImage)
+		if (!extended_)
+			resolved.image = std::make_shared<DetachedImage>(patches_[a]->patchEntry(parent));
+
+		// Otherwise same as loadPatchImage
+		else if (auto tex = textureAsPatch(a, parent))
+			resolved.texture = tex->resolvedCopy(parent);
+		else
+			resolved.image = std::make_shared<DetachedImage>(patchImageEntry(a, parent));
+
+		copy->resolved_.push_back(resolved);
+	}
+
+	return copy;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the texture to use for the patch at [pindex], if it is a
+// texture-as-patch (extended textures only), or nullptr otherwise
+// -----------------------------------------------------------------------------
+CTexture* CTexture::textureAsPatch(unsigned pindex, Archive* parent) const
+{
 	auto patch = patches_[pindex].get();
 
 	// If the texture is extended, search for textures-as-patches first
 	// (as long as the patch name is different from this texture's name)
-	if (extended_ && !(S_CMPNOCASE(patch->name(), name_)))
+	if (!extended_ || S_CMPNOCASE(patch->name(), name_))
+		return nullptr;
+
+	// Search the texture list we're in first
+	if (in_list_)
 	{
-		// Search the texture list we're in first
-		if (in_list_)
+		for (unsigned a = 0; a < in_list_->size(); a++)
 		{
-			for (unsigned a = 0; a < in_list_->size(); a++)
-			{
-				auto tex = in_list_->texture(a);
+			auto tex = in_list_->texture(a);
 
-				// Don't look past this texture in the list
-				if (tex->name() == name_)
-					break;
+			// Don't look past this texture in the list
+			if (tex->name() == name_)
+				break;
 
-				// Check for name match
-				if (S_CMPNOCASE(tex->name(), patch->name()))
-				{
-					// Load texture to image
-					return tex->toImage(image, parent, pal);
-				}
-			}
+			// Check for name match
+			if (S_CMPNOCASE(tex->name(), patch->name()))
+				return tex;
 		}
-
-		// Otherwise, try the resource manager
-		// TODO: Something has to be ignored here. The entire archive or just the current list?
-		auto tex = App::resources().getTexture(patch->name(), parent);
-		if (tex)
-			return tex->toImage(image, parent, pal);
 	}
 
+	// Otherwise, try the resource manager
+	// TODO: Something has to be ignored here. The entire archive or just the current list?
+	return App::resources().getTexture(patch->name(), parent);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the entry to load the image for the patch at [pindex] from, or
+// nullptr if none was found
+// -----------------------------------------------------------------------------
+ArchiveEntry* CTexture::patchImageEntry(unsigned pindex, Archive* parent) const
+{
 	// Get patch entry
+	auto patch = patches_[pindex].get();
 	auto entry = patch->patchEntry(parent);
-
-	// Load entry to image if valid
 	if (entry)
-		return Misc::loadImageFromEntry(&image, entry);
+		return entry;
 
 	// Maybe it's a texture?
-	entry = App::resources().getTextureEntry(patch->name(), "", parent);
-
-	if (entry)
-		return Misc::loadImageFromEntry(&image, entry);
-
-	return false;
+	return App::resources().getTextureEntry(patch->name(), "", parent);
 }
@@ -90,6 +90,7 @@ private:
 class TextureXList;
 class SImage;
 class Palette;
+class DetachedImage;
 
 class CTexture : public Announcer
 {
@@ -169,6 +170,8 @@ public:
 	bool loadPatchImage(unsigned pindex, SImage& image, Archive* parent = nullptr, Palette* pal = nullptr);
 	bool toImage(SImage& image, Archive* parent = nullptr, Palette* pal = nullptr, bool force_rgba = false);
 
+	std::unique_ptr<CTexture> resolvedCopy(Archive* parent = nullptr);
+
 	typedef std::unique_ptr<CTexture> UPtr;
 	typedef std::shared_ptr<CTexture> SPtr;
 
@@ -194,4 +197,16 @@ private:
 	// Editor info
 	uint8_t       state_   = 0;
 	TextureXList* in_list_ = nullptr;
+
+	// Patch images resolved by resolvedCopy (one per patch), used instead of
+	// looking up the patches when composing the texture
+	struct ResolvedPatch
+	{
+		std::shared_ptr<DetachedImage> image;
+		std::shared_ptr<CTexture>      texture; // Texture-as-patch
+	};
+	vector<ResolvedPatch> resolved_;
+
+	CTexture*     textureAsPatch(unsigned pindex, Archive* parent) const;
+	ArchiveEntry* patchImageEntry(unsigned pindex, Archive* parent) const;
 };
@@ -0,0 +1,407 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2019 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    ImageDecodeQueue.cpp
+// Description: ImageDecodeQueue class - decodes images on worker threads in
+//              priority order, with support for reprioritising and cancelling
+//              queued images. Used by the browsers to load item images in the
+//              background, with visible items first.
+//              Also DetachedImage, an image entry copied from its archive so
+//              that it can be decoded safely on a worker thread
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "ImageDecodeQueue.h"
+#include "Archive/ArchiveEntry.h"
+#include "Archive/EntryType/EntryType.h"
+#include "General/Misc.h"
+#include "Graphics/SImage/SImage.h"
+#include "Utility/StringUtils.h"
+
+
+// -----------------------------------------------------------------------------
+//
+// DetachedImage Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// DetachedImage class constructor
+// -----------------------------------------------------------------------------
+DetachedImage::DetachedImage(ArchiveEntry* entry)
+{
+	if (!entry)
+		return;
+
+	// Detect entry type if it isn't already, so the copy has it
+	if (entry->type() == EntryType::unknownType())
+		EntryType::detectEntryType(entry);
+
+	// Jaguar formats need other entries from the archive, so load them now
+	if (StrUtil::startsWith(entry->type()->formatId(), "img_jaguar"))
+	{
+		image_ = std::make_unique<SImage>();
+		if (!Misc::loadImageFromEntry(image_.get(), entry))
+			image_.reset();
+		return;
+	}
+
+	entry_ = std::make_unique<ArchiveEntry>(*entry);
+}
+
+// -----------------------------------------------------------------------------
+// DetachedImage class destructor
+// -----------------------------------------------------------------------------
+DetachedImage::~DetachedImage() = default;
+
+// -----------------------------------------------------------------------------
+// Loads the image into [image]. Can be called from any thread, but not
+// concurrently on the same DetachedImage
+// -----------------------------------------------------------------------------
+bool DetachedImage::load(SImage& image)
+{
+	if (image_)
+		return image.copyImage(image_.get());
+
+	return Misc::loadImageFromEntry(&image, entry_.get());
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// ImageDecodeQueue Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// ImageDecodeQueue class constructor. If [n_threads] is 0, one worker thread
+// is started per hardware thread, less one for the main thread
+// -----------------------------------------------------------------------------
+ImageDecodeQueue::ImageDecodeQueue(unsigned n_threads)
+{
+	if (n_threads == 0)
+	{
+		// hardware_concurrency can return 0 if it isn't known
+		auto hw   = std::thread::hardware_concurrency();
+		n_threads = hw > 1 ? hw - 1 : 1;
+	}
+
+	for (unsigned t = 0; t < n_threads; ++t)
+		threads_.emplace_back(&ImageDecodeQueue::worker, this);
+}
+
+// -----------------------------------------------------------------------------
+// ImageDecodeQueue class destructor. Any queued jobs are discarded, and jobs
+// currently being decoded are waited on
+// -----------------------------------------------------------------------------
+ImageDecodeQueue::~ImageDecodeQueue()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+		queue_.clear();
+	}
+
+	cv_job_.notify_all();
+	for (auto& thread : threads_)
+		thread.join();
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the job [id] is queued or being decoded
+// -----------------------------------------------------------------------------
+bool ImageDecodeQueue::isPending(unsigned id) const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return jobs_.find(id) != jobs_.end();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the number of jobs queued or being decoded
+// -----------------------------------------------------------------------------
+unsigned ImageDecodeQueue::nPending() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return jobs_.size();
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if there are any results waiting to be taken
+// -----------------------------------------------------------------------------
+bool ImageDecodeQueue::hasResults() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return !results_.empty();
+}
+
+// -----------------------------------------------------------------------------
+// Queues job [id] to decode an image with [decode] at [priority]. If the job
+// is already pending it is replaced (a job that is already being decoded will
+// have its result discarded)
+// -----------------------------------------------------------------------------
+void ImageDecodeQueue::request(unsigned id, int priority, const DecodeFunc& decode)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		auto& job = jobs_[id];
+		if (!job.running)
+			queue_.erase({ job.priority, id });
+
+		job.priority   = priority;
+		job.generation = ++next_generation_;
+		job.running    = false;
+		job.decode     = decode;
+		queue_.insert({ priority, id });
+	}
+
+	cv_job_.notify_one();
+}
+
+// -----------------------------------------------------------------------------
+// Changes the priority of job [id], if it is queued
+// -----------------------------------------------------------------------------
+void ImageDecodeQueue::setPriority(unsigned id, int priority)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	auto i = jobs_.find(id);
+	if (i == jobs_.end() || i->second.running || i->second.priority == priority)
+		return;
+
+	queue_.erase({ i->second.priority, id });
+	queue_.insert({ priority, id });
+	i->second.priority = priority;
+}
+
+// -----------------------------------------------------------------------------
+// Cancels job [id]. If it is currently being decoded, its result is discarded
+// -----------------------------------------------------------------------------
+void ImageDecodeQueue::cancel(unsigned id)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	auto i = jobs_.find(id);
+	if (i == jobs_.end())
+		return;
+
+	if (!i->second.running)
+		queue_.erase({ i->second.priority, id });
+	jobs_.erase(i);
+	cv_idle_.notify_all();
+}
+
+// -----------------------------------------------------------------------------
+// Cancels all pending jobs other than those in [ids], and returns the ids of
+// the cancelled jobs
+// -----------------------------------------------------------------------------
+vector<unsigned> ImageDecodeQueue::cancelExcept(const vector<unsigned>& ids)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	vector<unsigned> cancelled;
+	for (auto i = jobs_.begin(); i != jobs_.end();)
+	{
+		if (std::find(ids.begin(), ids.end(), i->first) != ids.end())
+		{
+			++i;
+			continue;
+		}
+
+		if (!i->second.running)
+			queue_.erase({ i->second.priority, i->first });
+		cancelled.push_back(i->first);
+		i = jobs_.erase(i);
+	}
+
+	if (!cancelled.empty())
+		cv_idle_.notify_all();
+
+	return cancelled;
+}
+
+// -----------------------------------------------------------------------------
+// Cancels all pending jobs and discards any results not yet taken
+// -----------------------------------------------------------------------------
+void ImageDecodeQueue::cancelAll()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	jobs_.clear();
+	queue_.clear();
+	results_.clear();
+	cv_idle_.notify_all();
+}
+
+// -----------------------------------------------------------------------------
+// Returns all results of jobs completed since the last call
+// -----------------------------------------------------------------------------
+vector<ImageDecodeQueue::Result> ImageDecodeQueue::takeResults()
+{
+	vector<Result> results;
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	results.swap(results_);
+
+	return results;
+}
+
+// -----------------------------------------------------------------------------
+// Waits until there are no jobs pending
+// -----------------------------------------------------------------------------
+void ImageDecodeQueue::waitIdle()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	cv_idle_.wait(lock, [this]() { return jobs_.empty(); });
+}
+
+// -----------------------------------------------------------------------------
+// Worker thread function - decodes the highest priority queued job until the
+// queue is stopped
+// -----------------------------------------------------------------------------
+void ImageDecodeQueue::worker()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	while (true)
+	{
+		cv_job_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+		if (stop_)
+			return;
+
+		// Take the next job
+		auto  id  = queue_.begin()->second;
+		auto& job = jobs_[id];
+		queue_.erase(queue_.begin());
+		job.running     = true;
+		auto generation = job.generation;
+		auto decode     = std::move(job.decode);
+
+		// Decode image
+		lock.unlock();
+		auto image = std::make_unique<SImage>();
+		auto ok    = decode(*image);
+		lock.lock();
+
+		// Keep the result unless the job was cancelled or requested again
+		// while decoding
+		auto i = jobs_.find(id);
+		if (i == jobs_.end() || i->second.generation != generation)
+			continue;
+
+		jobs_.erase(i);
+		results_.push_back({ id, ok, std::move(image) });
+		cv_idle_.notify_all();
+	}
+}
+
+
+// Testing
+
+#include "General/Console/Console.h"
+#include <atomic>
+
+CONSOLE_COMMAND(test_image_decode_queue, 0, false)
+{
+	// Checks job ordering, reprioritising and cancelling (of queued and running
+	// jobs) with a single worker thread, which is held on a blocking job while
+	// the others are queued. Doesn't decode any actual images
+	ImageDecodeQueue queue(1);
+	std::mutex       mutex;
+	vector<unsigned> order;
+	std::atomic<int> blocking_state(0); // 1 = running, 2 = released
+
+	auto job = [&](unsigned id) {
+		return [&, id](SImage&) {
+			std::lock_guard<std::mutex> lock(mutex);
+			order.push_back(id);
+			return true;
+		};
+	};
+	auto blocking_job = [&](SImage&) {
+		blocking_state = 1;
+		while (blocking_state != 2)
+			std::this_thread::yield();
+		return true;
+	};
+
+	unsigned failed = 0;
+	auto     check  = [&](bool ok, const char* test) {
+		if (!ok)
+		{
+			Log::error(wxString::Format("ImageDecodeQueue test failed: %s", test));
+			failed++;
+		}
+	};
+
+	// Hold the worker on job 0
+	queue.request(0, 0, blocking_job);
+	while (blocking_state != 1)
+		std::this_thread::yield();
+
+	// Queue jobs 1-5 in priority order, then move 5 to the front, cancel 3 and
+	// cancel the running job 0 (its result should be discarded)
+	for (unsigned id = 1; id <= 5; ++id)
+		queue.request(id, id * 10, job(id));
+	queue.setPriority(5, 0);
+	queue.cancel(3);
+	queue.cancel(0);
+	check(!queue.isPending(0) && !queue.isPending(3), "cancelled jobs are not pending");
+	check(queue.nPending() == 4, "pending count after cancel");
+
+	// Release the worker and wait for the rest
+	blocking_state = 2;
+	queue.waitIdle();
+	check(queue.nPending() == 0, "nothing pending after waitIdle");
+	check(order == vector<unsigned>({ 5, 1, 2, 4 }), "jobs decoded in priority order, skipping cancelled");
+
+	auto             results = queue.takeResults();
+	vector<unsigned> result_ids;
+	for (auto& result : results)
+		result_ids.push_back(result.id);
+	check(result_ids == vector<unsigned>({ 5, 1, 2, 4 }), "results only for completed jobs");
+	check(!queue.hasResults(), "no results left after takeResults");
+
+	// cancelExcept, with the worker held again
+	blocking_state = 0;
+	order.clear();
+	queue.request(100, 0, blocking_job);
+	while (blocking_state != 1)
+		std::this_thread::yield();
+	for (unsigned id = 10; id < 15; ++id)
+		queue.request(id, 0, job(id));
+	auto cancelled = queue.cancelExcept({ 100, 12 });
+	std::sort(cancelled.begin(), cancelled.end());
+	check(cancelled == vector<unsigned>({ 10, 11, 13, 14 }), "cancelExcept cancels the other jobs");
+	blocking_state = 2;
+	queue.waitIdle();
+	check(order == vector<unsigned>({ 12 }), "only the kept job is decoded after cancelExcept");
+	check(queue.takeResults().size() == 2, "results for the kept jobs");
+
+	Log::info(wxString::Format("ImageDecodeQueue tests done, %d failed", failed));
+}
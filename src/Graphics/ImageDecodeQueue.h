@@ -0,0 +1,83 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_map>
+
+class ArchiveEntry;
+class SImage;
+
+// An image entry copied out of its archive, so that it can be loaded on a
+// worker thread without touching the archive or the original entry. Must be
+// created on the main thread. Images in formats that need other entries in the
+// archive to load (Jaguar sprites/textures) are loaded immediately instead
+class DetachedImage
+{
+public:
+	DetachedImage(ArchiveEntry* entry);
+	~DetachedImage();
+
+	bool load(SImage& image);
+
+private:
+	std::unique_ptr<ArchiveEntry> entry_;
+	std::unique_ptr<SImage>       image_;
+};
+
+// Decodes images on a pool of worker threads, in priority order (lowest
+// priority value first). Jobs are identified by an id chosen by the caller, and
+// can be reprioritised or cancelled while they are queued. Results are
+// collected with takeResults, normally on the main thread, where any GL
+// texture upload can happen. Decode functions must not access any archives or
+// resources, so anything they need should be resolved (eg. as DetachedImages)
+// when the function is created
+class ImageDecodeQueue
+{
+public:
+	typedef std::function<bool(SImage&)> DecodeFunc;
+
+	struct Result
+	{
+		unsigned                id = 0;
+		bool                    ok = false;
+		std::unique_ptr<SImage> image;
+	};
+
+	ImageDecodeQueue(unsigned n_threads = 0);
+	~ImageDecodeQueue();
+
+	bool     isPending(unsigned id) const;
+	unsigned nPending() const;
+	bool     hasResults() const;
+
+	void             request(unsigned id, int priority, const DecodeFunc& decode);
+	void             setPriority(unsigned id, int priority);
+	void             cancel(unsigned id);
+	vector<unsigned> cancelExcept(const vector<unsigned>& ids);
+	void             cancelAll();
+	vector<Result>   takeResults();
+	void             waitIdle();
+
+private:
+	struct Job
+	{
+		int        priority   = 0;
+		unsigned   generation = 0;
+		bool       running    = false;
+		DecodeFunc decode;
+	};
+
+	std::unordered_map<unsigned, Job>  jobs_;
+	std::set<std::pair<int, unsigned>> queue_; // (priority, id) of jobs not yet running
+	vector<Result>                     results_;
+	vector<std::thread>                threads_;
+	mutable std::mutex                 mutex_;
+	std::condition_variable            cv_job_;
+	std::condition_variable            cv_idle_;
+	unsigned                           next_generation_ = 0;
+	bool                               stop_            = false;
+
+	void worker();
+};
@@ -0,0 +1,309 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2019 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    MapRasterizer.cpp
+// Description: MapRasterizer class - a software renderer for simple map
+//              overview images (anti-aliased lines and points), used to save
+//              map images without needing an OpenGL context
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "MapRasterizer.h"
+#include "Graphics/SImage/SImage.h"
+#include "Utility/Parallel.h"
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Blends [colour] into the RGBA pixel at [pixel] with [coverage] (0-1), the
+// same way as glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA)
+// -----------------------------------------------------------------------------
+inline void blendPixel(uint8_t* pixel, const ColRGBA& colour, float coverage)
+{
+	float alpha = coverage * colour.a * (1.f / 255.f);
+	float inv   = 1.f - alpha;
+	pixel[0]    = (uint8_t)(colour.r * alpha + pixel[0] * inv + 0.5f);
+	pixel[1]    = (uint8_t)(colour.g * alpha + pixel[1] * inv + 0.5f);
+	pixel[2]    = (uint8_t)(colour.b * alpha + pixel[2] * inv + 0.5f);
+	pixel[3]    = (uint8_t)(colour.a * alpha + pixel[3] * inv + 0.5f);
+}
+
+// -----------------------------------------------------------------------------
+// Narrows the span [x_min,x_max] to the x values where a*x + b is within
+// [low,high]
+// -----------------------------------------------------------------------------
+inline void clipSpan(double a, double b, double low, double high, double& x_min, double& x_max)
+{
+	if (a == 0)
+	{
+		// Constant over the row
+		if (b < low || b > high)
+			x_max = x_min - 1;
+		return;
+	}
+
+	double x1 = (low - b) / a;
+	double x2 = (high - b) / a;
+	if (x1 > x2)
+		std::swap(x1, x2);
+	x_min = std::max(x_min, x1);
+	x_max = std::min(x_max, x2);
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// MapRasterizer Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Clears all lines and points
+// -----------------------------------------------------------------------------
+void MapRasterizer::clear()
+{
+	lines_.clear();
+	points_.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Adds a line from [start] to [end] (in map coordinates). Lines are drawn in
+// the order they are added, after which points are drawn
+// -----------------------------------------------------------------------------
+void MapRasterizer::addLine(Vec2d start, Vec2d end, ColRGBA colour)
+{
+	lines_.push_back({ start, end, colour });
+}
+
+// -----------------------------------------------------------------------------
+// Adds a point at [pos] (in map coordinates)
+// -----------------------------------------------------------------------------
+void MapRasterizer::addPoint(Vec2d pos, ColRGBA colour)
+{
+	points_.push_back({ pos, colour });
+}
+
+// -----------------------------------------------------------------------------
+// Sets the view to fit the map area [min]-[max] into a [width]x[height] image,
+// with the map taking up [scale] of the image
+// -----------------------------------------------------------------------------
+void MapRasterizer::fitView(Vec2d min, Vec2d max, int width, int height, double scale)
+{
+	double map_width  = max.x - min.x;
+	double map_height = max.y - min.y;
+
+	// Offset to center of map
+	offset_ = { min.x + (map_width * 0.5), min.y + (map_height * 0.5) };
+
+	// Zoom to fit whole map
+	double x_scale = ((double)width) / map_width;
+	double y_scale = ((double)height) / map_height;
+	zoom_          = std::min<double>(x_scale, y_scale) * scale;
+}
+
+// -----------------------------------------------------------------------------
+// Sets the view to be centered on map position [offset] at [zoom]
+// -----------------------------------------------------------------------------
+void MapRasterizer::setView(Vec2d offset, double zoom)
+{
+	offset_ = offset;
+	zoom_   = zoom;
+}
+
+// -----------------------------------------------------------------------------
+// Renders all lines and points to a [width]x[height] RGBA [image].
+// Returns false if the image size is invalid
+// -----------------------------------------------------------------------------
+bool MapRasterizer::render(SImage& image, int width, int height) const
+{
+	if (width <= 0 || height <= 0)
+		return false;
+
+	// Transform lines and points to image space (y is flipped, map y goes up)
+	auto to_image = [&](const Vec2d& pos) {
+		return Vec2d{ (pos.x - offset_.x) * zoom_ + (width >> 1), height - ((pos.y - offset_.y) * zoom_ + (height >> 1)) };
+	};
+	vector<Line> lines(lines_.size());
+	for (unsigned a = 0; a < lines_.size(); ++a)
+		lines[a] = { to_image(lines_[a].start), to_image(lines_[a].end), lines_[a].colour };
+	vector<Point> points(points_.size());
+	for (unsigned a = 0; a < points_.size(); ++a)
+		points[a] = { to_image(points_[a].pos), points_[a].colour };
+
+	// Setup tiles
+	int          tile_size = std::max(16, tile_size_);
+	int          tiles_x   = (width + tile_size - 1) / tile_size;
+	int          tiles_y   = (height + tile_size - 1) / tile_size;
+	vector<Tile> tiles(tiles_x * tiles_y);
+	for (int ty = 0; ty < tiles_y; ++ty)
+		for (int tx = 0; tx < tiles_x; ++tx)
+		{
+			auto& tile = tiles[ty * tiles_x + tx];
+			tile.x1    = tx * tile_size;
+			tile.y1    = ty * tile_size;
+			tile.x2    = std::min(width, tile.x1 + tile_size);
+			tile.y2    = std::min(height, tile.y1 + tile_size);
+		}
+
+	// Bin lines and points into the tiles their bounds overlap (keeping draw order)
+	auto bin = [&](double x1, double y1, double x2, double y2, double radius, unsigned index, bool line) {
+		int tx1 = std::max(0, (int)std::floor((std::min(x1, x2) - radius) / tile_size));
+		int ty1 = std::max(0, (int)std::floor((std::min(y1, y2) - radius) / tile_size));
+		int tx2 = std::min(tiles_x - 1, (int)std::floor((std::max(x1, x2) + radius) / tile_size));
+		int ty2 = std::min(tiles_y - 1, (int)std::floor((std::max(y1, y2) + radius) / tile_size));
+		for (int ty = ty1; ty <= ty2; ++ty)
+			for (int tx = tx1; tx <= tx2; ++tx)
+			{
+				if (line)
+					tiles[ty * tiles_x + tx].lines.push_back(index);
+				else
+					tiles[ty * tiles_x + tx].points.push_back(index);
+			}
+	};
+	double line_radius  = line_width_ * 0.5 + 1;
+	double point_radius = point_size_ * 0.5 + 1;
+	for (unsigned a = 0; a < lines.size(); ++a)
+	{
+		auto& l = lines[a];
+		bin(l.start.x, l.start.y, l.end.x, l.end.y, line_radius, a, true);
+	}
+	for (unsigned a = 0; a < points.size(); ++a)
+		bin(points[a].pos.x, points[a].pos.y, points[a].pos.x, points[a].pos.y, point_radius, a, false);
+
+	// Render tiles (in parallel if there are enough of them)
+	vector<uint8_t> data((size_t)width * height * 4);
+	parallelFor(tiles.size(), 1, threads_, [&](unsigned start, unsigned end) {
+		for (auto index = start; index < end; ++index)
+			renderTile(tiles[index], lines, points, data.data(), width);
+	});
+
+	return image.setImageData(data, width, height, SImage::Type::RGBA);
+}
+
+// -----------------------------------------------------------------------------
+// Renders the lines and points overlapping [tile] into the image [data]
+// -----------------------------------------------------------------------------
+void MapRasterizer::renderTile(
+	const Tile&          tile,
+	const vector<Line>&  lines,
+	const vector<Point>& points,
+	uint8_t*             data,
+	int                  width) const
+{
+	// Clear to background
+	for (int y = tile.y1; y < tile.y2; ++y)
+	{
+		auto pixel = data + ((size_t)y * width + tile.x1) * 4;
+		for (int x = tile.x1; x < tile.x2; ++x, pixel += 4)
+		{
+			pixel[0] = col_background_.r;
+			pixel[1] = col_background_.g;
+			pixel[2] = col_background_.b;
+			pixel[3] = col_background_.a;
+		}
+	}
+
+	// Lines - coverage falls off over one pixel at the edges of the line
+	double radius = line_width_ * 0.5 + 0.5;
+	for (auto index : tile.lines)
+	{
+		auto&  line   = lines[index];
+		double dx     = line.end.x - line.start.x;
+		double dy     = line.end.y - line.start.y;
+		double length = std::sqrt(dx * dx + dy * dy);
+		if (length == 0)
+			continue;
+
+		// Unit direction and normal
+		double ux = dx / length;
+		double uy = dy / length;
+
+		// Rows covered by the line within the tile
+		int y1 = std::max(tile.y1, (int)std::floor(std::min(line.start.y, line.end.y) - radius));
+		int y2 = std::min(tile.y2 - 1, (int)std::ceil(std::max(line.start.y, line.end.y) + radius));
+		for (int y = y1; y <= y2; ++y)
+		{
+			// Find the span of pixels within [radius] of the line on this row:
+			// distance along the line (u) in [-radius, length + radius] and
+			// distance across the line (n) in [-radius, radius]
+			double py    = y + 0.5 - line.start.y;
+			double x_min = tile.x1;
+			double x_max = tile.x2 - 1;
+			clipSpan(ux, uy * py - ux * (line.start.x - 0.5), -radius, length + radius, x_min, x_max);
+			clipSpan(-uy, ux * py + uy * (line.start.x - 0.5), -radius, radius, x_min, x_max);
+			if (x_max < x_min)
+				continue;
+
+			int  xs    = std::max(tile.x1, (int)std::floor(x_min));
+			int  xe    = std::min(tile.x2 - 1, (int)std::ceil(x_max));
+			auto pixel = data + ((size_t)y * width + xs) * 4;
+			for (int x = xs; x <= xe; ++x, pixel += 4)
+			{
+				// Distance from pixel center to the line segment
+				double px = x + 0.5 - line.start.x;
+				double u  = std::min(length, std::max(0., px * ux + py * uy));
+				double ex = px - ux * u;
+				double ey = py - uy * u;
+				double d  = std::sqrt(ex * ex + ey * ey);
+
+				if (d < radius)
+					blendPixel(pixel, line.colour, (float)std::min(1., radius - d));
+			}
+		}
+	}
+
+	// Points - anti-aliased discs
+	double point_radius = point_size_ * 0.5 + 0.5;
+	for (auto index : tile.points)
+	{
+		auto& point = points[index];
+		int   x1    = std::max(tile.x1, (int)std::floor(point.pos.x - point_radius));
+		int   x2    = std::min(tile.x2 - 1, (int)std::ceil(point.pos.x + point_radius));
+		int   y1    = std::max(tile.y1, (int)std::floor(point.pos.y - point_radius));
+		int   y2    = std::min(tile.y2 - 1, (int)std::ceil(point.pos.y + point_radius));
+		for (int y = y1; y <= y2; ++y)
+		{
+			auto pixel = data + ((size_t)y * width + x1) * 4;
+			for (int x = x1; x <= x2; ++x, pixel += 4)
+			{
+				double px = x + 0.5 - point.pos.x;
+				double py = y + 0.5 - point.pos.y;
+				double d  = std::sqrt(px * px + py * py);
+				if (d < point_radius)
+					blendPixel(pixel, point.colour, (float)std::min(1., point_radius - d));
+			}
+		}
+	}
+}
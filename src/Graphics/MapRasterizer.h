@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Utility/Colour.h"
+
+class SImage;
+
+// Renders map lines and points (things) into an RGBA image entirely on the
+// CPU, with anti-aliasing similar to GL_LINE_SMOOTH/GL_POINT_SMOOTH. The image
+// is split into tiles which are rendered in parallel, so there is no limit on
+// the output size other than memory
+class MapRasterizer
+{
+public:
+	MapRasterizer()  = default;
+	~MapRasterizer() = default;
+
+	void setBackground(ColRGBA colour) { col_background_ = colour; }
+	void setLineWidth(float width) { line_width_ = width; }
+	void setPointSize(float size) { point_size_ = size; }
+	void setTileSize(int size) { tile_size_ = size; }
+	void setThreads(unsigned threads) { threads_ = threads; }
+
+	void clear();
+	void addLine(Vec2d start, Vec2d end, ColRGBA colour);
+	void addPoint(Vec2d pos, ColRGBA colour);
+
+	void fitView(Vec2d min, Vec2d max, int width, int height, double scale = 0.95);
+	void setView(Vec2d offset, double zoom);
+
+	bool render(SImage& image, int width, int height) const;
+
+private:
+	struct Line
+	{
+		Vec2d   start;
+		Vec2d   end;
+		ColRGBA colour;
+	};
+	struct Point
+	{
+		Vec2d   pos;
+		ColRGBA colour;
+	};
+	struct Tile
+	{
+		int              x1, y1, x2, y2;
+		vector<unsigned> lines;
+		vector<unsigned> points;
+	};
+
+	vector<Line>  lines_;
+	vector<Point> points_;
+	ColRGBA       col_background_ = ColRGBA(0, 0, 0, 255);
+	float         line_width_     = 1.f;
+	float         point_size_     = 8.f;
+	int           tile_size_      = 256;
+	unsigned      threads_        = 0;
+	Vec2d         offset_;
+	double        zoom_ = 1.;
+
+	void renderTile(
+		const Tile&          tile,
+		const vector<Line>&  lines,
+		const vector<Point>& points,
+		uint8_t*             data,
+		int                  width) const;
+};
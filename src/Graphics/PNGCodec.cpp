@@ -0,0 +1,695 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2019 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    PNGCodec.cpp
+// Description: Native PNG reading/writing functions, used to decode/encode PNG
+//              images (see SIFPng) and by the PNG optimizer. None of these use
+//              any global state, so they can be called from any thread
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "PNGCodec.h"
+#include "thirdparty/zlib/zlib.h"
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+const uint8_t png_signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+
+// Adam7 interlacing pass parameters
+const int adam7_start_x[7] = { 0, 4, 0, 2, 0, 1, 0 };
+const int adam7_start_y[7] = { 0, 0, 4, 0, 2, 0, 1 };
+const int adam7_step_x[7]  = { 8, 8, 4, 4, 2, 2, 1 };
+const int adam7_step_y[7]  = { 8, 8, 8, 4, 4, 2, 2 };
+
+// Maximum compression ratio of deflate, used to reject image data that is too
+// small to inflate to the size given in the header
+const size_t max_deflate_ratio = 1032;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the [index]th (raw) sample of [bit_depth] bits in [row]
+// -----------------------------------------------------------------------------
+inline unsigned sample(const uint8_t* row, size_t index, unsigned bit_depth)
+{
+	switch (bit_depth)
+	{
+	case 8: return row[index];
+	case 16: return (row[index * 2] << 8) | row[index * 2 + 1];
+	default:
+	{
+		size_t bit = index * bit_depth;
+		return (row[bit / 8] >> (8 - bit_depth - bit % 8)) & ((1 << bit_depth) - 1);
+	}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns raw sample [value] of [bit_depth] bits scaled to 8 bits
+// -----------------------------------------------------------------------------
+inline uint8_t scaleSample(unsigned value, unsigned bit_depth)
+{
+	if (bit_depth == 16)
+		return value >> 8;
+	if (bit_depth < 8)
+		return value * 255 / ((1 << bit_depth) - 1);
+	return value;
+}
+
+// -----------------------------------------------------------------------------
+// The paeth predictor used by filter type 4
+// -----------------------------------------------------------------------------
+inline uint8_t paeth(int a, int b, int c)
+{
+	int p  = a + b - c;
+	int pa = abs(p - a);
+	int pb = abs(p - b);
+	int pc = abs(p - c);
+	if (pa <= pb && pa <= pc)
+		return a;
+	return pb <= pc ? b : c;
+}
+
+// -----------------------------------------------------------------------------
+// Reverses filtering on [rows] scanlines of [row_bytes] in [data], which is
+// laid out as PNG filtered data (a filter type byte before each row). The
+// unfiltered rows are written to [out]
+// -----------------------------------------------------------------------------
+bool unfilter(const uint8_t* data, size_t rows, size_t row_bytes, unsigned bpp, uint8_t* out)
+{
+	const uint8_t* prev = nullptr;
+	for (size_t y = 0; y < rows; ++y)
+	{
+		uint8_t        type = *data++;
+		const uint8_t* in   = data;
+		uint8_t*       row  = out;
+		for (size_t x = 0; x < row_bytes; ++x)
+		{
+			int a = x >= bpp ? row[x - bpp] : 0;
+			int b = prev ? prev[x] : 0;
+			int c = prev && x >= bpp ? prev[x - bpp] : 0;
+			switch (type)
+			{
+			case 0: row[x] = in[x]; break;
+			case 1: row[x] = in[x] + a; break;
+			case 2: row[x] = in[x] + b; break;
+			case 3: row[x] = in[x] + ((a + b) >> 1); break;
+			case 4: row[x] = in[x] + paeth(a, b, c); break;
+			default: return false;
+			}
+		}
+
+		prev = row;
+		data += row_bytes;
+		out += row_bytes;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Applies filter [type] to scanline [row] (with previous scanline [prev], or
+// nullptr for the first row), writing the result to [out]
+// -----------------------------------------------------------------------------
+void filterRow(int type, const uint8_t* row, const uint8_t* prev, size_t row_bytes, unsigned bpp, uint8_t* out)
+{
+	for (size_t x = 0; x < row_bytes; ++x)
+	{
+		int a = x >= bpp ? row[x - bpp] : 0;
+		int b = prev ? prev[x] : 0;
+		int c = prev && x >= bpp ? prev[x - bpp] : 0;
+		switch (type)
+		{
+		case 1: out[x] = row[x] - a; break;
+		case 2: out[x] = row[x] - b; break;
+		case 3: out[x] = row[x] - ((a + b) >> 1); break;
+		case 4: out[x] = row[x] - paeth(a, b, c); break;
+		default: out[x] = row[x]; break;
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Inflates [data] into [out], which must already be the expected size
+// -----------------------------------------------------------------------------
+bool inflateData(const vector<uint8_t>& data, vector<uint8_t>& out)
+{
+	z_stream strm;
+	memset(&strm, 0, sizeof(strm));
+	if (inflateInit(&strm) != Z_OK)
+		return false;
+
+	strm.next_in   = const_cast<Bytef*>(data.data());
+	strm.avail_in  = data.size();
+	strm.next_out  = out.data();
+	strm.avail_out = out.size();
+	int ret        = inflate(&strm, Z_FINISH);
+	inflateEnd(&strm);
+
+	return ret == Z_STREAM_END && strm.avail_out == 0;
+}
+
+// -----------------------------------------------------------------------------
+// Decodes the (inflated) [idat] data into non-interlaced, unfiltered rows in
+// [image]
+// -----------------------------------------------------------------------------
+bool decodeImage(const PNGCodec::Header& header, const vector<uint8_t>& idat, vector<uint8_t>& image)
+{
+	size_t   row_bytes = header.rowBytes(header.width);
+	unsigned bpp       = header.bytesPerPixel();
+	image.assign(row_bytes * header.height, 0);
+
+	// Not interlaced, can unfilter directly
+	if (!header.interlace)
+		return unfilter(idat.data(), header.height, row_bytes, bpp, image.data());
+
+	// Interlaced, unfilter each pass and copy its pixels into place
+	unsigned        bits = header.bitsPerPixel();
+	size_t          pos  = 0;
+	vector<uint8_t> pass;
+	for (int p = 0; p < 7; ++p)
+	{
+		if (header.width <= (uint32_t)adam7_start_x[p] || header.height <= (uint32_t)adam7_start_y[p])
+			continue;
+
+		uint32_t pass_width     = (header.width - adam7_start_x[p] + adam7_step_x[p] - 1) / adam7_step_x[p];
+		uint32_t pass_height    = (header.height - adam7_start_y[p] + adam7_step_y[p] - 1) / adam7_step_y[p];
+		size_t   pass_row_bytes = header.rowBytes(pass_width);
+		pass.resize(pass_row_bytes * pass_height);
+		if (!unfilter(idat.data() + pos, pass_height, pass_row_bytes, bpp, pass.data()))
+			return false;
+		pos += (pass_row_bytes + 1) * pass_height;
+
+		for (uint32_t py = 0; py < pass_height; ++py)
+		{
+			auto src  = pass.data() + py * pass_row_bytes;
+			auto dest = image.data() + (adam7_start_y[p] + py * adam7_step_y[p]) * row_bytes;
+			for (uint32_t px = 0; px < pass_width; ++px)
+			{
+				uint32_t x = adam7_start_x[p] + px * adam7_step_x[p];
+				if (bits >= 8)
+					memcpy(dest + x * (bits / 8), src + px * (bits / 8), bits / 8);
+				else
+				{
+					// Sub-byte pixels
+					unsigned src_bit  = px * bits;
+					unsigned dest_bit = x * bits;
+					unsigned value    = (src[src_bit / 8] >> (8 - bits - src_bit % 8)) & ((1 << bits) - 1);
+					dest[dest_bit / 8] |= value << (8 - bits - dest_bit % 8);
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the size of the filtered image data for [header]
+// -----------------------------------------------------------------------------
+size_t filteredSize(const PNGCodec::Header& header)
+{
+	if (!header.interlace)
+		return (header.rowBytes(header.width) + 1) * header.height;
+
+	size_t size = 0;
+	for (int p = 0; p < 7; ++p)
+	{
+		if (header.width <= (uint32_t)adam7_start_x[p] || header.height <= (uint32_t)adam7_start_y[p])
+			continue;
+
+		uint32_t pass_width  = (header.width - adam7_start_x[p] + adam7_step_x[p] - 1) / adam7_step_x[p];
+		uint32_t pass_height = (header.height - adam7_start_y[p] + adam7_step_y[p] - 1) / adam7_step_y[p];
+		size += (header.rowBytes(pass_width) + 1) * pass_height;
+	}
+
+	return size;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// PNGCodec::Header Struct Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns true if the header describes an image format (and size) that can be
+// decoded
+// -----------------------------------------------------------------------------
+bool PNGCodec::Header::isValid() const
+{
+	if (width == 0 || height == 0 || interlace > 1)
+		return false;
+
+	// Too large to decode (also catches sizes that would overflow)
+	if (width > MAX_DIMENSION || height > MAX_DIMENSION || (uint64_t)width * height > MAX_PIXELS)
+		return false;
+
+	switch (colour_type)
+	{
+	case 0: return bit_depth == 1 || bit_depth == 2 || bit_depth == 4 || bit_depth == 8 || bit_depth == 16;
+	case 3: return bit_depth == 1 || bit_depth == 2 || bit_depth == 4 || bit_depth == 8;
+	case 2:
+	case 4:
+	case 6: return bit_depth == 8 || bit_depth == 16;
+	default: return false;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Reads the header from the [ihdr] chunk.
+// Returns false if it isn't a valid IHDR chunk for a supported image format
+// -----------------------------------------------------------------------------
+bool PNGCodec::Header::read(const Chunk& ihdr)
+{
+	if (ihdr.type != "IHDR" || ihdr.size != 13)
+		return false;
+
+	width       = readB32(ihdr.data);
+	height      = readB32(ihdr.data + 4);
+	bit_depth   = ihdr.data[8];
+	colour_type = ihdr.data[9];
+	interlace   = ihdr.data[12];
+
+	// Compression and filter methods must be 0
+	return isValid() && ihdr.data[10] == 0 && ihdr.data[11] == 0;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the header as IHDR chunk data (13 bytes) to [ihdr]
+// -----------------------------------------------------------------------------
+void PNGCodec::Header::write(uint8_t* ihdr) const
+{
+	for (int a = 0; a < 4; ++a)
+	{
+		ihdr[a]     = width >> (24 - a * 8);
+		ihdr[a + 4] = height >> (24 - a * 8);
+	}
+	ihdr[8]  = bit_depth;
+	ihdr[9]  = colour_type;
+	ihdr[10] = 0;
+	ihdr[11] = 0;
+	ihdr[12] = interlace;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// PNGCodec Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Reads a big-endian 32bit value from [data]
+// -----------------------------------------------------------------------------
+uint32_t PNGCodec::readB32(const uint8_t* data)
+{
+	return ((uint32_t)data[0] << 24) | (data[1] << 16) | (data[2] << 8) | data[3];
+}
+
+// -----------------------------------------------------------------------------
+// Appends [value] to [out] as a big-endian 32bit value
+// -----------------------------------------------------------------------------
+void PNGCodec::writeB32(vector<uint8_t>& out, uint32_t value)
+{
+	out.push_back(value >> 24);
+	out.push_back(value >> 16);
+	out.push_back(value >> 8);
+	out.push_back(value);
+}
+
+// -----------------------------------------------------------------------------
+// Appends the PNG signature to [out]
+// -----------------------------------------------------------------------------
+void PNGCodec::writeSignature(vector<uint8_t>& out)
+{
+	out.insert(out.end(), png_signature, png_signature + 8);
+}
+
+// -----------------------------------------------------------------------------
+// Appends a chunk of [type] with [size] bytes of [data] to [out]
+// -----------------------------------------------------------------------------
+void PNGCodec::writeChunk(vector<uint8_t>& out, const char* type, const uint8_t* data, uint32_t size)
+{
+	writeB32(out, size);
+	auto start = out.size();
+	out.insert(out.end(), type, type + 4);
+	if (size > 0)
+		out.insert(out.end(), data, data + size);
+	writeB32(out, crc32(0, out.data() + start, size + 4));
+}
+
+// -----------------------------------------------------------------------------
+// Splits [png] into chunks (which point into [png]'s data, so are only valid
+// while it is). Returns false and sets [error] if it isn't a valid PNG.
+// If [headers_only] is true, stops at the first IDAT chunk
+// -----------------------------------------------------------------------------
+bool PNGCodec::readChunks(const MemChunk& png, vector<Chunk>& chunks, wxString& error, bool headers_only)
+{
+	if (png.size() < 8 || memcmp(png.data(), png_signature, 8) != 0)
+	{
+		error = "Invalid PNG signature";
+		return false;
+	}
+
+	uint32_t pos = 8;
+	while (pos + 12 <= png.size())
+	{
+		Chunk chunk;
+		chunk.size = readB32(png.data() + pos);
+		chunk.type.assign((const char*)png.data() + pos + 4, 4);
+		chunk.data = png.data() + pos + 8;
+		if (chunk.size > png.size() - pos - 12)
+		{
+			error = wxString::Format("Truncated %s chunk", chunk.type);
+			return false;
+		}
+
+		chunks.push_back(chunk);
+		pos += chunk.size + 12;
+		if (chunk.type == "IEND" || (headers_only && chunk.type == "IDAT"))
+			return true;
+	}
+
+	error = headers_only ? "Missing IDAT chunk" : "Missing IEND chunk";
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Decompresses and unfilters the image data in [chunks] to [image], as
+// non-interlaced rows of [header].rowBytes(width) bytes.
+// Returns false and sets [error] if the data is invalid
+// -----------------------------------------------------------------------------
+bool PNGCodec::decode(const Header& header, const vector<Chunk>& chunks, vector<uint8_t>& image, wxString& error)
+{
+	// Gather compressed data (can be split over multiple IDAT chunks)
+	vector<uint8_t> idat;
+	for (auto& chunk : chunks)
+		if (chunk.type == "IDAT")
+			idat.insert(idat.end(), chunk.data, chunk.data + chunk.size);
+
+	if (!header.isValid())
+	{
+		error = "Unsupported image format or size";
+		return false;
+	}
+
+	// Check there is enough compressed data for the image size before
+	// allocating for it
+	auto size = filteredSize(header);
+	if (idat.size() * max_deflate_ratio < size)
+	{
+		error = "Missing or truncated image data";
+		return false;
+	}
+
+	vector<uint8_t> filtered(size);
+	if (!inflateData(idat, filtered) || !decodeImage(header, filtered, image))
+	{
+		error = "Invalid or corrupt image data";
+		return false;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Filters (with [filter], see filterImage) and compresses the non-interlaced
+// [image] rows of [header], writing the IDAT data to [idat]
+// -----------------------------------------------------------------------------
+bool PNGCodec::encode(const Header& header, const vector<uint8_t>& image, int filter, vector<uint8_t>& idat)
+{
+	vector<uint8_t> filtered;
+	filterImage(image, header.height, header.rowBytes(header.width), header.bytesPerPixel(), filter, filtered);
+	return deflateData(filtered, Z_DEFAULT_COMPRESSION, Z_DEFAULT_STRATEGY, idat);
+}
+
+// -----------------------------------------------------------------------------
+// Converts decoded [image] rows to 8bit RGBA in [out] (which must be at least
+// width * height * 4 bytes), using the palette and transparency chunks [plte]
+// and [trns] if given
+// -----------------------------------------------------------------------------
+void PNGCodec::expandRGBA(
+	const Header&          header,
+	const vector<uint8_t>& image,
+	const Chunk*           plte,
+	const Chunk*           trns,
+	uint8_t*               out)
+{
+	auto     row_bytes = header.rowBytes(header.width);
+	auto     depth     = header.bit_depth;
+	unsigned key[3]    = { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF }; // Transparent colour (greyscale/RGB)
+	if (trns && header.colour_type == 0 && trns->size >= 2)
+		key[0] = (trns->data[0] << 8) | trns->data[1];
+	else if (trns && header.colour_type == 2 && trns->size >= 6)
+		for (unsigned c = 0; c < 3; ++c)
+			key[c] = (trns->data[c * 2] << 8) | trns->data[c * 2 + 1];
+
+	for (uint32_t y = 0; y < header.height; ++y)
+	{
+		auto row = image.data() + y * row_bytes;
+		for (uint32_t x = 0; x < header.width; ++x, out += 4)
+		{
+			switch (header.colour_type)
+			{
+			case 0: // Greyscale
+			{
+				auto value = sample(row, x, depth);
+				out[0] = out[1] = out[2] = scaleSample(value, depth);
+				out[3]                   = value == key[0] ? 0 : 255;
+				break;
+			}
+			case 2: // RGB
+			{
+				auto r = sample(row, x * 3, depth);
+				auto g = sample(row, x * 3 + 1, depth);
+				auto b = sample(row, x * 3 + 2, depth);
+				out[0] = scaleSample(r, depth);
+				out[1] = scaleSample(g, depth);
+				out[2] = scaleSample(b, depth);
+				out[3] = r == key[0] && g == key[1] && b == key[2] ? 0 : 255;
+				break;
+			}
+			case 3: // Paletted
+			{
+				auto index = sample(row, x, depth);
+				if (plte && index * 3 + 2 < plte->size)
+					memcpy(out, plte->data + index * 3, 3);
+				else
+					out[0] = out[1] = out[2] = 0;
+				out[3] = trns && index < trns->size ? trns->data[index] : 255;
+				break;
+			}
+			case 4: // Greyscale + alpha
+				out[0] = out[1] = out[2] = scaleSample(sample(row, x * 2, depth), depth);
+				out[3]                   = scaleSample(sample(row, x * 2 + 1, depth), depth);
+				break;
+			case 6: // RGBA
+				for (unsigned c = 0; c < 4; ++c)
+					out[c] = scaleSample(sample(row, x * 4 + c, depth), depth);
+				break;
+			default: break;
+			}
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Filters all rows of [image] with [strategy] (a filter type, or adaptive to
+// pick the filter per-row that minimises the sum of absolute differences)
+// -----------------------------------------------------------------------------
+void PNGCodec::filterImage(
+	const vector<uint8_t>& image,
+	size_t                 rows,
+	size_t                 row_bytes,
+	unsigned               bpp,
+	int                    strategy,
+	vector<uint8_t>&       out)
+{
+	out.resize(rows * (row_bytes + 1));
+	vector<uint8_t> candidate(row_bytes);
+	for (size_t y = 0; y < rows; ++y)
+	{
+		auto row  = image.data() + y * row_bytes;
+		auto prev = y > 0 ? row - row_bytes : nullptr;
+		auto dest = out.data() + y * (row_bytes + 1);
+
+		if (strategy != FILTER_ADAPTIVE)
+		{
+			dest[0] = strategy;
+			filterRow(strategy, row, prev, row_bytes, bpp, dest + 1);
+			continue;
+		}
+
+		// Adaptive - try all filters on this row
+		size_t best_sum = std::numeric_limits<size_t>::max();
+		for (int type = 0; type < 5; ++type)
+		{
+			filterRow(type, row, prev, row_bytes, bpp, candidate.data());
+			size_t sum = 0;
+			for (auto value : candidate)
+				sum += value < 128 ? value : 256 - value;
+
+			if (sum < best_sum)
+			{
+				best_sum = sum;
+				dest[0]  = type;
+				memcpy(dest + 1, candidate.data(), row_bytes);
+			}
+		}
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+// Compresses [data] with zlib at [level] using [strategy]
+// -----------------------------------------------------------------------------
+bool PNGCodec::deflateData(const vector<uint8_t>& data, int level, int strategy, vector<uint8_t>& out)
+{
+	z_stream strm;
+	memset(&strm, 0, sizeof(strm));
+	if (deflateInit2(&strm, level, Z_DEFLATED, MAX_WBITS, 9, strategy) != Z_OK)
+		return false;
+
+	out.resize(deflateBound(&strm, data.size()));
+	strm.next_in   = const_cast<Bytef*>(data.data());
+	strm.avail_in  = data.size();
+	strm.next_out  = out.data();
+	strm.avail_out = out.size();
+	int ret        = deflate(&strm, Z_FINISH);
+	out.resize(strm.total_out);
+	deflateEnd(&strm);
+
+	return ret == Z_STREAM_END;
+}
+
+
+// Testing
+
+#include "General/Console/Console.h"
+#include "PNGOptimizer.h"
+
+CONSOLE_COMMAND(test_png_headers, 0, false)
+{
+	// Checks PNGs with oversized (malicious) or inconsistent headers and
+	// truncated image data are rejected with an error by both the decoder and
+	// the optimizer, rather than allocating for them
+	auto make_png = [](uint32_t width, uint32_t height, uint8_t colour_type, uint32_t data_rows) {
+		PNGCodec::Header header;
+		header.width       = width;
+		header.height      = height;
+		header.bit_depth   = 8;
+		header.colour_type = colour_type;
+
+		// Encode [data_rows] rows of (valid) image data, regardless of the size
+		// given in the header
+		PNGCodec::Header data_header = header;
+		data_header.width            = std::min<uint32_t>(width, 64);
+		data_header.height           = data_rows;
+		vector<uint8_t> image(data_header.rowBytes(data_header.width) * data_rows, 0);
+		vector<uint8_t> idat;
+		PNGCodec::encode(data_header, image, 0, idat);
+
+		uint8_t         ihdr[13];
+		uint8_t         plte[3] = { 0, 0, 0 };
+		vector<uint8_t> png;
+		header.write(ihdr);
+		PNGCodec::writeSignature(png);
+		PNGCodec::writeChunk(png, "IHDR", ihdr, 13);
+		if (colour_type == 3)
+			PNGCodec::writeChunk(png, "PLTE", plte, 3);
+		PNGCodec::writeChunk(png, "IDAT", idat.data(), idat.size());
+		PNGCodec::writeChunk(png, "IEND", nullptr, 0);
+
+		return png;
+	};
+
+	struct Case
+	{
+		const char*     name;
+		vector<uint8_t> png;
+		bool            valid;
+	};
+	vector<Case> cases;
+	cases.push_back({ "valid 64x64 paletted", make_png(64, 64, 3, 64), true });
+	cases.push_back({ "2^31 x 2^31 RGBA", make_png(0x80000000, 0x80000000, 6, 1), false });
+	cases.push_back({ "0xFFFFFFFF x 1 greyscale", make_png(0xFFFFFFFF, 1, 0, 1), false });
+	cases.push_back({ "16384 x 16384 RGBA", make_png(16384, 16384, 6, 1), false });
+	cases.push_back({ "8192 x 8192 RGBA, 1 row of data", make_png(8192, 8192, 6, 1), false });
+	cases.push_back({ "64 x 64 paletted, 16 rows of data", make_png(64, 64, 3, 16), false });
+
+	unsigned failed = 0;
+	for (auto& test : cases)
+	{
+		MemChunk png(test.png.data(), test.png.size());
+
+		// Decoder
+		vector<PNGCodec::Chunk> chunks;
+		PNGCodec::Header        header;
+		vector<uint8_t>         image;
+		wxString                error;
+		bool decoded = PNGCodec::readChunks(png, chunks, error) && header.read(chunks[0])
+					   && PNGCodec::decode(header, chunks, image, error);
+
+		// Optimizer
+		MemChunk out;
+		wxString opt_error;
+		bool     optimized = PNGOptimizer::optimize(png, out, opt_error);
+
+		if (decoded != test.valid || optimized != test.valid)
+		{
+			Log::error(wxString::Format(
+				"%s: expected %s, decode %s, optimize %s",
+				test.name,
+				test.valid ? "success" : "failure",
+				decoded ? "succeeded" : "failed",
+				optimized ? "succeeded" : "failed"));
+			failed++;
+		}
+		else
+			Log::info(wxString::Format("%s: ok (%s)", test.name, test.valid ? "decoded" : opt_error));
+	}
+
+	Log::info(wxString::Format("%d of %d PNG header tests failed", failed, (int)cases.size()));
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+namespace PNGCodec
+{
+// Scanline filter strategy to pick the best filter per-row
+static const int FILTER_ADAPTIVE = 5;
+
+// Largest image that will be decoded. Headers beyond these are rejected before
+// anything is allocated for them, which also keeps all size calculations for
+// valid headers well within range
+static const uint32_t MAX_DIMENSION = 32768;
+static const uint64_t MAX_PIXELS    = 64 * 1024 * 1024;
+
+struct Chunk
+{
+	std::string    type;
+	const uint8_t* data = nullptr;
+	uint32_t       size = 0;
+};
+
+struct Header
+{
+	uint32_t width       = 0;
+	uint32_t height      = 0;
+	uint8_t  bit_depth   = 0;
+	uint8_t  colour_type = 0;
+	uint8_t  interlace   = 0;
+
+	unsigned channels() const
+	{
+		switch (colour_type)
+		{
+		case 0: return 1; // Greyscale
+		case 2: return 3; // RGB
+		case 3: return 1; // Paletted
+		case 4: return 2; // Greyscale + alpha
+		case 6: return 4; // RGBA
+		default: return 0;
+		}
+	}
+	unsigned bitsPerPixel() const { return channels() * bit_depth; }
+	unsigned bytesPerPixel() const { return std::max(1u, bitsPerPixel() / 8); }
+	size_t   rowBytes(uint32_t w) const { return ((size_t)w * bitsPerPixel() + 7) / 8; }
+
+	bool isValid() const;
+	bool read(const Chunk& ihdr);
+	void write(uint8_t* ihdr) const;
+};
+
+uint32_t readB32(const uint8_t* data);
+void     writeB32(vector<uint8_t>& out, uint32_t value);
+void     writeSignature(vector<uint8_t>& out);
+void     writeChunk(vector<uint8_t>& out, const char* type, const uint8_t* data, uint32_t size);
+bool     readChunks(const MemChunk& png, vector<Chunk>& chunks, wxString& error, bool headers_only = false);
+
+bool decode(const Header& header, const vector<Chunk>& chunks, vector<uint8_t>& image, wxString& error);
+bool encode(const Header& header, const vector<uint8_t>& image, int filter, vector<uint8_t>& idat);
+void expandRGBA(
+	const Header&          header,
+	const vector<uint8_t>& image,
+	const Chunk*           plte,
+	const Chunk*           trns,
+	uint8_t*               out);
+void filterImage(
+	const vector<uint8_t>& image,
+	size_t                 rows,
+	size_t                 row_bytes,
+	unsigned               bpp,
+	int                    strategy,
+	vector<uint8_t>&       out);
+bool deflateData(const vector<uint8_t>& data, int level, int strategy, vector<uint8_t>& out);
+} // namespace PNGCodec
@@ -0,0 +1,150 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2019 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    PNGOptimizer.cpp
+// Description: Lossless PNG re-encoder. Decodes the image data, then tries
+//              combinations of scanline filters and zlib strategies, keeping
+//              the smallest result. All ancillary chunks are stripped except
+//              for tRNS and the ZDoom grAb/alPh chunks
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "PNGOptimizer.h"
+#include "PNGCodec.h"
+#include "thirdparty/zlib/zlib.h"
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Scanline filter strategies to try (0-4 = all rows use that filter type, plus
+// adaptive)
+const int n_filters = PNGCodec::FILTER_ADAPTIVE + 1;
+
+// zlib strategies to try
+const int zlib_strategies[] = { Z_DEFAULT_STRATEGY, Z_FILTERED, Z_RLE };
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// PNGOptimizer Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Re-encodes the PNG data in [png] as small as possible (losslessly), writing
+// the result to [out]. The result is non-interlaced, and only keeps the IHDR,
+// PLTE, tRNS, grAb, alPh, IDAT and IEND chunks.
+// Returns false and sets [error] if [png] could not be read.
+// This doesn't use any global state, so it can be called from any thread
+// -----------------------------------------------------------------------------
+bool PNGOptimizer::optimize(const MemChunk& png, MemChunk& out, wxString& error)
+{
+	// Read chunks
+	vector<PNGCodec::Chunk> chunks;
+	if (!PNGCodec::readChunks(png, chunks, error))
+		return false;
+
+	// Read header
+	PNGCodec::Header header;
+	if (!header.read(chunks[0]))
+	{
+		error = chunks[0].type == "IHDR" ? "Unsupported image format or size" : "Missing IHDR chunk";
+		return false;
+	}
+
+	// Gather chunks to keep
+	vector<PNGCodec::Chunk> keep_before; // grAb/alPh, written right after IHDR
+	const PNGCodec::Chunk*  plte = nullptr;
+	const PNGCodec::Chunk*  trns = nullptr;
+	for (auto& chunk : chunks)
+	{
+		if (chunk.type == "PLTE")
+			plte = &chunk;
+		else if (chunk.type == "tRNS")
+			trns = &chunk;
+		else if (chunk.type == "grAb" || chunk.type == "alPh")
+			keep_before.push_back(chunk);
+	}
+	if (header.colour_type == 3 && !plte)
+	{
+		error = "Missing PLTE chunk";
+		return false;
+	}
+
+	// Decompress and unfilter image data
+	vector<uint8_t> image;
+	if (!PNGCodec::decode(header, chunks, image, error))
+		return false;
+
+	// Try all filter/compression combinations, keeping the smallest
+	size_t          row_bytes = header.rowBytes(header.width);
+	vector<uint8_t> filtered;
+	vector<uint8_t> best;
+	vector<uint8_t> compressed;
+	for (int filter = 0; filter < n_filters; ++filter)
+	{
+		PNGCodec::filterImage(image, header.height, row_bytes, header.bytesPerPixel(), filter, filtered);
+		for (auto strategy : zlib_strategies)
+		{
+			if (!PNGCodec::deflateData(filtered, Z_BEST_COMPRESSION, strategy, compressed))
+				continue;
+			if (best.empty() || compressed.size() < best.size())
+				best.swap(compressed);
+		}
+	}
+	if (best.empty())
+	{
+		error = "Compression failed";
+		return false;
+	}
+
+	// Write optimized PNG
+	vector<uint8_t> data;
+	uint8_t         ihdr[13];
+	header.interlace = 0;
+	header.write(ihdr);
+	PNGCodec::writeSignature(data);
+	PNGCodec::writeChunk(data, "IHDR", ihdr, 13);
+	for (auto& chunk : keep_before)
+		PNGCodec::writeChunk(data, chunk.type.c_str(), chunk.data, chunk.size);
+	if (plte)
+		PNGCodec::writeChunk(data, "PLTE", plte->data, plte->size);
+	if (trns)
+		PNGCodec::writeChunk(data, "tRNS", trns->data, trns->size);
+	PNGCodec::writeChunk(data, "IDAT", best.data(), best.size());
+	PNGCodec::writeChunk(data, "IEND", nullptr, 0);
+
+	out.importMem(data.data(), data.size());
+	return true;
+}
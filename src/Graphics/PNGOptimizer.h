@@ -0,0 +1,6 @@
+#pragma once
+
+namespace PNGOptimizer
+{
+bool optimize(const MemChunk& png, MemChunk& out, wxString& error);
+} // namespace PNGOptimizer
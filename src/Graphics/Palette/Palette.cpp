@@ -51,9 +51,9 @@ CVAR(Float, col_match_b, 1.0, CVar::Flag::Save)
 CVAR(Float, col_match_h, 1.0, CVar::Flag::Save)
 CVAR(Float, col_match_s, 1.0, CVar::Flag::Save)
 CVAR(Float, col_match_l, 1.0, CVar::Flag::Save)
-EXTERN_CVAR(Float, col_greyscale_r)
-EXTERN_CVAR(Float, col_greyscale_g)
-EXTERN_CVAR(Float, col_greyscale_b)
+CVAR(Float, col_greyscale_r, 0.299, CVar::Flag::Save)
+CVAR(Float, col_greyscale_g, 0.587, CVar::Flag::Save)
+CVAR(Float, col_greyscale_b, 0.114, CVar::Flag::Save)
 
 
 // -----------------------------------------------------------------------------
@@ -0,0 +1,359 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2019 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    PaletteTables.cpp
+// Description: Functions to generate the palette lookup tables used by games
+//              for lighting and translucency - COLORMAP, and 256x256 blend
+//              tables such as Boom's TRANMAP or Heretic/Hexen's TINTTAB.
+//              Also ColourMatcher, which finds the nearest palette colours
+//              for large numbers of colours at once
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "PaletteTables.h"
+#include "Utility/Parallel.h"
+#include <climits>
+
+using namespace PaletteTables;
+
+
+// -----------------------------------------------------------------------------
+//
+// External Variables
+//
+// -----------------------------------------------------------------------------
+EXTERN_CVAR(Int, col_match)
+EXTERN_CVAR(Float, col_greyscale_r)
+EXTERN_CVAR(Float, col_greyscale_g)
+EXTERN_CVAR(Float, col_greyscale_b)
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the colour component [front] blended with [back] using [blend], by
+// [amount] (0-1)
+// -----------------------------------------------------------------------------
+uint8_t blendComponent(Blend blend, uint8_t front, uint8_t back, float amount)
+{
+	switch (blend)
+	{
+	case Blend::Additive: return std::min(255, (int)(back + front * amount + 0.5f));
+	case Blend::Subtractive: return std::max(0, (int)(back - front * amount + 0.5f));
+	default: return (uint8_t)(front * amount + back * (1.f - amount) + 0.5f);
+	}
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// ColourMatcher Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// ColourMatcher class constructor
+// -----------------------------------------------------------------------------
+ColourMatcher::ColourMatcher(const Palette& palette, Palette::ColourMatch match) : palette_{ palette }, match_{ match }
+{
+	if (match_ == Palette::ColourMatch::Default)
+		match_ = (Palette::ColourMatch)(int)col_match;
+
+	for (unsigned a = 0; a < 256; ++a)
+	{
+		auto col  = palette.colour(a);
+		pal_r_[a] = col.r;
+		pal_g_[a] = col.g;
+		pal_b_[a] = col.b;
+	}
+
+	if (match_ != Palette::ColourMatch::Old)
+		return;
+
+	// Get the squared min/max distance from each of the 16 cell rows to each
+	// palette colour, for each component
+	int* components[] = { pal_r_, pal_g_, pal_b_ };
+	for (unsigned c = 0; c < 3; ++c)
+	{
+		row_min_[c].resize(16 * 256);
+		row_max_[c].resize(16 * 256);
+		for (int row = 0; row < 16; ++row)
+		{
+			int low  = row * 16;
+			int high = low + 15;
+			for (unsigned a = 0; a < 256; ++a)
+			{
+				int value = components[c][a];
+				int d_min = value < low ? low - value : (value > high ? value - high : 0);
+				int d_max = std::max(value - low, high - value);
+
+				row_min_[c][row * 256 + a] = d_min * d_min;
+				row_max_[c][row * 256 + a] = d_max * d_max;
+			}
+		}
+	}
+	cells_.resize(16 * 16 * 16);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the index of the palette colour nearest to [rgb] (packed with
+// ColourMatcher::pack). Gives the same result as Palette::nearestColour with
+// the same matching method. Not thread-safe, use match to match in parallel
+// -----------------------------------------------------------------------------
+uint8_t ColourMatcher::nearest(uint32_t rgb)
+{
+	if (match_ != Palette::ColourMatch::Old)
+		return palette_.nearestColour(ColRGBA((rgb >> 16) & 0xFF, (rgb >> 8) & 0xFF, rgb & 0xFF), match_);
+
+	auto cell = cellIndex(rgb);
+	if (cells_[cell].empty())
+		buildCell(cell);
+
+	return nearestInCell(rgb);
+}
+
+// -----------------------------------------------------------------------------
+// Writes the nearest palette index for each colour in [colours] (packed with
+// ColourMatcher::pack) to [out], using up to [n_threads] threads (or one per
+// hardware thread if 0)
+// -----------------------------------------------------------------------------
+void ColourMatcher::match(const vector<uint32_t>& colours, uint8_t* out, unsigned n_threads)
+{
+	if (match_ == Palette::ColourMatch::Old)
+	{
+		// Build any grid cells needed first, so matching only reads them
+		vector<unsigned> needed;
+		vector<bool>     is_needed(cells_.size());
+		for (auto colour : colours)
+		{
+			auto cell = cellIndex(colour);
+			if (cells_[cell].empty() && !is_needed[cell])
+			{
+				is_needed[cell] = true;
+				needed.push_back(cell);
+			}
+		}
+		parallelFor(needed.size(), 64, n_threads, [&](unsigned start, unsigned end) {
+			for (auto a = start; a < end; ++a)
+				buildCell(needed[a]);
+		});
+
+		// Match
+		parallelFor(colours.size(), 4096, n_threads, [&](unsigned start, unsigned end) {
+			for (auto a = start; a < end; ++a)
+				out[a] = nearestInCell(colours[a]);
+		});
+
+		return;
+	}
+
+	// Sort colours along with their positions, so each distinct colour only
+	// needs to be matched once
+	vector<uint64_t> sorted(colours.size());
+	for (unsigned a = 0; a < colours.size(); ++a)
+		sorted[a] = ((uint64_t)colours[a] << 32) | a;
+	std::sort(sorted.begin(), sorted.end());
+
+	// Find the start of each run of the same colour
+	vector<unsigned> runs;
+	for (unsigned a = 0; a < sorted.size(); ++a)
+		if (a == 0 || sorted[a] >> 32 != sorted[a - 1] >> 32)
+			runs.push_back(a);
+	runs.push_back(sorted.size());
+
+	// Match each distinct colour, and write the result for all its positions
+	parallelFor(runs.size() - 1, 256, n_threads, [&](unsigned start, unsigned end) {
+		for (auto run = start; run < end; ++run)
+		{
+			auto index = nearest(sorted[runs[run]] >> 32);
+			for (auto a = runs[run]; a < runs[run + 1]; ++a)
+				out[sorted[a] & 0xFFFFFFFF] = index;
+		}
+	});
+}
+
+// -----------------------------------------------------------------------------
+// Builds the list of palette indices that could be nearest to a colour within
+// grid [cell]. These are the colours closer to the cell at their nearest than
+// the colour nearest at its furthest point is (so the result of the full
+// search is always among them, including ties, which keep palette order)
+// -----------------------------------------------------------------------------
+void ColourMatcher::buildCell(unsigned cell)
+{
+	auto r_min = &row_min_[0][(cell >> 8) * 256];
+	auto g_min = &row_min_[1][((cell >> 4) & 0xF) * 256];
+	auto b_min = &row_min_[2][(cell & 0xF) * 256];
+	auto r_max = &row_max_[0][(cell >> 8) * 256];
+	auto g_max = &row_max_[1][((cell >> 4) & 0xF) * 256];
+	auto b_max = &row_max_[2][(cell & 0xF) * 256];
+
+	int dist_min[256];
+	int threshold = INT_MAX;
+	for (unsigned a = 0; a < 256; ++a)
+	{
+		dist_min[a] = r_min[a] + g_min[a] + b_min[a];
+		threshold   = std::min(threshold, r_max[a] + g_max[a] + b_max[a]);
+	}
+
+	auto& candidates = cells_[cell];
+	for (unsigned a = 0; a < 256; ++a)
+		if (dist_min[a] <= threshold)
+			candidates.push_back(a);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the index of the palette colour nearest to [rgb] using the integer
+// RGB method, checking only the candidates in its (already built) grid cell
+// -----------------------------------------------------------------------------
+uint8_t ColourMatcher::nearestInCell(uint32_t rgb) const
+{
+	int r = (rgb >> 16) & 0xFF;
+	int g = (rgb >> 8) & 0xFF;
+	int b = rgb & 0xFF;
+
+	int     min_dist = INT_MAX;
+	uint8_t index    = 0;
+	for (auto a : cells_[cellIndex(rgb)])
+	{
+		int dr   = r - pal_r_[a];
+		int dg   = g - pal_g_[a];
+		int db   = b - pal_b_[a];
+		int dist = dr * dr + dg * dg + db * db;
+		if (dist < min_dist)
+		{
+			// Exact match
+			if (dist == 0)
+				return a;
+
+			min_dist = dist;
+			index    = a;
+		}
+	}
+
+	return index;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// PaletteTables Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Generates a COLORMAP lump for [palette] in [out]. This has 34 maps of 256
+// indices: the first 32 for diminishing light levels, fading to [fade] (black
+// for Doom, grey for Hexen's FOGMAP), and the 33rd is the inverted grey map
+// used by invulnerability. The 34th is unused and left black
+// -----------------------------------------------------------------------------
+void PaletteTables::generateColormap(const Palette& palette, MemChunk& out, const ColRGBA& fade, unsigned n_threads)
+{
+	auto diminish = [](uint8_t colour, uint8_t fade, unsigned level) {
+		return (uint8_t)((((float)colour) * (32.0 - level) + fade * level + 16.0) / 32.0);
+	};
+
+	vector<uint32_t> colours(34 * 256);
+	for (unsigned l = 0; l < 34; ++l)
+	{
+		for (unsigned c = 0; c < 256; ++c)
+		{
+			auto rgb = palette.colour(c);
+			if (l < 32)
+			{
+				// Light maps
+				rgb.r = diminish(rgb.r, fade.r, l);
+				rgb.g = diminish(rgb.g, fade.g, l);
+				rgb.b = diminish(rgb.b, fade.b, l);
+			}
+			else if (l == 32)
+			{
+				// Inverse map
+				float grey = ((float)rgb.r / 256.0 * col_greyscale_r) + ((float)rgb.g / 256.0 * col_greyscale_g)
+							 + ((float)rgb.b / 256.0 * col_greyscale_b);
+				grey = 1.0 - grey;
+				// Clamp value: with Id Software's values, the sum is greater than 1.0 (0.299+0.587+0.144=1.030)
+				// This means the negation above can give a negative value (for example, with RGB values of 247 or
+				// more), which will not be converted correctly to unsigned 8-bit int in the ColRGBA struct.
+				if (grey < 0.0)
+					grey = 0;
+				rgb.r = rgb.g = rgb.b = grey * 255;
+			}
+			else
+				rgb = palette.colour(0);
+
+			colours[l * 256 + c] = ColourMatcher::pack(rgb.r, rgb.g, rgb.b);
+		}
+	}
+
+	out.reSize(colours.size(), false);
+	ColourMatcher(palette).match(colours, out.data(), n_threads);
+}
+
+// -----------------------------------------------------------------------------
+// Generates a 256x256 blend table for [palette] in [out], where the index at
+// (background * 256) + foreground is the nearest palette colour to the
+// foreground colour blended over the background with [blend] by [amount]
+// (0-1). This is the layout of Boom's TRANMAP and Heretic/Hexen's TINTTAB
+// -----------------------------------------------------------------------------
+void PaletteTables::generateBlendTable(
+	const Palette& palette,
+	Blend          blend,
+	float          amount,
+	MemChunk&      out,
+	unsigned       n_threads)
+{
+	amount = std::clamp(amount, 0.f, 1.f);
+
+	// Blend colours
+	vector<uint32_t> colours(256 * 256);
+	parallelFor(256, 16, n_threads, [&](unsigned start, unsigned end) {
+		for (unsigned bg = start; bg < end; ++bg)
+		{
+			auto back = palette.colour(bg);
+			for (unsigned fg = 0; fg < 256; ++fg)
+			{
+				auto front              = palette.colour(fg);
+				colours[(bg << 8) + fg] = ColourMatcher::pack(
+					blendComponent(blend, front.r, back.r, amount),
+					blendComponent(blend, front.g, back.g, amount),
+					blendComponent(blend, front.b, back.b, amount));
+			}
+		}
+	});
+
+	// Match to palette
+	out.reSize(colours.size(), false);
+	ColourMatcher(palette).match(colours, out.data(), n_threads);
+}
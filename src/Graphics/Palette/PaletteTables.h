@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Palette.h"
+
+// Generation of the palette lookup tables games use for lighting and
+// translucency effects (COLORMAP, TRANMAP, TINTTAB etc.)
+namespace PaletteTables
+{
+enum class Blend
+{
+	Translucent, // Foreground at [amount] opacity over the background
+	Additive,    // Foreground multiplied by [amount] added to the background
+	Subtractive  // Foreground multiplied by [amount] subtracted from the background
+};
+
+// Finds the nearest palette indices for many colours at once, in parallel.
+// For the integer RGB ('Old') matching method, RGB space is split into a grid
+// of 16x16x16 cells, each with a list of the (few) palette colours that could
+// be nearest to any colour within it, so only those need to be checked. Other
+// methods are slower, so each distinct colour is only matched once
+class ColourMatcher
+{
+public:
+	ColourMatcher(const Palette& palette, Palette::ColourMatch match = Palette::ColourMatch::Default);
+	~ColourMatcher() = default;
+
+	uint8_t nearest(uint32_t rgb);
+	void    match(const vector<uint32_t>& colours, uint8_t* out, unsigned n_threads = 0);
+
+	static uint32_t pack(uint8_t r, uint8_t g, uint8_t b) { return (r << 16) | (g << 8) | b; }
+
+private:
+	Palette              palette_;
+	Palette::ColourMatch match_;
+
+	// Palette colour components
+	int pal_r_[256];
+	int pal_g_[256];
+	int pal_b_[256];
+
+	// Grid cells (candidate palette indices, built when first needed) and the
+	// squared min/max distance from each cell row to each palette colour, for
+	// each component
+	vector<vector<uint8_t>> cells_;
+	vector<int>             row_min_[3];
+	vector<int>             row_max_[3];
+
+	static unsigned cellIndex(uint32_t rgb) { return ((rgb >> 12) & 0xF00) | ((rgb >> 8) & 0xF0) | ((rgb >> 4) & 0xF); }
+
+	void    buildCell(unsigned cell);
+	uint8_t nearestInCell(uint32_t rgb) const;
+};
+
+void generateColormap(
+	const Palette& palette,
+	MemChunk&      out,
+	const ColRGBA& fade      = ColRGBA::BLACK,
+	unsigned       n_threads = 0);
+void generateBlendTable(const Palette& palette, Blend blend, float amount, MemChunk& out, unsigned n_threads = 0);
+} // namespace PaletteTables
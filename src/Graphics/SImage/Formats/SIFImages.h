@@ -1,78 +1,4 @@
 
-class PNGChunk
-{
-public:
-	PNGChunk(const wxString& name = "----") { memcpy(name_, CHR(name), 4); }
-	~PNGChunk() = default;
-
-	wxString  name() const { return wxString::FromAscii(name_, 4); }
-	uint32_t  size() const { return size_; }
-	uint32_t  crc() const { return crc_; }
-	MemChunk& data() { return data_; }
-
-	void read(MemChunk& mc)
-	{
-		// Read size and chunk name
-		mc.read(&size_, 4);
-		mc.read(name_, 4);
-
-		// Endianness correction
-		size_ = wxUINT32_SWAP_ON_LE(size_);
-
-		// Read chunk data
-		data_.clear();
-		mc.readMC(data_, size_);
-
-		// Read crc
-		mc.read(&crc_, 4);
-
-		// Endianness correction
-		crc_ = wxUINT32_SWAP_ON_LE(crc_);
-	}
-
-	void write(MemChunk& mc) const
-	{
-		// Endianness correction
-		uint32_t size_swapped = wxUINT32_SWAP_ON_LE(size_);
-		uint32_t crc_swapped  = wxUINT32_SWAP_ON_LE(crc_);
-
-		// Write chunk data
-		mc.write(&size_swapped, 4);
-		mc.write(name_, 4);
-		mc.write(data_.data(), size_);
-		mc.write(&crc_swapped, 4);
-	}
-
-	void setData(const uint8_t* data, uint32_t size)
-	{
-		// Read given data
-		data_.clear();
-		data_.write(data, size);
-
-		// Update variables
-		size_ = size;
-
-		// Note that the CRC is not computed just from
-		// the chunk data, but also the chunk name! So
-		// we need to write all that in a temporary MC
-		MemChunk fulldata;
-		fulldata.reSize(4 + size);
-		fulldata.seek(0, SEEK_SET);
-		fulldata.write(name_, 4);
-		fulldata.write(data, size);
-		crc_ = fulldata.crc();
-		fulldata.clear();
-	}
-
-	void setData(MemChunk& mc) { setData(mc.data(), mc.size()); }
-
-private:
-	uint32_t size_ = 0;
-	char     name_[4];
-	MemChunk data_;
-	uint32_t crc_ = 0;
-};
-
 // TODO: Keep PNG chunks in SImage so they are preserved between load/save
 class SIFPng : public SIFormat
 {
@@ -103,56 +29,21 @@ public:
 		inf.width  = 0;
 		inf.height = 0;
 
-		// Read first chunk
-		mc.seek(8, SEEK_SET);
-		PNGChunk chunk;
-		chunk.read(mc);
-		// Should be IHDR
-		int bpp = 32;
-		if (chunk.name() == "IHDR")
-		{
-			// Read IHDR data
-			IhdrChunk ihdr;
-			chunk.data().read(&ihdr, 13, 0);
-
-			// Set info from IHDR
-			inf.width  = ihdr.width;
-			inf.height = ihdr.height;
-			bpp        = ihdr.bpp;
-			if (ihdr.coltype == 3 && ihdr.bpp == 8)
-			{
-				// Only 8bpp 'indexed' pngs are counted as PalMask for now, all others will be converted to RGBA
-				inf.colformat   = SImage::Type::PalMask;
-				inf.has_palette = true;
-			}
-			else
-				inf.colformat = SImage::Type::RGBA;
-		}
-
-		// Look for other info chunks (grAb or alPh)
-		while (true)
-		{
-			chunk.read(mc);
-
-			// Set format to alpha map if alPh present (and 8bpp)
-			if (bpp == 8 && chunk.name() == "alPh")
-				inf.colformat = SImage::Type::AlphaMap;
-
-			// Set offsets if grAb present
-			else if (chunk.name() == "grAb")
-			{
-				// Read offsets
-				int32_t xoff, yoff;
-				chunk.data().read(&xoff, 4, 0);
-				chunk.data().read(&yoff, 4);
-				inf.offset_x = wxINT32_SWAP_ON_LE(xoff);
-				inf.offset_y = wxINT32_SWAP_ON_LE(yoff);
-			}
-
-			// Stop on IDAT chunk
-			else if (chunk.name() == "IDAT")
-				break;
-		}
+		// Read header chunks only, no need to decode the image
+		vector<PNGCodec::Chunk> chunks;
+		PNGCodec::Header        header;
+		wxString                error;
+		if (!PNGCodec::readChunks(mc, chunks, error, true) || !header.read(chunks[0]))
+			return inf;
+
+		// Set info from IHDR and any grAb/alPh chunks
+		bool alPh = false;
+		readInfoChunks(chunks, inf.offset_x, inf.offset_y, alPh);
+		inf.width     = header.width;
+		inf.height    = header.height;
+		inf.colformat = imageType(header, alPh);
+		if (inf.colformat == SImage::Type::PalMask)
+			inf.has_palette = true;
 
 		return inf;
 	}
@@ -232,181 +123,122 @@ public:
 protected:
 	bool readImage(SImage& image, MemChunk& data, int index) override
 	{
-		// Create FreeImage bitmap from entry data
-		auto mem = FreeImage_OpenMemory((BYTE*)data.data(), data.size());
-		auto fif = FreeImage_GetFileTypeFromMemory(mem, 0);
-		auto bm  = FreeImage_LoadFromMemory(fif, mem, 0);
-		FreeImage_CloseMemory(mem);
-
-		// Check it created/read ok
-		if (!bm)
+		// Read chunks and header
+		vector<PNGCodec::Chunk> chunks;
+		PNGCodec::Header        header;
+		wxString                error;
+		if (!PNGCodec::readChunks(data, chunks, error))
 		{
-			Global::error = "Error reading PNG data";
+			Global::error = "Error reading PNG data: " + error.ToStdString();
+			return false;
+		}
+		if (!header.read(chunks[0]))
+		{
+			Global::error = "Error reading PNG data: Unsupported image format or size";
 			return false;
 		}
-
-		// Get image info
-		int  width  = FreeImage_GetWidth(bm);
-		int  height = FreeImage_GetHeight(bm);
-		int  bpp    = FreeImage_GetBPP(bm);
-		auto type   = SImage::Type::RGBA;
 
 		// Read extra info from various PNG chunks
-		int32_t xoff       = 0;
-		int32_t yoff       = 0;
-		bool    alPh_chunk = false;
-		bool    grAb_chunk = false;
-		data.seek(8, SEEK_SET); // Start after PNG header
-		PNGChunk chunk;
-		while (true)
+		int                    xoff = 0;
+		int                    yoff = 0;
+		bool                   alPh = false;
+		const PNGCodec::Chunk* plte = nullptr;
+		const PNGCodec::Chunk* trns = nullptr;
+		readInfoChunks(chunks, xoff, yoff, alPh);
+		for (auto& chunk : chunks)
 		{
-			// Read next PNG chunk
-			chunk.read(data);
-
-			// Check for 'grAb' chunk
-			if (!grAb_chunk && chunk.name() == "grAb")
-			{
-				// Read offsets
-				chunk.data().read(&xoff, 4, 0);
-				chunk.data().read(&yoff, 4);
-				xoff       = wxINT32_SWAP_ON_LE(xoff);
-				yoff       = wxINT32_SWAP_ON_LE(yoff);
-				grAb_chunk = true;
-			}
-
-			// Check for 'alPh' chunk
-			if (!alPh_chunk && chunk.name() == "alPh")
-				alPh_chunk = true;
-
-			// If both chunks are found no need to search further
-			if (grAb_chunk && alPh_chunk)
-				break;
+			if (chunk.type == "PLTE")
+				plte = &chunk;
+			else if (chunk.type == "tRNS")
+				trns = &chunk;
+		}
 
-			// Stop searching when we get to IDAT chunk
-			if (chunk.name() == "IDAT")
-				break;
+		// Decode image data
+		vector<uint8_t> pixels;
+		if (!PNGCodec::decode(header, chunks, pixels, error))
+		{
+			Global::error = "Error reading PNG data: " + error.ToStdString();
+			return false;
 		}
 
-		// Get image palette if it exists
-		auto    bm_pal = FreeImage_GetPalette(bm);
+		// 8bit paletted and greyscale images are loaded as paletted (with a
+		// greyscale palette for greyscale), anything else is converted to RGBA
+		auto    type = imageType(header, alPh);
+		int     size = header.width * header.height;
 		Palette palette;
-		if (bpp == 8 && bm_pal)
+		if (type == SImage::Type::RGBA)
 		{
-			type  = SImage::Type::PalMask;
-			int a = 0;
-			int b = FreeImage_GetColorsUsed(bm);
-			if (b > 256)
-				b = 256;
-			for (; a < b; a++)
-				palette.setColour(a, ColRGBA(bm_pal[a].rgbRed, bm_pal[a].rgbGreen, bm_pal[a].rgbBlue, 255));
+			image.create(header.width, header.height, type);
+			PNGCodec::expandRGBA(header, pixels, plte, trns, imageData(image));
 		}
-
-		// If it's a ZDoom alpha map
-		if (alPh_chunk && bpp == 8)
-			type = SImage::Type::AlphaMap;
-
-		// Create image
-		if (bm_pal)
-			image.create(width, height, type, &palette);
 		else
-			image.create(width, height, type, nullptr);
-
-		// Load image data
-		auto img_data = imageData(image);
-		if (type == SImage::Type::PalMask || type == SImage::Type::AlphaMap)
 		{
-			// Flip vertically
-			FreeImage_FlipVertical(bm);
-
-			// Load indexed data
-			unsigned c = 0;
-			for (int row = 0; row < height; row++)
+			for (int a = 0; a < 256; a++)
 			{
-				auto scanline = FreeImage_GetScanLine(bm, row);
-				for (int x = 0; x < width; x++)
-					img_data[c++] = scanline[x];
+				if (header.colour_type == 0)
+					palette.setColour(a, ColRGBA(a, a, a, 255));
+				else if (plte && a * 3 + 2 < (int)plte->size)
+					palette.setColour(a, ColRGBA(plte->data[a * 3], plte->data[a * 3 + 1], plte->data[a * 3 + 2], 255));
 			}
 
-			// Set mask
+			image.create(header.width, header.height, type, &palette);
+			memcpy(imageData(image), pixels.data(), size);
+
+			// Set mask from transparency info
 			if (type == SImage::Type::PalMask)
 			{
-				auto mask       = imageMask(image);
-				auto alphatable = FreeImage_GetTransparencyTable(bm);
-				if (alphatable)
+				auto mask = imageMask(image);
+				if (trns && header.colour_type == 3)
+				{
+					for (int a = 0; a < size; a++)
+						mask[a] = pixels[a] < trns->size ? trns->data[pixels[a]] : 255;
+				}
+				else if (trns && header.colour_type == 0 && trns->size >= 2)
 				{
-					for (int a = 0; a < width * height; a++)
-						mask[a] = alphatable[img_data[a]];
+					// Greyscale transparency is a (16bit) grey level
+					auto key = (trns->data[0] << 8) | trns->data[1];
+					for (int a = 0; a < size; a++)
+						mask[a] = pixels[a] == key ? 0 : 255;
 				}
 				else
 					image.fillAlpha(255);
 			}
 		}
-		else if (type == SImage::Type::RGBA)
-		{
-			// Convert to 32bpp & flip vertically
-			auto rgb = FreeImage_ConvertTo32Bits(bm);
-			if (!rgb)
-			{
-				Log::error("FreeImage_ConvertTo32Bits failed for PNG data");
-				Global::error = "Error reading PNG data";
-				return false;
-			}
-			FreeImage_FlipVertical(rgb);
-
-			// Load raw RGBA data
-			auto bits_rgb = FreeImage_GetBits(rgb);
-			int  c        = 0;
-			for (int a = 0; a < width * height; a++)
-			{
-				img_data[c++] = bits_rgb[a * 4 + 2]; // Red
-				img_data[c++] = bits_rgb[a * 4 + 1]; // Green
-				img_data[c++] = bits_rgb[a * 4];     // Blue
-				img_data[c++] = bits_rgb[a * 4 + 3]; // Alpha
-			}
-
-			FreeImage_Unload(rgb);
-		}
 
 		// Set offsets
 		image.setXOffset(xoff);
 		image.setYOffset(yoff);
 
-		// Clean up
-		FreeImage_Unload(bm);
-
 		return true;
 	}
 
 	bool writeImage(SImage& image, MemChunk& data, Palette* pal, int index) override
 	{
 		// Variables
-		FIBITMAP* bm       = nullptr;
-		auto      img_data = imageData(image);
-		auto      img_mask = imageMask(image);
-		auto      type     = image.type();
-		int       width    = image.width();
-		int       height   = image.height();
+		auto img_data = imageData(image);
+		auto img_mask = imageMask(image);
+		auto type     = image.type();
+		int  width    = image.width();
+		int  height   = image.height();
+
+		PNGCodec::Header header;
+		header.width     = width;
+		header.height    = height;
+		header.bit_depth = 8;
+		vector<uint8_t> pixels;
+		vector<uint8_t> plte;
+		vector<uint8_t> trns;
+		int             filter = 0;
 
 		if (type == SImage::Type::RGBA)
 		{
-			// Init 32bpp FIBITMAP
-			bm = FreeImage_Allocate(width, height, 32, 0x0000FF00, 0x00FF0000, 0x000000FF);
-
-			// Write image data
-			uint8_t* bits = FreeImage_GetBits(bm);
-			uint32_t c    = 0;
-			for (int a = 0; a < width * height * 4; a += 4)
-			{
-				bits[c++] = img_data[a + 2];
-				bits[c++] = img_data[a + 1];
-				bits[c++] = img_data[a];
-				bits[c++] = img_data[a + 3];
-			}
+			header.colour_type = 6;
+			pixels.assign(img_data, img_data + width * height * 4);
+			filter = PNGCodec::FILTER_ADAPTIVE;
 		}
 		else if (type == SImage::Type::PalMask)
 		{
-			// Init 8bpp FIBITMAP
-			bm = FreeImage_Allocate(width, height, 8);
+			header.colour_type = 3;
 
 			// Get palette to use
 			Palette usepal;
@@ -415,15 +247,6 @@ protected:
 			else if (pal)
 				usepal.copyPalette(pal);
 
-			// Set palette
-			auto bm_pal = FreeImage_GetPalette(bm);
-			for (int a = 0; a < 256; a++)
-			{
-				bm_pal[a].rgbRed   = usepal.colour(a).r;
-				bm_pal[a].rgbGreen = usepal.colour(a).g;
-				bm_pal[a].rgbBlue  = usepal.colour(a).b;
-			}
-
 			// Handle transparency if needed
 			if (img_mask)
 			{
@@ -451,108 +274,100 @@ protected:
 					}
 				}
 
-				// Set freeimage palette transparency if needed
+				// Set palette transparency if needed
 				if (usepal.transIndex() >= 0)
-					FreeImage_SetTransparentIndex(bm, usepal.transIndex());
+				{
+					trns.assign(usepal.transIndex() + 1, 255);
+					trns[usepal.transIndex()] = 0;
+				}
 			}
 
-			// Write image data
-			for (int row = 0; row < height; row++)
+			// Set palette
+			for (int a = 0; a < 256; a++)
 			{
-				uint8_t* scanline = FreeImage_GetScanLine(bm, row);
-				memcpy(scanline, img_data + (row * width), width);
+				plte.push_back(usepal.colour(a).r);
+				plte.push_back(usepal.colour(a).g);
+				plte.push_back(usepal.colour(a).b);
 			}
+
+			pixels.assign(img_data, img_data + width * height);
 		}
 		else if (type == SImage::Type::AlphaMap)
 		{
-			// Init 8bpp FIBITMAP
-			bm = FreeImage_Allocate(width, height, 8);
-
-			// Set palette (greyscale)
-			auto bm_pal = FreeImage_GetPalette(bm);
-			for (int a = 0; a < 256; a++)
-			{
-				bm_pal[a].rgbRed   = a;
-				bm_pal[a].rgbGreen = a;
-				bm_pal[a].rgbBlue  = a;
-			}
-
-			// Write image data
-			for (int row = 0; row < height; row++)
-			{
-				auto scanline = FreeImage_GetScanLine(bm, row);
-				memcpy(scanline, img_data + (row * width), width);
-			}
+			// Greyscale
+			header.colour_type = 0;
+			pixels.assign(img_data, img_data + width * height);
 		}
 		else
 			return false;
 
-		// Flip the image
-		FreeImage_FlipVertical(bm);
-
-		// Write the image to a temp file
-		FreeImage_Save(FIF_PNG, bm, App::path("temp.png", App::Dir::Temp).c_str());
-
-		// Load it into a memchunk
-		MemChunk png;
-		png.importFile(App::path("temp.png", App::Dir::Temp));
-
-		// Check it loaded ok
-		if (png.size() == 0)
+		// Compress image data
+		vector<uint8_t> idat;
+		if (!PNGCodec::encode(header, pixels, filter, idat))
 		{
-			Log::error("Error reading temporary file");
+			Global::error = "Error compressing PNG data";
 			return false;
 		}
 
 		// Write PNG header and IHDR
-		auto png_data = png.data();
-		data.clear();
-		data.write(png_data, 33);
+		vector<uint8_t> png;
+		uint8_t         ihdr[13];
+		header.write(ihdr);
+		PNGCodec::writeSignature(png);
+		PNGCodec::writeChunk(png, "IHDR", ihdr, 13);
 
 		// Create grAb chunk with offsets (only if offsets exist)
 		if (image.offset().x != 0 || image.offset().y != 0)
 		{
-			PNGChunk  grAb("grAb");
-			GrabChunk gc = { wxINT32_SWAP_ON_LE((int32_t)image.offset().x),
-							 wxINT32_SWAP_ON_LE((int32_t)image.offset().y) };
-			grAb.setData((const uint8_t*)&gc, 8);
-			grAb.write(data);
+			vector<uint8_t> grAb;
+			PNGCodec::writeB32(grAb, image.offset().x);
+			PNGCodec::writeB32(grAb, image.offset().y);
+			PNGCodec::writeChunk(png, "grAb", grAb.data(), 8);
 		}
 
 		// Create alPh chunk if it's an alpha map
 		if (type == SImage::Type::AlphaMap)
-		{
-			PNGChunk alPh("alPh");
-			alPh.write(data);
-		}
+			PNGCodec::writeChunk(png, "alPh", nullptr, 0);
 
 		// Write remaining PNG data
-		data.write(png_data + 33, png.size() - 33);
+		if (!plte.empty())
+			PNGCodec::writeChunk(png, "PLTE", plte.data(), plte.size());
+		if (!trns.empty())
+			PNGCodec::writeChunk(png, "tRNS", trns.data(), trns.size());
+		PNGCodec::writeChunk(png, "IDAT", idat.data(), idat.size());
+		PNGCodec::writeChunk(png, "IEND", nullptr, 0);
 
-		// Clean up
-		wxRemoveFile(App::path("temp.png", App::Dir::Temp));
+		data.importMem(png.data(), png.size());
 
 		// Success
 		return true;
 	}
 
 private:
-	// grAb chunk struct
-	struct GrabChunk
+	// Reads offsets from the grAb chunk in [chunks] to [xoff] and [yoff], and
+	// sets [alPh] to true if there is an alPh chunk
+	static void readInfoChunks(const vector<PNGCodec::Chunk>& chunks, int& xoff, int& yoff, bool& alPh)
 	{
-		int32_t xoff;
-		int32_t yoff;
-	};
+		for (auto& chunk : chunks)
+		{
+			if (chunk.type == "grAb" && chunk.size >= 8)
+			{
+				xoff = (int32_t)PNGCodec::readB32(chunk.data);
+				yoff = (int32_t)PNGCodec::readB32(chunk.data + 4);
+			}
+			else if (chunk.type == "alPh")
+				alPh = true;
+		}
+	}
 
-	// IHDR chunk struct
-	struct IhdrChunk
+	// Returns the SImage type to load a PNG with [header] as.
+	// Only 8bit paletted or greyscale PNGs are loaded as paletted (or alpha
+	// maps, if they have an alPh chunk), all others are converted to RGBA
+	static SImage::Type imageType(const PNGCodec::Header& header, bool alPh)
 	{
-		uint32_t width;
-		uint32_t height;
-		uint8_t  bpp;
-		uint8_t  coltype;
-		uint8_t  compression;
-		uint8_t  filter;
-		uint8_t  interlace;
-	};
+		if (header.bit_depth != 8 || (header.colour_type != 0 && header.colour_type != 3))
+			return SImage::Type::RGBA;
+
+		return alPh ? SImage::Type::AlphaMap : SImage::Type::PalMask;
+	}
 };
@@ -35,6 +35,7 @@
 #include "Archive/Archive.h"
 #include "Archive/EntryType/EntryType.h"
 #include "General/Misc.h"
+#include "Graphics/PNGCodec.h"
 #include "SIFormat.h"
 
 
@@ -43,6 +44,7 @@
 // Variables
 //
 // -----------------------------------------------------------------------------
+CVAR(Bool, gfx_extraconv, false, CVar::Flag::Save)
 namespace
 {
 vector<SIFormat*> simage_formats;
@@ -53,14 +55,6 @@ SIFormat*         sif_unknown = nullptr;
 } // namespace
 
 
-// -----------------------------------------------------------------------------
-//
-// External Variables
-//
-// -----------------------------------------------------------------------------
-EXTERN_CVAR(Bool, gfx_extraconv)
-
-
 // -----------------------------------------------------------------------------
 //
 // SIF* Classes
@@ -36,6 +36,7 @@
 #include "Graphics/Translation.h"
 #include "SIFormat.h"
 #include "Utility/MathStuff.h"
+#include <unordered_map>
 
 #undef BOOL
 
@@ -336,6 +337,106 @@ void SImage::clearData(bool clear_mask)
 		mask_.clear();
 }
 
+// -----------------------------------------------------------------------------
+// Returns the index of the colour in [pal] that each pixel of the (RGBA) image
+// matches exactly, or -1 for pixels that don't match a palette colour
+// -----------------------------------------------------------------------------
+vector<short> SImage::exactPaletteIndices(Palette* pal) const
+{
+	vector<short> indices(width_ * height_);
+
+	// Images tend to use few distinct colours, so remember the index found for
+	// each rather than searching the palette for every pixel
+	std::unordered_map<uint32_t, short> found;
+	for (int p = 0; p < width_ * height_; p++)
+	{
+		auto q   = p * 4;
+		auto rgb = (uint32_t)data_[q] << 16 | (uint32_t)data_[q + 1] << 8 | data_[q + 2];
+		auto it  = found.find(rgb);
+		if (it == found.end())
+		{
+			ColRGBA col(data_[q], data_[q + 1], data_[q + 2]);
+			auto    index = pal->nearestColour(col);
+			it            = found.emplace(rgb, col.equals(pal->colour(index)) ? index : -1).first;
+		}
+		indices[p] = it->second;
+	}
+
+	return indices;
+}
+
+// -----------------------------------------------------------------------------
+// Applies the compiled translation [table] to the image, converting it to
+// RGBA if [truecolor] is true. [pal_indices] are the palette indices of each
+// pixel for RGBA images (see exactPaletteIndices)
+// -----------------------------------------------------------------------------
+void SImage::applyTranslationTable(const Translation::Table& table, bool truecolor, const vector<short>& pal_indices)
+{
+	auto n_pixels = width_ * height_;
+	auto mask     = mask_.hasData() ? mask_.data() : nullptr;
+	auto data     = data_.data();
+
+	// Truecolor image, translate pixels matching a palette colour in place
+	if (type_ == Type::RGBA)
+	{
+		for (int p = 0; p < n_pixels; p++)
+		{
+			auto index = pal_indices[p];
+			if (index < 0 || (mask && mask[p] == 0))
+				continue;
+
+			auto& col   = table.colours[index];
+			auto  q     = p * 4;
+			data[q + 0] = col.r;
+			data[q + 1] = col.g;
+			data[q + 2] = col.b;
+			data[q + 3] = mask ? mask[p] : table.keep_alpha[index] ? data[q + 3] : col.a;
+		}
+	}
+
+	// Paletted to truecolor, write translated colours to new RGBA data
+	else if (truecolor)
+	{
+		vector<uint8_t> newdata(n_pixels * 4);
+		for (int p = 0; p < n_pixels; p++)
+		{
+			if (mask && mask[p] == 0)
+				continue;
+
+			auto& col      = table.colours[data[p]];
+			auto  q        = p * 4;
+			newdata[q + 0] = col.r;
+			newdata[q + 1] = col.g;
+			newdata[q + 2] = col.b;
+			newdata[q + 3] = mask ? mask[p] : col.a;
+		}
+
+		clearData(true);
+		data_.importMem(newdata.data(), n_pixels * 4);
+		type_ = Type::RGBA;
+	}
+
+	// Paletted, just remap the indices
+	else
+	{
+		uint8_t remap[256];
+		for (int i = 0; i < 256; i++)
+			remap[i] = table.colours[i].index;
+
+		if (mask)
+		{
+			for (int p = 0; p < n_pixels; p++)
+				if (mask[p])
+					data[p] = remap[data[p]];
+		}
+		else
+		{
+			for (int p = 0; p < n_pixels; p++)
+				data[p] = remap[data[p]];
+		}
+	}
+}
+
 // -----------------------------------------------------------------------------
 // Creates an empty image
 // -----------------------------------------------------------------------------
@@ -1269,65 +1370,29 @@ bool SImage::applyTranslation(Translation* tr, Palette* pal, bool truecolor)
 	if (type_ == Type::AlphaMap)
 		return false;
 
-	// Handle truecolor images
-	if (type_ == Type::RGBA)
-		truecolor = true;
-	size_t bpp = this->bpp();
-
 	// Get palette to use
 	if (has_palette_ || !pal)
 		pal = &palette_;
 
-	uint8_t* newdata = nullptr;
-	if (truecolor && type_ == Type::PalMask)
+	// Find the palette indices used in the image, only those need translating
+	bool          used[256] = {};
+	vector<short> pal_indices;
+	if (type_ == Type::RGBA)
 	{
-		newdata = new uint8_t[width_ * height_ * 4];
-		memset(newdata, 0, width_ * height_ * 4);
+		pal_indices = exactPaletteIndices(pal);
+		for (auto index : pal_indices)
+			if (index >= 0)
+				used[index] = true;
 	}
 	else
-		newdata = data_.data();
-
-	// Go through pixels
-	for (int p = 0; p < width_ * height_; p++)
 	{
-		// No need to process transparent pixels
-		if (mask_.hasData() && mask_[p] == 0)
-			continue;
-
-		ColRGBA col;
-		int     q = p * bpp;
-		if (type_ == Type::PalMask)
-			col.set(pal->colour(data_[p]));
-		else if (type_ == Type::RGBA)
-		{
-			col.set(data_[q], data_[q + 1], data_[q + 2], data_[q + 3]);
-
-			// skip colours that don't match exactly to the palette
-			col.index = pal->nearestColour(col);
-			if (!col.equals(pal->colour(col.index)))
-				continue;
-		}
-
-		col = tr->translate(col, pal);
-
-		if (truecolor)
-		{
-			q              = p * 4;
-			newdata[q + 0] = col.r;
-			newdata[q + 1] = col.g;
-			newdata[q + 2] = col.b;
-			newdata[q + 3] = mask_.hasData() ? mask_[p] : col.a;
-		}
-		else
-			data_[p] = col.index;
+		for (int p = 0; p < width_ * height_; p++)
+			used[data_[p]] = true;
 	}
 
-	if (truecolor && type_ == Type::PalMask)
-	{
-		clearData(true);
-		data_.importMem(newdata, width_ * height_ * 4);
-		type_ = Type::RGBA;
-	}
+	Translation::Table table;
+	tr->compile(table, pal, type_ == Type::RGBA, used);
+	applyTranslationTable(table, truecolor, pal_indices);
 
 	return true;
 }
@@ -1337,10 +1402,25 @@ bool SImage::applyTranslation(Translation* tr, Palette* pal, bool truecolor)
 // -----------------------------------------------------------------------------
 bool SImage::applyTranslation(const wxString& tr, Palette* pal, bool truecolor)
 {
-	Translation trans;
-	trans.clear();
-	trans.parse(tr);
-	return applyTranslation(&trans, pal, truecolor);
+	// Check image is ok
+	if (!data_.hasData())
+		return false;
+
+	// Can't apply a translation to a non-coloured image
+	if (type_ == Type::AlphaMap)
+		return false;
+
+	// Get palette to use
+	if (has_palette_ || !pal)
+		pal = &palette_;
+
+	auto          table = Translation::compiled(tr, pal, type_ == Type::RGBA);
+	vector<short> pal_indices;
+	if (type_ == Type::RGBA)
+		pal_indices = exactPaletteIndices(pal);
+	applyTranslationTable(*table, truecolor, pal_indices);
+
+	return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -2,8 +2,8 @@
 
 #include "General/ListenerAnnouncer.h"
 #include "Graphics/Palette/Palette.h"
+#include "Graphics/Translation.h"
 
-class Translation;
 class SIFormat;
 
 class SImage : public Announcer
@@ -178,5 +178,10 @@ private:
 	int numimages_ = 1;
 
 	// Internal functions
-	void clearData(bool clear_mask = true);
+	void          clearData(bool clear_mask = true);
+	vector<short> exactPaletteIndices(Palette* pal) const;
+	void          applyTranslationTable(
+		const Translation::Table& table,
+		bool                      truecolor,
+		const vector<short>&      pal_indices);
 };
@@ -45,6 +45,8 @@
 #include "Palette/Palette.h"
 #include "Utility/StringUtils.h"
 #include "Utility/Tokenizer.h"
+#include <mutex>
+#include <unordered_map>
 
 
 // -----------------------------------------------------------------------------
@@ -55,6 +57,13 @@
 EXTERN_CVAR(Float, col_greyscale_r)
 EXTERN_CVAR(Float, col_greyscale_g)
 EXTERN_CVAR(Float, col_greyscale_b)
+EXTERN_CVAR(Int, col_match)
+EXTERN_CVAR(Float, col_match_r)
+EXTERN_CVAR(Float, col_match_g)
+EXTERN_CVAR(Float, col_match_b)
+EXTERN_CVAR(Float, col_match_h)
+EXTERN_CVAR(Float, col_match_s)
+EXTERN_CVAR(Float, col_match_l)
 
 
 // -----------------------------------------------------------------------------
@@ -160,9 +169,9 @@ void Translation::parse(wxString def)
 	Tokenizer tz;
 	tz.setSpecialCharacters(",");
 	tz.openString(def.ToStdString());
-	parseRange(tz.current().text);
+	parseRange(tz.current().text());
 	while (tz.advIfNext(','))
-		parseRange(tz.next().text);
+		parseRange(tz.next().text());
 }
 
 // -----------------------------------------------------------------------------
@@ -318,7 +327,7 @@ void Translation::parseRange(const wxString& range)
 	}
 	else if (tz.advIfNext('$'))
 	{
-		translations_.emplace_back(new TransRangeSpecial{ { o_start, o_end }, tz.next().text });
+		translations_.emplace_back(new TransRangeSpecial{ { o_start, o_end }, tz.next().text() });
 	}
 	else
 	{
@@ -713,6 +722,42 @@ ColRGBA Translation::specialBlend(ColRGBA col, uint8_t type, Palette* pal) const
 	return colour;
 }
 
+// -----------------------------------------------------------------------------
+// Compiles the translation against [pal] into [table], by translating each
+// palette index. If [indices] is given, only the indices set in it are
+// translated.
+// If [truecolour_src] is true the table is for truecolour images, where a
+// pixel's alpha can differ from its palette colour's, so each index is
+// translated at alpha 0 and 255 to find whether the result keeps the source
+// alpha (translations only ever keep it or replace it)
+// -----------------------------------------------------------------------------
+void Translation::compile(Table& table, Palette* pal, bool truecolour_src, const bool* indices)
+{
+	if (pal == nullptr)
+		pal = MainEditor::currentPalette();
+
+	for (int i = 0; i < 256; ++i)
+	{
+		if (indices && !indices[i])
+			continue;
+
+		if (!truecolour_src)
+		{
+			table.colours[i] = translate(pal->colour(i), pal);
+			continue;
+		}
+
+		auto col  = pal->colour(i);
+		col.index = i;
+		col.a     = 0;
+		auto zero = translate(col, pal);
+		col.a     = 255;
+
+		table.colours[i]    = translate(col, pal);
+		table.keep_alpha[i] = zero.a == 0 && table.colours[i].a == 255;
+	}
+}
+
 // -----------------------------------------------------------------------------
 // Adds a new translation range of [type] at [pos] in the list
 // -----------------------------------------------------------------------------
@@ -867,3 +912,53 @@ wxString Translation::getPredefined(wxString def)
 
 	return def;
 }
+
+// -----------------------------------------------------------------------------
+// Returns the translation [def] compiled against [pal] (see compile above).
+// Compiled tables are cached by definition, palette and colour matching
+// settings, since the same translations tend to be applied over and over (eg.
+// to thing sprites in the map editor)
+// -----------------------------------------------------------------------------
+std::shared_ptr<const Translation::Table> Translation::compiled(
+	const wxString& def,
+	Palette*        pal,
+	bool            truecolour_src)
+{
+	static std::unordered_map<std::string, std::shared_ptr<const Table>> cache;
+	static std::mutex                                                      cache_mutex;
+
+	if (pal == nullptr)
+		pal = MainEditor::currentPalette();
+
+	// Build key
+	std::string key = def.ToStdString();
+	key += truecolour_src ? '\1' : '\0';
+	for (int i = 0; i < 256; ++i)
+	{
+		auto col = pal->colour(i);
+		key.append({ (char)col.r, (char)col.g, (char)col.b, (char)col.a, (char)col.index });
+	}
+	double settings[] = { (double)col_match, col_match_r,     col_match_g,     col_match_b,     col_match_h,
+						  col_match_s,        col_match_l,     col_greyscale_r, col_greyscale_g, col_greyscale_b };
+	key.append((const char*)settings, sizeof(settings));
+
+	{
+		std::lock_guard<std::mutex> lock(cache_mutex);
+		auto                        cached = cache.find(key);
+		if (cached != cache.end())
+			return cached->second;
+	}
+
+	// Not cached, compile it
+	Translation translation;
+	translation.parse(def);
+	auto table = std::make_shared<Table>();
+	translation.compile(*table, pal, truecolour_src);
+
+	std::lock_guard<std::mutex> lock(cache_mutex);
+	if (cache.size() >= 256)
+		cache.clear();
+	cache[key] = table;
+
+	return table;
+}
@@ -260,6 +260,14 @@ class Palette;
 class Translation
 {
 public:
+	// A translation compiled against a palette: the translated colour of each
+	// palette index, so it can be applied to an image with a lookup per pixel
+	struct Table
+	{
+		ColRGBA colours[256];
+		bool    keep_alpha[256] = {}; // Colour takes the alpha of the source pixel (truecolour sources only)
+	};
+
 	Translation()  = default;
 	~Translation() = default;
 
@@ -278,12 +286,14 @@ public:
 
 	ColRGBA translate(ColRGBA col, Palette* pal = nullptr);
 	ColRGBA specialBlend(ColRGBA col, uint8_t type, Palette* pal = nullptr) const;
+	void    compile(Table& table, Palette* pal, bool truecolour_src, const bool* indices = nullptr);
 
 	void addRange(TransRange::Type type, int pos);
 	void removeRange(int pos);
 	void swapRanges(int pos1, int pos2);
 
-	static wxString getPredefined(wxString def);
+	static wxString                     getPredefined(wxString def);
+	static std::shared_ptr<const Table> compiled(const wxString& def, Palette* pal, bool truecolour_src);
 
 private:
 	vector<TransRange::UPtr> translations_;
@@ -0,0 +1,183 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2019 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    HeadlessEditor.cpp
+// Description: MainEditor namespace functions for tools built on the core
+//              library without the GUI (eg. slade_bench). There is no main
+//              window, so there is never a 'current' archive or entry, and the
+//              'current' palette is the global palette of the archive last
+//              given to setGlobalPaletteFromArchive on the calling thread
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "MainEditor/MainEditor.h"
+#include "App.h"
+#include "Archive/Archive.h"
+#include "General/Misc.h"
+#include "Graphics/Palette/PaletteManager.h"
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace MainEditor
+{
+// Per-thread, so that tools processing several archives at once (eg. slade_cli)
+// don't share (or race on) one archive's palette
+thread_local Palette pal_global;
+thread_local bool    pal_global_set = false;
+} // namespace MainEditor
+
+
+// -----------------------------------------------------------------------------
+//
+// MainEditor Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Does nothing, there's no main editor window to initialise
+// -----------------------------------------------------------------------------
+bool MainEditor::init()
+{
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns nullptr, there's no main window
+// -----------------------------------------------------------------------------
+MainWindow* MainEditor::window()
+{
+	return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Returns nullptr, there's no main window
+// -----------------------------------------------------------------------------
+wxWindow* MainEditor::windowWx()
+{
+	return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Returns nullptr, there's no current archive
+// -----------------------------------------------------------------------------
+Archive* MainEditor::currentArchive()
+{
+	return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Returns nullptr, there's no current entry
+// -----------------------------------------------------------------------------
+ArchiveEntry* MainEditor::currentEntry()
+{
+	return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Returns an empty list, there's no current entry selection
+// -----------------------------------------------------------------------------
+vector<ArchiveEntry*> MainEditor::currentEntrySelection()
+{
+	return {};
+}
+
+// -----------------------------------------------------------------------------
+// Returns the palette for [entry] (from its archive), or the global palette
+// (see setGlobalPaletteFromArchive) if no entry is given.
+// Works the same as the 'Existing/Global' option of the GUI palette chooser
+// -----------------------------------------------------------------------------
+Palette* MainEditor::currentPalette(ArchiveEntry* entry)
+{
+	if (!pal_global_set)
+		pal_global.copyPalette(App::paletteManager()->globalPalette());
+
+	if (entry)
+		Misc::loadPaletteFromArchive(&pal_global, entry->parent(), Misc::detectPaletteHack(entry));
+
+	pal_global_set = true;
+	return &pal_global;
+}
+
+// -----------------------------------------------------------------------------
+// Returns nullptr, there are no entry panels
+// -----------------------------------------------------------------------------
+EntryPanel* MainEditor::currentEntryPanel()
+{
+	return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Does nothing, there's no texture editor
+// -----------------------------------------------------------------------------
+void MainEditor::openTextureEditor(Archive* archive, ArchiveEntry* entry) {}
+
+// -----------------------------------------------------------------------------
+// Does nothing, there's no map editor
+// -----------------------------------------------------------------------------
+void MainEditor::openMapEditor(Archive* archive) {}
+
+// -----------------------------------------------------------------------------
+// Does nothing, there are no archive tabs
+// -----------------------------------------------------------------------------
+void MainEditor::openArchiveTab(Archive* archive) {}
+
+// -----------------------------------------------------------------------------
+// Does nothing, there are no entry panels
+// -----------------------------------------------------------------------------
+void MainEditor::openEntry(ArchiveEntry* entry) {}
+
+// -----------------------------------------------------------------------------
+// Sets the global palette for the calling thread to the palette in [archive]
+// (or its parent archive if it doesn't have one), or to the default global
+// palette if [archive] is null
+// -----------------------------------------------------------------------------
+void MainEditor::setGlobalPaletteFromArchive(Archive* archive)
+{
+	pal_global_set = true;
+
+	while (archive)
+	{
+		if (Misc::loadPaletteFromArchive(&pal_global, archive))
+			return;
+
+		archive = archive->parentArchive();
+	}
+
+	pal_global.copyPalette(App::paletteManager()->globalPalette());
+}
+
+#ifdef USE_WEBVIEW_STARTPAGE
+// -----------------------------------------------------------------------------
+// Does nothing, there's no documentation tab
+// -----------------------------------------------------------------------------
+void MainEditor::openDocs(const wxString& page_name) {}
+#endif
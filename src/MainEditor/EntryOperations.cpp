@@ -42,6 +42,7 @@
 #include "General/Console/Console.h"
 #include "General/Misc.h"
 #include "Graphics/GameFormats.h"
+#include "Graphics/PNGOptimizer.h"
 #include "MainEditor/MainEditor.h"
 #include "SLADEWxApp.h"
 #include "UI/Controls/PaletteChooser.h"
@@ -58,9 +59,6 @@
 // -----------------------------------------------------------------------------
 CVAR(String, path_acc, "", CVar::Flag::Save);
 CVAR(String, path_acc_libs, "", CVar::Flag::Save);
-CVAR(String, path_pngout, "", CVar::Flag::Save);
-CVAR(String, path_pngcrush, "", CVar::Flag::Save);
-CVAR(String, path_deflopt, "", CVar::Flag::Save);
 CVAR(String, path_db2, "", CVar::Flag::Save)
 CVAR(Bool, acc_always_show_output, false, CVar::Flag::Save);
 
@@ -1433,7 +1431,8 @@ bool EntryOperations::exportAsPNG(ArchiveEntry* entry, const wxString& filename)
 }
 
 // -----------------------------------------------------------------------------
-// Attempts to optimize [entry] using external PNG optimizers.
+// Attempts to optimize [entry] by re-encoding it with PNGOptimizer.
+// The entry data is only replaced if the optimized PNG is smaller
 // -----------------------------------------------------------------------------
 bool EntryOperations::optimizePNG(ArchiveEntry* entry)
 {
@@ -1452,198 +1451,22 @@ bool EntryOperations::optimizePNG(ArchiveEntry* entry)
 		return false;
 	}
 
-	// Check if the PNG tools path are set up, at least one of them should be
-	wxString pngpathc = path_pngcrush;
-	wxString pngpatho = path_pngout;
-	wxString pngpathd = path_deflopt;
-	if ((pngpathc.IsEmpty() || !wxFileExists(pngpathc)) && (pngpatho.IsEmpty() || !wxFileExists(pngpatho))
-		&& (pngpathd.IsEmpty() || !wxFileExists(pngpathd)))
+	// Optimize
+	MemChunk optimized;
+	wxString error;
+	if (!PNGOptimizer::optimize(entry->data(), optimized, error))
 	{
-		Log::error(1, "PNG tool paths not defined or invalid, no optimization done.");
+		Log::warning(wxString::Format("Unable to optimize PNG %s: %s", entry->name(), error));
 		return false;
 	}
 
-	// Save special chunks
-	Vec2i         offsets;
-	bool          alphchunk     = getalPhChunk(entry);
-	bool          grabchunk     = readgrAbChunk(entry, offsets);
-	wxString      errormessages = "";
-	wxArrayString output;
-	wxArrayString errors;
-	size_t        oldsize   = entry->size();
-	size_t        crushsize = 0, outsize = 0, deflsize = 0;
-	bool          crushed = false, outed = false;
-
-	// Run PNGCrush
-	if (!pngpathc.IsEmpty() && wxFileExists(pngpathc))
-	{
-		wxFileName fn(pngpathc);
-		fn.SetExt("opt");
-		wxString pngfile = fn.GetFullPath();
-		fn.SetExt("png");
-		wxString optfile = fn.GetFullPath();
-		entry->exportFile(pngfile.ToStdString());
-
-		wxString command = path_pngcrush + " -brute \"" + pngfile + "\" \"" + optfile + "\"";
-		output.Empty();
-		errors.Empty();
-		wxExecute(command, output, errors, wxEXEC_SYNC);
-
-		if (wxFileExists(optfile))
-		{
-			if (optfile.size() < oldsize)
-			{
-				entry->importFile(optfile.ToStdString());
-				wxRemoveFile(optfile);
-				wxRemoveFile(pngfile);
-			}
-			else
-				errormessages += "PNGCrush failed to reduce file size further.\n";
-			crushed = true;
-		}
-		else
-			errormessages += "PNGCrush failed to create optimized file.\n";
-		crushsize = entry->size();
-
-		// send app output to console if wanted
-		if (false)
-		{
-			wxString crushlog = "";
-			if (errors.GetCount())
-			{
-				crushlog += "PNGCrush error messages:\n";
-				for (size_t i = 0; i < errors.GetCount(); ++i)
-					crushlog += errors[i] + "\n";
-				errormessages += crushlog;
-			}
-			if (output.GetCount())
-			{
-				crushlog += "PNGCrush output messages:\n";
-				for (size_t i = 0; i < output.GetCount(); ++i)
-					crushlog += output[i] + "\n";
-			}
-			Log::info(1, crushlog);
-		}
-	}
-
-	// Run PNGOut
-	if (!pngpatho.IsEmpty() && wxFileExists(pngpatho))
-	{
-		wxFileName fn(pngpatho);
-		fn.SetExt("opt");
-		wxString pngfile = fn.GetFullPath();
-		fn.SetExt("png");
-		wxString optfile = fn.GetFullPath();
-		entry->exportFile(pngfile.ToStdString());
-
-		wxString command = path_pngout + " /y \"" + pngfile + "\" \"" + optfile + "\"";
-		output.Empty();
-		errors.Empty();
-		wxExecute(command, output, errors, wxEXEC_SYNC);
-
-		if (wxFileExists(optfile))
-		{
-			if (optfile.size() < oldsize)
-			{
-				entry->importFile(optfile.ToStdString());
-				wxRemoveFile(optfile);
-				wxRemoveFile(pngfile);
-			}
-			else
-				errormessages += "PNGout failed to reduce file size further.\n";
-			outed = true;
-		}
-		else if (!crushed)
-			// Don't treat it as an error if PNGout couldn't create a smaller file than PNGCrush
-			errormessages += "PNGout failed to create optimized file.\n";
-		outsize = entry->size();
-
-		// send app output to console if wanted
-		if (false)
-		{
-			wxString pngoutlog = "";
-			if (errors.GetCount())
-			{
-				pngoutlog += "PNGOut error messages:\n";
-				for (size_t i = 0; i < errors.GetCount(); ++i)
-					pngoutlog += errors[i] + "\n";
-				errormessages += pngoutlog;
-			}
-			if (output.GetCount())
-			{
-				pngoutlog += "PNGOut output messages:\n";
-				for (size_t i = 0; i < output.GetCount(); ++i)
-					pngoutlog += output[i] + "\n";
-			}
-			Log::info(1, pngoutlog);
-		}
-	}
-
-	// Run deflopt
-	if (!pngpathd.IsEmpty() && wxFileExists(pngpathd))
-	{
-		wxFileName fn(pngpathd);
-		fn.SetExt("png");
-		wxString pngfile = fn.GetFullPath();
-		entry->exportFile(pngfile.ToStdString());
-
-		wxString command = path_deflopt + " /sf \"" + pngfile + "\"";
-		output.Empty();
-		errors.Empty();
-		wxExecute(command, output, errors, wxEXEC_SYNC);
-
-		entry->importFile(pngfile.ToStdString());
-		wxRemoveFile(pngfile);
-		deflsize = entry->size();
-
-		// send app output to console if wanted
-		if (false)
-		{
-			wxString defloptlog = "";
-			if (errors.GetCount())
-			{
-				defloptlog += "DeflOpt error messages:\n";
-				for (size_t i = 0; i < errors.GetCount(); ++i)
-					defloptlog += errors[i] + "\n";
-				errormessages += defloptlog;
-			}
-			if (output.GetCount())
-			{
-				defloptlog += "DeflOpt output messages:\n";
-				for (size_t i = 0; i < output.GetCount(); ++i)
-					defloptlog += output[i] + "\n";
-			}
-			Log::info(1, defloptlog);
-		}
-	}
-	output.Clear();
-	errors.Clear();
-
-	// Rewrite special chunks
-	if (alphchunk)
-		modifyalPhChunk(entry, true);
-	if (grabchunk)
-		setGfxOffsets(entry, offsets.x, offsets.y);
+	// Replace entry data if smaller
+	auto oldsize = entry->size();
+	if (optimized.size() < oldsize)
+		entry->importMemChunk(optimized);
 
 	Log::info(wxString::Format(
-		"PNG %s size %i =PNGCrush=> %i =PNGout=> %i =DeflOpt=> %i =+grAb/alPh=> %i",
-		entry->name(),
-		oldsize,
-		crushsize,
-		outsize,
-		deflsize,
-		entry->size()));
-
-
-	if (!crushed && !outed && !errormessages.IsEmpty())
-	{
-		ExtMessageDialog dlg(nullptr, "Optimizing Report");
-		dlg.setMessage("The following issues were encountered while optimizing:");
-		dlg.setExt(errormessages);
-		dlg.ShowModal();
-
-		return false;
-	}
+		"PNG %s size %u => %u (%u bytes saved)", entry->name(), oldsize, entry->size(), oldsize - entry->size()));
 
 	return true;
 }
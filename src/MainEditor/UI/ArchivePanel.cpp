@@ -63,6 +63,7 @@
 #include "General/UI.h"
 #include "Graphics/Icons.h"
 #include "Graphics/Palette/PaletteManager.h"
+#include "Graphics/PNGOptimizer.h"
 #include "MainEditor/ArchiveOperations.h"
 #include "MainEditor/Conversions.h"
 #include "MainEditor/EntryOperations.h"
@@ -73,8 +74,11 @@
 #include "Scripting/ScriptManager.h"
 #include "UI/Controls/PaletteChooser.h"
 #include "UI/Controls/SIconButton.h"
+#include "Utility/Parallel.h"
 #include "Utility/SFileDialog.h"
 #include "Utility/StringUtils.h"
+#include <atomic>
+#include <thread>
 
 
 // -----------------------------------------------------------------------------
@@ -104,9 +108,6 @@ CVAR(Bool, archive_build_skip_hidden, true, CVar::Flag::Save)
 // External Variables
 //
 // -----------------------------------------------------------------------------
-EXTERN_CVAR(String, path_pngout)
-EXTERN_CVAR(String, path_pngcrush)
-EXTERN_CVAR(String, path_deflopt)
 EXTERN_CVAR(Bool, confirm_entry_revert)
 
 
@@ -844,7 +845,8 @@ bool ArchivePanel::importFiles()
 		undo_manager_->beginRecord("Import Files");
 
 		// Go through the list of files
-		bool ok = false;
+		Announcer::Batch batch;
+		bool             ok = false;
 		entry_list_->Show(false);
 		UI::showSplash("Importing Files...", true);
 		entry_list_->setEntriesAutoUpdate(false);
@@ -1187,6 +1189,7 @@ bool ArchivePanel::deleteEntry(bool confirm)
 	undo_manager_->beginRecord("Delete Entry");
 
 	// Go through the selected entries
+	Announcer::Batch batch;
 	entry_list_->setEntriesAutoUpdate(false);
 	for (int a = selected_entries.size() - 1; a >= 0; a--)
 	{
@@ -1874,18 +1877,21 @@ bool ArchivePanel::pasteEntry() const
 	bool pasted = false;
 	undo_manager_->beginRecord("Paste Entry");
 	entry_list_->setEntriesAutoUpdate(false);
-	for (unsigned a = 0; a < App::clipboard().size(); a++)
 	{
-		// Check item type
-		if (App::clipboard().item(a)->type() != ClipboardItem::Type::EntryTree)
-			continue;
+		Announcer::Batch batch;
+		for (unsigned a = 0; a < App::clipboard().size(); a++)
+		{
+			// Check item type
+			if (App::clipboard().item(a)->type() != ClipboardItem::Type::EntryTree)
+				continue;
 
-		// Get clipboard item
-		auto clip = dynamic_cast<EntryTreeClipboardItem*>(App::clipboard().item(a));
+			// Get clipboard item
+			auto clip = dynamic_cast<EntryTreeClipboardItem*>(App::clipboard().item(a));
 
-		// Merge it in
-		if (archive_->paste(clip->tree(), index, entry_list_->currentDir()))
-			pasted = true;
+			// Merge it in
+			if (archive_->paste(clip->tree(), index, entry_list_->currentDir()))
+				pasted = true;
+		}
 	}
 	undo_manager_->endRecord(true);
 	entry_list_->setEntriesAutoUpdate(true);
@@ -2629,46 +2635,72 @@ bool ArchivePanel::compileACS(bool hexen) const
 }
 
 // -----------------------------------------------------------------------------
-// Compiles any selected text entries as ACS scripts
+// Optimizes any selected PNG entries.
+// Each PNG is re-encoded independently, so they are optimized across all
+// available hardware threads before the results are applied (with undo)
 // -----------------------------------------------------------------------------
 bool ArchivePanel::optimizePNG() const
 {
-	// Check if the PNG tools path are set up, at least one of them should be
-	wxString pngpathc = path_pngcrush;
-	wxString pngpatho = path_pngout;
-	wxString pngpathd = path_deflopt;
-	if ((pngpathc.IsEmpty() || !wxFileExists(pngpathc)) && (pngpatho.IsEmpty() || !wxFileExists(pngpatho))
-		&& (pngpathd.IsEmpty() || !wxFileExists(pngpathd)))
-	{
-		wxMessageBox(
-			"Error: PNG tool paths not defined or invalid, please configure in SLADE preferences",
-			"Error",
-			wxOK | wxCENTRE | wxICON_ERROR);
+	// Get selected PNG entries
+	vector<ArchiveEntry*> entries;
+	for (auto entry : entry_list_->selectedEntries())
+		if (entry->type()->formatId() == "img_png")
+			entries.push_back(entry);
+	if (entries.empty())
 		return false;
-	}
-
-	// Get selected entries
-	auto selection = entry_list_->selectedEntries();
 
-	UI::showSplash("Running external programs, please wait...", true);
+	UI::showSplash("Optimizing PNG entries, please wait...", true);
+
+	// Copy entry data (entries can't be accessed from worker threads)
+	unsigned         count = entries.size();
+	vector<MemChunk> source(count);
+	for (unsigned a = 0; a < count; a++)
+		source[a].importMem(entries[a]->rawData(true), entries[a]->size());
+
+	// Optimize
+	vector<MemChunk>      optimized(count);
+	vector<wxString>      errors(count);
+	vector<char>          ok(count, 0);
+	std::atomic<unsigned> done{ 0 };
+	auto                  this_thread = std::this_thread::get_id();
+	parallelFor(count, 1, 0, [&](unsigned start, unsigned end) {
+		for (auto index = start; index < end; ++index)
+		{
+			if (std::this_thread::get_id() == this_thread)
+			{
+				UI::setSplashProgressMessage(std::string{ entries[index]->nameNoExt() });
+				UI::setSplashProgress((float)done / (float)count);
+			}
+			ok[index] = PNGOptimizer::optimize(source[index], optimized[index], errors[index]);
+			++done;
+		}
+	});
 
 	// Begin recording undo level
 	undo_manager_->beginRecord("Optimize PNG");
 
-	// Go through selection
+	// Apply results
+	size_t total_saved = 0;
 	entry_list_->setEntriesAutoUpdate(false);
-	for (unsigned a = 0; a < selection.size(); a++)
+	for (unsigned a = 0; a < count; a++)
 	{
-		if (a == selection.size() - 1)
-			entry_list_->setEntriesAutoUpdate(true);
+		auto entry = entries[a];
+		if (!ok[a])
+		{
+			Log::warning(wxString::Format("Unable to optimize PNG %s: %s", entry->name(), errors[a]));
+			continue;
+		}
 
-		UI::setSplashProgressMessage(std::string{ selection[a]->nameNoExt() });
-		UI::setSplashProgress(float(a) / float(selection.size()));
-		if (selection[a]->type()->formatId() == "img_png")
+		auto oldsize = entry->size();
+		if (optimized[a].size() < oldsize)
 		{
-			undo_manager_->recordUndoStep(std::make_unique<EntryDataUS>(selection[a]));
-			EntryOperations::optimizePNG(selection[a]);
+			undo_manager_->recordUndoStep(std::make_unique<EntryDataUS>(entry));
+			entry->importMemChunk(optimized[a]);
+			total_saved += oldsize - entry->size();
 		}
+
+		Log::info(wxString::Format(
+			"PNG %s size %u => %u (%u bytes saved)", entry->name(), oldsize, entry->size(), oldsize - entry->size()));
 	}
 	entry_list_->setEntriesAutoUpdate(true);
 	UI::hideSplash();
@@ -2676,6 +2708,8 @@ bool ArchivePanel::optimizePNG() const
 	// Finish recording undo level
 	undo_manager_->endRecord(true);
 
+	Log::info(wxString::Format("Optimized %u PNG entries, %lu bytes saved in total", count, total_saved));
+
 	return true;
 }
 
@@ -38,6 +38,7 @@
 #include "General/UI.h"
 #include "Graphics/Icons.h"
 #include "Graphics/Palette/PaletteManager.h"
+#include "Graphics/Palette/PaletteTables.h"
 #include "Graphics/SImage/SIFormat.h"
 #include "MainEditor/MainEditor.h"
 #include "MainEditor/UI/MainWindow.h"
@@ -51,10 +52,6 @@
 // Variables
 //
 // -----------------------------------------------------------------------------
-CVAR(Float, col_greyscale_r, 0.299, CVar::Flag::Save)
-CVAR(Float, col_greyscale_g, 0.587, CVar::Flag::Save)
-CVAR(Float, col_greyscale_b, 0.114, CVar::Flag::Save)
-
 namespace
 {
 wxString extensions =
@@ -514,6 +511,105 @@ private:
 };
 
 
+// -----------------------------------------------------------------------------
+// GenerateBlendTableDialog Class
+//
+// A simple dialog for the 'Generate Translucency Table' function, allows the
+// user to select the blend mode, amount and name of the table to generate
+// -----------------------------------------------------------------------------
+class GenerateBlendTableDialog : public wxDialog
+{
+public:
+	GenerateBlendTableDialog(wxWindow* parent) :
+		wxDialog(
+			parent,
+			-1,
+			"Generate Translucency Table",
+			wxDefaultPosition,
+			wxDefaultSize,
+			wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER)
+	{
+		// Set dialog icon
+		wxIcon icon;
+		icon.CopyFromBitmap(Icons::getIcon(Icons::General, "colormap"));
+		SetIcon(icon);
+
+		// Setup main sizer
+		auto msizer = new wxBoxSizer(wxVERTICAL);
+		SetSizer(msizer);
+		auto sizer = new wxBoxSizer(wxVERTICAL);
+		msizer->Add(sizer, 1, wxEXPAND | wxALL, UI::padLarge());
+
+		// Add entry name
+		auto hbox = new wxBoxSizer(wxHORIZONTAL);
+		sizer->Add(hbox, 0, wxEXPAND | wxBOTTOM, UI::pad());
+
+		text_name_ = new wxTextCtrl(this, -1, "TRANMAP");
+		hbox->Add(new wxStaticText(this, -1, "Entry Name:"), 0, wxALIGN_CENTER_VERTICAL | wxRIGHT, UI::pad());
+		hbox->Add(text_name_, 1, wxEXPAND);
+
+		// Add blend mode buttons
+		rb_translucent_ = new wxRadioButton(
+			this, -1, "Translucent (TRANMAP, TINTTAB)", wxDefaultPosition, wxDefaultSize, wxRB_GROUP);
+		sizer->Add(rb_translucent_, 0, wxEXPAND | wxBOTTOM, UI::pad());
+		rb_additive_ = new wxRadioButton(this, -1, "Additive");
+		sizer->Add(rb_additive_, 0, wxEXPAND | wxBOTTOM, UI::pad());
+		rb_subtractive_ = new wxRadioButton(this, -1, "Subtractive");
+		sizer->Add(rb_subtractive_, 0, wxEXPAND | wxBOTTOM, UI::pad());
+
+		// Add 'amount' slider (Boom's TRANMAP is 66%)
+		hbox = new wxBoxSizer(wxHORIZONTAL);
+		sizer->Add(hbox, 0, wxEXPAND | wxBOTTOM, UI::pad());
+
+		slider_amount_ = new wxSlider(this, -1, 66, 0, 100);
+		label_amount_  = new wxStaticText(this, -1, "100%");
+		hbox->Add(new wxStaticText(this, -1, "Amount:"), 0, wxALIGN_CENTER_VERTICAL | wxRIGHT, UI::pad());
+		hbox->Add(slider_amount_, 1, wxEXPAND | wxRIGHT, UI::pad());
+		hbox->Add(label_amount_, 0, wxALIGN_CENTER_VERTICAL);
+
+		// Add buttons
+		sizer->Add(CreateButtonSizer(wxOK | wxCANCEL), 0, wxEXPAND);
+
+		// Init layout
+		wxWindowBase::Layout();
+
+		// Bind events
+		slider_amount_->Bind(wxEVT_SLIDER, [&](wxCommandEvent&) {
+			label_amount_->SetLabel(wxString::Format("%d%% ", slider_amount_->GetValue()));
+		});
+
+		// Setup dialog size
+		SetInitialSize(wxSize(-1, -1));
+		wxTopLevelWindowBase::SetMinSize(GetSize());
+		CenterOnParent();
+
+		// Set values
+		label_amount_->SetLabel("66% ");
+	}
+
+	wxString entryName() const { return text_name_->GetValue(); }
+	float    amount() const { return (float)slider_amount_->GetValue() * 0.01f; }
+
+	PaletteTables::Blend blend() const
+	{
+		if (rb_additive_->GetValue())
+			return PaletteTables::Blend::Additive;
+		if (rb_subtractive_->GetValue())
+			return PaletteTables::Blend::Subtractive;
+
+		return PaletteTables::Blend::Translucent;
+	}
+
+private:
+	wxTextCtrl*    text_name_      = nullptr;
+	wxRadioButton* rb_translucent_ = nullptr;
+	wxRadioButton* rb_additive_    = nullptr;
+	wxRadioButton* rb_subtractive_ = nullptr;
+	wxSlider*      slider_amount_  = nullptr;
+	wxStaticText*  label_amount_   = nullptr;
+};
+
+
 // -----------------------------------------------------------------------------
 // PaletteGradientDialog Class
 //
@@ -1048,109 +1144,56 @@ bool PaletteEntryPanel::gradient()
 // -----------------------------------------------------------------------------
 // Generates a COLORMAP lump from the current palette
 // -----------------------------------------------------------------------------
-#define DIMINISH(color, level) color = (uint8_t)((((float)(color)) * (32.0 - level) + 16.0) / 32.0)
 bool PaletteEntryPanel::generateColormaps()
 {
-	static const int GREENMAP = 255;
-	static const int GRAYMAP  = 32;
-
 	if (!entry_ || !entry_->parent() || !palettes_[0])
 		return false;
 
 	MemChunk mc;
-	SImage   img;
-	MemChunk imc;
-	mc.reSize(34 * 256);
-	mc.seek(0, SEEK_SET);
-	imc.reSize(34 * 256 * 4);
-	imc.seek(0, SEEK_SET);
-	uint8_t rgba[4];
-	rgba[3] = 255;
-
-	ColRGBA rgb;
-	float   grey;
-	// Generate 34 maps: the first 32 for diminishing light levels,
-	// the 33th for the inverted grey map used by invulnerability.
-	// The 34th colormap remains empty and black.
-	for (size_t l = 0; l < 34; ++l)
-	{
-		for (size_t c = 0; c < 256; ++c)
-		{
-			rgb = palettes_[0]->colour(c);
-			if (l < 32)
-			{
-				// Generate light maps
-				DIMINISH(rgb.r, l);
-				DIMINISH(rgb.g, l);
-				DIMINISH(rgb.b, l);
-#if (0)
-			}
-			else if (l == GREENMAP)
-			{
-				// Point of mostly useless trivia: the green "light amp" colormap in the Press Release beta
-				// have colors that, on average, correspond to a bit less than (R*75/256, G*225/256, B*115/256)
-#endif
-			}
-			else if (l == GRAYMAP)
-			{
-				// Generate inverse map
-				grey = ((float)rgb.r / 256.0 * col_greyscale_r) + ((float)rgb.g / 256.0 * col_greyscale_g)
-					   + ((float)rgb.b / 256.0 * col_greyscale_b);
-				grey = 1.0 - grey;
-				// Clamp value: with Id Software's values, the sum is greater than 1.0 (0.299+0.587+0.144=1.030)
-				// This means the negation above can give a negative value (for example, with RGB values of 247 or
-				// more), which will not be converted correctly to unsigned 8-bit int in the ColRGBA struct.
-				if (grey < 0.0)
-					grey = 0;
-				rgb.r = rgb.g = rgb.b = grey * 255;
-			}
-			else
-			{
-				// Fill with 0
-				rgb = palettes_[0]->colour(0);
-			}
-			rgba[0] = rgb.r;
-			rgba[1] = rgb.g;
-			rgba[2] = rgb.b;
-			imc.write(&rgba, 4);
-			mc[(256 * l) + c] = palettes_[0]->nearestColour(rgb);
-		}
-	}
-#if 0
-	// Create truecolor image
-	uint8_t* imd = new uint8_t[256*34*4];
-	memcpy(imd, imc.getData(), 256*34*4);
-	img.setImageData(imd, 256, 34, RGBA);
-	// imd will be freed by img's destructor
-	ArchiveEntry* tcolormap;
-	string name = entry->getName(true) + "-tcm.png";
-	tcolormap = new ArchiveEntry(name);
-	if (tcolormap)
-	{
-		entry->getParent()->addEntry(tcolormap);
-		SIFormat::getFormat("png")->saveImage(img, tcolormap->getMCData());
-		EntryType::detectEntryType(tcolormap);
-	}
-#endif
-	// Now override or create new entry
-	ArchiveEntry* colormap;
-	colormap         = entry_->parent()->entry("COLORMAP", true);
-	bool preexisting = colormap != nullptr;
-	if (!colormap)
-	{
-		// We need to create this entry
-		colormap = new ArchiveEntry("COLORMAP.lmp", 34 * 256);
-	}
-	if (!colormap)
+	PaletteTables::generateColormap(*palettes_[0], mc);
+
+	return writeTable("COLORMAP", mc);
+}
+
+// -----------------------------------------------------------------------------
+// Generates a translucency (blend) table lump such as TRANMAP or TINTTAB from
+// the current palette
+// -----------------------------------------------------------------------------
+bool PaletteEntryPanel::generateBlendTable()
+{
+	if (!entry_ || !entry_->parent() || !palettes_[0])
 		return false;
-	colormap->importMemChunk(mc);
-	if (!preexisting)
-	{
-		entry_->parent()->addEntry(colormap);
-	}
+
+	GenerateBlendTableDialog dlg(theMainWindow);
+	if (dlg.ShowModal() != wxID_OK)
+		return false;
+
+	auto name = dlg.entryName().Trim().Trim(false).Upper();
+	if (name.empty())
+		return false;
+
+	MemChunk mc;
+	PaletteTables::generateBlendTable(*palettes_[0], dlg.blend(), dlg.amount(), mc);
+
+	return writeTable(name, mc);
+}
+
+// -----------------------------------------------------------------------------
+// Writes the generated table [data] to the entry [name] in the palette's
+// archive, creating it (as [name].lmp) if it doesn't exist
+// -----------------------------------------------------------------------------
+bool PaletteEntryPanel::writeTable(const wxString& name, MemChunk& data) const
+{
+	auto entry = entry_->parent()->entry(name.ToStdString(), true);
+	if (entry)
+		return entry->importMemChunk(data);
+
+	entry = new ArchiveEntry((name + ".lmp").ToStdString(), data.size());
+	entry->importMemChunk(data);
+	entry_->parent()->addEntry(entry);
+
 	return true;
 }
-#undef DIMINISH
 
 // -----------------------------------------------------------------------------
 // Just a helper for generatePalettes to make the code less redundant
@@ -1283,6 +1326,13 @@ bool PaletteEntryPanel::handleEntryPanelAction(const wxString& id)
 		return true;
 	}
 
+	// Generate Translucency Table
+	if (id == "ppal_blendtable")
+	{
+		generateBlendTable();
+		return true;
+	}
+
 	// Colourise
 	else if (id == "ppal_colourise")
 	{
@@ -1387,6 +1437,7 @@ bool PaletteEntryPanel::fillCustomMenu(wxMenu* custom)
 	SAction::fromId("ppal_remove")->addToMenu(custom);
 	SAction::fromId("ppal_removeothers")->addToMenu(custom);
 	SAction::fromId("ppal_colormap")->addToMenu(custom);
+	SAction::fromId("ppal_blendtable")->addToMenu(custom);
 	custom->AppendSeparator();
 	SAction::fromId("ppal_moveup")->addToMenu(custom);
 	SAction::fromId("ppal_movedown")->addToMenu(custom);
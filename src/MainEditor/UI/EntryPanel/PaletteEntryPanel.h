@@ -5,12 +5,11 @@
 
 /* TODO:
  * - Improve and enrich palette edition functions
- * - Add some COLORMAP generator or editor maybe. It should handle a fade
- *   to a given color (generally black for COLORMAP, but it might be grey
- *   like Hexen's FOGMAP for example) as well as special colormaps (e.g.,
- *   invulnerability) and invariant ranges (cf. Strife or Harmony). It
- *   should also be able to generate TINTTAB/XLATAB/TRANMAP used by Boom,
- *   Heretic, Hexen and Strife for translucency effects. Note: Hacx only
+ * - Add a COLORMAP editor maybe. The generator (see PaletteTables) can
+ *   fade to a given color (generally black for COLORMAP, but it might be
+ *   grey like Hexen's FOGMAP for example) but not yet handle invariant
+ *   ranges (cf. Strife or Harmony), and Strife's XLATAB needs its own
+ *   blend (it combines two translucency levels). Note: Hacx only
  *   features 33 ranges in its COLORMAP lump, while the other games have
  *   the full complement of 34 including one unused (a legacy of the Doom
  *   beta version which used a green colormap for the light amp visors).
@@ -37,6 +36,7 @@ public:
 
 	// Palette manipulation functions
 	bool generateColormaps();
+	bool generateBlendTable();
 	bool generatePalettes();
 	bool clearOne();
 	bool clearOthers();
@@ -65,6 +65,9 @@ private:
 	// A helper for generatePalettes() which has no reason to be called outside
 	void generatePalette(int r, int g, int b, int shift, int steps);
 
+	// A helper for the table generation functions, to write the result to the archive
+	bool writeTable(const wxString& name, MemChunk& data) const;
+
 	// Events
 	void onPalCanvasMouseEvent(wxMouseEvent& e);
 };
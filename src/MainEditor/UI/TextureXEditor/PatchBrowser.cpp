@@ -40,6 +40,7 @@
 #include "General/ResourceManager.h"
 #include "Graphics/CTexture/CTexture.h"
 #include "Graphics/CTexture/TextureXList.h"
+#include "Graphics/ImageDecodeQueue.h"
 #include "Graphics/SImage/SImage.h"
 #include "MainEditor/MainEditor.h"
 #include "MainEditor/UI/MainWindow.h"
@@ -64,41 +65,46 @@ PatchBrowserItem::~PatchBrowserItem()
 }
 
 // -----------------------------------------------------------------------------
-// Loads the item's image from its associated entry (if any)
+// Returns a function to decode the item's image from its associated entry or
+// texture (if any)
 // -----------------------------------------------------------------------------
-bool PatchBrowserItem::loadImage()
+ImageDecodeQueue::DecodeFunc PatchBrowserItem::imageDecoder()
 {
-	SImage img;
-
-	// Load patch image
+	// Patch image
 	if (type_ == Type::Patch)
 	{
 		// Find patch entry
 		auto entry = App::resources().getPatchEntry(name_, nspace_, archive_);
+		if (!entry)
+			return {};
 
-		// Load entry to image, if it exists
-		if (entry)
-			Misc::loadImageFromEntry(&img, entry);
-		else
-			return false;
+		auto image = std::make_shared<DetachedImage>(entry);
+		return [image](SImage& img) { return image->load(img); };
 	}
 
-	// Or, load texture image
+	// Or, texture image
 	if (type_ == Type::CTexture)
 	{
 		// Find texture
 		auto tex = App::resources().getTexture(name_, archive_);
+		if (!tex)
+			return {};
 
-		// Load texture to image, if it exists
-		if (tex)
-			tex->toImage(img, archive_, parent_->palette());
-		else
-			return false;
+		std::shared_ptr<CTexture> texture = tex->resolvedCopy(archive_);
+		auto                      palette = std::make_shared<Palette>(*parent_->palette());
+		return [texture, palette](SImage& img) { return texture->toImage(img, nullptr, palette.get()); };
 	}
 
-	// Create gl texture from image
+	return {};
+}
+
+// -----------------------------------------------------------------------------
+// Creates the item's gl texture from its decoded [image]
+// -----------------------------------------------------------------------------
+bool PatchBrowserItem::imageDecoded(SImage& image, bool ok)
+{
 	OpenGL::Texture::clear(image_tex_);
-	image_tex_ = OpenGL::Texture::createFromImage(img, parent_->palette());
+	image_tex_ = OpenGL::Texture::createFromImage(image, parent_->palette());
 	return image_tex_ > 0;
 }
 
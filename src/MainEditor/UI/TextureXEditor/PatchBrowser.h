@@ -31,10 +31,12 @@ public:
 
 	~PatchBrowserItem();
 
-	bool     loadImage() override;
 	wxString itemInfo() override;
 	void     clearImage() override;
 
+	ImageDecodeQueue::DecodeFunc imageDecoder() override;
+	bool                         imageDecoded(SImage& image, bool ok) override;
+
 private:
 	Archive* archive_ = nullptr;
 	Type     type_    = Type::Patch;
@@ -34,13 +34,15 @@
 #include "Game/Configuration.h"
 #include "Game/ThingType.h"
 #include "General/SAction.h"
+#include "SLADEMap/SLADEMap.h"
+#include "Utility/MathStuff.h"
+#ifndef HEADLESS
 #include "MapEditor/MapEditContext.h"
 #include "MapEditor/MapEditor.h"
 #include "MapTextureManager.h"
-#include "SLADEMap/SLADEMap.h"
 #include "UI/Dialogs/MapTextureBrowser.h"
 #include "UI/Dialogs/ThingTypeBrowser.h"
-#include "Utility/MathStuff.h"
+#endif
 
 
 // -----------------------------------------------------------------------------
@@ -181,47 +183,7 @@ public:
 			return "No missing textures found";
 	}
 
-	bool fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor) override
-	{
-		if (index >= lines_.size())
-			return false;
-
-		if (fix_type == 0)
-		{
-			// Browse textures
-			MapTextureBrowser browser(MapEditor::windowWx(), MapEditor::TextureType::Texture, "-", map_);
-			if (browser.ShowModal() == wxID_OK)
-			{
-				editor->beginUndoRecord("Change Texture", true, false, false);
-
-				// Set texture if one selected
-				wxString texture = browser.selectedItem()->name();
-				switch (parts_[index])
-				{
-				case MapLine::Part::FrontUpper: lines_[index]->setStringProperty("side1.texturetop", texture); break;
-				case MapLine::Part::FrontMiddle:
-					lines_[index]->setStringProperty("side1.texturemiddle", texture);
-					break;
-				case MapLine::Part::FrontLower: lines_[index]->setStringProperty("side1.texturebottom", texture); break;
-				case MapLine::Part::BackUpper: lines_[index]->setStringProperty("side2.texturetop", texture); break;
-				case MapLine::Part::BackMiddle: lines_[index]->setStringProperty("side2.texturemiddle", texture); break;
-				case MapLine::Part::BackLower: lines_[index]->setStringProperty("side2.texturebottom", texture); break;
-				default: return false;
-				}
-
-				editor->endUndoRecord();
-
-				// Remove problem
-				lines_.erase(lines_.begin() + index);
-				parts_.erase(parts_.begin() + index);
-				return true;
-			}
-
-			return false;
-		}
-
-		return false;
-	}
+	bool fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor) override;
 
 	MapObject* getObject(unsigned index) override
 	{
@@ -319,13 +281,7 @@ public:
 			Game::configuration().actionSpecial(special).name());
 	}
 
-	bool fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor) override
-	{
-		// Begin tag edit
-		SActionHandler::doAction("mapw_line_tagedit");
-
-		return false;
-	}
+	bool fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor) override;
 
 	MapObject* getObject(unsigned index) override
 	{
@@ -451,11 +407,7 @@ public:
 			Game::configuration().actionSpecial(special).name());
 	}
 
-	bool fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor) override
-	{
-		// Can't automatically fix that
-		return false;
-	}
+	bool fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor) override;
 
 	MapObject* getObject(unsigned index) override
 	{
@@ -542,54 +494,7 @@ public:
 			intersections_[index].intersect_point.y);
 	}
 
-	bool fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor) override
-	{
-		if (index >= intersections_.size())
-			return false;
-
-		if (fix_type == 0)
-		{
-			auto line1 = intersections_[index].line1;
-			auto line2 = intersections_[index].line2;
-
-			editor->beginUndoRecord("Split Lines");
-
-			// Create split vertex
-			auto nv = map_->createVertex(intersections_[index].intersect_point, -1);
-
-			// Split first line
-			map_->splitLine(line1, nv);
-			auto nl1 = map_->line(map_->nLines() - 1);
-
-			// Split second line
-			map_->splitLine(line2, nv);
-			auto nl2 = map_->line(map_->nLines() - 1);
-
-			// Remove intersection
-			intersections_.erase(intersections_.begin() + index);
-
-			editor->endUndoRecord();
-
-			// Create list of lines to re-check
-			vector<MapLine*> lines;
-			lines.push_back(line1);
-			lines.push_back(line2);
-			lines.push_back(nl1);
-			lines.push_back(nl2);
-			for (auto& intersection : intersections_)
-			{
-				VECTOR_ADD_UNIQUE(lines, intersection.line1);
-				VECTOR_ADD_UNIQUE(lines, intersection.line2);
-			}
-
-			// Re-check intersections
-			checkIntersections(lines);
-
-			return true;
-		}
-
-		return false;
-	}
+	bool fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor) override;
 
 	MapObject* getObject(unsigned index) override
 	{
@@ -668,39 +573,7 @@ public:
 			"Lines %d and %d are overlapping", overlaps_[index].line1->index(), overlaps_[index].line2->index());
 	}
 
-	bool fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor) override
-	{
-		if (index >= overlaps_.size())
-			return false;
-
-		if (fix_type == 0)
-		{
-			auto line1 = overlaps_[index].line1;
-			auto line2 = overlaps_[index].line2;
-
-			editor->beginUndoRecord("Merge Lines");
-
-			// Remove first line and correct sectors
-			map_->removeLine(line1);
-			map_->correctLineSectors(line2);
-
-			editor->endUndoRecord();
-
-			// Remove any overlaps for line1 (since it was removed)
-			for (unsigned a = 0; a < overlaps_.size(); a++)
-			{
-				if (overlaps_[a].line1 == line1 || overlaps_[a].line2 == line1)
-				{
-					overlaps_.erase(overlaps_.begin() + a);
-					a--;
-				}
-			}
-
-			return true;
-		}
-
-		return false;
-	}
+	bool fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor) override;
 
 	MapObject* getObject(unsigned index) override
 	{
@@ -903,40 +776,7 @@ public:
 			"Things %d and %d are overlapping", overlaps_[index].thing1->index(), overlaps_[index].thing2->index());
 	}
 
-	bool fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor) override
-	{
-		if (index >= overlaps_.size())
-			return false;
-
-		// Get thing to remove (depending on fix)
-		MapThing* thing = nullptr;
-		if (fix_type == 0)
-			thing = overlaps_[index].thing1;
-		else if (fix_type == 1)
-			thing = overlaps_[index].thing2;
-
-		if (thing)
-		{
-			// Remove thing
-			editor->beginUndoRecord("Delete Thing", false, false, true);
-			map_->removeThing(thing);
-			editor->endUndoRecord();
-
-			// Clear any overlaps involving the removed thing
-			for (unsigned a = 0; a < overlaps_.size(); a++)
-			{
-				if (overlaps_[a].thing1 == thing || overlaps_[a].thing2 == thing)
-				{
-					overlaps_.erase(overlaps_.begin() + a);
-					a--;
-				}
-			}
-
-			return true;
-		}
-
-		return false;
-	}
+	bool fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor) override;
 
 	MapObject* getObject(unsigned index) override
 	{
@@ -972,6 +812,7 @@ private:
 };
 
 
+#ifndef HEADLESS
 // -----------------------------------------------------------------------------
 // UnknownTexturesCheck Class
 //
@@ -1087,46 +928,7 @@ public:
 		return line;
 	}
 
-	bool fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor) override
-	{
-		if (index >= lines_.size())
-			return false;
-
-		if (fix_type == 0)
-		{
-			// Browse textures
-			MapTextureBrowser browser(MapEditor::windowWx(), MapEditor::TextureType::Texture, "-", map_);
-			if (browser.ShowModal() == wxID_OK)
-			{
-				// Set texture if one selected
-				wxString texture = browser.selectedItem()->name();
-				editor->beginUndoRecord("Change Texture", true, false, false);
-				switch (parts_[index])
-				{
-				case MapLine::Part::FrontUpper: lines_[index]->setStringProperty("side1.texturetop", texture); break;
-				case MapLine::Part::FrontMiddle:
-					lines_[index]->setStringProperty("side1.texturemiddle", texture);
-					break;
-				case MapLine::Part::FrontLower: lines_[index]->setStringProperty("side1.texturebottom", texture); break;
-				case MapLine::Part::BackUpper: lines_[index]->setStringProperty("side2.texturetop", texture); break;
-				case MapLine::Part::BackMiddle: lines_[index]->setStringProperty("side2.texturemiddle", texture); break;
-				case MapLine::Part::BackLower: lines_[index]->setStringProperty("side2.texturebottom", texture); break;
-				default: return false;
-				}
-
-				editor->endUndoRecord();
-
-				// Remove problem
-				lines_.erase(lines_.begin() + index);
-				parts_.erase(parts_.begin() + index);
-				return true;
-			}
-
-			return false;
-		}
-
-		return false;
-	}
+	bool fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor) override;
 
 	MapObject* getObject(unsigned index) override
 	{
@@ -1202,38 +1004,7 @@ public:
 				"Sector %d has unknown ceiling texture \"%s\"", sector->index(), sector->ceiling().texture);
 	}
 
-	bool fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor) override
-	{
-		if (index >= sectors_.size())
-			return false;
-
-		if (fix_type == 0)
-		{
-			// Browse textures
-			MapTextureBrowser browser(MapEditor::windowWx(), MapEditor::TextureType::Flat, "", map_);
-			if (browser.ShowModal() == wxID_OK)
-			{
-				// Set texture if one selected
-				wxString texture = browser.selectedItem()->name();
-				editor->beginUndoRecord("Change Texture");
-				if (floor_[index])
-					sectors_[index]->setFloorTexture(texture);
-				else
-					sectors_[index]->setCeilingTexture(texture);
-
-				editor->endUndoRecord();
-
-				// Remove problem
-				sectors_.erase(sectors_.begin() + index);
-				floor_.erase(floor_.begin() + index);
-				return true;
-			}
-
-			return false;
-		}
-
-		return false;
-	}
+	bool fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor) override;
 
 	MapObject* getObject(unsigned index) override
 	{
@@ -1258,6 +1029,7 @@ private:
 	vector<MapSector*> sectors_;
 	vector<bool>       floor_;
 };
+#endif
 
 
 // -----------------------------------------------------------------------------
@@ -1290,27 +1062,7 @@ public:
 		return wxString::Format("Thing %d has unknown type %d", things_[index]->index(), things_[index]->type());
 	}
 
-	bool fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor) override
-	{
-		if (index >= things_.size())
-			return false;
-
-		if (fix_type == 0)
-		{
-			ThingTypeBrowser browser(MapEditor::windowWx());
-			if (browser.ShowModal() == wxID_OK)
-			{
-				editor->beginUndoRecord("Change Thing Type");
-				things_[index]->setIntProperty("type", browser.selectedType());
-				things_.erase(things_.begin() + index);
-				editor->endUndoRecord();
-
-				return true;
-			}
-		}
-
-		return false;
-	}
+	bool fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor) override;
 
 	MapObject* getObject(unsigned index) override
 	{
@@ -1402,35 +1154,7 @@ public:
 		return wxString::Format("Thing %d is stuck inside line %d", things_[index]->index(), lines_[index]->index());
 	}
 
-	bool fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor) override
-	{
-		if (index >= things_.size())
-			return false;
-
-		if (fix_type == 0)
-		{
-			auto thing = things_[index];
-			auto line  = lines_[index];
-
-			// Get nearest line point to thing
-			auto np = MathStuff::closestPointOnLine(thing->position(), line->seg());
-
-			// Get distance to move
-			double r    = Game::configuration().thingType(thing->type()).radius();
-			double dist = MathStuff::distance(Vec2d(), Vec2d(r, r));
-
-			editor->beginUndoRecord("Move Thing", true, false, false);
-
-			// Move along line direction
-			thing->move(np - line->frontVector() * dist);
-
-			editor->endUndoRecord();
-
-			return true;
-		}
-
-		return false;
-	}
+	bool fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor) override;
 
 	MapObject* getObject(unsigned index) override
 	{
@@ -1513,54 +1237,7 @@ public:
 			"Line %d has potentially wrong %s sector %s", invalid_refs_[index].line->index(), side, sector);
 	}
 
-	bool fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor) override
-	{
-		if (index >= invalid_refs_.size())
-			return false;
-
-		if (fix_type == 0)
-		{
-			editor->beginUndoRecord("Correct Line Sector");
-
-			// Set sector
-			auto ref = invalid_refs_[index];
-			if (ref.sector)
-				map_->setLineSector(ref.line->index(), ref.sector->index(), ref.front);
-			else
-			{
-				// Remove side if no sector
-				if (ref.front && ref.line->s1())
-					map_->removeSide(ref.line->s1());
-				else if (!ref.front && ref.line->s2())
-					map_->removeSide(ref.line->s2());
-			}
-
-			// Flip line if needed
-			if (!ref.line->s1() && ref.line->s2())
-				ref.line->flip();
-
-			editor->endUndoRecord();
-
-			// Remove problem (and any others for the line)
-			for (unsigned a = 0; a < invalid_refs_.size(); a++)
-			{
-				if (invalid_refs_[a].line == ref.line)
-				{
-					invalid_refs_.erase(invalid_refs_.begin() + a);
-					a--;
-				}
-			}
-
-			// Re-check line
-			checkLine(ref.line);
-
-			editor->updateDisplay();
-
-			return true;
-		}
-
-		return false;
-	}
+	bool fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor) override;
 
 	MapObject* getObject(unsigned index) override
 	{
@@ -1635,52 +1312,7 @@ public:
 			return wxString::Format("Line %d has no sides", lines_[index]);
 	}
 
-	bool fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor) override
-	{
-		if (index >= lines_.size())
-			return false;
-
-		auto line = map_->line(lines_[index]);
-		if (line->s2())
-		{
-			// Flip
-			if (fix_type == 0)
-			{
-				line->flip();
-				return true;
-			}
-
-			// Create sector
-			else if (fix_type == 1)
-			{
-				auto pos = line->dirTabPoint(0.1);
-				editor->edit2D().createSector(pos);
-				doCheck();
-				return true;
-			}
-		}
-		else
-		{
-			// Delete
-			if (fix_type == 0)
-			{
-				map_->removeLine(line);
-				doCheck();
-				return true;
-			}
-
-			// Create sector
-			else if (fix_type == 1)
-			{
-				auto pos = line->dirTabPoint(0.1);
-				editor->edit2D().createSector(pos);
-				doCheck();
-				return true;
-			}
-		}
-
-		return false;
-	}
+	bool fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor) override;
 
 	MapObject* getObject(unsigned index) override
 	{
@@ -1750,22 +1382,7 @@ public:
 		return wxString::Format("Sector %d has no sides", sectors_[index]);
 	}
 
-	bool fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor) override
-	{
-		if (index >= sectors_.size())
-			return false;
-
-		auto sec = map_->sector(sectors_[index]);
-		if (fix_type == 0)
-		{
-			// Try to preserve flags if they exist
-			int special = sec->special();
-			int base    = Game::configuration().baseSectorType(special);
-			special &= ~base;
-			sec->setIntProperty("special", special);
-		}
-		return false;
-	}
+	bool fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor) override;
 
 	MapObject* getObject(unsigned index) override
 	{
@@ -1842,20 +1459,7 @@ public:
 			special ? "special" : "type");
 	}
 
-	bool fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor) override
-	{
-		if (index >= objects_.size())
-			return false;
-
-		// Reset
-		if (fix_type == 0)
-		{
-			objects_[index]->setIntProperty("special", 0);
-			return true;
-		}
-
-		return false;
-	}
+	bool fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor) override;
 
 	MapObject* getObject(unsigned index) override
 	{
@@ -1914,22 +1518,7 @@ public:
 		return wxString::Format("Thing %d is obsolete", things_[index]->index());
 	}
 
-	bool fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor) override
-	{
-		if (index >= things_.size())
-			return false;
-
-		// Reset
-		if (fix_type == 0)
-		{
-			editor->beginUndoRecord("Delete Thing", false, false, true);
-			map_->removeThing(things_[index]);
-			editor->endUndoRecord();
-			return true;
-		}
-
-		return false;
-	}
+	bool fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor) override;
 
 	MapObject* getObject(unsigned index) override
 	{
@@ -1954,6 +1543,559 @@ private:
 };
 
 
+// -----------------------------------------------------------------------------
+//
+// MapCheck Fixes
+//
+// -----------------------------------------------------------------------------
+// Fixes use the map editor and its dialogs, so in headless builds (slade_cli)
+// they all do nothing and problems can only be reported
+#ifndef HEADLESS
+
+// -----------------------------------------------------------------------------
+// MissingTextureCheck: Browses for a texture to set on the line part missing one
+// -----------------------------------------------------------------------------
+bool MissingTextureCheck::fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor)
+{
+	if (index >= lines_.size())
+		return false;
+
+	if (fix_type == 0)
+	{
+		// Browse textures
+		MapTextureBrowser browser(MapEditor::windowWx(), MapEditor::TextureType::Texture, "-", map_);
+		if (browser.ShowModal() == wxID_OK)
+		{
+			editor->beginUndoRecord("Change Texture", true, false, false);
+
+			// Set texture if one selected
+			wxString texture = browser.selectedItem()->name();
+			switch (parts_[index])
+			{
+			case MapLine::Part::FrontUpper: lines_[index]->setStringProperty("side1.texturetop", texture); break;
+			case MapLine::Part::FrontMiddle: lines_[index]->setStringProperty("side1.texturemiddle", texture); break;
+			case MapLine::Part::FrontLower: lines_[index]->setStringProperty("side1.texturebottom", texture); break;
+			case MapLine::Part::BackUpper: lines_[index]->setStringProperty("side2.texturetop", texture); break;
+			case MapLine::Part::BackMiddle: lines_[index]->setStringProperty("side2.texturemiddle", texture); break;
+			case MapLine::Part::BackLower: lines_[index]->setStringProperty("side2.texturebottom", texture); break;
+			default: return false;
+			}
+
+			editor->endUndoRecord();
+
+			// Remove problem
+			lines_.erase(lines_.begin() + index);
+			parts_.erase(parts_.begin() + index);
+			return true;
+		}
+
+		return false;
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// SpecialTagsCheck: Opens the tag editor for the line
+// -----------------------------------------------------------------------------
+bool SpecialTagsCheck::fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor)
+{
+	// Begin tag edit
+	SActionHandler::doAction("mapw_line_tagedit");
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// MissingTaggedCheck: Can't be fixed automatically
+// -----------------------------------------------------------------------------
+bool MissingTaggedCheck::fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor)
+{
+	// Can't automatically fix that
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// LinesIntersectCheck: Splits both lines at their intersection point
+// -----------------------------------------------------------------------------
+bool LinesIntersectCheck::fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor)
+{
+	if (index >= intersections_.size())
+		return false;
+
+	if (fix_type == 0)
+	{
+		auto line1 = intersections_[index].line1;
+		auto line2 = intersections_[index].line2;
+
+		editor->beginUndoRecord("Split Lines");
+
+		// Create split vertex
+		auto nv = map_->createVertex(intersections_[index].intersect_point, -1);
+
+		// Split first line
+		map_->splitLine(line1, nv);
+		auto nl1 = map_->line(map_->nLines() - 1);
+
+		// Split second line
+		map_->splitLine(line2, nv);
+		auto nl2 = map_->line(map_->nLines() - 1);
+
+		// Remove intersection
+		intersections_.erase(intersections_.begin() + index);
+
+		editor->endUndoRecord();
+
+		// Create list of lines to re-check
+		vector<MapLine*> lines;
+		lines.push_back(line1);
+		lines.push_back(line2);
+		lines.push_back(nl1);
+		lines.push_back(nl2);
+		for (auto& intersection : intersections_)
+		{
+			VECTOR_ADD_UNIQUE(lines, intersection.line1);
+			VECTOR_ADD_UNIQUE(lines, intersection.line2);
+		}
+
+		// Re-check intersections
+		checkIntersections(lines);
+
+		return true;
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// LinesOverlapCheck: Merges the overlapping lines
+// -----------------------------------------------------------------------------
+bool LinesOverlapCheck::fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor)
+{
+	if (index >= overlaps_.size())
+		return false;
+
+	if (fix_type == 0)
+	{
+		auto line1 = overlaps_[index].line1;
+		auto line2 = overlaps_[index].line2;
+
+		editor->beginUndoRecord("Merge Lines");
+
+		// Remove first line and correct sectors
+		map_->removeLine(line1);
+		map_->correctLineSectors(line2);
+
+		editor->endUndoRecord();
+
+		// Remove any overlaps for line1 (since it was removed)
+		for (unsigned a = 0; a < overlaps_.size(); a++)
+		{
+			if (overlaps_[a].line1 == line1 || overlaps_[a].line2 == line1)
+			{
+				overlaps_.erase(overlaps_.begin() + a);
+				a--;
+			}
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// ThingsOverlapCheck: Deletes one of the overlapping things
+// -----------------------------------------------------------------------------
+bool ThingsOverlapCheck::fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor)
+{
+	if (index >= overlaps_.size())
+		return false;
+
+	// Get thing to remove (depending on fix)
+	MapThing* thing = nullptr;
+	if (fix_type == 0)
+		thing = overlaps_[index].thing1;
+	else if (fix_type == 1)
+		thing = overlaps_[index].thing2;
+
+	if (thing)
+	{
+		// Remove thing
+		editor->beginUndoRecord("Delete Thing", false, false, true);
+		map_->removeThing(thing);
+		editor->endUndoRecord();
+
+		// Clear any overlaps involving the removed thing
+		for (unsigned a = 0; a < overlaps_.size(); a++)
+		{
+			if (overlaps_[a].thing1 == thing || overlaps_[a].thing2 == thing)
+			{
+				overlaps_.erase(overlaps_.begin() + a);
+				a--;
+			}
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// UnknownTexturesCheck: Browses for a texture to replace the unknown one
+// -----------------------------------------------------------------------------
+bool UnknownTexturesCheck::fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor)
+{
+	if (index >= lines_.size())
+		return false;
+
+	if (fix_type == 0)
+	{
+		// Browse textures
+		MapTextureBrowser browser(MapEditor::windowWx(), MapEditor::TextureType::Texture, "-", map_);
+		if (browser.ShowModal() == wxID_OK)
+		{
+			// Set texture if one selected
+			wxString texture = browser.selectedItem()->name();
+			editor->beginUndoRecord("Change Texture", true, false, false);
+			switch (parts_[index])
+			{
+			case MapLine::Part::FrontUpper: lines_[index]->setStringProperty("side1.texturetop", texture); break;
+			case MapLine::Part::FrontMiddle: lines_[index]->setStringProperty("side1.texturemiddle", texture); break;
+			case MapLine::Part::FrontLower: lines_[index]->setStringProperty("side1.texturebottom", texture); break;
+			case MapLine::Part::BackUpper: lines_[index]->setStringProperty("side2.texturetop", texture); break;
+			case MapLine::Part::BackMiddle: lines_[index]->setStringProperty("side2.texturemiddle", texture); break;
+			case MapLine::Part::BackLower: lines_[index]->setStringProperty("side2.texturebottom", texture); break;
+			default: return false;
+			}
+
+			editor->endUndoRecord();
+
+			// Remove problem
+			lines_.erase(lines_.begin() + index);
+			parts_.erase(parts_.begin() + index);
+			return true;
+		}
+
+		return false;
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// UnknownFlatsCheck: Browses for a flat to replace the unknown one
+// -----------------------------------------------------------------------------
+bool UnknownFlatsCheck::fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor)
+{
+	if (index >= sectors_.size())
+		return false;
+
+	if (fix_type == 0)
+	{
+		// Browse textures
+		MapTextureBrowser browser(MapEditor::windowWx(), MapEditor::TextureType::Flat, "", map_);
+		if (browser.ShowModal() == wxID_OK)
+		{
+			// Set texture if one selected
+			wxString texture = browser.selectedItem()->name();
+			editor->beginUndoRecord("Change Texture");
+			if (floor_[index])
+				sectors_[index]->setFloorTexture(texture);
+			else
+				sectors_[index]->setCeilingTexture(texture);
+
+			editor->endUndoRecord();
+
+			// Remove problem
+			sectors_.erase(sectors_.begin() + index);
+			floor_.erase(floor_.begin() + index);
+			return true;
+		}
+
+		return false;
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// UnknownThingTypesCheck: Browses for a type to set on the thing
+// -----------------------------------------------------------------------------
+bool UnknownThingTypesCheck::fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor)
+{
+	if (index >= things_.size())
+		return false;
+
+	if (fix_type == 0)
+	{
+		ThingTypeBrowser browser(MapEditor::windowWx());
+		if (browser.ShowModal() == wxID_OK)
+		{
+			editor->beginUndoRecord("Change Thing Type");
+			things_[index]->setIntProperty("type", browser.selectedType());
+			things_.erase(things_.begin() + index);
+			editor->endUndoRecord();
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// StuckThingsCheck: Moves the thing out of the line it is stuck in
+// -----------------------------------------------------------------------------
+bool StuckThingsCheck::fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor)
+{
+	if (index >= things_.size())
+		return false;
+
+	if (fix_type == 0)
+	{
+		auto thing = things_[index];
+		auto line  = lines_[index];
+
+		// Get nearest line point to thing
+		auto np = MathStuff::closestPointOnLine(thing->position(), line->seg());
+
+		// Get distance to move
+		double r    = Game::configuration().thingType(thing->type()).radius();
+		double dist = MathStuff::distance(Vec2d(), Vec2d(r, r));
+
+		editor->beginUndoRecord("Move Thing", true, false, false);
+
+		// Move along line direction
+		thing->move(np - line->frontVector() * dist);
+
+		editor->endUndoRecord();
+
+		return true;
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// SectorReferenceCheck: Sets the side to reference the correct sector (or removes it)
+// -----------------------------------------------------------------------------
+bool SectorReferenceCheck::fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor)
+{
+	if (index >= invalid_refs_.size())
+		return false;
+
+	if (fix_type == 0)
+	{
+		editor->beginUndoRecord("Correct Line Sector");
+
+		// Set sector
+		auto ref = invalid_refs_[index];
+		if (ref.sector)
+			map_->setLineSector(ref.line->index(), ref.sector->index(), ref.front);
+		else
+		{
+			// Remove side if no sector
+			if (ref.front && ref.line->s1())
+				map_->removeSide(ref.line->s1());
+			else if (!ref.front && ref.line->s2())
+				map_->removeSide(ref.line->s2());
+		}
+
+		// Flip line if needed
+		if (!ref.line->s1() && ref.line->s2())
+			ref.line->flip();
+
+		editor->endUndoRecord();
+
+		// Remove problem (and any others for the line)
+		for (unsigned a = 0; a < invalid_refs_.size(); a++)
+		{
+			if (invalid_refs_[a].line == ref.line)
+			{
+				invalid_refs_.erase(invalid_refs_.begin() + a);
+				a--;
+			}
+		}
+
+		// Re-check line
+		checkLine(ref.line);
+
+		editor->updateDisplay();
+
+		return true;
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// InvalidLineCheck: Flips the line (or deletes it if one-sided), or creates a sector in front of it
+// -----------------------------------------------------------------------------
+bool InvalidLineCheck::fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor)
+{
+	if (index >= lines_.size())
+		return false;
+
+	auto line = map_->line(lines_[index]);
+	if (line->s2())
+	{
+		// Flip
+		if (fix_type == 0)
+		{
+			line->flip();
+			return true;
+		}
+
+		// Create sector
+		else if (fix_type == 1)
+		{
+			auto pos = line->dirTabPoint(0.1);
+			editor->edit2D().createSector(pos);
+			doCheck();
+			return true;
+		}
+	}
+	else
+	{
+		// Delete
+		if (fix_type == 0)
+		{
+			map_->removeLine(line);
+			doCheck();
+			return true;
+		}
+
+		// Create sector
+		else if (fix_type == 1)
+		{
+			auto pos = line->dirTabPoint(0.1);
+			editor->edit2D().createSector(pos);
+			doCheck();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// UnknownSectorCheck: Resets the sector type, keeping any flags
+// -----------------------------------------------------------------------------
+bool UnknownSectorCheck::fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor)
+{
+	if (index >= sectors_.size())
+		return false;
+
+	auto sec = map_->sector(sectors_[index]);
+	if (fix_type == 0)
+	{
+		// Try to preserve flags if they exist
+		int special = sec->special();
+		int base    = Game::configuration().baseSectorType(special);
+		special &= ~base;
+		sec->setIntProperty("special", special);
+	}
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// UnknownSpecialCheck: Resets the special
+// -----------------------------------------------------------------------------
+bool UnknownSpecialCheck::fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor)
+{
+	if (index >= objects_.size())
+		return false;
+
+	// Reset
+	if (fix_type == 0)
+	{
+		objects_[index]->setIntProperty("special", 0);
+		return true;
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// ObsoleteThingCheck: Deletes the thing
+// -----------------------------------------------------------------------------
+bool ObsoleteThingCheck::fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor)
+{
+	if (index >= things_.size())
+		return false;
+
+	// Reset
+	if (fix_type == 0)
+	{
+		editor->beginUndoRecord("Delete Thing", false, false, true);
+		map_->removeThing(things_[index]);
+		editor->endUndoRecord();
+		return true;
+	}
+
+	return false;
+}
+
+#else
+
+bool MissingTextureCheck::fixProblem(unsigned, unsigned, MapEditContext*)
+{
+	return false;
+}
+bool SpecialTagsCheck::fixProblem(unsigned, unsigned, MapEditContext*)
+{
+	return false;
+}
+bool MissingTaggedCheck::fixProblem(unsigned, unsigned, MapEditContext*)
+{
+	return false;
+}
+bool LinesIntersectCheck::fixProblem(unsigned, unsigned, MapEditContext*)
+{
+	return false;
+}
+bool LinesOverlapCheck::fixProblem(unsigned, unsigned, MapEditContext*)
+{
+	return false;
+}
+bool ThingsOverlapCheck::fixProblem(unsigned, unsigned, MapEditContext*)
+{
+	return false;
+}
+bool UnknownThingTypesCheck::fixProblem(unsigned, unsigned, MapEditContext*)
+{
+	return false;
+}
+bool StuckThingsCheck::fixProblem(unsigned, unsigned, MapEditContext*)
+{
+	return false;
+}
+bool SectorReferenceCheck::fixProblem(unsigned, unsigned, MapEditContext*)
+{
+	return false;
+}
+bool InvalidLineCheck::fixProblem(unsigned, unsigned, MapEditContext*)
+{
+	return false;
+}
+bool UnknownSectorCheck::fixProblem(unsigned, unsigned, MapEditContext*)
+{
+	return false;
+}
+bool UnknownSpecialCheck::fixProblem(unsigned, unsigned, MapEditContext*)
+{
+	return false;
+}
+bool ObsoleteThingCheck::fixProblem(unsigned, unsigned, MapEditContext*)
+{
+	return false;
+}
+
+#endif
+
+
 // -----------------------------------------------------------------------------
 //
 // MapCheck Class Static Functions
@@ -1974,8 +2116,13 @@ MapCheck::UPtr MapCheck::standardCheck(StandardCheck type, SLADEMap* map, MapTex
 	case IntersectingLine: return std::make_unique<LinesIntersectCheck>(map);
 	case OverlappingLine: return std::make_unique<LinesOverlapCheck>(map);
 	case OverlappingThing: return std::make_unique<ThingsOverlapCheck>(map);
+#ifndef HEADLESS
 	case UnknownTexture: return std::make_unique<UnknownTexturesCheck>(map, texman);
 	case UnknownFlat: return std::make_unique<UnknownFlatsCheck>(map, texman);
+#else
+	case UnknownTexture:
+	case UnknownFlat: return nullptr; // Needs the map editor's texture manager
+#endif
 	case UnknownThingType: return std::make_unique<UnknownThingTypesCheck>(map);
 	case StuckThing: return std::make_unique<StuckThingsCheck>(map);
 	case SectorReference: return std::make_unique<SectorReferenceCheck>(map);
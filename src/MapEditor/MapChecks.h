@@ -32,14 +32,16 @@ public:
 	MapCheck(SLADEMap* map) : map_{ map } {}
 	virtual ~MapCheck() = default;
 
-	virtual void       doCheck()                                                             = 0;
-	virtual unsigned   nProblems()                                                           = 0;
-	virtual wxString   problemDesc(unsigned index)                                           = 0;
-	virtual bool       fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor) = 0;
-	virtual MapObject* getObject(unsigned index)                                             = 0;
+	virtual void       doCheck()                   = 0;
+	virtual unsigned   nProblems()                 = 0;
+	virtual wxString   problemDesc(unsigned index) = 0;
+	virtual MapObject* getObject(unsigned index)   = 0;
 	virtual wxString   progressText() { return "Checking..."; }
 	virtual wxString   fixText(unsigned fix_type, unsigned index) { return ""; }
 
+	// Fixes need the map editor, so aren't available in headless builds
+	virtual bool fixProblem(unsigned index, unsigned fix_type, MapEditContext* editor) { return false; }
+
 	typedef std::unique_ptr<MapCheck> UPtr;
 
 	static UPtr     standardCheck(StandardCheck type, SLADEMap* map, MapTextureManager* texman = nullptr);
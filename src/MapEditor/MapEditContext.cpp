@@ -39,6 +39,7 @@
 #include "General/Console/Console.h"
 #include "General/UndoRedo.h"
 #include "MapChecks.h"
+#include "MapEditor/Renderer/MapVisibility.h"
 #include "MapEditor/Renderer/Overlays/InfoOverlay3d.h"
 #include "MapEditor/Renderer/Overlays/LineTextureOverlay.h"
 #include "MapEditor/Renderer/Overlays/QuickTextureOverlay3d.h"
@@ -50,6 +51,8 @@
 #include "UI/MapCanvas.h"
 #include "UI/MapEditorWindow.h"
 #include "UndoSteps.h"
+#include "Utility/MathStuff.h"
+#include "Utility/Profiler.h"
 #include "Utility/StringUtils.h"
 
 using MapEditor::Input;
@@ -371,6 +374,8 @@ bool MapEditContext::update(long frametime)
 // -----------------------------------------------------------------------------
 bool MapEditContext::openMap(Archive::MapDesc map)
 {
+	PROFILE_ZONE("MapEditContext::openMap");
+
 	Log::info(wxString::Format("Opening map %s", map.name));
 	if (!map_.readMap(map))
 		return false;
@@ -2421,7 +2426,10 @@ CONSOLE_COMMAND(m_check, 0, true)
 	{
 		// Run
 		Log::console(check->progressText());
-		check->doCheck();
+		{
+			PROFILE_ZONE("MapCheck::doCheck");
+			check->doCheck();
+		}
 
 		// Check if no problems found
 		if (check->nProblems() == 0)
@@ -2448,6 +2456,65 @@ CONSOLE_COMMAND(m_test_sector, 0, false)
 	Log::info(wxString::Format("Took %ldms", ms));
 }
 
+CONSOLE_COMMAND(m_test_specials, 0, false)
+{
+	auto& context  = MapEditor::editContext();
+	auto& map      = context.map();
+	auto  specials = map.mapSpecials();
+	int   count    = args.empty() ? 20 : StrUtil::toInt(args[0]);
+	if (map.nSectors() == 0 || count <= 0)
+		return;
+
+	// The test modifies sector heights on the map being edited, so record it
+	// as an undo level that can be undone like any other edit
+	context.beginUndoRecord("Test Map Specials", true, false, false);
+
+	// Returns the floor and ceiling planes of all sectors in the map
+	auto planes = [&map]() {
+		vector<Plane> list;
+		for (auto sector : map.sectors())
+		{
+			list.push_back(sector->floor().plane);
+			list.push_back(sector->ceiling().plane);
+		}
+		return list;
+	};
+
+	sf::Clock clock;
+	specials->processMapSpecials(&map);
+	auto full_time = clock.getElapsedTime().asMicroseconds();
+
+	// Change sector heights one at a time and check the incremental result
+	// matches a full pass
+	long long incremental_time = 0;
+	int       mismatches       = 0;
+	for (int a = 0; a < count * 2; a++)
+	{
+		auto sector = map.sector((a / 2 * 7919) % map.nSectors());
+		sector->setFloorHeight(sector->floor().height + (a % 2 == 0 ? 8 : -8));
+
+		clock.restart();
+		specials->updateMapSpecials(&map);
+		incremental_time += clock.getElapsedTime().asMicroseconds();
+		auto incremental = planes();
+
+		specials->processMapSpecials(&map);
+		if (incremental != planes())
+		{
+			Log::console(wxString::Format("Mismatch after modifying sector %d", sector->index()));
+			mismatches++;
+		}
+	}
+
+	context.endUndoRecord(true);
+
+	Log::console(wxString::Format(
+		"%d mismatches, full pass %lldus, incremental pass %lldus avg",
+		mismatches,
+		(long long)full_time,
+		incremental_time / (count * 2)));
+}
+
 CONSOLE_COMMAND(m_test_mobj_backup, 0, false)
 {
 	sf::Clock clock;
@@ -2508,6 +2575,221 @@ CONSOLE_COMMAND(m_n_polys, 0, false)
 	Log::console(wxString::Format("%d polygons total", npoly));
 }
 
+CONSOLE_COMMAND(m_test_polygons, 0, false)
+{
+	// Builds all sector polygons with both the triangulator and the old splitter,
+	// checking they cover the same area and comparing build times
+	SLADEMap& map = MapEditor::editContext().map();
+	if (map.nSectors() == 0)
+		return;
+
+	// Total area covered by a polygon's sub-polygons
+	auto poly_area = [](Polygon2D& poly) {
+		double area = 0;
+		for (unsigned a = 0; a < poly.nSubPolys(); a++)
+		{
+			auto& verts = poly.subPoly(a)->vertices;
+			for (unsigned v = 0; v < verts.size(); v++)
+			{
+				auto& v1 = verts[v];
+				auto& v2 = verts[(v + 1) % verts.size()];
+				area += (double)v1.x * v2.y - (double)v2.x * v1.y;
+			}
+		}
+		return std::fabs(area * 0.5);
+	};
+
+	sf::Clock clock;
+	Polygon2D poly_split, poly_tri;
+	double    time_split = 0, time_tri = 0;
+	unsigned  n_split = 0, n_tri = 0, mismatches = 0;
+	for (unsigned a = 0; a < map.nSectors(); a++)
+	{
+		auto sector = map.sector(a);
+
+		// Old splitter
+		clock.restart();
+		PolygonSplitter splitter;
+		poly_split.clear();
+		splitter.openSector(sector);
+		splitter.doSplitting(&poly_split);
+		time_split += clock.getElapsedTime().asMicroseconds() / 1000.;
+
+		// Triangulator
+		clock.restart();
+		poly_tri.openSector(sector);
+		time_tri += clock.getElapsedTime().asMicroseconds() / 1000.;
+
+		// Compare coverage
+		n_split += poly_split.nSubPolys();
+		n_tri += poly_tri.nSubPolys();
+		double area_split = poly_area(poly_split);
+		double area_tri   = poly_area(poly_tri);
+		if (std::fabs(area_split - area_tri) > std::max(1.0, area_split * 0.0001))
+		{
+			mismatches++;
+			Log::info(wxString::Format(
+				"Sector %d: splitter area %1.2f (%d polys), triangulator area %1.2f (%d polys)",
+				a,
+				area_split,
+				poly_split.nSubPolys(),
+				area_tri,
+				poly_tri.nSubPolys()));
+		}
+	}
+
+	Log::info(wxString::Format("Splitter: %1.2fms, %d polygons", time_split, n_split));
+	Log::info(wxString::Format("Triangulator: %1.2fms, %d polygons", time_tri, n_tri));
+	Log::info(wxString::Format("%d of %lu sectors differ in coverage", mismatches, map.nSectors()));
+
+	// Parallel initial build
+	for (unsigned a = 0; a < map.nSectors(); a++)
+		map.sector(a)->resetPolygon();
+	clock.restart();
+	map.sectors().initPolygons();
+	Log::info(wxString::Format("Parallel build: %dms", clock.getElapsedTime().asMilliseconds()));
+}
+
+CONSOLE_COMMAND(m_test_vis, 0, false)
+{
+	// Computes the potentially visible set from random camera positions, timing it
+	// against a scan of all sector bounding boxes (as done without it), and
+	// checking nothing hit by rays cast out from the camera was left out
+	SLADEMap& map = MapEditor::editContext().map();
+	if (map.nSectors() == 0)
+		return;
+
+	unsigned      n_views = args.empty() ? 200 : StrUtil::toInt(args[0]);
+	MapVisibility vis(&map);
+	vis.updatePortals();
+
+	sf::Clock      clock;
+	vector<double> scan_dist(map.nSectors());
+	double         time_vis = 0, time_scan = 0;
+	unsigned       n_computed = 0, n_visible = 0, n_scanned = 0, n_rays = 0, missed_sectors = 0, missed_lines = 0;
+	for (unsigned view = 0; view < n_views; view++)
+	{
+		// Pick a random camera position within a random sector
+		auto  sector = map.sector(rand() % map.nSectors());
+		auto  bbox   = sector->boundingBox();
+		Vec2d cam;
+		bool  found = false;
+		for (unsigned attempt = 0; attempt < 20 && !found; attempt++)
+		{
+			cam.set(
+				bbox.min.x + (bbox.max.x - bbox.min.x) * (rand() % 1000) * 0.001,
+				bbox.min.y + (bbox.max.y - bbox.min.y) * (rand() % 1000) * 0.001);
+			found = sector->containsPoint(cam);
+		}
+		if (!found)
+			continue;
+		double floor = sector->floor().plane.heightAt(cam);
+		double z     = std::min(floor + 41, sector->ceiling().plane.heightAt(cam));
+		if (z < floor)
+			continue;
+
+		double angle     = (rand() % 3600) * MathStuff::PI / 1800;
+		Vec2d  direction = { cos(angle), sin(angle) };
+		bool   full_view = view % 4 == 0;
+
+		// Portal visibility
+		clock.restart();
+		if (!vis.compute({ cam.x, cam.y, z }, direction, full_view))
+			continue;
+		time_vis += clock.getElapsedTime().asMicroseconds() / 1000.;
+		n_computed++;
+		n_visible += vis.visibleSectors().size();
+
+		// Bounding box scan
+		clock.restart();
+		Seg2d strafe(cam, cam + Vec2d(direction.y, -direction.x));
+		for (unsigned a = 0; a < map.nSectors(); a++)
+		{
+			auto sbox = map.sector(a)->boundingBox();
+			if (!full_view && !sbox.contains(cam) && MathStuff::lineSide(sbox.min, strafe) > 0
+				&& MathStuff::lineSide(sbox.max, strafe) > 0
+				&& MathStuff::lineSide({ sbox.min.x, sbox.max.y }, strafe) > 0
+				&& MathStuff::lineSide({ sbox.max.x, sbox.min.y }, strafe) > 0)
+			{
+				scan_dist[a] = -1;
+				continue;
+			}
+			scan_dist[a] = std::min(
+				std::min(MathStuff::distanceToLine(cam, sbox.leftSide()), MathStuff::distanceToLine(cam, sbox.rightSide())),
+				std::min(MathStuff::distanceToLine(cam, sbox.topSide()), MathStuff::distanceToLine(cam, sbox.bottomSide())));
+			n_scanned++;
+		}
+		time_scan += clock.getElapsedTime().asMicroseconds() / 1000.;
+
+		// Cast rays, following them through the map until they hit something solid
+		for (unsigned ray = 0; ray < 64; ray++)
+		{
+			double ray_angle = full_view ? angle + ray * MathStuff::PI / 32 : angle + (ray - 31.5) * MathStuff::PI / 64;
+			Vec2d  ray_dir   = { cos(ray_angle), sin(ray_angle) };
+
+			vector<std::pair<double, MapLine*>> hits;
+			for (unsigned a = 0; a < map.nLines(); a++)
+			{
+				auto   line  = map.line(a);
+				auto   edge  = line->end() - line->start();
+				double denom = ray_dir.cross(edge);
+				if (denom == 0)
+					continue;
+				auto   offset = line->start() - cam;
+				double t      = offset.cross(edge) / denom;
+				double u      = offset.cross(ray_dir) / denom;
+				if (t > 0 && u >= 0 && u <= 1)
+					hits.emplace_back(t, line);
+			}
+			std::sort(hits.begin(), hits.end());
+			n_rays++;
+
+			MapSector* current = sector;
+			for (auto& hit : hits)
+			{
+				auto line = hit.second;
+				bool front = MathStuff::lineSide(cam, line->seg()) > 0;
+				auto from  = front ? line->s1() : line->s2();
+				auto to    = front ? line->s2() : line->s1();
+				if (!from || from->sector() != current)
+					break;
+
+				if (!vis.lineVisible(line->index()))
+					missed_lines++;
+				if (!to || !to->sector() || !MapVisibility::portalOpen(current, to->sector()))
+					break;
+
+				current = to->sector();
+				if (!vis.sectorVisible(current->index()))
+				{
+					missed_sectors++;
+					break;
+				}
+			}
+		}
+	}
+
+	if (n_computed == 0)
+		return;
+
+	Log::info(wxString::Format(
+		"Portal visibility: %1.3fms avg, %1.1f of %d sectors visible avg (%d portals)",
+		time_vis / n_computed,
+		(double)n_visible / n_computed,
+		map.nSectors(),
+		vis.nPortals()));
+	Log::info(wxString::Format(
+		"Bounding box scan: %1.3fms avg, %1.1f sectors in front avg",
+		time_scan / n_computed,
+		(double)n_scanned / n_computed));
+	Log::info(wxString::Format(
+		"%d rays from %d views, %d sectors and %d lines hit but not visible",
+		n_rays,
+		n_computed,
+		missed_sectors,
+		missed_lines));
+}
+
 CONSOLE_COMMAND(mobj_info, 1, false)
 {
 	int id = StrUtil::toInt(args[0]);
@@ -37,6 +37,7 @@
 #include "General/Misc.h"
 #include "General/ResourceManager.h"
 #include "Graphics/CTexture/CTexture.h"
+#include "Graphics/ImageDecodeQueue.h"
 #include "Graphics/SImage/SImage.h"
 #include "MainEditor/MainEditor.h"
 #include "MainEditor/UI/MainWindow.h"
@@ -59,6 +60,220 @@ MapTextureManager::Texture tex_invalid;
 CVAR(Int, map_tex_filter, 0, CVar::Flag::Save)
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Image sources for a texture, flat or sprite, resolved on the main thread by
+// a MapTextureManager decoder function so it can be decoded on any thread
+struct ImageSource
+{
+	std::unique_ptr<DetachedImage> entry;     // Stand-alone texture/flat/sprite
+	std::unique_ptr<DetachedImage> hires_ref; // Texture replaced by a hires texture entry
+	std::unique_ptr<CTexture>      composite;
+	MapTextureManager::DecodeProps composite_props;
+	Palette                        palette;
+	bool                           mirror = false;
+	wxString                       translation;
+	std::unique_ptr<Palette>       palette_override;
+
+	ImageSource(Palette* palette) : palette{ *palette } {}
+};
+
+// -----------------------------------------------------------------------------
+// Returns the texture filter to use for map textures (or sprites if [sprite]
+// is true), depending on the map_tex_filter cvar
+// -----------------------------------------------------------------------------
+OpenGL::TexFilter textureFilter(bool sprite)
+{
+	switch (map_tex_filter)
+	{
+	case 0: return OpenGL::TexFilter::NearestLinearMin;
+	case 2: return sprite ? OpenGL::TexFilter::Linear : OpenGL::TexFilter::LinearMipmap;
+	case 3: return OpenGL::TexFilter::NearestMipmap;
+	default: return OpenGL::TexFilter::Linear;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [mtex] is loaded with [filter]. If it is loaded with a
+// different filter it is unloaded so that it can be reloaded
+// -----------------------------------------------------------------------------
+bool isLoaded(MapTextureManager::Texture& mtex, OpenGL::TexFilter filter)
+{
+	if (!mtex.gl_id)
+		return false;
+
+	// If the texture filter matches the desired one, it's loaded
+	auto& tex_info = OpenGL::Texture::info(mtex.gl_id);
+	if (tex_info.filter == filter)
+		return true;
+
+	// Otherwise, unload the texture
+	OpenGL::Texture::clear(mtex.gl_id);
+	mtex.gl_id = 0;
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Resolves composite texture [ctex] into [source], with patches from [archive]
+// primarily
+// -----------------------------------------------------------------------------
+void resolveComposite(ImageSource& source, CTexture* ctex, Archive* archive)
+{
+	if (!ctex)
+		return;
+
+	source.composite = ctex->resolvedCopy(archive);
+
+	double sx = ctex->scaleX();
+	if (sx == 0)
+		sx = 1.0;
+	double sy = ctex->scaleY();
+	if (sy == 0)
+		sy = 1.0;
+
+	source.composite_props.world_panning = ctex->worldPanning();
+	source.composite_props.scale         = { 1.0 / sx, 1.0 / sy };
+}
+
+// -----------------------------------------------------------------------------
+// Resolves the sprite [name] into [source], from [archive] primarily.
+// Sprite name also supports wildcards (?).
+// Returns false if no matching sprite was found
+// -----------------------------------------------------------------------------
+bool resolveSprite(ImageSource& source, const wxString& name, Archive* archive)
+{
+	auto& resources = App::resources();
+	auto  entry     = resources.getPatchEntry(name, "sprites", archive);
+	if (!entry)
+		entry = resources.getPatchEntry(name, "", archive);
+	if (!entry && name.length() == 8)
+	{
+		wxString newname = name;
+		newname[4]       = name[6];
+		newname[5]       = name[7];
+		newname[6]       = name[4];
+		newname[7]       = name[5];
+		entry            = resources.getPatchEntry(newname, "sprites", archive);
+		if (entry)
+			source.mirror = true;
+	}
+	if (entry)
+	{
+		source.entry = std::make_unique<DetachedImage>(entry);
+		return true;
+	}
+
+	// Try composite textures then
+	auto ctex = resources.getTexture(name, archive);
+	if (ctex)
+	{
+		source.composite = ctex->resolvedCopy(archive);
+		return true;
+	}
+
+	// Try rotations/frames matching the wildcard
+	if (name.EndsWith("?"))
+	{
+		auto sname = name.Left(name.size() - 1);
+		if (resolveSprite(source, sname + '0', archive) || resolveSprite(source, sname + '1', archive))
+			return true;
+		if (sname.length() == 5)
+		{
+			for (char chr = 'A'; chr <= ']'; ++chr)
+			{
+				if (resolveSprite(source, sname + '0' + chr + '0', archive)
+					|| resolveSprite(source, sname + '1' + chr + '1', archive))
+					return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Decodes the texture or flat image from [source] into [image], and its
+// properties into [props]
+// -----------------------------------------------------------------------------
+bool decodeTexture(ImageSource& source, SImage& image, MapTextureManager::DecodeProps& props)
+{
+	// Composite textures take precedence over stand-alone textures
+	if (source.composite && source.composite->toImage(image, nullptr, &source.palette, true))
+	{
+		props = source.composite_props;
+		return true;
+	}
+
+	if (!source.entry || !source.entry->load(image))
+		return false;
+
+	// Handle hires texture scale
+	SImage imgref;
+	if (source.hires_ref && source.hires_ref->load(imgref))
+	{
+		int w, h, sw, sh;
+		w                   = image.width();
+		h                   = image.height();
+		sw                  = imgref.width();
+		sh                  = imgref.height();
+		props.world_panning = true;
+		props.scale         = { (double)sw / (double)w, (double)sh / (double)h };
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Decodes the sprite image from [source] into [image]
+// -----------------------------------------------------------------------------
+bool decodeSprite(ImageSource& source, SImage& image)
+{
+	// We need a valid image either from an entry or a composite texture
+	if (source.entry)
+	{
+		if (!source.entry->load(image))
+			return false;
+	}
+	else if (!source.composite || !source.composite->toImage(image, nullptr, &source.palette, true))
+		return false;
+
+	// Apply translation
+	if (!source.translation.IsEmpty())
+		image.applyTranslation(source.translation, &source.palette, true);
+
+	// Apply palette override
+	if (source.palette_override)
+		image.setPalette(source.palette_override.get());
+
+	// Apply mirroring
+	if (source.mirror)
+		image.mirror(false);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the key for sprite [name] with [translation] and [palette] in the
+// loaded sprites map
+// -----------------------------------------------------------------------------
+wxString spriteKey(const wxString& name, const wxString& translation, const wxString& palette)
+{
+	wxString hashname = name.Upper();
+	if (!translation.IsEmpty())
+		hashname += translation.Lower();
+	if (!palette.IsEmpty())
+		hashname += palette.Upper();
+
+	return hashname;
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // MapTextureManager Class Functions
@@ -109,109 +324,23 @@ Palette* MapTextureManager::resourcePalette() const
 // -----------------------------------------------------------------------------
 const MapTextureManager::Texture& MapTextureManager::texture(const wxString& name, bool mixed)
 {
-	// Get texture matching name
+	// Get texture matching name, return it if it's loaded
 	auto& mtex = textures_[name.Upper()];
-
-	// Get desired filter type
-	auto filter = OpenGL::TexFilter::Linear;
-	if (map_tex_filter == 0)
-		filter = OpenGL::TexFilter::NearestLinearMin;
-	else if (map_tex_filter == 1)
-		filter = OpenGL::TexFilter::Linear;
-	else if (map_tex_filter == 2)
-		filter = OpenGL::TexFilter::LinearMipmap;
-	else if (map_tex_filter == 3)
-		filter = OpenGL::TexFilter::NearestMipmap;
-
-	// If the texture is loaded
-	if (mtex.gl_id)
-	{
-		// If the texture filter matches the desired one, return it
-		auto& tex_info = OpenGL::Texture::info(mtex.gl_id);
-		if (tex_info.filter == filter)
-			return mtex;
-		else
-		{
-			// Otherwise, reload the texture
-			OpenGL::Texture::clear(mtex.gl_id);
-			mtex.gl_id = 0;
-		}
-	}
+	if (isLoaded(mtex, textureFilter(false)))
+		return mtex;
 
 	// Texture not found or unloaded, look for it
+	SImage      image;
+	DecodeProps props;
+	if (textureDecoder(name, false)(image, props))
+		return uploadTexture(name, false, &image, props);
 
-	// Look for stand-alone textures first
-	auto etex         = App::resources().getTextureEntry(name, "hires", archive_);
-	auto textypefound = CTexture::Type::HiRes;
-	if (etex == nullptr)
-	{
-		etex         = App::resources().getTextureEntry(name, "textures", archive_);
-		textypefound = CTexture::Type::Texture;
-	}
-	if (etex)
-	{
-		SImage image;
-		// Get image format hint from type, if any
-		if (Misc::loadImageFromEntry(&image, etex))
-		{
-			mtex.gl_id = OpenGL::Texture::createFromImage(image, palette_.get(), filter);
-
-			// Handle hires texture scale
-			if (textypefound == CTexture::Type::HiRes)
-			{
-				auto ref = App::resources().getTextureEntry(name, "textures", archive_);
-				if (ref)
-				{
-					SImage imgref;
-					if (Misc::loadImageFromEntry(&imgref, ref))
-					{
-						int w, h, sw, sh;
-						w                  = image.width();
-						h                  = image.height();
-						sw                 = imgref.width();
-						sh                 = imgref.height();
-						mtex.world_panning = true;
-						mtex.scale         = { (double)sw / (double)w, (double)sh / (double)h };
-					}
-				}
-			}
-		}
-	}
-
-	// Try composite textures then
-	auto ctex = App::resources().getTexture(name, archive_);
-	if (ctex) // Composite textures take precedence over the textures directory
-	{
-		textypefound = CTexture::Type::WallTexture;
-		SImage image;
-		if (ctex->toImage(image, archive_, palette_.get(), true))
-		{
-			mtex.gl_id = OpenGL::Texture::createFromImage(image, palette_.get(), filter);
-
-			double sx = ctex->scaleX();
-			if (sx == 0)
-				sx = 1.0;
-			double sy = ctex->scaleY();
-			if (sy == 0)
-				sy = 1.0;
-
-			mtex.world_panning = ctex->worldPanning();
-			mtex.scale         = { 1.0 / sx, 1.0 / sy };
-		}
-	}
-
-	// Not found
-	if (!mtex.gl_id)
-	{
-		// Try flats if mixed
-		if (mixed)
-			return flat(name, false);
-
-		// Otherwise use missing texture
-		mtex.gl_id = OpenGL::Texture::missingTexture();
-	}
+	// Not found, try flats if mixed
+	if (mixed)
+		return flat(name, false);
 
-	return mtex;
+	// Otherwise use missing texture
+	return uploadTexture(name, false, nullptr, props);
 }
 
 // -----------------------------------------------------------------------------
@@ -220,90 +349,23 @@ const MapTextureManager::Texture& MapTextureManager::texture(const wxString& nam
 // -----------------------------------------------------------------------------
 const MapTextureManager::Texture& MapTextureManager::flat(const wxString& name, bool mixed)
 {
-	// Get flat matching name
+	// Get flat matching name, return it if it's loaded
 	auto& mtex = flats_[name.Upper()];
+	if (isLoaded(mtex, textureFilter(false)))
+		return mtex;
 
-	// Get desired filter type
-	auto filter = OpenGL::TexFilter::Linear;
-	if (map_tex_filter == 0)
-		filter = OpenGL::TexFilter::NearestLinearMin;
-	else if (map_tex_filter == 1)
-		filter = OpenGL::TexFilter::Linear;
-	else if (map_tex_filter == 2)
-		filter = OpenGL::TexFilter::LinearMipmap;
-	else if (map_tex_filter == 3)
-		filter = OpenGL::TexFilter::NearestMipmap;
-
-	// If the texture is loaded
-	if (mtex.gl_id)
-	{
-		// If the texture filter matches the desired one, return it
-		auto& tex_info = OpenGL::Texture::info(mtex.gl_id);
-		if (tex_info.filter == filter)
-			return mtex;
-		else
-		{
-			// Otherwise, reload the texture
-			OpenGL::Texture::clear(mtex.gl_id);
-			mtex.gl_id = 0;
-		}
-	}
+	// Flat not found or unloaded, look for it
+	SImage      image;
+	DecodeProps props;
+	if (textureDecoder(name, true, mixed)(image, props))
+		return uploadTexture(name, true, &image, props);
 
+	// Not found, try textures if mixed
 	if (mixed)
-	{
-		auto ctex = App::resources().getTexture(name, archive_);
-		if (ctex && ctex->isExtended() && ctex->type() != "WallTexture")
-		{
-			SImage image;
-			if (ctex->toImage(image, archive_, palette_.get(), true))
-			{
-				mtex.gl_id = OpenGL::Texture::createFromImage(image, palette_.get(), filter);
-
-				double sx = ctex->scaleX();
-				if (sx == 0)
-					sx = 1.0;
-				double sy = ctex->scaleY();
-				if (sy == 0)
-					sy = 1.0;
-
-				mtex.scale         = { 1.0 / sx, 1.0 / sy };
-				mtex.world_panning = ctex->worldPanning();
-
-				return mtex;
-			}
-		}
-	}
-
-	// Flat not found, look for it
-	// Palette8bit* pal = getResourcePalette();
-	if (!mtex.gl_id)
-	{
-		auto entry = App::resources().getTextureEntry(name, "hires", archive_);
-		if (entry == nullptr)
-			entry = App::resources().getTextureEntry(name, "flats", archive_);
-		if (entry == nullptr)
-			entry = App::resources().getFlatEntry(name, archive_);
-		if (entry)
-		{
-			SImage image;
-			if (Misc::loadImageFromEntry(&image, entry))
-				mtex.gl_id = OpenGL::Texture::createFromImage(image, palette_.get(), filter);
-		}
-	}
+		return texture(name, false);
 
-	// Not found
-	if (!mtex.gl_id)
-	{
-		// Try textures if mixed
-		if (mixed)
-			return texture(name, false);
-
-		// Otherwise use missing texture
-		else
-			mtex.gl_id = OpenGL::Texture::missingTexture();
-	}
-
-	return mtex;
+	// Otherwise use missing texture
+	return uploadTexture(name, true, nullptr, props);
 }
 
 // -----------------------------------------------------------------------------
@@ -319,120 +381,16 @@ const MapTextureManager::Texture& MapTextureManager::sprite(
 	if (name.IsEmpty())
 		return tex_invalid;
 
-	// Get sprite matching name
-	wxString hashname = name.Upper();
-	if (!translation.IsEmpty())
-		hashname += translation.Lower();
-	if (!palette.IsEmpty())
-		hashname += palette.Upper();
-	auto& mtex = sprites_[hashname];
-
-	// Get desired filter type
-	auto filter = OpenGL::TexFilter::Linear;
-	if (map_tex_filter == 0)
-		filter = OpenGL::TexFilter::NearestLinearMin;
-	else if (map_tex_filter == 1)
-		filter = OpenGL::TexFilter::Linear;
-	else if (map_tex_filter == 2)
-		filter = OpenGL::TexFilter::Linear;
-	else if (map_tex_filter == 3)
-		filter = OpenGL::TexFilter::NearestMipmap;
-
-	// If the texture is loaded
-	if (mtex.gl_id)
-	{
-		// If the texture filter matches the desired one, return it
-		auto& tex_info = OpenGL::Texture::info(mtex.gl_id);
-		if (tex_info.filter == filter)
-			return mtex;
-		else
-		{
-			// Otherwise, reload the texture
-			OpenGL::Texture::clear(mtex.gl_id);
-			mtex.gl_id = 0;
-		}
-	}
-
-	// Sprite not found, look for it
-	bool   found  = false;
-	bool   mirror = false;
-	SImage image;
-	// Palette8bit* pal = getResourcePalette();
-	auto entry = App::resources().getPatchEntry(name, "sprites", archive_);
-	if (!entry)
-		entry = App::resources().getPatchEntry(name, "", archive_);
-	if (!entry && name.length() == 8)
-	{
-		wxString newname = name;
-		newname[4]       = name[6];
-		newname[5]       = name[7];
-		newname[6]       = name[4];
-		newname[7]       = name[5];
-		entry            = App::resources().getPatchEntry(newname, "sprites", archive_);
-		if (entry)
-			mirror = true;
-	}
-	if (entry)
-	{
-		found = true;
-		Misc::loadImageFromEntry(&image, entry);
-	}
-	else // Try composite textures then
-	{
-		auto ctex = App::resources().getTexture(name, archive_);
-		if (ctex && ctex->toImage(image, archive_, palette_.get(), true))
-			found = true;
-	}
-
-	// We have a valid image either from an entry or a composite texture.
-	if (found)
-	{
-		auto pal = palette_.get();
-
-		// Apply translation
-		if (!translation.IsEmpty())
-			image.applyTranslation(translation, pal, true);
-
-		// Apply palette override
-		if (!palette.IsEmpty())
-		{
-			auto newpal = App::resources().getPaletteEntry(palette, archive_);
-			if (newpal && newpal->size() == 768)
-			{
-				pal = image.palette();
-				pal->loadMem(newpal->data());
-			}
-		}
-
-		// Apply mirroring
-		if (mirror)
-			image.mirror(false);
-
-		// Turn into GL texture
-		mtex.gl_id = OpenGL::Texture::createFromImage(image, pal, filter, false);
+	// Get sprite matching name, return it if it's loaded
+	auto& mtex = sprites_[spriteKey(name, translation, palette)];
+	if (isLoaded(mtex, textureFilter(true)))
 		return mtex;
-	}
-	else if (name.EndsWith("?"))
-	{
-		auto sname = name.Left(name.size() - 1);
-		auto stex  = &sprite(sname + '0', translation, palette);
-		if (!stex->gl_id)
-			stex = &sprite(sname + '1', translation, palette);
-		if (stex->gl_id)
-			return *stex;
-		if (!stex->gl_id && sname.length() == 5)
-		{
-			for (char chr = 'A'; chr <= ']'; ++chr)
-			{
-				stex = &sprite(sname + '0' + chr + '0', translation, palette);
-				if (stex->gl_id)
-					return *stex;
-				stex = &sprite(sname + '1' + chr + '1', translation, palette);
-				if (stex->gl_id)
-					return *stex;
-			}
-		}
-	}
+
+	// Sprite not found or unloaded, look for it
+	SImage      image;
+	DecodeProps props;
+	if (spriteDecoder(name, translation, palette)(image, props))
+		return uploadSprite(name, translation, palette, &image);
 
 	return tex_invalid;
 }
@@ -467,6 +425,146 @@ int MapTextureManager::verticalOffset(const wxString& name) const
 	return 0;
 }
 
+// -----------------------------------------------------------------------------
+// Returns a function that decodes the image for the texture (or flat if
+// [flat] is true) matching [name]. If [mixed] is true, extended composite
+// textures can be used as flats.
+// The image sources are resolved when this is called, so the returned function
+// can be called from any thread, and the resulting image uploaded with
+// uploadTexture on the main thread
+// -----------------------------------------------------------------------------
+MapTextureManager::Decoder MapTextureManager::textureDecoder(const wxString& name, bool flat, bool mixed) const
+{
+	auto  source    = std::make_shared<ImageSource>(palette_.get());
+	auto& resources = App::resources();
+
+	if (!flat)
+	{
+		// Composite textures take precedence over the textures directory
+		resolveComposite(*source, resources.getTexture(name, archive_), archive_);
+
+		// Look for stand-alone textures
+		auto entry = resources.getTextureEntry(name, "hires", archive_);
+		if (entry)
+		{
+			// Hires textures are scaled to the size of the texture they replace
+			auto ref = resources.getTextureEntry(name, "textures", archive_);
+			if (ref)
+				source->hires_ref = std::make_unique<DetachedImage>(ref);
+		}
+		else
+			entry = resources.getTextureEntry(name, "textures", archive_);
+		if (entry)
+			source->entry = std::make_unique<DetachedImage>(entry);
+	}
+	else
+	{
+		// Extended composite textures can be used as flats if mixed
+		if (mixed)
+		{
+			auto ctex = resources.getTexture(name, archive_);
+			if (ctex && ctex->isExtended() && ctex->type() != "WallTexture")
+				resolveComposite(*source, ctex, archive_);
+		}
+
+		// Look for stand-alone flats
+		auto entry = resources.getTextureEntry(name, "hires", archive_);
+		if (entry == nullptr)
+			entry = resources.getTextureEntry(name, "flats", archive_);
+		if (entry == nullptr)
+			entry = resources.getFlatEntry(name, archive_);
+		if (entry)
+			source->entry = std::make_unique<DetachedImage>(entry);
+	}
+
+	return [source](SImage& image, DecodeProps& props) { return decodeTexture(*source, image, props); };
+}
+
+// -----------------------------------------------------------------------------
+// Returns a function that decodes the image for the sprite matching [name],
+// with [translation] and [palette] applied.
+// The image sources are resolved when this is called, so the returned function
+// can be called from any thread, and the resulting image uploaded with
+// uploadSprite on the main thread
+// -----------------------------------------------------------------------------
+MapTextureManager::Decoder MapTextureManager::spriteDecoder(
+	const wxString& name,
+	const wxString& translation,
+	const wxString& palette) const
+{
+	auto source = std::make_shared<ImageSource>(palette_.get());
+	if (name.IsEmpty() || !resolveSprite(*source, name, archive_))
+		return [](SImage&, DecodeProps&) { return false; };
+
+	source->translation = translation;
+
+	// Get palette override
+	if (!palette.IsEmpty())
+	{
+		auto newpal = App::resources().getPaletteEntry(palette, archive_);
+		if (newpal && newpal->size() == 768)
+		{
+			source->palette_override = std::make_unique<Palette>();
+			source->palette_override->loadMem(newpal->data());
+		}
+	}
+
+	return [source](SImage& image, DecodeProps&) { return decodeSprite(*source, image); };
+}
+
+// -----------------------------------------------------------------------------
+// Creates the GL texture for the texture (or flat if [flat] is true) matching
+// [name] from [image] and [props], as decoded by a textureDecoder function.
+// If [image] is null the missing texture is used.
+// Does nothing if the texture was loaded in the meantime
+// -----------------------------------------------------------------------------
+const MapTextureManager::Texture& MapTextureManager::uploadTexture(
+	const wxString&    name,
+	bool               flat,
+	SImage*            image,
+	const DecodeProps& props)
+{
+	auto& mtex   = flat ? flats_[name.Upper()] : textures_[name.Upper()];
+	auto  filter = textureFilter(false);
+	if (isLoaded(mtex, filter))
+		return mtex;
+
+	if (image)
+		mtex.gl_id = OpenGL::Texture::createFromImage(*image, palette_.get(), filter);
+
+	if (mtex.gl_id)
+	{
+		mtex.world_panning = props.world_panning;
+		mtex.scale         = props.scale;
+	}
+	else
+		mtex.gl_id = OpenGL::Texture::missingTexture();
+
+	return mtex;
+}
+
+// -----------------------------------------------------------------------------
+// Creates the GL texture for the sprite matching [name] with [translation] and
+// [palette] from [image], as decoded by a spriteDecoder function.
+// Does nothing if the sprite was loaded in the meantime
+// -----------------------------------------------------------------------------
+const MapTextureManager::Texture& MapTextureManager::uploadSprite(
+	const wxString& name,
+	const wxString& translation,
+	const wxString& palette,
+	SImage*         image)
+{
+	auto& mtex   = sprites_[spriteKey(name, translation, palette)];
+	auto  filter = textureFilter(true);
+	if (isLoaded(mtex, filter) || !image)
+		return mtex;
+
+	// Turn into GL texture
+	mtex.gl_id = OpenGL::Texture::createFromImage(*image, palette_.get(), filter, false);
+
+	return mtex;
+}
+
 // -----------------------------------------------------------------------------
 // Loads all editor images (thing icons, etc) from the program resource archive
 // -----------------------------------------------------------------------------
@@ -6,6 +6,7 @@
 class ArchiveTreeNode;
 class Archive;
 class Palette;
+class SImage;
 
 class MapTextureManager : public Listener
 {
@@ -29,6 +30,14 @@ public:
 	};
 	typedef std::map<wxString, Texture> MapTexHashMap;
 
+	// Texture properties determined along with its image by a Decoder
+	struct DecodeProps
+	{
+		bool  world_panning = false;
+		Vec2d scale         = { 1., 1. };
+	};
+	typedef std::function<bool(SImage&, DecodeProps&)> Decoder;
+
 	struct TexInfo
 	{
 		wxString short_name;
@@ -70,6 +79,16 @@ public:
 	const Texture& editorImage(const wxString& name);
 	int            verticalOffset(const wxString& name) const;
 
+	// Split texture loading, for decoding images in the background
+	Decoder        textureDecoder(const wxString& name, bool flat, bool mixed = false) const;
+	Decoder        spriteDecoder(const wxString& name, const wxString& translation, const wxString& palette) const;
+	const Texture& uploadTexture(const wxString& name, bool flat, SImage* image, const DecodeProps& props);
+	const Texture& uploadSprite(
+		const wxString& name,
+		const wxString& translation,
+		const wxString& palette,
+		SImage*         image);
+
 	vector<TexInfo>& allTexturesInfo() { return tex_info_; }
 	vector<TexInfo>& allFlatsInfo() { return flat_info_; }
 
@@ -0,0 +1,279 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2019 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    MapBuffers2D.cpp
+// Description: MapBuffers2D class - generates the vertex data for the 2d map
+//              view's vertex and line VBOs, and keeps track of which parts of
+//              it changed since the last update so they can be uploaded
+//              without re-uploading everything
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "MapBuffers2D.h"
+#include "App.h"
+#include "SLADEMap/SLADEMap.h"
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Dirty objects at most this far apart are merged into the same range, since a
+// few extra objects are cheaper to upload than another buffer update call
+const unsigned RANGE_MERGE_GAP = 32;
+
+// If more than 1/n of the objects are dirty, everything is regenerated instead
+const unsigned FULL_UPDATE_RATIO = 4;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Sorts the object indices in [indices] and merges them into [ranges]
+// -----------------------------------------------------------------------------
+void buildRanges(vector<unsigned>& indices, vector<MapBuffers2D::Range>& ranges)
+{
+	ranges.clear();
+	if (indices.empty())
+		return;
+
+	std::sort(indices.begin(), indices.end());
+	ranges.push_back({ indices[0], 1 });
+	for (auto index : indices)
+	{
+		auto& range = ranges.back();
+		if (index < range.start + range.count)
+			continue;
+
+		if (index <= range.start + range.count + RANGE_MERGE_GAP)
+			range.count = index - range.start + 1;
+		else
+			ranges.push_back({ index, 1 });
+	}
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// MapBuffers2D Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Forces everything to be regenerated on the next update
+// -----------------------------------------------------------------------------
+void MapBuffers2D::invalidate()
+{
+	vertices_valid_ = false;
+	lines_valid_    = false;
+}
+
+// -----------------------------------------------------------------------------
+// Updates the vertex data for any map vertices modified since the last update.
+// If the result is Update::Partial, the updated vertices are in dirtyVertices
+// -----------------------------------------------------------------------------
+MapBuffers2D::Update MapBuffers2D::updateVertices()
+{
+	auto& vertices  = map_->vertices();
+	auto  structure = map_->mapData().structureVersion();
+	auto  since     = vertices_updated_;
+	dirty_vertices_.clear();
+
+	// Regenerate everything if vertices were added or removed
+	if (!vertices_valid_ || structure != vertices_structure_ || vertex_data_.size() != vertices.size() * 2)
+	{
+		vertex_data_.resize(vertices.size() * 2);
+		for (unsigned a = 0; a < vertices.size(); ++a)
+			writeVertex(a);
+
+		vertices_valid_     = true;
+		vertices_structure_ = structure;
+		vertices_updated_   = App::runTimer();
+		return Update::Full;
+	}
+
+	// Moving a vertex always updates the map geometry time
+	if (map_->geometryUpdated() < since)
+		return Update::None;
+
+	vertices_updated_ = App::runTimer();
+
+	// Find modified vertices
+	dirty_.clear();
+	for (unsigned a = 0; a < vertices.size(); ++a)
+		if (vertices[a]->modifiedTime() >= since)
+			dirty_.push_back(a);
+	if (dirty_.empty())
+		return Update::None;
+
+	// Update them
+	if (dirty_.size() > vertices.size() / FULL_UPDATE_RATIO)
+	{
+		for (unsigned a = 0; a < vertices.size(); ++a)
+			writeVertex(a);
+		dirty_vertices_.push_back({ 0, (unsigned)vertices.size() });
+	}
+	else
+	{
+		for (auto index : dirty_)
+			writeVertex(index);
+		buildRanges(dirty_, dirty_vertices_);
+	}
+
+	return Update::Partial;
+}
+
+// -----------------------------------------------------------------------------
+// Updates the line data for any map lines modified (or with vertices moved)
+// since the last update, with direction tabs if [show_direction] is true.
+// Line colours are given by [colour], with alpha multiplied by [base_alpha].
+// If the result is Update::Partial, the updated lines are in dirtyLines
+// -----------------------------------------------------------------------------
+MapBuffers2D::Update MapBuffers2D::updateLines(bool show_direction, float base_alpha, const LineColourFunc& colour)
+{
+	auto& lines     = map_->lines();
+	auto  structure = map_->mapData().structureVersion();
+	auto  since     = lines_updated_;
+	auto  vpl       = show_direction ? 4u : 2u;
+	dirty_lines_.clear();
+
+	// Regenerate everything if lines were added or removed, or the line
+	// style changed
+	if (!lines_valid_ || structure != lines_structure_ || show_direction != line_dirs_ || base_alpha != line_alpha_
+		|| line_data_.size() != lines.size() * vpl)
+	{
+		line_dirs_  = show_direction;
+		line_alpha_ = base_alpha;
+		line_data_.resize(lines.size() * vpl);
+		for (unsigned a = 0; a < lines.size(); ++a)
+			writeLine(a, colour);
+
+		lines_valid_     = true;
+		lines_structure_ = structure;
+		lines_updated_   = App::runTimer();
+		return Update::Full;
+	}
+
+	lines_updated_ = App::runTimer();
+
+	// Find modified lines
+	dirty_.clear();
+	for (unsigned a = 0; a < lines.size(); ++a)
+		if (lines[a]->modifiedTime() >= since)
+			dirty_.push_back(a);
+
+	// Find lines attached to moved vertices
+	if (map_->geometryUpdated() >= since)
+	{
+		for (auto vertex : map_->vertices())
+			if (vertex->modifiedTime() >= since)
+				for (auto line : vertex->connectedLines())
+					dirty_.push_back(line->index());
+	}
+
+	if (dirty_.empty())
+		return Update::None;
+
+	// Update them
+	if (dirty_.size() > lines.size() / FULL_UPDATE_RATIO)
+	{
+		for (unsigned a = 0; a < lines.size(); ++a)
+			writeLine(a, colour);
+		dirty_lines_.push_back({ 0, (unsigned)lines.size() });
+	}
+	else
+	{
+		for (auto index : dirty_)
+			writeLine(index, colour);
+		buildRanges(dirty_, dirty_lines_);
+	}
+
+	return Update::Partial;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the data for the map vertex at [index]
+// -----------------------------------------------------------------------------
+void MapBuffers2D::writeVertex(unsigned index)
+{
+	auto vertex                 = map_->vertex(index);
+	vertex_data_[index * 2]     = vertex->xPos();
+	vertex_data_[index * 2 + 1] = vertex->yPos();
+}
+
+// -----------------------------------------------------------------------------
+// Writes the data for the map line at [index], using [colour] for its colour
+// -----------------------------------------------------------------------------
+void MapBuffers2D::writeLine(unsigned index, const LineColourFunc& colour)
+{
+	auto line  = map_->line(index);
+	auto verts = &line_data_[index * verticesPerLine()];
+
+	// Get line colour
+	auto  col   = colour(line);
+	float alpha = line_alpha_ * col.fa();
+
+	// Set line vertices
+	verts[0].x = line->v1()->xPos();
+	verts[0].y = line->v1()->yPos();
+	verts[1].x = line->v2()->xPos();
+	verts[1].y = line->v2()->yPos();
+
+	// Set line colour(s)
+	verts[0].r = verts[1].r = col.fr();
+	verts[0].g = verts[1].g = col.fg();
+	verts[0].b = verts[1].b = col.fb();
+	verts[0].a = verts[1].a = alpha;
+
+	// Direction tab if needed
+	if (line_dirs_)
+	{
+		auto mid   = line->getPoint(MapObject::Point::Mid);
+		auto tab   = line->dirTabPoint();
+		verts[2].x = mid.x;
+		verts[2].y = mid.y;
+		verts[3].x = tab.x;
+		verts[3].y = tab.y;
+
+		// Colours
+		verts[2].r = verts[3].r = col.fr();
+		verts[2].g = verts[3].g = col.fg();
+		verts[2].b = verts[3].b = col.fb();
+		verts[2].a = verts[3].a = alpha * 0.6f;
+	}
+}
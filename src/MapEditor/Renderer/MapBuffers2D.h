@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Utility/Colour.h"
+
+class SLADEMap;
+class MapLine;
+
+// CPU-side vertex data for the 2d map view's vertex and line VBOs, kept up to
+// date incrementally. Each update regenerates only the objects modified since
+// the last one and reports them as dirty ranges, so only those parts of the
+// VBOs need to be uploaded again. Everything is regenerated if objects were
+// added to or removed from the map.
+// Doesn't use OpenGL itself, so it can be used (and benchmarked) headless
+class MapBuffers2D
+{
+public:
+	struct LineVertex
+	{
+		float x, y;
+		float r, g, b, a;
+	};
+
+	// A range of map vertices or lines (not buffer elements)
+	struct Range
+	{
+		unsigned start;
+		unsigned count;
+	};
+
+	enum class Update
+	{
+		None,    // Nothing changed
+		Partial, // Only the dirty ranges changed
+		Full     // Everything was regenerated, and the size may have changed
+	};
+
+	typedef std::function<ColRGBA(MapLine*)> LineColourFunc;
+
+	MapBuffers2D(SLADEMap* map = nullptr) : map_{ map } {}
+	~MapBuffers2D() = default;
+
+	const vector<float>&      vertexData() const { return vertex_data_; }
+	const vector<LineVertex>& lineData() const { return line_data_; }
+	const vector<Range>&      dirtyVertices() const { return dirty_vertices_; }
+	const vector<Range>&      dirtyLines() const { return dirty_lines_; }
+	unsigned                  verticesPerLine() const { return line_dirs_ ? 4 : 2; }
+
+	void   invalidate();
+	Update updateVertices();
+	Update updateLines(bool show_direction, float base_alpha, const LineColourFunc& colour);
+
+private:
+	SLADEMap* map_ = nullptr;
+
+	// Vertices (x,y per map vertex)
+	vector<float> vertex_data_;
+	vector<Range> dirty_vertices_;
+	bool          vertices_valid_     = false;
+	long          vertices_updated_   = 0;
+	unsigned      vertices_structure_ = 0;
+
+	// Lines (2 or 4 vertices per map line, depending on direction tabs)
+	vector<LineVertex> line_data_;
+	vector<Range>      dirty_lines_;
+	bool               lines_valid_     = false;
+	long               lines_updated_   = 0;
+	unsigned           lines_structure_ = 0;
+	bool               line_dirs_       = false;
+	float              line_alpha_      = 1.f;
+
+	vector<unsigned> dirty_; // Dirty object indices, kept to avoid reallocating
+
+	void writeVertex(unsigned index);
+	void writeLine(unsigned index, const LineColourFunc& colour);
+};
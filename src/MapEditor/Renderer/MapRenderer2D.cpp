@@ -44,6 +44,7 @@
 #include "OpenGL/OpenGL.h"
 #include "SLADEMap/SLADEMap.h"
 #include "Utility/Polygon2D.h"
+#include "Utility/Profiler.h"
 
 
 // -----------------------------------------------------------------------------
@@ -178,6 +179,8 @@ bool MapRenderer2D::setupVertexRendering(float size_scale, bool overlay) const
 // -----------------------------------------------------------------------------
 void MapRenderer2D::renderVertices(float alpha)
 {
+	PROFILE_ZONE("MapRenderer2D::renderVertices");
+
 	// Check there are any vertices to render
 	if (map_->nVertices() == 0)
 		return;
@@ -232,6 +235,7 @@ void MapRenderer2D::renderVerticesImmediate()
 
 		glEndList();
 
+		n_vertices_       = map_->nVertices();
 		vertices_updated_ = App::runTimer();
 	}
 }
@@ -246,8 +250,7 @@ void MapRenderer2D::renderVerticesVBO()
 		return;
 
 	// Update vertices VBO if required
-	if (vbo_vertices_ == 0 || map_->nVertices() != n_vertices_ || map_->geometryUpdated() > vertices_updated_)
-		updateVerticesVBO();
+	updateVerticesVBO();
 
 	// Set VBO arrays to use
 	glEnableClientState(GL_VERTEX_ARRAY);
@@ -367,6 +370,8 @@ ColRGBA MapRenderer2D::lineColour(MapLine* line, bool ignore_filter) const
 // -----------------------------------------------------------------------------
 void MapRenderer2D::renderLines(bool show_direction, float alpha)
 {
+	PROFILE_ZONE("MapRenderer2D::renderLines");
+
 	// Check there are any lines to render
 	if (map_->nLines() == 0)
 		return;
@@ -449,6 +454,7 @@ void MapRenderer2D::renderLinesImmediate(bool show_direction, float alpha)
 
 	glEndList();
 	lines_dirs_    = show_direction;
+	n_lines_       = map_->nLines();
 	lines_updated_ = App::runTimer();
 }
 
@@ -462,10 +468,7 @@ void MapRenderer2D::renderLinesVBO(bool show_direction, float alpha)
 		return;
 
 	// Update lines VBO if required
-	if (vbo_lines_ == 0 || show_direction != lines_dirs_ || map_->nLines() != n_lines_
-		|| map_->geometryUpdated() > lines_updated_
-		|| map_->mapData().modifiedSince(lines_updated_, MapObject::Type::Line))
-		updateLinesVBO(show_direction, alpha);
+	updateLinesVBO(show_direction, alpha);
 
 	// Disable any blending
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -1143,6 +1146,8 @@ void MapRenderer2D::renderSimpleSquareThing(double x, double y, double angle, co
 // -----------------------------------------------------------------------------
 void MapRenderer2D::renderThings(float alpha, bool force_dir)
 {
+	PROFILE_ZONE("MapRenderer2D::renderThings");
+
 	// Don't bother if (practically) invisible
 	if (alpha <= 0.01f)
 		return;
@@ -1808,6 +1813,8 @@ void MapRenderer2D::renderPathedThings(vector<MapThing*>& things)
 // -----------------------------------------------------------------------------
 void MapRenderer2D::renderFlats(int type, bool texture, float alpha)
 {
+	PROFILE_ZONE("MapRenderer2D::renderFlats");
+
 	// Don't bother if (practically) invisible
 	if (alpha <= 0.01f)
 		return;
@@ -1974,8 +1981,6 @@ void MapRenderer2D::renderFlatsVBO(int type, bool texture, float alpha)
 	using Game::Feature;
 	using Game::UDMFFeature;
 
-	bool vbo_updated = false;
-
 	if (flat_ignore_light)
 		glColor4f(flat_brightness, flat_brightness, flat_brightness, alpha);
 
@@ -1996,23 +2001,8 @@ void MapRenderer2D::renderFlatsVBO(int type, bool texture, float alpha)
 		last_flat_type_ = type;
 	}
 
-	// First, check if any polygon vertex data has changed (in this case we need to refresh the entire vbo)
-	for (unsigned a = 0; a < map_->nSectors(); a++)
-	{
-		auto poly = map_->sector(a)->polygon();
-		if (poly && poly->vboUpdate() > 1)
-		{
-			updateFlatsVBO();
-			vbo_updated = true;
-		}
-	}
-
-	// Create VBO if necessary
-	if (!vbo_updated && vbo_flats_ == 0)
-	{
-		updateFlatsVBO();
-		vbo_updated = true;
-	}
+	// Write any changed polygon vertex data to the VBO
+	updateFlatsVBO();
 
 	// Setup opengl state
 	if (texture)
@@ -2870,113 +2860,135 @@ void MapRenderer2D::renderObjectEditGroup(ObjectEditGroup* group)
 }
 
 // -----------------------------------------------------------------------------
-// (Re)builds the map vertices VBO
+// Updates the map vertices VBO. Only vertices modified since the last update
+// are uploaded, unless vertices were added or removed
 // -----------------------------------------------------------------------------
 void MapRenderer2D::updateVerticesVBO()
 {
 	// Create VBO if needed
 	if (vbo_vertices_ == 0)
+	{
 		glGenBuffers(1, &vbo_vertices_);
+		buffers_.invalidate();
+	}
+
+	// Update vertex data
+	auto update = buffers_.updateVertices();
+	if (update == MapBuffers2D::Update::None)
+		return;
 
-	// Fill vertices VBO
-	int             nfloats = map_->nVertices() * 2;
-	vector<GLfloat> verts(nfloats);
-	unsigned        i = 0;
-	for (unsigned a = 0; a < map_->nVertices(); a++)
+	// Upload to VBO
+	auto& verts = buffers_.vertexData();
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_vertices_);
+	if (update == MapBuffers2D::Update::Full)
+		glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * verts.size(), verts.data(), GL_DYNAMIC_DRAW);
+	else
 	{
-		verts[i++] = map_->vertex(a)->xPos();
-		verts[i++] = map_->vertex(a)->yPos();
+		for (auto& range : buffers_.dirtyVertices())
+			glBufferSubData(
+				GL_ARRAY_BUFFER,
+				sizeof(GLfloat) * 2 * range.start,
+				sizeof(GLfloat) * 2 * range.count,
+				verts.data() + 2 * range.start);
 	}
-	glBindBuffer(GL_ARRAY_BUFFER, vbo_vertices_);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * nfloats, verts.data(), GL_STATIC_DRAW);
 
 	// Clean up
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-	n_vertices_       = map_->nVertices();
-	vertices_updated_ = App::runTimer();
 }
 
 // -----------------------------------------------------------------------------
-// (Re)builds the map lines VBO
+// Updates the map lines VBO. Only lines modified (or with vertices moved) since
+// the last update are uploaded, unless lines were added or removed or the line
+// style changed
 // -----------------------------------------------------------------------------
 void MapRenderer2D::updateLinesVBO(bool show_direction, float base_alpha)
 {
-	Log::info(3, "Updating lines VBO");
-
 	// Create VBO if needed
 	if (vbo_lines_ == 0)
-		glGenBuffers(1, &vbo_lines_);
-
-	// Determine the number of vertices per line
-	int vpl = 2;
-	if (show_direction)
-		vpl = 4;
-
-	// Fill lines VBO
-	int            nverts = map_->nLines() * vpl;
-	vector<GLVert> lines(nverts);
-	unsigned       v = 0;
-	ColRGBA        col;
-	float          alpha;
-	for (unsigned a = 0; a < map_->nLines(); a++)
 	{
-		auto line = map_->line(a);
+		glGenBuffers(1, &vbo_lines_);
+		buffers_.invalidate();
+	}
 
-		// Get line colour
-		col   = lineColour(line);
-		alpha = base_alpha * col.fa();
-
-		// Set line vertices
-		lines[v].x     = line->v1()->xPos();
-		lines[v].y     = line->v1()->yPos();
-		lines[v + 1].x = line->v2()->xPos();
-		lines[v + 1].y = line->v2()->yPos();
-
-		// Set line colour(s)
-		lines[v].r = lines[v + 1].r = col.fr();
-		lines[v].g = lines[v + 1].g = col.fg();
-		lines[v].b = lines[v + 1].b = col.fb();
-		lines[v].a = lines[v + 1].a = alpha;
-
-		// Direction tab if needed
-		if (show_direction)
-		{
-			auto mid       = line->getPoint(MapObject::Point::Mid);
-			auto tab       = line->dirTabPoint();
-			lines[v + 2].x = mid.x;
-			lines[v + 2].y = mid.y;
-			lines[v + 3].x = tab.x;
-			lines[v + 3].y = tab.y;
-
-			// Colours
-			lines[v + 2].r = lines[v + 3].r = col.fr();
-			lines[v + 2].g = lines[v + 3].g = col.fg();
-			lines[v + 2].b = lines[v + 3].b = col.fb();
-			lines[v + 2].a = lines[v + 3].a = alpha * 0.6f;
-		}
+	// Update line data
+	auto colour = [this](MapLine* line) { return lineColour(line); };
+	auto update = buffers_.updateLines(show_direction, base_alpha, colour);
+	if (update == MapBuffers2D::Update::None)
+		return;
 
-		// Next line
-		v += vpl;
-	}
+	// Upload to VBO
+	auto& lines     = buffers_.lineData();
+	auto  line_size = sizeof(MapBuffers2D::LineVertex) * buffers_.verticesPerLine();
 	glBindBuffer(GL_ARRAY_BUFFER, vbo_lines_);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(GLVert) * nverts, lines.data(), GL_STATIC_DRAW);
+	if (update == MapBuffers2D::Update::Full)
+	{
+		Log::info(3, "Updating lines VBO");
+		glBufferData(GL_ARRAY_BUFFER, sizeof(MapBuffers2D::LineVertex) * lines.size(), lines.data(), GL_DYNAMIC_DRAW);
+	}
+	else
+	{
+		for (auto& range : buffers_.dirtyLines())
+			glBufferSubData(
+				GL_ARRAY_BUFFER,
+				line_size * range.start,
+				line_size * range.count,
+				lines.data() + buffers_.verticesPerLine() * range.start);
+	}
 
 	// Clean up
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-	n_lines_       = map_->nLines();
-	lines_updated_ = App::runTimer();
 }
 
 // -----------------------------------------------------------------------------
-// (Re)builds the map flats VBO
+// Updates the map flats VBO. Polygons with changed vertex data are rewritten in
+// place if they are the same size as before, otherwise (or if sectors were
+// added or removed) the whole VBO is rebuilt
 // -----------------------------------------------------------------------------
 void MapRenderer2D::updateFlatsVBO()
 {
 	if (!flats_use_vbo)
 		return;
 
+	// Check if the VBO needs to be rebuilt
+	bool rebuild = vbo_flats_ == 0 || flat_slots_.size() != map_->nSectors();
+	if (!rebuild)
+	{
+		vector<unsigned> changed;
+		for (unsigned a = 0; a < map_->nSectors(); a++)
+		{
+			auto sector = map_->sector(a);
+			auto poly   = sector->polygon();
+			if (flat_slots_[a].sector != sector)
+			{
+				rebuild = true;
+				break;
+			}
+			if (poly->vboUpdate() > 1)
+			{
+				if (poly->vboDataSize() != flat_slots_[a].size)
+				{
+					rebuild = true;
+					break;
+				}
+				changed.push_back(a);
+			}
+		}
+
+		// Nothing to rebuild, just write changed polygons to their places
+		if (!rebuild)
+		{
+			if (changed.empty())
+				return;
+
+			glBindBuffer(GL_ARRAY_BUFFER, vbo_flats_);
+			for (auto index : changed)
+				map_->sector(index)->polygon()->writeToVBO(flat_slots_[index].offset, flat_slots_[index].index);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+			return;
+		}
+	}
+
 	// Create VBO if needed
 	if (vbo_flats_ == 0)
 		glGenBuffers(1, &vbo_flats_);
@@ -2991,15 +3003,21 @@ void MapRenderer2D::updateFlatsVBO()
 
 	// Allocate buffer data
 	glBindBuffer(GL_ARRAY_BUFFER, vbo_flats_);
-	glBufferData(GL_ARRAY_BUFFER, totalsize, nullptr, GL_STATIC_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, totalsize, nullptr, GL_DYNAMIC_DRAW);
 
 	// Write polygon data to VBO
 	unsigned offset = 0;
 	unsigned index  = 0;
+	flat_slots_.resize(map_->nSectors());
 	for (unsigned a = 0; a < map_->nSectors(); a++)
 	{
-		auto poly = map_->sector(a)->polygon();
-		offset    = poly->writeToVBO(offset, index);
+		auto  poly  = map_->sector(a)->polygon();
+		auto& slot  = flat_slots_[a];
+		slot.sector = map_->sector(a);
+		slot.offset = offset;
+		slot.index  = index;
+		slot.size   = poly->vboDataSize();
+		offset      = poly->writeToVBO(offset, index);
 		index += poly->totalVertices();
 	}
 
@@ -3084,6 +3102,7 @@ void MapRenderer2D::forceUpdate(float line_alpha)
 
 	if (OpenGL::vboSupport())
 	{
+		buffers_.invalidate();
 		updateVerticesVBO();
 		updateLinesVBO(lines_dirs_, line_alpha);
 	}
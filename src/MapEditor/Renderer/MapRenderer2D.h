@@ -1,5 +1,6 @@
 #pragma once
 
+#include "MapBuffers2D.h"
 #include "MapEditor/MapEditor.h"
 #include "Utility/Colour.h"
 
@@ -18,7 +19,7 @@ class ThingType;
 class MapRenderer2D
 {
 public:
-	MapRenderer2D(SLADEMap* map) : map_{ map } {}
+	MapRenderer2D(SLADEMap* map) : map_{ map }, buffers_{ map } {}
 	~MapRenderer2D();
 
 	double viewScaleInv() const { return view_scale_inv_; }
@@ -130,9 +131,20 @@ private:
 	long flats_updated_    = 0;
 
 	// VBOs etc
-	unsigned vbo_vertices_ = 0;
-	unsigned vbo_lines_    = 0;
-	unsigned vbo_flats_    = 0;
+	unsigned     vbo_vertices_ = 0;
+	unsigned     vbo_lines_    = 0;
+	unsigned     vbo_flats_    = 0;
+	MapBuffers2D buffers_;
+
+	// Where each sector's polygon is in the flats VBO
+	struct FlatSlot
+	{
+		MapSector* sector = nullptr;
+		unsigned   offset = 0;
+		unsigned   index  = 0;
+		unsigned   size   = 0;
+	};
+	vector<FlatSlot> flat_slots_;
 
 	// Display lists
 	unsigned list_vertices_ = 0;
@@ -152,18 +164,6 @@ private:
 	vector<uint8_t> vis_t_;
 	vector<uint8_t> vis_s_;
 
-	// Structs
-	struct GLVert
-	{
-		float x, y;
-		float r, g, b, a;
-	};
-	struct GLLine
-	{
-		GLVert v1, v2;   // The line itself
-		GLVert dv1, dv2; // Direction tab
-	};
-
 	// Other
 	bool     lines_dirs_     = false;
 	unsigned n_vertices_     = 0;
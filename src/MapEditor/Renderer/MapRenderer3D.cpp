@@ -44,6 +44,7 @@
 #include "SLADEMap/SLADEMap.h"
 #include "UI/Controls/PaletteChooser.h"
 #include "Utility/MathStuff.h"
+#include "Utility/Profiler.h"
 
 
 // -----------------------------------------------------------------------------
@@ -58,6 +59,7 @@ CVAR(Bool, render_fog_quality, true, CVar::Flag::Save)
 CVAR(Bool, render_max_dist_adaptive, false, CVar::Flag::Save)
 CVAR(Int, render_adaptive_ms, 15, CVar::Flag::Save)
 CVAR(Bool, render_3d_sky, true, CVar::Flag::Save)
+CVAR(Bool, render_3d_portal_vis, true, CVar::Flag::Save)
 CVAR(Int, render_3d_things, 1, CVar::Flag::Save)
 CVAR(Int, render_3d_things_style, 1, CVar::Flag::Save)
 CVAR(Int, render_3d_hilight, 1, CVar::Flag::Save)
@@ -89,7 +91,7 @@ EXTERN_CVAR(Bool, use_zeth_icons)
 // -----------------------------------------------------------------------------
 // MapRenderer3D class constructor
 // -----------------------------------------------------------------------------
-MapRenderer3D::MapRenderer3D(SLADEMap* map) : map_{ map }
+MapRenderer3D::MapRenderer3D(SLADEMap* map) : map_{ map }, visibility_{ map }
 {
 	// Build skybox circle
 	buildSkyCircle();
@@ -142,6 +144,7 @@ void MapRenderer3D::refresh()
 {
 	// Clear any existing map data
 	dist_sectors_.clear();
+	visibility_.clear();
 	if (quads_)
 	{
 		delete quads_;
@@ -163,6 +166,7 @@ void MapRenderer3D::refresh()
 
 	floors_.clear();
 	ceilings_.clear();
+	bvh_flats_.clear();
 
 	// Set sky texture
 	auto minf     = Game::configuration().mapInfo(map_->mapName());
@@ -181,6 +185,9 @@ void MapRenderer3D::clearData()
 	things_.clear();
 	floors_.clear();
 	ceilings_.clear();
+	bvh_walls_.clear();
+	bvh_things_.clear();
+	bvh_flats_.clear();
 
 	// Clear everything else
 	refresh();
@@ -526,6 +533,8 @@ void MapRenderer3D::setFog(ColRGBA& fogcol, uint8_t light)
 // -----------------------------------------------------------------------------
 void MapRenderer3D::renderMap()
 {
+	PROFILE_ZONE("MapRenderer3D::renderMap");
+
 	// Setup GL stuff
 	glEnable(GL_DEPTH_TEST);
 	glCullFace(GL_BACK);
@@ -563,15 +572,22 @@ void MapRenderer3D::renderMap()
 	{
 		floors_.resize(map_->nSectors());
 		ceilings_.resize(map_->nSectors());
+		bvh_flats_.resize(map_->nSectors() * 2);
 	}
 
 	// Create lines array if empty
 	if (lines_.size() != map_->nLines())
+	{
 		lines_.resize(map_->nLines());
+		bvh_walls_.resize(map_->nLines());
+	}
 
 	// Create things array if empty
 	if (things_.size() != map_->nThings())
+	{
 		things_.resize(map_->nThings());
+		bvh_things_.resize(map_->nThings());
+	}
 
 	// Quick distance vis check
 	sf::Clock clock;
@@ -718,6 +734,8 @@ void MapRenderer3D::renderSkySlice(float top, float bottom, float atop, float ab
 // -----------------------------------------------------------------------------
 void MapRenderer3D::renderSky()
 {
+	PROFILE_ZONE("MapRenderer3D::renderSky");
+
 	OpenGL::setColour(ColRGBA::WHITE);
 	glDisable(GL_CULL_FACE);
 	glDisable(GL_FOG);
@@ -951,6 +969,33 @@ void MapRenderer3D::updateSector(unsigned index)
 		sector->polygon()->updateVBOData();
 	}
 
+	// Update picking bounds
+	auto bbox = sector->boundingBox();
+	for (unsigned a = 0; a < 2; a++)
+	{
+		// Get the plane's height range over the sector's bounding box (unbounded
+		// if the plane is vertical)
+		auto&  plane = a == 0 ? floors_[index].plane : ceilings_[index].plane;
+		double min_z = -1000000;
+		double max_z = 1000000;
+		if (plane.c != 0)
+		{
+			double h1 = plane.heightAt(bbox.min.x, bbox.min.y);
+			double h2 = plane.heightAt(bbox.min.x, bbox.max.y);
+			double h3 = plane.heightAt(bbox.max.x, bbox.min.y);
+			double h4 = plane.heightAt(bbox.max.x, bbox.max.y);
+			if (std::isfinite(h1) && std::isfinite(h2) && std::isfinite(h3) && std::isfinite(h4))
+			{
+				min_z = std::min({ h1, h2, h3, h4 });
+				max_z = std::max({ h1, h2, h3, h4 });
+			}
+		}
+
+		BVH::Box box({ bbox.min.x, bbox.min.y, min_z }, { bbox.max.x, bbox.max.y, max_z });
+		box.pad(1);
+		bvh_flats_.setItem(index * 2 + a, box);
+	}
+
 	// Finish up
 	floors_[index].updated_time   = App::runTimer();
 	ceilings_[index].updated_time = App::runTimer();
@@ -1044,6 +1089,8 @@ void MapRenderer3D::renderFlat(Flat* flat)
 // -----------------------------------------------------------------------------
 void MapRenderer3D::renderFlats()
 {
+	PROFILE_ZONE("MapRenderer3D::renderFlats");
+
 	// Check for map
 	if (!map_)
 		return;
@@ -1272,7 +1319,10 @@ void MapRenderer3D::updateLine(unsigned index)
 	// Skip invalid line
 	auto line = map_->line(index);
 	if (!line->s1())
+	{
+		bvh_walls_.removeItem(index);
 		return;
+	}
 
 	// Process line special
 	map_->mapSpecials()->processLineSpecial(line);
@@ -1854,6 +1904,14 @@ void MapRenderer3D::updateLine(unsigned index)
 		lines_[index].quads.push_back(quad);
 	}
 
+	// Update picking bounds
+	BVH::Box box;
+	for (auto& quad : lines_[index].quads)
+		for (auto& point : quad.points)
+			box.extend(Vec3d(point.x, point.y, point.z));
+	box.pad(1);
+	bvh_walls_.setItem(index, box);
+
 	// Finished
 	lines_[index].updated_time = App::runTimer();
 }
@@ -1914,6 +1972,8 @@ void MapRenderer3D::renderQuad(MapRenderer3D::Quad* quad, float alpha)
 // -----------------------------------------------------------------------------
 void MapRenderer3D::renderWalls()
 {
+	PROFILE_ZONE("MapRenderer3D::renderWalls");
+
 	// Init
 	quads_transparent_.clear();
 	glEnable(GL_TEXTURE_2D);
@@ -1964,6 +2024,8 @@ void MapRenderer3D::renderWalls()
 // -----------------------------------------------------------------------------
 void MapRenderer3D::renderTransparentWalls()
 {
+	PROFILE_ZONE("MapRenderer3D::renderTransparentWalls");
+
 	// Init
 	glEnable(GL_TEXTURE_2D);
 	glDepthMask(GL_FALSE);
@@ -2090,7 +2152,7 @@ void MapRenderer3D::updateThing(unsigned index, MapThing* thing)
 
 	// Setup thing info
 	things_[index].type   = &(Game::configuration().thingType(thing->type()));
-	things_[index].sector = map_->sectors().atPos(thing->position());
+	things_[index].sector = map_->sector(map_->mapData().geometry().sectorAt(thing->position()));
 
 	// Get sprite texture
 	uint32_t theight      = render_thing_icon_size;
@@ -2154,6 +2216,21 @@ void MapRenderer3D::updateThing(unsigned index, MapThing* thing)
 	// Adjust height by sprite Y offset if needed
 	things_[index].z += MapEditor::textureManager().verticalOffset(things_[index].type->sprite());
 
+	// Update picking bounds (same size as checked in determineHilight)
+	auto&  tex_info  = OpenGL::Texture::info(things_[index].sprite);
+	double halfwidth = tex_info.size.x * 0.5;
+	double height    = tex_info.size.y;
+	if (things_[index].flags & ICON)
+	{
+		halfwidth = render_thing_icon_size * 0.5;
+		height    = render_thing_icon_size;
+	}
+	BVH::Box box(
+		{ thing->xPos() - halfwidth, thing->yPos() - halfwidth, things_[index].z },
+		{ thing->xPos() + halfwidth, thing->yPos() + halfwidth, things_[index].z + height });
+	box.pad(1);
+	bvh_things_.setItem(index, box);
+
 	things_[index].updated_time = App::runTimer();
 }
 
@@ -2162,6 +2239,8 @@ void MapRenderer3D::updateThing(unsigned index, MapThing* thing)
 // -----------------------------------------------------------------------------
 void MapRenderer3D::renderThings()
 {
+	PROFILE_ZONE("MapRenderer3D::renderThings");
+
 	// Init
 	glEnable(GL_TEXTURE_2D);
 	glCullFace(GL_BACK);
@@ -2206,6 +2285,10 @@ void MapRenderer3D::renderThings()
 				break;
 		}
 
+		// Skip if in a sector that isn't visible
+		if (vis_valid_ && things_[a].sector && !visibility_.sectorVisible(things_[a].sector->index()))
+			continue;
+
 		// Skip if not shown
 		if (!things_[a].type->decoration() && render_3d_things == 2)
 			continue;
@@ -2558,8 +2641,10 @@ void MapRenderer3D::updateFlatsVBO()
 void MapRenderer3D::updateWallsVBO() const {}
 
 // -----------------------------------------------------------------------------
-// Runs a quick check of all sector bounding boxes against the current view to
-// hide any that are outside it
+// Determines the potentially visible sectors and lines from the camera.
+// Uses portal visibility if possible, otherwise runs a quick check of all
+// sector bounding boxes against the current view to hide any that are outside
+// it
 // -----------------------------------------------------------------------------
 void MapRenderer3D::quickVisDiscard()
 {
@@ -2567,6 +2652,25 @@ void MapRenderer3D::quickVisDiscard()
 	if (dist_sectors_.size() != map_->nSectors())
 		dist_sectors_.resize(map_->nSectors());
 
+	// Portal visibility (when looking up/down steeply, anything around the camera can be in view)
+	bool full_view = cam_pitch_ <= -0.9 || cam_pitch_ >= 0.9;
+	vis_valid_     = false;
+	if (render_3d_portal_vis)
+		vis_valid_ = visibility_.compute(cam_position_, cam_direction_, full_view, render_max_dist);
+	if (vis_valid_)
+	{
+		std::fill(dist_sectors_.begin(), dist_sectors_.end(), -1.0f);
+		for (auto index : visibility_.visibleSectors())
+			dist_sectors_[index] = 0.0f;
+
+		for (auto& line : lines_)
+			line.visible = false;
+		for (auto index : visibility_.visibleLines())
+			lines_[index].visible = true;
+
+		return;
+	}
+
 	// Go through all sectors
 	auto   cam = cam_position_.get2d();
 	double min_dist, dist;
@@ -2660,9 +2764,12 @@ void MapRenderer3D::checkVisibleQuads()
 	unsigned updates = 0;
 	bool     update  = false;
 	Seg2d    strafe(cam_position_.get2d(), (cam_position_ + cam_strafe_).get2d());
-	for (unsigned a = 0; a < lines_.size(); a++)
+	auto&    vis_lines = visibility_.visibleLines();
+	unsigned n_lines   = vis_valid_ ? vis_lines.size() : lines_.size();
+	for (unsigned l = 0; l < n_lines; l++)
 	{
-		line = map_->line(a);
+		unsigned a = vis_valid_ ? vis_lines[l] : l;
+		line       = map_->line(a);
 
 		// Skip if not visible
 		if (!lines_[a].visible)
@@ -2740,11 +2847,14 @@ void MapRenderer3D::checkVisibleFlats()
 	// Go through sectors
 	MapSector* sector;
 	n_flats_ = 0;
-	float alpha;
-	auto  cam = cam_position_.get2d();
-	for (unsigned a = 0; a < map_->nSectors(); a++)
+	float    alpha;
+	auto     cam         = cam_position_.get2d();
+	auto&    vis_sectors = visibility_.visibleSectors();
+	unsigned n_sectors   = vis_valid_ ? vis_sectors.size() : map_->nSectors();
+	for (unsigned s = 0; s < n_sectors; s++)
 	{
-		sector = map_->sector(a);
+		unsigned a = vis_valid_ ? vis_sectors[s] : s;
+		sector     = map_->sector(a);
 
 		// Skip if invisible
 		if (dist_sectors_[a] < 0)
@@ -2779,8 +2889,10 @@ void MapRenderer3D::checkVisibleFlats()
 		// Add floor flat
 		flats_[n_flats_++] = &(floors_[a]);
 	}
-	for (unsigned a = 0; a < map_->nSectors(); a++)
+	for (unsigned s = 0; s < n_sectors; s++)
 	{
+		unsigned a = vis_valid_ ? vis_sectors[s] : s;
+
 		// Skip if invisible
 		if (dist_sectors_[a] < 0)
 			continue;
@@ -2805,23 +2917,21 @@ MapEditor::Item MapRenderer3D::determineHilight()
 		|| things_.size() != map_->nThings())
 		return current;
 
-	// Check lines
-	double height, dist;
-	for (unsigned a = 0; a < map_->nLines(); a++)
-	{
+	// Check lines (only those whose bounds are hit by the view ray)
+	bvh_walls_.intersectRay(cam_position_, cam_dir3d_, min_dist, [&](unsigned a) {
 		// Ignore if not visible
 		if (!lines_[a].visible)
-			continue;
+			return;
 
 		auto line = map_->line(a);
 
 		// Find (2d) distance to line
-		dist = MathStuff::distanceRayLine(
+		double dist = MathStuff::distanceRayLine(
 			cam_position_.get2d(), (cam_position_ + cam_dir3d_).get2d(), line->start(), line->end());
 
 		// Ignore if no intersection or something was closer
 		if (dist < 0 || dist >= min_dist)
-			continue;
+			return;
 
 		// Find quad intersect if any
 		auto intersection = cam_position_ + cam_dir3d_ * dist;
@@ -2864,49 +2974,57 @@ MapEditor::Item MapRenderer3D::determineHilight()
 				min_dist = dist;
 			}
 		}
-	}
+	});
 
-	// Check sectors
-	for (unsigned a = 0; a < map_->nSectors(); a++)
-	{
+	// Check sector floors/ceilings
+	bvh_flats_.intersectRay(cam_position_, cam_dir3d_, min_dist, [&](unsigned item) {
 		// Ignore if not visible
-		if (dist_sectors_[a] < 0)
-			continue;
+		unsigned a = item / 2;
+		if (a >= dist_sectors_.size() || dist_sectors_[a] < 0)
+			return;
 
-		// Check distance to floor plane
-		dist = MathStuff::distanceRayPlane(cam_position_, cam_dir3d_, floors_[a].plane);
-		if (dist >= 0 && dist < min_dist)
+		// Floor
+		if (item % 2 == 0)
 		{
-			// Check if on the correct side of the plane
-			if (cam_position_.z > floors_[a].plane.heightAt(cam_position_.x, cam_position_.y))
+			// Check distance to floor plane
+			double dist = MathStuff::distanceRayPlane(cam_position_, cam_dir3d_, floors_[a].plane);
+			if (dist >= 0 && dist < min_dist)
 			{
-				// Check if intersection is within sector
-				if (map_->sector(a)->containsPoint((cam_position_ + cam_dir3d_ * dist).get2d()))
+				// Check if on the correct side of the plane
+				if (cam_position_.z > floors_[a].plane.heightAt(cam_position_.x, cam_position_.y))
 				{
-					current.index = a;
-					current.type  = MapEditor::ItemType::Floor;
-					min_dist      = dist;
+					// Check if intersection is within sector
+					if (map_->sector(a)->containsPoint((cam_position_ + cam_dir3d_ * dist).get2d()))
+					{
+						current.index = a;
+						current.type  = MapEditor::ItemType::Floor;
+						min_dist      = dist;
+					}
 				}
 			}
 		}
 
-		// Check distance to ceiling plane
-		dist = MathStuff::distanceRayPlane(cam_position_, cam_dir3d_, ceilings_[a].plane);
-		if (dist >= 0 && dist < min_dist)
+		// Ceiling
+		else
 		{
-			// Check if on the correct side of the plane
-			if (cam_position_.z < ceilings_[a].plane.heightAt(cam_position_.x, cam_position_.y))
+			// Check distance to ceiling plane
+			double dist = MathStuff::distanceRayPlane(cam_position_, cam_dir3d_, ceilings_[a].plane);
+			if (dist >= 0 && dist < min_dist)
 			{
-				// Check if intersection is within sector
-				if (map_->sector(a)->containsPoint((cam_position_ + cam_dir3d_ * dist).get2d()))
+				// Check if on the correct side of the plane
+				if (cam_position_.z < ceilings_[a].plane.heightAt(cam_position_.x, cam_position_.y))
 				{
-					current.index = a;
-					current.type  = MapEditor::ItemType::Ceiling;
-					min_dist      = dist;
+					// Check if intersection is within sector
+					if (map_->sector(a)->containsPoint((cam_position_ + cam_dir3d_ * dist).get2d()))
+					{
+						current.index = a;
+						current.type  = MapEditor::ItemType::Ceiling;
+						min_dist      = dist;
+					}
 				}
 			}
 		}
-	}
+	});
 
 	// Update item distance
 	if (min_dist >= 9999999 || min_dist < 0)
@@ -2917,28 +3035,26 @@ MapEditor::Item MapRenderer3D::determineHilight()
 	// Check things (if visible)
 	if (render_3d_things == 0)
 		return current;
-	double halfwidth, theight;
-	for (unsigned a = 0; a < map_->nThings(); a++)
-	{
+	bvh_things_.intersectRay(cam_position_, cam_dir3d_, min_dist, [&](unsigned a) {
 		// Ignore if no sprite
 		if (!things_[a].sprite)
-			continue;
+			return;
 
 		// Ignore if not visible
 		auto thing = map_->thing(a);
 		if (MathStuff::lineSide(thing->position(), strafe) > 0)
-			continue;
+			return;
 
 		// Ignore if not shown
 		if (!things_[a].type->decoration() && render_3d_things == 2)
-			continue;
+			return;
 
 		// Find distance to thing sprite
-		auto& tex_info = OpenGL::Texture::info(things_[a].sprite);
-		halfwidth      = tex_info.size.x * 0.5;
+		auto&  tex_info  = OpenGL::Texture::info(things_[a].sprite);
+		double halfwidth = tex_info.size.x * 0.5;
 		if (things_[a].flags & ICON)
 			halfwidth = render_thing_icon_size * 0.5;
-		dist = MathStuff::distanceRayLine(
+		double dist = MathStuff::distanceRayLine(
 			cam_position_.get2d(),
 			(cam_position_ + cam_dir3d_).get2d(),
 			thing->position() - cam_strafe_.get2d() * halfwidth,
@@ -2946,11 +3062,11 @@ MapEditor::Item MapRenderer3D::determineHilight()
 
 		// Ignore if no intersection or something was closer
 		if (dist < 0 || dist >= min_dist)
-			continue;
+			return;
 
 		// Check intersection height
-		theight = tex_info.size.y;
-		height  = cam_position_.z + cam_dir3d_.z * dist;
+		double theight = tex_info.size.y;
+		double height  = cam_position_.z + cam_dir3d_.z * dist;
 		if (things_[a].flags & ICON)
 			theight = render_thing_icon_size;
 		if (height >= things_[a].z && height <= things_[a].z + theight)
@@ -2959,7 +3075,7 @@ MapEditor::Item MapRenderer3D::determineHilight()
 			current.type  = MapEditor::ItemType::Thing;
 			min_dist      = dist;
 		}
-	}
+	});
 
 	// Update item distance
 	if (min_dist >= 9999999 || min_dist < 0)
@@ -2,7 +2,9 @@
 
 #include "General/ListenerAnnouncer.h"
 #include "MapEditor/Edit/Edit3D.h"
+#include "MapVisibility.h"
 #include "SLADEMap/SLADEMap.h"
+#include "Utility/BVH.h"
 
 class ItemSelection;
 class Polygon2D;
@@ -198,6 +200,8 @@ private:
 
 	// Visibility
 	vector<float> dist_sectors_;
+	MapVisibility visibility_;
+	bool          vis_valid_ = false;
 
 	// Camera
 	Vec3d  cam_position_;
@@ -218,6 +222,11 @@ private:
 	vector<Flat>  ceilings_;
 	Flat**        flats_ = nullptr;
 
+	// Picking (hilight) acceleration
+	BVH bvh_walls_;  // Item per line
+	BVH bvh_flats_;  // Items per sector (floor, ceiling)
+	BVH bvh_things_; // Item per thing
+
 	// VBOs
 	unsigned vbo_floors_   = 0;
 	unsigned vbo_ceilings_ = 0;
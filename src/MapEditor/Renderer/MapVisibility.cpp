@@ -0,0 +1,410 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2019 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    MapVisibility.cpp
+// Description: MapVisibility class - determines the potentially visible set of
+//              sectors and lines from a 3d mode camera position, by flooding
+//              out from the camera's sector through the two-sided lines
+//              (portals) that fall within the view.
+//              Doesn't need an OpenGL context, so can be used headless
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "MapVisibility.h"
+#include "App.h"
+#include "SLADEMap/SLADEMap.h"
+#include "Utility/MathStuff.h"
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Tolerance for view cone tests (on normalized vectors), errs towards visible
+const double CONE_EPSILON = 0.0001;
+
+// Lines closer than this to the camera are always considered in view, since
+// the direction to them is unreliable (MathStuff::distanceToLine can also be up
+// to a unit out near the ends of a line)
+const double NEAR_DISTANCE = 2.0;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// MapVisibility::Window Struct Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Window constructor, for the view cone going anticlockwise from [start] to
+// [end]
+// -----------------------------------------------------------------------------
+MapVisibility::Window::Window(Vec2d start, Vec2d end) : start{ start }, end{ end }
+{
+	// For a 180 degree cone, the middle is perpendicular (anticlockwise) to start
+	mid = start + end;
+	if (mid.magnitude() < 0.000001)
+		mid.set(-start.y, start.x);
+	mid.normalize();
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// MapVisibility Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Sets the map to check visibility in to [map]
+// -----------------------------------------------------------------------------
+void MapVisibility::setMap(SLADEMap* map)
+{
+	map_ = map;
+	clear();
+}
+
+// -----------------------------------------------------------------------------
+// Clears all portal and visibility data
+// -----------------------------------------------------------------------------
+void MapVisibility::clear()
+{
+	sectors_.clear();
+	portals_updated_ = -1;
+	n_portals_       = 0;
+	last_sector_     = -1;
+	stamp_           = 0;
+	line_stamp_.clear();
+	visible_sectors_.clear();
+	visible_lines_.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Updates the sector portal lists.
+// Only sectors whose geometry has changed since the last update are rebuilt,
+// unless the map geometry as a whole has changed
+// -----------------------------------------------------------------------------
+void MapVisibility::updatePortals()
+{
+	if (!map_)
+	{
+		clear();
+		return;
+	}
+
+	// Rebuild everything if sectors were added/removed or the map geometry changed
+	auto n_sectors = map_->nSectors();
+	bool rebuild   = sectors_.size() != n_sectors || map_->geometryUpdated() >= portals_updated_;
+	if (rebuild)
+	{
+		sectors_.clear();
+		sectors_.resize(n_sectors);
+		n_portals_   = 0;
+		last_sector_ = -1;
+	}
+
+	for (unsigned a = 0; a < n_sectors; a++)
+		if (rebuild || map_->sector(a)->geometryUpdatedTime() >= portals_updated_)
+			buildSectorPortals(a);
+
+	portals_updated_ = App::runTimer();
+}
+
+// -----------------------------------------------------------------------------
+// Rebuilds the portal and line lists for the sector at [index]
+// -----------------------------------------------------------------------------
+void MapVisibility::buildSectorPortals(unsigned index)
+{
+	auto  sector = map_->sector(index);
+	auto& info   = sectors_[index];
+
+	n_portals_ -= info.portals.size();
+	info.portals.clear();
+	info.lines.clear();
+
+	for (auto side : sector->connectedSides())
+	{
+		auto line = side->parentLine();
+		if (!line)
+			continue;
+		info.lines.push_back(line);
+
+		// Two-sided lines are portals into the sector on the other side
+		bool front = line->s1() == side;
+		auto other = front ? line->s2() : line->s1();
+		if (!other || !other->sector())
+			continue;
+
+		Portal portal;
+		portal.line  = line;
+		portal.to    = other->sector();
+		portal.front = front;
+		info.portals.push_back(portal);
+	}
+
+	n_portals_ += info.portals.size();
+}
+
+// -----------------------------------------------------------------------------
+// Determines the sectors and lines potentially visible from [camera], looking
+// in [direction] (with a 180 degree field of view, or all around if
+// [full_view] is true). Nothing further than [max_dist] is visible, if it is
+// positive.
+//
+// Returns false if the camera isn't within a sector (or is above/below it), in
+// which case visibility can't be determined and everything should be
+// considered potentially visible
+// -----------------------------------------------------------------------------
+bool MapVisibility::compute(Vec3d camera, Vec2d direction, bool full_view, double max_dist)
+{
+	visible_sectors_.clear();
+	visible_lines_.clear();
+	if (!map_)
+		return false;
+
+	updatePortals();
+
+	// Find the sector containing the camera (most likely the same as last time)
+	auto cam    = camera.get2d();
+	int  sector = -1;
+	if (last_sector_ >= 0 && last_sector_ < (int)map_->nSectors() && map_->sector(last_sector_)->containsPoint(cam))
+		sector = last_sector_;
+	else if (auto found = map_->sectors().atPos(cam))
+		sector = found->index();
+	last_sector_ = sector;
+	if (sector < 0)
+		return false;
+
+	// Check the camera is vertically within the sector
+	auto cam_sector = map_->sector(sector);
+	if (camera.z < cam_sector->floor().plane.heightAt(cam) - 1.0
+		|| camera.z > cam_sector->ceiling().plane.heightAt(cam) + 1.0)
+		return false;
+
+	// Start a new query
+	if (++stamp_ == 0)
+	{
+		for (auto& info : sectors_)
+			info.stamp = 0;
+		std::fill(line_stamp_.begin(), line_stamp_.end(), 0);
+		stamp_ = 1;
+	}
+	line_stamp_.resize(map_->nLines(), 0);
+
+	// Initial view cone
+	Window view;
+	if (full_view)
+		view.full = true;
+	else
+	{
+		auto  dir = direction.normalized();
+		Vec2d right(dir.y, -dir.x);
+		view = Window(right, right * -1.0);
+	}
+
+	// Flood out from the camera sector through any portals within the view
+	struct Visit
+	{
+		unsigned sector;
+		Window   window;
+	};
+	vector<Visit> stack;
+	stack.push_back({ (unsigned)sector, view });
+	Window clipped;
+	while (!stack.empty())
+	{
+		auto visit = stack.back();
+		stack.pop_back();
+		auto& info = sectors_[visit.sector];
+
+		// Mark sector visible, resetting traversal state if this is its first visit
+		if (info.stamp != stamp_)
+		{
+			info.stamp     = stamp_;
+			info.visits    = 0;
+			info.saturated = false;
+			visible_sectors_.push_back(visit.sector);
+		}
+		if (info.saturated)
+			continue;
+
+		// Skip if the sector has already been visited with a wider window
+		bool seen = false;
+		for (unsigned a = 0; a < info.visits; a++)
+		{
+			auto& prev = info.windows[a];
+			if (prev.full || (windowContains(prev, visit.window.start) && windowContains(prev, visit.window.end)))
+			{
+				seen = true;
+				break;
+			}
+		}
+		if (seen)
+			continue;
+
+		// Once a sector has been visited too many times, visit it once more with the
+		// whole view window instead, which covers any further visits
+		if (info.visits == MAX_SECTOR_VISITS)
+		{
+			info.saturated = true;
+			visit.window   = view;
+		}
+		else
+			info.windows[info.visits++] = visit.window;
+
+		// Mark any of its lines within the view window visible
+		for (auto line : info.lines)
+		{
+			auto index = line->index();
+			if (line_stamp_[index] == stamp_)
+				continue;
+
+			double dist = MathStuff::distanceToLine(cam, line->seg());
+			if (max_dist > 0 && dist > max_dist + NEAR_DISTANCE)
+				continue;
+			if (dist < NEAR_DISTANCE || clipWindow(visit.window, line->start() - cam, line->end() - cam, clipped))
+			{
+				line_stamp_[index] = stamp_;
+				visible_lines_.push_back(index);
+			}
+		}
+
+		// Go through portals
+		for (auto& portal : info.portals)
+		{
+			// Skip if the sector beyond has already been fully visited
+			auto  to_index = portal.to->index();
+			auto& to_info  = sectors_[to_index];
+			if (to_info.stamp == stamp_ && to_info.saturated)
+				continue;
+
+			// Check the portal isn't closed (eg. a shut door)
+			if (!portalOpen(map_->sector(visit.sector), portal.to))
+				continue;
+
+			// Check distance
+			auto   seg  = portal.line->seg();
+			double dist = MathStuff::distanceToLine(cam, seg);
+			if (max_dist > 0 && dist > max_dist + NEAR_DISTANCE)
+				continue;
+
+			// Determine the view window through the portal
+			if (dist < NEAR_DISTANCE)
+				clipped = visit.window;
+			else
+			{
+				// Can only see through the portal from the sector's side of it
+				double side = MathStuff::lineSide(cam, seg);
+				if (portal.front ? side <= 0 : side >= 0)
+					continue;
+
+				if (!clipWindow(visit.window, seg.start() - cam, seg.end() - cam, clipped))
+					continue;
+			}
+
+			stack.push_back({ to_index, clipped });
+		}
+	}
+
+	std::sort(visible_sectors_.begin(), visible_sectors_.end());
+	std::sort(visible_lines_.begin(), visible_lines_.end());
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the portal between [sector1] and [sector2] can be seen
+// through. It's closed if the sectors' flat floors and ceilings leave no gap
+// between them (sloped planes are always considered open)
+// -----------------------------------------------------------------------------
+bool MapVisibility::portalOpen(MapSector* sector1, MapSector* sector2)
+{
+	auto sloped = [](const Plane& plane) { return plane.a != 0. || plane.b != 0.; };
+	if (sloped(sector1->floor().plane) || sloped(sector1->ceiling().plane) || sloped(sector2->floor().plane)
+		|| sloped(sector2->ceiling().plane))
+		return true;
+
+	return std::min(sector1->ceiling().height, sector2->ceiling().height)
+		   > std::max(sector1->floor().height, sector2->floor().height);
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the (normalized) direction [dir] is within [window]
+// -----------------------------------------------------------------------------
+bool MapVisibility::windowContains(const Window& window, Vec2d dir)
+{
+	if (window.full)
+		return true;
+
+	return window.start.cross(dir) >= -CONE_EPSILON && dir.cross(window.end) >= -CONE_EPSILON
+		   && window.mid.dot(dir) >= -CONE_EPSILON;
+}
+
+// -----------------------------------------------------------------------------
+// Clips [window] to the cone from the camera to the line from [v1] to [v2]
+// (relative to the camera), writing the result to [out].
+// Returns false if the line is entirely outside the window
+// -----------------------------------------------------------------------------
+bool MapVisibility::clipWindow(const Window& window, Vec2d v1, Vec2d v2, Window& out)
+{
+	v1.normalize();
+	v2.normalize();
+	if (v1.cross(v2) < 0)
+		std::swap(v1, v2);
+	Window line(v1, v2);
+
+	if (window.full)
+	{
+		out = line;
+		return true;
+	}
+
+	// The clipped cone starts at whichever start is within the other cone, and
+	// likewise ends at whichever end is within the other cone
+	Vec2d start, end;
+	if (windowContains(window, line.start))
+		start = line.start;
+	else if (windowContains(line, window.start))
+		start = window.start;
+	else
+		return false;
+	if (windowContains(window, line.end))
+		end = line.end;
+	else if (windowContains(line, window.end))
+		end = window.end;
+	else
+		return false;
+
+	out = Window(start, end);
+	return true;
+}
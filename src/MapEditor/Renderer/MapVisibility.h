@@ -0,0 +1,80 @@
+#pragma once
+
+class SLADEMap;
+class MapLine;
+class MapSector;
+
+class MapVisibility
+{
+public:
+	MapVisibility(SLADEMap* map = nullptr) : map_{ map } {}
+	~MapVisibility() = default;
+
+	SLADEMap*               map() const { return map_; }
+	const vector<unsigned>& visibleSectors() const { return visible_sectors_; }
+	const vector<unsigned>& visibleLines() const { return visible_lines_; }
+	unsigned                nPortals() const { return n_portals_; }
+
+	bool sectorVisible(unsigned index) const { return index < sectors_.size() && sectors_[index].stamp == stamp_; }
+	bool lineVisible(unsigned index) const { return index < line_stamp_.size() && line_stamp_[index] == stamp_; }
+
+	void setMap(SLADEMap* map);
+	void clear();
+	void updatePortals();
+	bool compute(Vec3d camera, Vec2d direction, bool full_view, double max_dist = -1);
+
+	static bool portalOpen(MapSector* sector1, MapSector* sector2);
+
+private:
+	// A view cone from the camera, going anticlockwise from [start] to [end]
+	// (all normalized). Spans at most 180 degrees unless [full] is set
+	struct Window
+	{
+		Vec2d start;
+		Vec2d end;
+		Vec2d mid; // A direction within the cone, to tell it apart from its opposite
+		bool  full = false;
+
+		Window() = default;
+		Window(Vec2d start, Vec2d end);
+	};
+
+	// A two-sided line leading from a sector into [to]
+	struct Portal
+	{
+		MapLine*   line  = nullptr;
+		MapSector* to    = nullptr;
+		bool       front = true; // Whether the sector is on the front side of the line
+	};
+
+	static const unsigned MAX_SECTOR_VISITS = 4;
+
+	struct SectorPortals
+	{
+		vector<Portal>   portals;
+		vector<MapLine*> lines;
+
+		// Per-query traversal state (reset when [stamp] differs)
+		unsigned stamp     = 0;
+		unsigned visits    = 0;
+		bool     saturated = false;
+		Window   windows[MAX_SECTOR_VISITS];
+	};
+
+	SLADEMap*             map_ = nullptr;
+	vector<SectorPortals> sectors_;
+	long                  portals_updated_ = -1;
+	unsigned              n_portals_       = 0;
+	int                   last_sector_     = -1;
+
+	// Query results
+	unsigned         stamp_ = 0;
+	vector<unsigned> line_stamp_;
+	vector<unsigned> visible_sectors_;
+	vector<unsigned> visible_lines_;
+
+	void buildSectorPortals(unsigned index);
+
+	static bool windowContains(const Window& window, Vec2d dir);
+	static bool clipWindow(const Window& window, Vec2d v1, Vec2d v2, Window& out);
+};
@@ -42,6 +42,7 @@
 #include "OpenGL/OpenGL.h"
 #include "Overlays/MCOverlay.h"
 #include "Utility/MathStuff.h"
+#include "Utility/Profiler.h"
 
 using namespace MapEditor;
 
@@ -971,6 +972,8 @@ void Renderer::drawAnimations() const
 // -----------------------------------------------------------------------------
 void Renderer::drawMap2d()
 {
+	PROFILE_ZONE("Renderer::drawMap2d");
+
 	// Apply the current 2d view
 	view_.apply();
 
@@ -1196,6 +1199,8 @@ void Renderer::drawMap2d()
 // -----------------------------------------------------------------------------
 void Renderer::drawMap3d()
 {
+	PROFILE_ZONE("Renderer::drawMap3d");
+
 	// Setup 3d renderer view
 	renderer_3d_.setupView(view_.size().x, view_.size().y);
 
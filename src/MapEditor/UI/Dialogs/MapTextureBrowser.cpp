@@ -93,6 +93,33 @@ bool MapTexBrowserItem::loadImage()
 		return false;
 }
 
+// -----------------------------------------------------------------------------
+// Returns a function to decode the texture or flat image
+// -----------------------------------------------------------------------------
+ImageDecodeQueue::DecodeFunc MapTexBrowserItem::imageDecoder()
+{
+	if (type_ != TEXTURE && type_ != FLAT)
+		return {};
+
+	auto decoder  = MapEditor::textureManager().textureDecoder(name_, type_ == FLAT);
+	auto props    = std::make_shared<MapTextureManager::DecodeProps>();
+	decode_props_ = props;
+	return [decoder, props](SImage& image) { return decoder(image, *props); };
+}
+
+// -----------------------------------------------------------------------------
+// Adds the decoded texture or flat [image] to the texture manager, and uses it
+// for the item
+// -----------------------------------------------------------------------------
+bool MapTexBrowserItem::imageDecoded(SImage& image, bool ok)
+{
+	auto& tex = MapEditor::textureManager().uploadTexture(name_, type_ == FLAT, ok ? &image : nullptr, *decode_props_);
+
+	image_tex_ = tex.gl_id;
+	scale_     = tex.scale;
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Returns a string with extra information about the texture/flat
 // -----------------------------------------------------------------------------
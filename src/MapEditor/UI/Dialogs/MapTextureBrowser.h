@@ -21,9 +21,14 @@ public:
 	int      usageCount() const { return usage_count_; }
 	void     setUsage(int count) { usage_count_ = count; }
 
+	ImageDecodeQueue::DecodeFunc imageDecoder() override;
+	bool                         imageDecoded(SImage& image, bool ok) override;
+
 private:
 	int   usage_count_ = 0;
 	Vec2d scale_       = { 1., 1. };
+
+	std::shared_ptr<MapTextureManager::DecodeProps> decode_props_;
 };
 
 class MapTextureBrowser : public BrowserWindow
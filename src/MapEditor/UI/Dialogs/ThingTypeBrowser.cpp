@@ -61,7 +61,43 @@ CVAR(Bool, use_zeth_icons, false, CVar::Flag::Save)
 bool ThingBrowserItem::loadImage()
 {
 	// Get sprite
-	auto tex = MapEditor::textureManager().sprite(type_.sprite(), type_.translation(), type_.palette()).gl_id;
+	return setImage(MapEditor::textureManager().sprite(type_.sprite(), type_.translation(), type_.palette()).gl_id);
+}
+
+// -----------------------------------------------------------------------------
+// Returns a function to decode the sprite image, or an empty function if there
+// is no sprite (the icon is loaded instead)
+// -----------------------------------------------------------------------------
+ImageDecodeQueue::DecodeFunc ThingBrowserItem::imageDecoder()
+{
+	if (type_.sprite().IsEmpty())
+		return {};
+
+	auto decoder = MapEditor::textureManager().spriteDecoder(type_.sprite(), type_.translation(), type_.palette());
+	return [decoder](SImage& image) {
+		MapTextureManager::DecodeProps props;
+		return decoder(image, props);
+	};
+}
+
+// -----------------------------------------------------------------------------
+// Adds the decoded sprite [image] to the texture manager, and uses it for the
+// item (or an icon if the sprite wasn't found)
+// -----------------------------------------------------------------------------
+bool ThingBrowserItem::imageDecoded(SImage& image, bool ok)
+{
+	auto& sprite = MapEditor::textureManager().uploadSprite(
+		type_.sprite(), type_.translation(), type_.palette(), ok ? &image : nullptr);
+
+	return setImage(sprite.gl_id);
+}
+
+// -----------------------------------------------------------------------------
+// Sets the item image to [sprite_tex], or to the thing type's icon if it is 0
+// -----------------------------------------------------------------------------
+bool ThingBrowserItem::setImage(unsigned sprite_tex)
+{
+	auto tex = sprite_tex;
 	if (!tex && use_zeth_icons && type_.zethIcon() >= 0)
 	{
 		// Sprite not found, try the Zeth icon
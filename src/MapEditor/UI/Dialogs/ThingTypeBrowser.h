@@ -19,8 +19,13 @@ public:
 
 	bool loadImage() override;
 
+	ImageDecodeQueue::DecodeFunc imageDecoder() override;
+	bool                         imageDecoded(SImage& image, bool ok) override;
+
 private:
 	Game::ThingType const& type_;
+
+	bool setImage(unsigned sprite_tex);
 };
 
 class ThingTypeBrowser : public BrowserWindow
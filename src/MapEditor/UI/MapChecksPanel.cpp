@@ -38,6 +38,7 @@
 #include "MapEditor/MapEditor.h"
 #include "SLADEMap/SLADEMap.h"
 #include "UI/WxUtils.h"
+#include "Utility/Profiler.h"
 #include "Utility/SFileDialog.h"
 
 
@@ -335,7 +336,10 @@ void MapChecksPanel::onBtnCheck(wxCommandEvent& e)
 	{
 		// Check
 		updateStatusText(check->progressText());
-		check->doCheck();
+		{
+			PROFILE_ZONE("MapCheck::doCheck");
+			check->doCheck();
+		}
 
 		// Add results to list
 		for (unsigned b = 0; b < check->nProblems(); b++)
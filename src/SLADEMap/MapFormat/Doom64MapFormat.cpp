@@ -142,8 +142,7 @@ bool Doom64MapFormat::readVERTEXES(ArchiveEntry* entry, MapObjectCollection& map
 	for (size_t a = 0; a < nv; a++)
 	{
 		UI::setSplashProgress(p + ((float)a / nv) * 0.2f);
-		map_data.addVertex(
-			std::make_unique<MapVertex>(Vec2d{ (double)vert_data[a].x / 65536, (double)vert_data[a].y / 65536 }));
+		map_data.createVertex(Vec2d{ (double)vert_data[a].x / 65536, (double)vert_data[a].y / 65536 });
 	}
 
 	Log::info(3, wxString::Format("Read %lu vertices", map_data.vertices().size()));
@@ -178,12 +177,12 @@ bool Doom64MapFormat::readSIDEDEFS(ArchiveEntry* entry, MapObjectCollection& map
 		UI::setSplashProgress(p + ((float)a / ns) * 0.2f);
 
 		// Add side
-		map_data.addSide(std::make_unique<MapSide>(
+		map_data.createSide(
 			map_data.sectors().at(side_data[a].sector),
 			ResourceManager::doom64TextureName(side_data[a].tex_upper),
 			ResourceManager::doom64TextureName(side_data[a].tex_middle),
 			ResourceManager::doom64TextureName(side_data[a].tex_lower),
-			Vec2i{ side_data[a].x_offset, side_data[a].y_offset }));
+			Vec2i{ side_data[a].x_offset, side_data[a].y_offset });
 	}
 
 	Log::info(3, wxString::Format("Read %lu sides", map_data.sides().size()));
@@ -240,8 +239,7 @@ bool Doom64MapFormat::readLINEDEFS(ArchiveEntry* entry, MapObjectCollection& map
 		}
 
 		// Create line
-		auto line = map_data.addLine(
-			std::make_unique<MapLine>(v1, v2, map_data.sides().at(s1_index), map_data.sides().at(s2_index)));
+		auto line = map_data.createLine(v1, v2, map_data.sides().at(s1_index), map_data.sides().at(s2_index));
 
 		// Set properties
 		line->setArg(0, data.sector_tag);
@@ -286,14 +284,14 @@ bool Doom64MapFormat::readSECTORS(ArchiveEntry* entry, MapObjectCollection& map_
 		const auto& data = sect_data[a];
 
 		// Add sector
-		auto sector = map_data.addSector(std::make_unique<MapSector>(
+		auto sector = map_data.createSector(
 			data.f_height,
 			ResourceManager::doom64TextureName(data.f_tex),
 			data.c_height,
 			ResourceManager::doom64TextureName(data.c_tex),
 			255,
 			data.special,
-			data.tag));
+			data.tag);
 
 		// Set properties
 		sector->setIntProperty("flags", data.flags);
@@ -338,13 +336,13 @@ bool Doom64MapFormat::readTHINGS(ArchiveEntry* entry, MapObjectCollection& map_d
 		const auto& data = thng_data[a];
 
 		// Create thing
-		auto thing = map_data.addThing(std::make_unique<MapThing>(
+		auto thing = map_data.createThing(
 			Vec3d{ (double)data.x, (double)data.y, (double)data.z },
 			data.type,
 			data.angle,
 			data.flags,
 			args,
-			data.tid));
+			data.tid);
 	}
 
 	Log::info(3, wxString::Format("Read %lu things", map_data.things().size()));
@@ -122,14 +122,8 @@ bool UniversalDoomMapFormat::readMap(Archive::MapDesc map, MapObjectCollection&
 	{
 		UI::setSplashProgress(((float)a / defs_vertices.size()) * 0.2f);
 
-		auto vertex = createVertex(defs_vertices[a]);
-		if (!vertex)
-		{
+		if (!createVertex(defs_vertices[a], map_data))
 			Log::warning(wxString::Format("Invalid UDMF vertex definition %d, not added", a));
-			continue;
-		}
-
-		map_data.addVertex(std::move(vertex));
 	}
 
 	// Create sectors from parsed data
@@ -138,14 +132,8 @@ bool UniversalDoomMapFormat::readMap(Archive::MapDesc map, MapObjectCollection&
 	{
 		UI::setSplashProgress(0.2f + ((float)a / defs_sectors.size()) * 0.2f);
 
-		auto sector = createSector(defs_sectors[a]);
-		if (!sector)
-		{
+		if (!createSector(defs_sectors[a], map_data))
 			Log::warning(wxString::Format("Invalid UDMF sector definition %d, not added", a));
-			continue;
-		}
-
-		map_data.addSector(std::move(sector));
 	}
 
 	// Create sides from parsed data
@@ -154,14 +142,8 @@ bool UniversalDoomMapFormat::readMap(Archive::MapDesc map, MapObjectCollection&
 	{
 		UI::setSplashProgress(0.4f + ((float)a / defs_sides.size()) * 0.2f);
 
-		auto side = createSide(defs_sides[a], map_data);
-		if (!side)
-		{
+		if (!createSide(defs_sides[a], map_data))
 			Log::warning(wxString::Format("Invalid UDMF side definition %d, not added", a));
-			continue;
-		}
-
-		map_data.addSide(std::move(side));
 	}
 
 	// Create lines from parsed data
@@ -170,14 +152,8 @@ bool UniversalDoomMapFormat::readMap(Archive::MapDesc map, MapObjectCollection&
 	{
 		UI::setSplashProgress(0.6f + ((float)a / defs_lines.size()) * 0.2f);
 
-		auto line = createLine(defs_lines[a], map_data);
-		if (!line)
-		{
+		if (!createLine(defs_lines[a], map_data))
 			Log::warning(wxString::Format("Invalid UDMF line definition %d, not added", a));
-			continue;
-		}
-
-		map_data.addLine(std::move(line));
 	}
 
 	// Create things from parsed data
@@ -186,14 +162,8 @@ bool UniversalDoomMapFormat::readMap(Archive::MapDesc map, MapObjectCollection&
 	{
 		UI::setSplashProgress(0.8f + ((float)a / defs_things.size()) * 0.2f);
 
-		auto thing = createThing(defs_things[a]);
-		if (!thing)
-		{
+		if (!createThing(defs_things[a], map_data))
 			Log::warning(wxString::Format("Invalid UDMF thing definition %d, not added", a));
-			continue;
-		}
-
-		map_data.addThing(std::move(thing));
 	}
 
 	// Keep map-scope values
@@ -318,9 +288,10 @@ vector<ArchiveEntry::UPtr> UniversalDoomMapFormat::writeMap(
 }
 
 // -----------------------------------------------------------------------------
-// Creates and returns a vertex from parsed UDMF definition [def]
+// Creates a vertex from parsed UDMF definition [def] in [map_data] and returns
+// it, or nullptr if [def] is invalid
 // -----------------------------------------------------------------------------
-std::unique_ptr<MapVertex> UniversalDoomMapFormat::createVertex(ParseTreeNode* def) const
+MapVertex* UniversalDoomMapFormat::createVertex(ParseTreeNode* def, MapObjectCollection& map_data) const
 {
 	// Check for required properties
 	auto prop_x = def->childPTN("x");
@@ -329,13 +300,14 @@ std::unique_ptr<MapVertex> UniversalDoomMapFormat::createVertex(ParseTreeNode* d
 		return nullptr;
 
 	// Create vertex
-	return std::make_unique<MapVertex>(Vec2d{ prop_x->floatValue(), prop_y->floatValue() }, def);
+	return map_data.createVertex(Vec2d{ prop_x->floatValue(), prop_y->floatValue() }, def);
 }
 
 // -----------------------------------------------------------------------------
-// Creates and returns a sector from parsed UDMF definition [def]
+// Creates a sector from parsed UDMF definition [def] in [map_data] and returns
+// it, or nullptr if [def] is invalid
 // -----------------------------------------------------------------------------
-std::unique_ptr<MapSector> UniversalDoomMapFormat::createSector(ParseTreeNode* def) const
+MapSector* UniversalDoomMapFormat::createSector(ParseTreeNode* def, MapObjectCollection& map_data) const
 {
 	// Check for required properties
 	auto prop_ftex = def->childPTN("texturefloor");
@@ -344,14 +316,14 @@ std::unique_ptr<MapSector> UniversalDoomMapFormat::createSector(ParseTreeNode* d
 		return nullptr;
 
 	// Create sector
-	return std::make_unique<MapSector>(prop_ftex->stringValue(), prop_ctex->stringValue(), def);
+	return map_data.createSector(prop_ftex->stringValue(), prop_ctex->stringValue(), def);
 }
 
 // -----------------------------------------------------------------------------
-// Creates and returns a side from parsed UDMF definition [def]
+// Creates a side from parsed UDMF definition [def] in [map_data] and returns
+// it, or nullptr if [def] is invalid
 // -----------------------------------------------------------------------------
-std::unique_ptr<MapSide> UniversalDoomMapFormat::createSide(ParseTreeNode* def, const MapObjectCollection& map_data)
-	const
+MapSide* UniversalDoomMapFormat::createSide(ParseTreeNode* def, MapObjectCollection& map_data) const
 {
 	// Check for required properties
 	auto prop_sector = def->childPTN("sector");
@@ -364,14 +336,14 @@ std::unique_ptr<MapSide> UniversalDoomMapFormat::createSide(ParseTreeNode* def,
 		return nullptr;
 
 	// Create side
-	return std::make_unique<MapSide>(sector, def);
+	return map_data.createSide(sector, def);
 }
 
 // -----------------------------------------------------------------------------
-// Creates and returns a line from parsed UDMF definition [def]
+// Creates a line from parsed UDMF definition [def] in [map_data] and returns
+// it, or nullptr if [def] is invalid
 // -----------------------------------------------------------------------------
-std::unique_ptr<MapLine> UniversalDoomMapFormat::createLine(ParseTreeNode* def, const MapObjectCollection& map_data)
-	const
+MapLine* UniversalDoomMapFormat::createLine(ParseTreeNode* def, MapObjectCollection& map_data) const
 {
 	// Check for required properties
 	auto prop_v1 = def->childPTN(MapLine::PROP_V1);
@@ -392,13 +364,14 @@ std::unique_ptr<MapLine> UniversalDoomMapFormat::createLine(ParseTreeNode* def,
 	auto s2 = prop_s2 ? map_data.sides().at(prop_s2->intValue()) : nullptr;
 
 	// Create line
-	return std::make_unique<MapLine>(v1, v2, s1, s2, def);
+	return map_data.createLine(v1, v2, s1, s2, def);
 }
 
 // -----------------------------------------------------------------------------
-// Creates and returns a thing from parsed UDMF definition [def]
+// Creates a thing from parsed UDMF definition [def] in [map_data] and returns
+// it, or nullptr if [def] is invalid
 // -----------------------------------------------------------------------------
-std::unique_ptr<MapThing> UniversalDoomMapFormat::createThing(ParseTreeNode* def) const
+MapThing* UniversalDoomMapFormat::createThing(ParseTreeNode* def, MapObjectCollection& map_data) const
 {
 	// Check for required properties
 	auto prop_x    = def->childPTN(MapThing::PROP_X);
@@ -408,6 +381,5 @@ std::unique_ptr<MapThing> UniversalDoomMapFormat::createThing(ParseTreeNode* def
 		return nullptr;
 
 	// Create thing
-	return std::make_unique<MapThing>(
-		Vec3d{ prop_x->floatValue(), prop_y->floatValue(), 0. }, prop_type->intValue(), def);
+	return map_data.createThing(Vec3d{ prop_x->floatValue(), prop_y->floatValue(), 0. }, prop_type->intValue(), def);
 }
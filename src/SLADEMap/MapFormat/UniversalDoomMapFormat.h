@@ -22,9 +22,9 @@ public:
 private:
 	wxString udmf_namespace_;
 
-	std::unique_ptr<MapVertex> createVertex(ParseTreeNode* def) const;
-	std::unique_ptr<MapSector> createSector(ParseTreeNode* def) const;
-	std::unique_ptr<MapSide>   createSide(ParseTreeNode* def, const MapObjectCollection& map_data) const;
-	std::unique_ptr<MapLine>   createLine(ParseTreeNode* def, const MapObjectCollection& map_data) const;
-	std::unique_ptr<MapThing>  createThing(ParseTreeNode* def) const;
+	MapVertex* createVertex(ParseTreeNode* def, MapObjectCollection& map_data) const;
+	MapSector* createSector(ParseTreeNode* def, MapObjectCollection& map_data) const;
+	MapSide*   createSide(ParseTreeNode* def, MapObjectCollection& map_data) const;
+	MapLine*   createLine(ParseTreeNode* def, MapObjectCollection& map_data) const;
+	MapThing*  createThing(ParseTreeNode* def, MapObjectCollection& map_data) const;
 };
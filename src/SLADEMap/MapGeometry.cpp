@@ -0,0 +1,302 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2019 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    MapGeometry.cpp
+// Description: MapGeometry class - a copy of map geometry in flat arrays, with
+//              batch queries (distance to many lines, sector at point, etc.)
+//              that process it in cache-friendly passes
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "MapGeometry.h"
+#include "MapObjectCollection.h"
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Lines/sectors are processed in chunks of this size, small enough for the
+// per-chunk results to stay on the stack (and in cache)
+const unsigned CHUNK_SIZE = 256;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// MapGeometry Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Rebuilds the geometry from the map objects in [objects]
+// -----------------------------------------------------------------------------
+void MapGeometry::build(const MapObjectCollection& objects)
+{
+	// Vertices
+	auto& vertices = objects.vertices();
+	vertex_x_.resize(vertices.size());
+	vertex_y_.resize(vertices.size());
+	for (unsigned a = 0; a < vertices.size(); ++a)
+	{
+		vertex_x_[a] = vertices[a]->xPos();
+		vertex_y_[a] = vertices[a]->yPos();
+	}
+
+	// Lines
+	auto& lines   = objects.lines();
+	auto  n_lines = lines.size();
+	line_v1_.resize(n_lines);
+	line_v2_.resize(n_lines);
+	line_front_.resize(n_lines);
+	line_back_.resize(n_lines);
+	line_x1_.resize(n_lines);
+	line_y1_.resize(n_lines);
+	line_ca_.resize(n_lines);
+	line_sa_.resize(n_lines);
+	line_length_.resize(n_lines);
+	for (unsigned a = 0; a < n_lines; ++a)
+	{
+		auto line      = lines[a];
+		auto front     = line->frontSector();
+		auto back      = line->backSector();
+		line_v1_[a]    = line->v1()->index();
+		line_v2_[a]    = line->v2()->index();
+		line_front_[a] = front ? (int)front->index() : -1;
+		line_back_[a]  = back ? (int)back->index() : -1;
+
+		// Same as MapLine::distanceTo calculates (a zero length line is just
+		// the point at v1)
+		double dx       = vertex_x_[line_v2_[a]] - vertex_x_[line_v1_[a]];
+		double dy       = vertex_y_[line_v2_[a]] - vertex_y_[line_v1_[a]];
+		double length   = sqrt(dx * dx + dy * dy);
+		line_x1_[a]     = vertex_x_[line_v1_[a]];
+		line_y1_[a]     = vertex_y_[line_v1_[a]];
+		line_length_[a] = length;
+		line_ca_[a]     = length != 0 ? dx / length : 0.;
+		line_sa_[a]     = length != 0 ? dy / length : 0.;
+	}
+
+	// Sector bounding boxes and lines (counted first, then filled in)
+	auto n_sectors = objects.sectors().size();
+	sector_min_x_.assign(n_sectors, 0.);
+	sector_min_y_.assign(n_sectors, 0.);
+	sector_max_x_.assign(n_sectors, 0.);
+	sector_max_y_.assign(n_sectors, 0.);
+	sector_lines_start_.assign(n_sectors + 1, 0);
+	for (unsigned a = 0; a < n_lines; ++a)
+	{
+		if (line_front_[a] >= 0)
+			++sector_lines_start_[line_front_[a] + 1];
+		if (line_back_[a] >= 0)
+			++sector_lines_start_[line_back_[a] + 1];
+	}
+	for (unsigned a = 0; a < n_sectors; ++a)
+		sector_lines_start_[a + 1] += sector_lines_start_[a];
+
+	vector<unsigned> next(sector_lines_start_.begin(), sector_lines_start_.end() - 1);
+	sector_lines_.resize(sector_lines_start_.back());
+	for (unsigned a = 0; a < n_lines; ++a)
+	{
+		for (auto sector : { line_front_[a], line_back_[a] })
+		{
+			if (sector < 0)
+				continue;
+
+			double x1 = vertex_x_[line_v1_[a]];
+			double y1 = vertex_y_[line_v1_[a]];
+			double x2 = vertex_x_[line_v2_[a]];
+			double y2 = vertex_y_[line_v2_[a]];
+			if (next[sector] == sector_lines_start_[sector])
+			{
+				// First line of sector
+				sector_min_x_[sector] = std::min(x1, x2);
+				sector_min_y_[sector] = std::min(y1, y2);
+				sector_max_x_[sector] = std::max(x1, x2);
+				sector_max_y_[sector] = std::max(y1, y2);
+			}
+			else
+			{
+				sector_min_x_[sector] = std::min(sector_min_x_[sector], std::min(x1, x2));
+				sector_min_y_[sector] = std::min(sector_min_y_[sector], std::min(y1, y2));
+				sector_max_x_[sector] = std::max(sector_max_x_[sector], std::max(x1, x2));
+				sector_max_y_[sector] = std::max(sector_max_y_[sector], std::max(y1, y2));
+			}
+
+			sector_lines_[next[sector]++] = a;
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Writes the distance from [point] to each line to [distances], which must
+// have room for nLines values
+// -----------------------------------------------------------------------------
+void MapGeometry::lineDistances(Vec2d point, double* distances) const
+{
+	lineDistances(point, 0, nLines(), distances);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the index of the line nearest to [point], or -1 if no line is closer
+// than [min]. Equivalent to LineList::nearest
+// -----------------------------------------------------------------------------
+int MapGeometry::nearestLine(Vec2d point, double min) const
+{
+	double distances[CHUNK_SIZE];
+	double min_dist = min;
+	int    nearest  = -1;
+	for (unsigned first = 0; first < nLines(); first += CHUNK_SIZE)
+	{
+		auto count = std::min(CHUNK_SIZE, nLines() - first);
+		lineDistances(point, first, count, distances);
+
+		for (unsigned a = 0; a < count; ++a)
+			if (distances[a] < min_dist)
+			{
+				nearest  = first + a;
+				min_dist = distances[a];
+			}
+	}
+
+	return nearest;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [point] is within [sector]. Equivalent to
+// MapSector::containsPoint
+// -----------------------------------------------------------------------------
+bool MapGeometry::sectorContains(unsigned sector, Vec2d point) const
+{
+	// Check with bbox first
+	if (point.x < sector_min_x_[sector] || point.x > sector_max_x_[sector] || point.y < sector_min_y_[sector]
+		|| point.y > sector_max_y_[sector])
+		return false;
+
+	// Find nearest line in the sector
+	double min_dist = 999999;
+	int    nline    = -1;
+	for (auto a = sector_lines_start_[sector]; a < sector_lines_start_[sector + 1]; ++a)
+	{
+		auto dist = lineDistance(sector_lines_[a], point);
+		if (dist < min_dist)
+		{
+			nline    = sector_lines_[a];
+			min_dist = dist;
+		}
+	}
+
+	// No nearest (shouldn't happen)
+	if (nline < 0)
+		return false;
+
+	// Check the side of the nearest line
+	auto x1   = line_x1_[nline];
+	auto y1   = line_y1_[nline];
+	auto side = (point.x - x1) * (vertex_y_[line_v2_[nline]] - y1) - (point.y - y1) * (vertex_x_[line_v2_[nline]] - x1);
+	if (side >= 0)
+		return line_front_[nline] == (int)sector;
+	else
+		return line_back_[nline] == (int)sector;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the index of the (first) sector containing [point], or -1 if it is
+// not within any sector. Equivalent to SectorList::atPos
+// -----------------------------------------------------------------------------
+int MapGeometry::sectorAt(Vec2d point) const
+{
+	uint8_t in_bbox[CHUNK_SIZE];
+	for (unsigned first = 0; first < nSectors(); first += CHUNK_SIZE)
+	{
+		auto count = std::min(CHUNK_SIZE, nSectors() - first);
+
+		// Check all sector bboxes in the chunk
+		auto min_x = sector_min_x_.data() + first;
+		auto min_y = sector_min_y_.data() + first;
+		auto max_x = sector_max_x_.data() + first;
+		auto max_y = sector_max_y_.data() + first;
+		for (unsigned a = 0; a < count; ++a)
+			in_bbox[a] = (point.x >= min_x[a]) & (point.x <= max_x[a]) & (point.y >= min_y[a]) & (point.y <= max_y[a]);
+
+		// Check the sectors the point is within the bbox of
+		for (unsigned a = 0; a < count; ++a)
+			if (in_bbox[a] && sectorContains(first + a, point))
+				return first + a;
+	}
+
+	return -1;
+}
+
+// -----------------------------------------------------------------------------
+// Sets [sectors] to the index of the sector containing each point in [points]
+// (or -1 if the point isn't within a sector)
+// -----------------------------------------------------------------------------
+void MapGeometry::sectorsAt(const vector<Vec2d>& points, vector<int>& sectors) const
+{
+	sectors.resize(points.size());
+	for (unsigned a = 0; a < points.size(); ++a)
+		sectors[a] = sectorAt(points[a]);
+}
+
+// -----------------------------------------------------------------------------
+// Writes the distance from [point] to [count] lines beginning at [first] to
+// [distances]. This is the same calculation as MapLine::distanceTo, written
+// without branches so it can be vectorized
+// -----------------------------------------------------------------------------
+void MapGeometry::lineDistances(Vec2d point, unsigned first, unsigned count, double* distances) const
+{
+	auto x1     = line_x1_.data() + first;
+	auto y1     = line_y1_.data() + first;
+	auto ca     = line_ca_.data() + first;
+	auto sa     = line_sa_.data() + first;
+	auto length = line_length_.data() + first;
+	for (unsigned a = 0; a < count; ++a)
+	{
+		// Clip intersection to line (but not exactly on endpoints)
+		double mx = (point.x - x1[a]) * ca[a] + (point.y - y1[a]) * sa[a];
+		mx        = mx <= 0 ? 0.00001 : (mx >= length[a] ? length[a] - 0.00001 : mx);
+
+		double dx    = x1[a] + mx * ca[a] - point.x;
+		double dy    = y1[a] + mx * sa[a] - point.y;
+		distances[a] = sqrt(dx * dx + dy * dy);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the distance from [point] to [line]
+// -----------------------------------------------------------------------------
+double MapGeometry::lineDistance(unsigned line, Vec2d point) const
+{
+	double distance;
+	lineDistances(point, line, 1, &distance);
+	return distance;
+}
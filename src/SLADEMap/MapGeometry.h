@@ -0,0 +1,70 @@
+#pragma once
+
+class MapObjectCollection;
+
+// A copy of the map geometry (vertex positions, line vertices and sectors,
+// sector bounds) in flat arrays, for queries that need to check many lines or
+// sectors at once. Going through these is much faster than going through the
+// map objects themselves, since the data for all lines etc. is contiguous and
+// can be processed in simple (vectorizable) loops.
+// Line distances and sector containment give the same results as
+// MapLine::distanceTo and MapSector::containsPoint.
+// Use MapObjectCollection::geometry to get an up-to-date copy for a map
+class MapGeometry
+{
+public:
+	MapGeometry()  = default;
+	~MapGeometry() = default;
+
+	unsigned nVertices() const { return vertex_x_.size(); }
+	unsigned nLines() const { return line_v1_.size(); }
+	unsigned nSectors() const { return sector_lines_start_.empty() ? 0 : sector_lines_start_.size() - 1; }
+
+	Vec2d    vertexPos(unsigned index) const { return { vertex_x_[index], vertex_y_[index] }; }
+	unsigned lineV1(unsigned index) const { return line_v1_[index]; }
+	unsigned lineV2(unsigned index) const { return line_v2_[index]; }
+	int      lineFrontSector(unsigned index) const { return line_front_[index]; }
+	int      lineBackSector(unsigned index) const { return line_back_[index]; }
+
+	void build(const MapObjectCollection& objects);
+
+	// Batch queries
+	void lineDistances(Vec2d point, double* distances) const;
+	int  nearestLine(Vec2d point, double min = 64) const;
+	bool sectorContains(unsigned sector, Vec2d point) const;
+	int  sectorAt(Vec2d point) const;
+	void sectorsAt(const vector<Vec2d>& points, vector<int>& sectors) const;
+
+private:
+	// Vertices
+	vector<double> vertex_x_;
+	vector<double> vertex_y_;
+
+	// Lines (sector indices are -1 for no sector)
+	vector<unsigned> line_v1_;
+	vector<unsigned> line_v2_;
+	vector<int>      line_front_;
+	vector<int>      line_back_;
+
+	// Line geometry for distance calculations (start point, direction and
+	// length, as used in MapLine::distanceTo)
+	vector<double> line_x1_;
+	vector<double> line_y1_;
+	vector<double> line_ca_;
+	vector<double> line_sa_;
+	vector<double> line_length_;
+
+	// Sector bounding boxes
+	vector<double> sector_min_x_;
+	vector<double> sector_min_y_;
+	vector<double> sector_max_x_;
+	vector<double> sector_max_y_;
+
+	// Lines of each sector (one per side), sector_lines_[sector_lines_start_[s]]
+	// to sector_lines_[sector_lines_start_[s + 1] - 1] for sector s
+	vector<unsigned> sector_lines_start_;
+	vector<unsigned> sector_lines_;
+
+	void   lineDistances(Vec2d point, unsigned first, unsigned count, double* distances) const;
+	double lineDistance(unsigned line, Vec2d point) const;
+};
@@ -104,6 +104,10 @@ void MapObject::setModified()
 	}
 
 	modified_time_ = App::runTimer();
+
+	// The map's geometry cache depends on vertices, lines and sides
+	if (parent_map_ && (type_ == Type::Vertex || type_ == Type::Line || type_ == Type::Side))
+		parent_map_->invalidateGeometry();
 }
 
 // -----------------------------------------------------------------------------
@@ -48,13 +48,23 @@ MapObjectCollection::MapObjectCollection(SLADEMap* parent_map) : parent_map_{ pa
 }
 
 // -----------------------------------------------------------------------------
-// Adds [object] to the map objects list
+// Adds [object] to the map objects list, taking ownership of it
 // -----------------------------------------------------------------------------
 void MapObjectCollection::addMapObject(std::unique_ptr<MapObject> object)
+{
+	addMapObject(object.get());
+	objects_.back().owned = std::move(object);
+}
+
+// -----------------------------------------------------------------------------
+// Adds [object] (owned by one of the object pools) to the map objects list
+// -----------------------------------------------------------------------------
+void MapObjectCollection::addMapObject(MapObject* object)
 {
 	object->obj_id_     = objects_.size();
 	object->parent_map_ = parent_map_;
-	objects_.emplace_back(std::move(object), true);
+	objects_.emplace_back(object, true);
+	++structure_version_;
 }
 
 // -----------------------------------------------------------------------------
@@ -64,6 +74,7 @@ void MapObjectCollection::addMapObject(std::unique_ptr<MapObject> object)
 void MapObjectCollection::removeMapObject(MapObject* object)
 {
 	objects_[object->obj_id_].in_map = false;
+	++structure_version_;
 }
 
 // -----------------------------------------------------------------------------
@@ -104,6 +115,8 @@ void MapObjectCollection::putObjectIdList(MapObject::Type type, vector<unsigned>
 // -----------------------------------------------------------------------------
 void MapObjectCollection::restoreObjectIdList(MapObject::Type type, vector<unsigned>& list)
 {
+	++structure_version_;
+
 	if (type == MapObject::Type::Vertex)
 	{
 		// Clear
@@ -115,7 +128,7 @@ void MapObjectCollection::restoreObjectIdList(MapObject::Type type, vector<unsig
 		for (auto id : list)
 		{
 			objects_[id].in_map = true;
-			vertices_.add(dynamic_cast<MapVertex*>(objects_[id].object.get()));
+			vertices_.add(dynamic_cast<MapVertex*>(objects_[id].object));
 			vertices_.last()->index_ = vertices_.size() - 1;
 		}
 	}
@@ -130,7 +143,7 @@ void MapObjectCollection::restoreObjectIdList(MapObject::Type type, vector<unsig
 		for (auto id : list)
 		{
 			objects_[id].in_map = true;
-			lines_.add(dynamic_cast<MapLine*>(objects_[id].object.get()));
+			lines_.add(dynamic_cast<MapLine*>(objects_[id].object));
 			lines_.back()->index_ = lines_.size() - 1;
 		}
 	}
@@ -145,7 +158,7 @@ void MapObjectCollection::restoreObjectIdList(MapObject::Type type, vector<unsig
 		for (auto id : list)
 		{
 			objects_[id].in_map = true;
-			sides_.add(dynamic_cast<MapSide*>(objects_[id].object.get()));
+			sides_.add(dynamic_cast<MapSide*>(objects_[id].object));
 			sides_.back()->index_ = sides_.size() - 1;
 		}
 	}
@@ -160,7 +173,7 @@ void MapObjectCollection::restoreObjectIdList(MapObject::Type type, vector<unsig
 		for (auto id : list)
 		{
 			objects_[id].in_map = true;
-			sectors_.add(dynamic_cast<MapSector*>(objects_[id].object.get()));
+			sectors_.add(dynamic_cast<MapSector*>(objects_[id].object));
 			sectors_.back()->index_ = sectors_.size() - 1;
 		}
 	}
@@ -175,7 +188,7 @@ void MapObjectCollection::restoreObjectIdList(MapObject::Type type, vector<unsig
 		for (auto id : list)
 		{
 			objects_[id].in_map = true;
-			things_.add(dynamic_cast<MapThing*>(objects_[id].object.get()));
+			things_.add(dynamic_cast<MapThing*>(objects_[id].object));
 			things_.back()->index_ = things_.size() - 1;
 		}
 	}
@@ -219,11 +232,34 @@ void MapObjectCollection::clear()
 	sectors_.clear();
 	things_.clear();
 
-	// Clear map objects
+	// Clear map objects (all pooled objects are freed in bulk)
 	objects_.clear();
+	vertex_pool_.clear();
+	side_pool_.clear();
+	line_pool_.clear();
+	sector_pool_.clear();
+	thing_pool_.clear();
 
 	// Object id 0 is always null
 	objects_.emplace_back(nullptr, false);
+
+	++structure_version_;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the map geometry cache, rebuilding it first if anything changed
+// since it was last built
+// -----------------------------------------------------------------------------
+const MapGeometry& MapObjectCollection::geometry() const
+{
+	if (!geometry_valid_ || geometry_structure_ != structure_version_)
+	{
+		geometry_.build(*this);
+		geometry_valid_     = true;
+		geometry_structure_ = structure_version_;
+	}
+
+	return geometry_;
 }
 
 // -----------------------------------------------------------------------------
@@ -537,10 +573,9 @@ MapSide* MapObjectCollection::duplicateSide(MapSide* side)
 	if (!side)
 		return nullptr;
 
-	auto ns = std::make_unique<MapSide>(side->sector());
+	auto ns = side_pool_.create(side->sector());
 	ns->copy(side);
-	addSide(std::move(ns));
-	return sides_.back();
+	return addPooled(ns, sides_);
 }
 
 // -----------------------------------------------------------------------------
@@ -575,7 +610,7 @@ vector<MapObject*> MapObjectCollection::allModifiedObjects(long since) const
 	for (auto& holder : objects_)
 	{
 		if (holder.object && holder.object->modified_time_ >= since)
-			modified_objects.push_back(holder.object.get());
+			modified_objects.push_back(holder.object);
 	}
 
 	return modified_objects;
@@ -1,11 +1,13 @@
 #pragma once
 
 #include "General/Defs.h"
+#include "MapGeometry.h"
 #include "MapObjectList/LineList.h"
 #include "MapObjectList/SectorList.h"
 #include "MapObjectList/SideList.h"
 #include "MapObjectList/ThingList.h"
 #include "MapObjectList/VertexList.h"
+#include "MapObjectPool.h"
 
 class MapObjectCollection
 {
@@ -30,12 +32,19 @@ public:
 	// MapObject id stuff (used for undo/redo)
 	void       addMapObject(std::unique_ptr<MapObject> object);
 	void       removeMapObject(MapObject* object);
-	MapObject* getObjectById(unsigned id) const { return objects_[id].object.get(); }
+	MapObject* getObjectById(unsigned id) const { return objects_[id].object; }
 	void       putObjectIdList(MapObject::Type type, vector<unsigned>& list) const;
 	void       restoreObjectIdList(MapObject::Type type, vector<unsigned>& list);
 
-	void refreshIndices();
-	void clear();
+	void     refreshIndices();
+	void     clear();
+	unsigned structureVersion() const { return structure_version_; }
+
+	// Geometry cache (see MapGeometry). Kept up to date automatically for
+	// changes made through the parent map, otherwise invalidateGeometry must be
+	// called after moving vertices or changing line vertices/sides
+	const MapGeometry& geometry() const;
+	void               invalidateGeometry() { geometry_valid_ = false; }
 
 	// Object add
 	MapVertex* addVertex(std::unique_ptr<MapVertex> vertex);
@@ -44,6 +53,29 @@ public:
 	MapSector* addSector(std::unique_ptr<MapSector> sector);
 	MapThing*  addThing(std::unique_ptr<MapThing> thing);
 
+	// Object create (allocated from the object pools, construction args are the
+	// same as for the object type)
+	template<typename... Args> MapVertex* createVertex(Args&&... args)
+	{
+		return addPooled(vertex_pool_.create(std::forward<Args>(args)...), vertices_);
+	}
+	template<typename... Args> MapSide* createSide(Args&&... args)
+	{
+		return addPooled(side_pool_.create(std::forward<Args>(args)...), sides_);
+	}
+	template<typename... Args> MapLine* createLine(Args&&... args)
+	{
+		return addPooled(line_pool_.create(std::forward<Args>(args)...), lines_);
+	}
+	template<typename... Args> MapSector* createSector(Args&&... args)
+	{
+		return addPooled(sector_pool_.create(std::forward<Args>(args)...), sectors_);
+	}
+	template<typename... Args> MapThing* createThing(Args&&... args)
+	{
+		return addPooled(thing_pool_.create(std::forward<Args>(args)...), things_);
+	}
+
 	// Object duplicate
 	MapSide* duplicateSide(MapSide* side);
 
@@ -79,22 +111,43 @@ public:
 private:
 	struct MapObjectHolder
 	{
-		std::unique_ptr<MapObject> object;
+		MapObject*                 object;
 		bool                       in_map;
+		std::unique_ptr<MapObject> owned; // Only set if the object isn't from one of the pools
 
-		MapObjectHolder(std::unique_ptr<MapObject> object, bool in_map) : object{ std::move(object) }, in_map{ in_map }
-		{
-		}
+		MapObjectHolder(MapObject* object, bool in_map) : object{ object }, in_map{ in_map } {}
 	};
 
-	SLADEMap* parent_map_     = nullptr;
-	MapFormat current_format_ = MapFormat::Doom;
-	bool      position_frac_  = false;
+	SLADEMap* parent_map_        = nullptr;
+	MapFormat current_format_    = MapFormat::Doom;
+	bool      position_frac_     = false;
+	unsigned  structure_version_ = 0; // Incremented whenever objects are added to or removed from the map
+
+	// Object storage, all objects are kept until the collection is cleared
+	MapObjectPool<MapVertex> vertex_pool_;
+	MapObjectPool<MapSide>   side_pool_;
+	MapObjectPool<MapLine>   line_pool_;
+	MapObjectPool<MapSector> sector_pool_;
+	MapObjectPool<MapThing>  thing_pool_;
+	vector<MapObjectHolder>  objects_;
+
+	VertexList vertices_;
+	SideList   sides_;
+	LineList   lines_;
+	SectorList sectors_;
+	ThingList  things_;
 
-	vector<MapObjectHolder> objects_;
-	VertexList              vertices_;
-	SideList                sides_;
-	LineList                lines_;
-	SectorList              sectors_;
-	ThingList               things_;
+	mutable MapGeometry geometry_;
+	mutable bool        geometry_valid_     = false;
+	mutable unsigned    geometry_structure_ = 0; // Structure version the geometry was built from
+
+	void addMapObject(MapObject* object);
+
+	template<class T, class L> T* addPooled(T* object, L& list)
+	{
+		object->index_ = list.size();
+		list.add(object);
+		addMapObject(object);
+		return object;
+	}
 };
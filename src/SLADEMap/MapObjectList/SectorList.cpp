@@ -34,6 +34,9 @@
 #include "Main.h"
 #include "SectorList.h"
 #include "General/UI.h"
+#include "Utility/Parallel.h"
+#include <atomic>
+#include <thread>
 
 
 // -----------------------------------------------------------------------------
@@ -127,17 +130,30 @@ BBox SectorList::allSectorBounds() const
 }
 
 // -----------------------------------------------------------------------------
-// Forces building of polygons for all sectors in the list
+// Forces building of polygons for all sectors in the list.
+// Each sector's polygon only depends on its own sides, so they are built across
+// all available hardware threads, with the calling thread updating progress
 // -----------------------------------------------------------------------------
-void SectorList::initPolygons()
+void SectorList::initPolygons() const
 {
 	UI::setSplashProgressMessage("Building sector polygons");
 	UI::setSplashProgress(0.0f);
-	for (unsigned i = 0; i < count_; ++i)
-	{
-		UI::setSplashProgress((float)i / (float)count_);
-		objects_[i]->polygon();
-	}
+
+	// Build in parallel (not worth it for small maps), only updating progress
+	// from this thread
+	auto                  this_thread = std::this_thread::get_id();
+	std::atomic<unsigned> built{ 0 };
+	unsigned              n_threads = std::max(1u, std::min(std::thread::hardware_concurrency(), count_ / 64));
+	parallelFor(count_, 1, n_threads, [&](unsigned start, unsigned end) {
+		for (auto index = start; index < end; ++index)
+		{
+			if (std::this_thread::get_id() == this_thread)
+				UI::setSplashProgress((float)built / (float)count_);
+			objects_[index]->polygon();
+			++built;
+		}
+	});
+
 	UI::setSplashProgress(1.0f);
 }
 
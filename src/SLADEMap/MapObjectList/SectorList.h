@@ -13,7 +13,7 @@ public:
 
 	MapSector*         atPos(Vec2d point) const;
 	BBox               allSectorBounds() const;
-	void               initPolygons();
+	void               initPolygons() const;
 	void               initBBoxes();
 	void               putAllWithId(int id, vector<MapSector*>& list) const;
 	vector<MapSector*> allWithId(int id) const;
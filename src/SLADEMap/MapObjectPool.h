@@ -0,0 +1,50 @@
+#pragma once
+
+#include <new>
+
+// Storage for map objects of type [T], allocated in blocks of BLOCK_SIZE
+// objects rather than individually, so objects of the same type are mostly
+// contiguous in memory and loading a large map needs far fewer allocations.
+// Objects never move once created (removed objects are kept for undo anyway),
+// and are only destroyed all at once, by clear()
+template<class T> class MapObjectPool
+{
+public:
+	static const unsigned BLOCK_SIZE = 1024;
+
+	MapObjectPool() = default;
+	~MapObjectPool() { clear(); }
+
+	MapObjectPool(const MapObjectPool&) = delete;
+	MapObjectPool& operator=(const MapObjectPool&) = delete;
+
+	unsigned size() const { return size_; }
+	unsigned nBlocks() const { return blocks_.size(); }
+
+	// Constructs a new object from [args] and returns it
+	template<typename... Args> T* create(Args&&... args)
+	{
+		if (size_ == blocks_.size() * BLOCK_SIZE)
+			blocks_.emplace_back(new Slot[BLOCK_SIZE]);
+
+		auto object = new (&blocks_[size_ / BLOCK_SIZE][size_ % BLOCK_SIZE]) T(std::forward<Args>(args)...);
+		++size_;
+		return object;
+	}
+
+	// Destroys all objects and frees all blocks
+	void clear()
+	{
+		for (unsigned a = 0; a < size_; ++a)
+			std::launder(reinterpret_cast<T*>(&blocks_[a / BLOCK_SIZE][a % BLOCK_SIZE]))->~T();
+
+		blocks_.clear();
+		size_ = 0;
+	}
+
+private:
+	typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type Slot;
+
+	vector<std::unique_ptr<Slot[]>> blocks_;
+	unsigned                        size_ = 0;
+};
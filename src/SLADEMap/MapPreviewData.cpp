@@ -0,0 +1,741 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2019 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    MapPreviewData.cpp
+// Description: MapPreviewData class - the basic features of a map, read from
+//              its entries for map previews, and rendering them to an image
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "MapPreviewData.h"
+#include "Archive/Formats/WadArchive.h"
+#include "General/ColourConfiguration.h"
+#include "Graphics/MapRasterizer.h"
+#include "Graphics/SImage/SImage.h"
+#include "MapFormat/Doom64MapFormat.h"
+#include "MapFormat/DoomMapFormat.h"
+#include "MapFormat/HexenMapFormat.h"
+#include "Utility/Tokenizer.h"
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Float, map_image_thickness, 1.5, CVar::Flag::Save)
+CVAR(Bool, map_image_things, false, CVar::Flag::Save)
+
+
+// -----------------------------------------------------------------------------
+//
+// MapPreviewData Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Adds a vertex to the map data
+// -----------------------------------------------------------------------------
+void MapPreviewData::addVertex(double x, double y)
+{
+	verts_.emplace_back(x, y);
+}
+
+// -----------------------------------------------------------------------------
+// Adds a line to the map data
+// -----------------------------------------------------------------------------
+void MapPreviewData::addLine(unsigned v1, unsigned v2, bool twosided, bool special, bool macro)
+{
+	lines_.emplace_back(v1, v2, twosided, special, macro);
+}
+
+// -----------------------------------------------------------------------------
+// Adds a thing to the map data
+// -----------------------------------------------------------------------------
+void MapPreviewData::addThing(double x, double y)
+{
+	things_.emplace_back(x, y);
+}
+
+// -----------------------------------------------------------------------------
+// Reads the map described by [map] (adding to any existing data)
+// -----------------------------------------------------------------------------
+bool MapPreviewData::open(Archive::MapDesc map)
+{
+	// All errors = invalid map
+	Global::error = "Invalid map";
+
+	// Check if this map is a pk3 map (the wad is only needed while reading)
+	Archive::UPtr temp_archive;
+	if (map.archive)
+	{
+		// Attempt to open entry as wad archive
+		temp_archive = std::make_unique<WadArchive>();
+		if (!temp_archive->open(map.head))
+			return false;
+
+		// Detect maps
+		auto maps = temp_archive->detectMaps();
+
+		// Set map if there are any in the archive
+		if (!maps.empty())
+			map = maps[0];
+		else
+			return false;
+	}
+
+	// Parse UDMF map
+	if (map.format == MapFormat::UDMF)
+	{
+		ArchiveEntry* udmfdata = nullptr;
+		for (auto mapentry = map.head; mapentry != map.end; mapentry = mapentry->nextEntry())
+		{
+			// Check entry type
+			if (mapentry->type() == EntryType::fromId("udmf_textmap"))
+			{
+				udmfdata = mapentry;
+				break;
+			}
+		}
+		if (udmfdata == nullptr)
+			return false;
+
+		// Start parsing
+		Tokenizer tz;
+		tz.openView(udmfdata->data(), map.head->name());
+
+		// Get first token
+		wxString token       = tz.getToken();
+		size_t   vertcounter = 0, linecounter = 0, thingcounter = 0;
+		while (!token.IsEmpty())
+		{
+			if (!token.CmpNoCase("namespace"))
+			{
+				//  skip till we reach the ';'
+				do
+				{
+					token = tz.getToken();
+				} while (token.Cmp(";"));
+			}
+			else if (!token.CmpNoCase("vertex"))
+			{
+				// Get X and Y properties
+				bool   gotx = false;
+				bool   goty = false;
+				double x    = 0.;
+				double y    = 0.;
+				do
+				{
+					token = tz.getToken();
+					if (!token.CmpNoCase("x") || !token.CmpNoCase("y"))
+					{
+						bool isx = !token.CmpNoCase("x");
+						token    = tz.getToken();
+						if (token.Cmp("="))
+						{
+							Log::error(wxString::Format("Bad syntax for vertex %i in UDMF map data", vertcounter));
+							return false;
+						}
+						if (isx)
+							x = tz.getDouble(), gotx = true;
+						else
+							y = tz.getDouble(), goty = true;
+						// skip to end of declaration after each key
+						do
+						{
+							token = tz.getToken();
+						} while (token.Cmp(";"));
+					}
+				} while (token.Cmp("}"));
+				if (gotx && goty)
+					addVertex(x, y);
+				else
+				{
+					Log::error(wxString::Format("Wrong vertex %i in UDMF map data", vertcounter));
+					return false;
+				}
+				vertcounter++;
+			}
+			else if (!token.CmpNoCase("linedef"))
+			{
+				bool   special  = false;
+				bool   twosided = false;
+				bool   gotv1 = false, gotv2 = false;
+				size_t v1 = 0, v2 = 0;
+				do
+				{
+					token = tz.getToken();
+					if (!token.CmpNoCase("v1") || !token.CmpNoCase("v2"))
+					{
+						bool isv1 = !token.CmpNoCase("v1");
+						token     = tz.getToken();
+						if (token.Cmp("="))
+						{
+							Log::error(wxString::Format("Bad syntax for linedef %i in UDMF map data", linecounter));
+							return false;
+						}
+						if (isv1)
+							v1 = tz.getInteger(), gotv1 = true;
+						else
+							v2 = tz.getInteger(), gotv2 = true;
+						// skip to end of declaration after each key
+						do
+						{
+							token = tz.getToken();
+						} while (token.Cmp(";"));
+					}
+					else if (!token.CmpNoCase("special"))
+					{
+						special = true;
+						// skip to end of declaration after each key
+						do
+						{
+							token = tz.getToken();
+						} while (token.Cmp(";"));
+					}
+					else if (!token.CmpNoCase("sideback"))
+					{
+						twosided = true;
+						// skip to end of declaration after each key
+						do
+						{
+							token = tz.getToken();
+						} while (token.Cmp(";"));
+					}
+				} while (token.Cmp("}"));
+				if (gotv1 && gotv2)
+					addLine(v1, v2, twosided, special);
+				else
+				{
+					Log::error(wxString::Format("Wrong line %i in UDMF map data", linecounter));
+					return false;
+				}
+				linecounter++;
+			}
+			else if (S_CMPNOCASE(token, "thing"))
+			{
+				// Get X and Y properties
+				bool   gotx = false;
+				bool   goty = false;
+				double x    = 0.;
+				double y    = 0.;
+				do
+				{
+					token = tz.getToken();
+					if (!token.CmpNoCase("x") || !token.CmpNoCase("y"))
+					{
+						bool isx = !token.CmpNoCase("x");
+						token    = tz.getToken();
+						if (token.Cmp("="))
+						{
+							Log::error(wxString::Format("Bad syntax for thing %i in UDMF map data", vertcounter));
+							return false;
+						}
+						if (isx)
+							x = tz.getDouble(), gotx = true;
+						else
+							y = tz.getDouble(), goty = true;
+						// skip to end of declaration after each key
+						do
+						{
+							token = tz.getToken();
+						} while (token.Cmp(";"));
+					}
+				} while (token.Cmp("}"));
+				if (gotx && goty)
+					addThing(x, y);
+				else
+				{
+					Log::error(wxString::Format("Wrong thing %i in UDMF map data", vertcounter));
+					return false;
+				}
+				vertcounter++;
+			}
+			else
+			{
+				// Check for side or sector definition (increase counts)
+				if (S_CMPNOCASE(token, "sidedef"))
+					n_sides_++;
+				else if (S_CMPNOCASE(token, "sector"))
+					n_sectors_++;
+
+				// map preview ignores sidedefs, sectors, comments,
+				// unknown fields, etc. so skip to end of block
+				do
+				{
+					token = tz.getToken();
+				} while (token.Cmp("}") && !token.empty());
+			}
+			// Iterate to next token
+			token = tz.getToken();
+		}
+	}
+
+	// Non-UDMF map
+	if (map.format != MapFormat::UDMF)
+	{
+		// Read vertices (required)
+		if (!readVertices(map.head, map.end, map.format))
+			return false;
+
+		// Read linedefs (required)
+		if (!readLines(map.head, map.end, map.format))
+			return false;
+
+		// Read things
+		if (map.format != MapFormat::UDMF)
+			readThings(map.head, map.end, map.format);
+
+		// Read sides & sectors (count only)
+		ArchiveEntry* sidedefs = nullptr;
+		ArchiveEntry* sectors  = nullptr;
+		while (map.head)
+		{
+			// Check entry type
+			if (map.head->type() == EntryType::fromId("map_sidedefs"))
+				sidedefs = map.head;
+			if (map.head->type() == EntryType::fromId("map_sectors"))
+				sectors = map.head;
+
+			// Exit loop if we've reached the end of the map entries
+			if (map.head == map.end)
+				break;
+			else
+				map.head = map.head->nextEntry();
+		}
+		if (sidedefs && sectors)
+		{
+			// Doom64 map
+			if (map.format != MapFormat::Doom64)
+			{
+				n_sides_   = sidedefs->size() / 30;
+				n_sectors_ = sectors->size() / 26;
+			}
+
+			// Doom/Hexen map
+			else
+			{
+				n_sides_   = sidedefs->size() / 12;
+				n_sectors_ = sectors->size() / 16;
+			}
+		}
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Reads non-UDMF vertex data
+// -----------------------------------------------------------------------------
+bool MapPreviewData::readVertices(ArchiveEntry* map_head, ArchiveEntry* map_end, MapFormat map_format)
+{
+	// Find VERTEXES entry
+	ArchiveEntry* vertexes = nullptr;
+	while (map_head)
+	{
+		// Check entry type
+		if (map_head->type() == EntryType::fromId("map_vertexes"))
+		{
+			vertexes = map_head;
+			break;
+		}
+
+		// Exit loop if we've reached the end of the map entries
+		if (map_head == map_end)
+			break;
+		else
+			map_head = map_head->nextEntry();
+	}
+
+	// Can't open a map without vertices
+	if (!vertexes)
+		return false;
+
+	// Read vertex data
+	auto& mc = vertexes->data();
+	mc.seek(0, SEEK_SET);
+
+	if (map_format == MapFormat::Doom64)
+	{
+		Doom64MapFormat::Vertex v;
+		while (true)
+		{
+			// Read vertex
+			if (!mc.read(&v, 8))
+				break;
+
+			// Add vertex
+			addVertex((double)v.x / 65536, (double)v.y / 65536);
+		}
+	}
+	else
+	{
+		DoomMapFormat::Vertex v;
+		while (true)
+		{
+			// Read vertex
+			if (!mc.read(&v, 4))
+				break;
+
+			// Add vertex
+			addVertex((double)v.x, (double)v.y);
+		}
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Reads non-UDMF line data
+// -----------------------------------------------------------------------------
+bool MapPreviewData::readLines(ArchiveEntry* map_head, ArchiveEntry* map_end, MapFormat map_format)
+{
+	// Find LINEDEFS entry
+	ArchiveEntry* linedefs = nullptr;
+	while (map_head)
+	{
+		// Check entry type
+		if (map_head->type() == EntryType::fromId("map_linedefs"))
+		{
+			linedefs = map_head;
+			break;
+		}
+
+		// Exit loop if we've reached the end of the map entries
+		if (map_head == map_end)
+			break;
+		else
+			map_head = map_head->nextEntry();
+	}
+
+	// Can't open a map without linedefs
+	if (!linedefs)
+		return false;
+
+	// Read line data
+	auto& mc = linedefs->data();
+	mc.seek(0, SEEK_SET);
+	if (map_format == MapFormat::Doom)
+	{
+		while (true)
+		{
+			// Read line
+			DoomMapFormat::LineDef l;
+			if (!mc.read(&l, sizeof(DoomMapFormat::LineDef)))
+				break;
+
+			// Check properties
+			bool special  = false;
+			bool twosided = false;
+			if (l.side2 != 0xFFFF)
+				twosided = true;
+			if (l.type > 0)
+				special = true;
+
+			// Add line
+			addLine(l.vertex1, l.vertex2, twosided, special);
+		}
+	}
+	else if (map_format == MapFormat::Doom64)
+	{
+		while (true)
+		{
+			// Read line
+			Doom64MapFormat::LineDef l;
+			if (!mc.read(&l, sizeof(Doom64MapFormat::LineDef)))
+				break;
+
+			// Check properties
+			bool macro    = false;
+			bool special  = false;
+			bool twosided = false;
+			if (l.side2 != 0xFFFF)
+				twosided = true;
+			if (l.type > 0)
+			{
+				if (l.type & 0x100)
+					macro = true;
+				else
+					special = true;
+			}
+
+			// Add line
+			addLine(l.vertex1, l.vertex2, twosided, special, macro);
+		}
+	}
+	else if (map_format == MapFormat::Hexen)
+	{
+		while (true)
+		{
+			// Read line
+			HexenMapFormat::LineDef l;
+			if (!mc.read(&l, sizeof(HexenMapFormat::LineDef)))
+				break;
+
+			// Check properties
+			bool special  = false;
+			bool twosided = false;
+			if (l.side2 != 0xFFFF)
+				twosided = true;
+			if (l.type > 0)
+				special = true;
+
+			// Add line
+			addLine(l.vertex1, l.vertex2, twosided, special);
+		}
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Reads non-UDMF thing data
+// -----------------------------------------------------------------------------
+bool MapPreviewData::readThings(ArchiveEntry* map_head, ArchiveEntry* map_end, MapFormat map_format)
+{
+	// Find THINGS entry
+	ArchiveEntry* things = nullptr;
+	while (map_head)
+	{
+		// Check entry type
+		if (map_head->type() == EntryType::fromId("map_things"))
+		{
+			things = map_head;
+			break;
+		}
+
+		// Exit loop if we've reached the end of the map entries
+		if (map_head == map_end)
+			break;
+		else
+			map_head = map_head->nextEntry();
+	}
+
+	// No things
+	if (!things)
+		return false;
+
+	// Read things data
+	if (map_format == MapFormat::Doom)
+	{
+		auto     thng_data = (DoomMapFormat::Thing*)things->rawData(true);
+		unsigned nt        = things->size() / sizeof(DoomMapFormat::Thing);
+		for (size_t a = 0; a < nt; a++)
+			addThing(thng_data[a].x, thng_data[a].y);
+	}
+	else if (map_format == MapFormat::Doom64)
+	{
+		auto     thng_data = (Doom64MapFormat::Thing*)things->rawData(true);
+		unsigned nt        = things->size() / sizeof(Doom64MapFormat::Thing);
+		for (size_t a = 0; a < nt; a++)
+			addThing(thng_data[a].x, thng_data[a].y);
+	}
+	else if (map_format == MapFormat::Hexen)
+	{
+		auto     thng_data = (HexenMapFormat::Thing*)things->rawData(true);
+		unsigned nt        = things->size() / sizeof(HexenMapFormat::Thing);
+		for (size_t a = 0; a < nt; a++)
+			addThing(thng_data[a].x, thng_data[a].y);
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Clears map data
+// -----------------------------------------------------------------------------
+void MapPreviewData::clear()
+{
+	verts_.clear();
+	lines_.clear();
+	things_.clear();
+	n_sides_   = 0;
+	n_sectors_ = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Sets [min] and [max] to the extents of the map
+// -----------------------------------------------------------------------------
+void MapPreviewData::bounds(Vec2d& min, Vec2d& max) const
+{
+	min = { 999999.0, 999999.0 };
+	max = { -999999.0, -999999.0 };
+	for (auto& vert : verts_)
+	{
+		if (vert.x < min.x)
+			min.x = vert.x;
+		if (vert.x > max.x)
+			max.x = vert.x;
+		if (vert.y < min.y)
+			min.y = vert.y;
+		if (vert.y > max.y)
+			max.y = vert.y;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Draws the map in [image] (of [width]x[height], or scaled down from the map
+// size if negative/zero). Returns false if the image couldn't be rendered.
+// This is rendered in software via MapRasterizer, so no OpenGL context is
+// needed and there is no limit on the image size
+// -----------------------------------------------------------------------------
+bool MapPreviewData::createImage(SImage& image, int width, int height) const
+{
+	// Find extents of map
+	Vec2d m_min, m_max;
+	bounds(m_min, m_max);
+	double mapwidth  = m_max.x - m_min.x;
+	double mapheight = m_max.y - m_min.y;
+
+	if (width == 0)
+		width = -5;
+	if (height == 0)
+		height = -5;
+	if (width < 0)
+		width = mapwidth / abs(width);
+	if (height < 0)
+		height = mapheight / abs(height);
+
+	// Setup colours
+	auto col_save_background   = ColourConfiguration::colour("map_image_background");
+	auto col_save_line_1s      = ColourConfiguration::colour("map_image_line_1s");
+	auto col_save_line_2s      = ColourConfiguration::colour("map_image_line_2s");
+	auto col_save_line_special = ColourConfiguration::colour("map_image_line_special");
+	auto col_save_line_macro   = ColourConfiguration::colour("map_image_line_macro");
+	auto col_view_thing        = ColourConfiguration::colour("map_view_thing");
+
+	// Setup rasterizer
+	MapRasterizer rasterizer;
+	rasterizer.setBackground(col_save_background);
+	rasterizer.setLineWidth(map_image_thickness);
+	rasterizer.fitView(m_min, m_max, width, height);
+
+	// Add lines (2s lines first so 1s lines are drawn over them)
+	for (int pass = 0; pass < 2; pass++)
+	{
+		for (auto& line : lines_)
+		{
+			if (line.twosided != (pass == 0))
+				continue;
+
+			// Check ends
+			if (line.v1 >= verts_.size() || line.v2 >= verts_.size())
+				continue;
+
+			// Get vertices
+			auto v1 = verts_[line.v1];
+			auto v2 = verts_[line.v2];
+
+			// Get colour
+			auto colour = col_save_line_1s;
+			if (line.special)
+				colour = col_save_line_special;
+			else if (line.macro)
+				colour = col_save_line_macro;
+			else if (line.twosided)
+				colour = col_save_line_2s;
+
+			rasterizer.addLine({ v1.x, v1.y }, { v2.x, v2.y }, colour);
+		}
+	}
+
+	// Add things
+	if (map_image_things)
+	{
+		double zoom = std::min<double>((double)width / mapwidth, (double)height / mapheight) * 0.95;
+		rasterizer.setPointSize(std::max(2., 40. * zoom));
+		for (auto& thing : things_)
+			rasterizer.addPoint({ thing.x, thing.y }, col_view_thing);
+	}
+
+	return rasterizer.render(image, width, height);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the number of (attached) vertices in the map
+// -----------------------------------------------------------------------------
+unsigned MapPreviewData::nVertices() const
+{
+	// Get list of used vertices
+	vector<bool> v_used;
+	for (unsigned a = 0; a < verts_.size(); a++)
+		v_used.push_back(false);
+	for (auto& line : lines_)
+	{
+		v_used[line.v1] = true;
+		v_used[line.v2] = true;
+	}
+
+	// Get count of used vertices
+	unsigned count = 0;
+	for (auto&& a : v_used)
+	{
+		if (a)
+			count++;
+	}
+
+	return count;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the width (in map units) of the map
+// -----------------------------------------------------------------------------
+unsigned MapPreviewData::width() const
+{
+	int min_x = wxINT32_MAX;
+	int max_x = wxINT32_MIN;
+
+	for (auto& vertex : verts_)
+	{
+		if (vertex.x < min_x)
+			min_x = vertex.x;
+		if (vertex.x > max_x)
+			max_x = vertex.x;
+	}
+
+	return max_x - min_x;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the height (in map units) of the map
+// -----------------------------------------------------------------------------
+unsigned MapPreviewData::height() const
+{
+	int min_y = wxINT32_MAX;
+	int max_y = wxINT32_MIN;
+
+	for (auto& vertex : verts_)
+	{
+		if (vertex.y < min_y)
+			min_y = vertex.y;
+		if (vertex.y > max_y)
+			max_y = vertex.y;
+	}
+
+	return max_y - min_y;
+}
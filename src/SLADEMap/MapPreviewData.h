@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Archive/Archive.h"
+
+class SImage;
+
+// The basic features of a map (vertices, lines and things), read directly from
+// the map entries without loading the full map. Used to show map previews, and
+// to render a map to an image (which needs no UI or OpenGL)
+class MapPreviewData
+{
+public:
+	// Structs for basic map features
+	struct Vertex
+	{
+		double x;
+		double y;
+		Vertex(double x, double y) : x{ x }, y{ y } {}
+	};
+
+	struct Line
+	{
+		unsigned v1       = 0;
+		unsigned v2       = 0;
+		bool     twosided = false;
+		bool     special  = false;
+		bool     macro    = false;
+		bool     segment  = false;
+
+		Line(
+			unsigned v1,
+			unsigned v2,
+			bool     twosided = false,
+			bool     special  = false,
+			bool     macro    = false,
+			bool     segment  = false) :
+			v1{ v1 },
+			v2{ v2 },
+			twosided{ twosided },
+			special{ special },
+			macro{ macro },
+			segment{ segment }
+		{
+		}
+	};
+
+	struct Thing
+	{
+		double x;
+		double y;
+		Thing(double x, double y) : x{ x }, y{ y } {}
+	};
+
+	MapPreviewData()  = default;
+	~MapPreviewData() = default;
+
+	const vector<Vertex>& vertices() const { return verts_; }
+	const vector<Line>&   lines() const { return lines_; }
+	const vector<Thing>&  things() const { return things_; }
+
+	void addVertex(double x, double y);
+	void addLine(unsigned v1, unsigned v2, bool twosided, bool special, bool macro = false);
+	void addThing(double x, double y);
+	bool open(Archive::MapDesc map);
+	bool readVertices(ArchiveEntry* map_head, ArchiveEntry* map_end, MapFormat map_format);
+	bool readLines(ArchiveEntry* map_head, ArchiveEntry* map_end, MapFormat map_format);
+	bool readThings(ArchiveEntry* map_head, ArchiveEntry* map_end, MapFormat map_format);
+	void clear();
+	void bounds(Vec2d& min, Vec2d& max) const;
+	bool createImage(SImage& image, int width, int height) const;
+
+	unsigned nVertices() const;
+	unsigned nSides() const { return n_sides_; }
+	unsigned nLines() const { return lines_.size(); }
+	unsigned nSectors() const { return n_sectors_; }
+	unsigned nThings() const { return things_.size(); }
+	unsigned width() const;
+	unsigned height() const;
+
+private:
+	vector<Vertex> verts_;
+	vector<Line>   lines_;
+	vector<Thing>  things_;
+	unsigned       n_sides_   = 0;
+	unsigned       n_sectors_ = 0;
+};
@@ -32,6 +32,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "MapSpecials.h"
+#include "App.h"
 #include "Game/Configuration.h"
 #include "SLADEMap.h"
 #include "Utility/MathStuff.h"
@@ -65,19 +66,449 @@ void MapSpecials::reset()
 {
 	sector_colours_.clear();
 	sector_fadecolours_.clear();
+	slope_lines_.clear();
+	slope_things_.clear();
+	translucent_lines_.clear();
+	special_deps_.clear();
+	last_pass_time_ = -1;
 }
 
 // -----------------------------------------------------------------------------
-// Process map specials, depending on the current game/port
+// Process all map specials, depending on the current game/port
 // -----------------------------------------------------------------------------
-void MapSpecials::processMapSpecials(SLADEMap* map) const
+void MapSpecials::processMapSpecials(SLADEMap* map)
 {
+	collectSpecials(map);
+
 	// ZDoom
 	if (Game::configuration().currentPort() == "zdoom")
 		processZDoomMapSpecials(map);
 	// Eternity, currently no need for processEternityMapSpecials
 	else if (Game::configuration().currentPort() == "eternity")
 		processEternitySlopes(map);
+
+	// Record what each special depends on for later incremental updates
+	for (auto& i : special_deps_)
+	{
+		i.second = {};
+		putSpecialDeps(map, i.first, i.second);
+	}
+
+	finishPass(map);
+}
+
+// -----------------------------------------------------------------------------
+// Re-processes only the map specials affected by any map objects modified
+// since the last pass.
+// Falls back to a full pass if objects were added/removed, the port changed or
+// the edit affects most of the map anyway
+// -----------------------------------------------------------------------------
+void MapSpecials::updateMapSpecials(SLADEMap* map)
+{
+	auto port = Game::configuration().currentPort();
+	if (last_pass_time_ < 0 || port != last_pass_port_
+		|| map->mapData().structureVersion() != last_pass_structure_)
+	{
+		processMapSpecials(map);
+		return;
+	}
+
+	// Nothing to do for ports without supported specials
+	if (port != "zdoom" && port != "eternity")
+		return;
+
+	auto modified = map->mapData().modifiedObjects(last_pass_time_, MapObject::Type::Object);
+	if (modified.empty())
+		return;
+
+	// Determine sectors, tags and line ids directly affected by the modified
+	// objects
+	SectorSet            dirty;
+	std::set<int>        dirty_tags;
+	std::set<int>        dirty_line_ids;
+	std::set<MapObject*> changed_specials;
+	std::set<MapLine*>   modified_lines;
+	auto                 addLineSectors = [&dirty](MapLine* line) {
+		if (line->frontSector())
+			dirty.insert(line->frontSector());
+		if (line->backSector())
+			dirty.insert(line->backSector());
+	};
+	for (auto object : modified)
+	{
+		switch (object->objType())
+		{
+		case MapObject::Type::Vertex:
+			for (auto line : dynamic_cast<MapVertex*>(object)->connectedLines())
+				addLineSectors(line);
+			break;
+		case MapObject::Type::Line:
+		{
+			auto line = dynamic_cast<MapLine*>(object);
+			addLineSectors(line);
+			dirty_line_ids.insert(line->id());
+			modified_lines.insert(line);
+			break;
+		}
+		case MapObject::Type::Side:
+		{
+			auto side = dynamic_cast<MapSide*>(object);
+			if (side->sector())
+				dirty.insert(side->sector());
+			if (side->parentLine())
+				addLineSectors(side->parentLine());
+			break;
+		}
+		case MapObject::Type::Sector:
+			dirty.insert(dynamic_cast<MapSector*>(object));
+			dirty_tags.insert(dynamic_cast<MapSector*>(object)->id());
+			break;
+		default: break;
+		}
+
+		// Check for added/removed/changed specials
+		if (object->objType() == MapObject::Type::Line || object->objType() == MapObject::Type::Thing)
+		{
+			updateSpecialLists(object);
+			if (special_deps_.count(object) || isSlopeSpecial(object))
+				changed_specials.insert(object);
+		}
+	}
+
+	// Update the dependencies of any specials that might have changed. Both the
+	// old and new targets of these are affected
+	auto geometry_dirty = dirty;
+	for (auto special : changed_specials)
+	{
+		auto& deps = special_deps_[special];
+		dirty.insert(deps.targets.begin(), deps.targets.end());
+
+		if (!isSlopeSpecial(special))
+		{
+			special_deps_.erase(special);
+			continue;
+		}
+
+		deps = {};
+		putSpecialDeps(map, special, deps);
+		dirty.insert(deps.targets.begin(), deps.targets.end());
+	}
+	for (auto& i : special_deps_)
+	{
+		if (changed_specials.count(i.first))
+			continue;
+
+		// Specials that look up modified sectors/lines by tag/id, or that have
+		// no target yet (eg. a thing not inside any sector), may now resolve to
+		// different sectors
+		auto& deps     = i.second;
+		bool  affected = deps.targets.empty() && !geometry_dirty.empty();
+		for (auto sector : deps.targets)
+			affected = affected || geometry_dirty.count(sector) > 0;
+		for (auto sector : deps.inputs)
+			affected = affected || geometry_dirty.count(sector) > 0;
+		for (auto tag : deps.tags)
+			affected = affected || dirty_tags.count(tag) > 0;
+		for (auto id : deps.line_ids)
+			affected = affected || dirty_line_ids.count(id) > 0;
+
+		if (affected)
+		{
+			dirty.insert(deps.targets.begin(), deps.targets.end());
+			deps = {};
+			putSpecialDeps(map, i.first, deps);
+			dirty.insert(deps.targets.begin(), deps.targets.end());
+		}
+	}
+
+	// Spread dirty sectors to everything depending on them. Since a special
+	// is always applied as a whole, if one of its targets is dirty all of them
+	// are
+	bool changed = true;
+	while (changed)
+	{
+		changed = false;
+		for (auto& i : special_deps_)
+		{
+			auto& deps    = i.second;
+			bool  depends = false;
+			for (auto sector : deps.inputs)
+				depends = depends || dirty.count(sector) > 0;
+			for (auto sector : deps.targets)
+				depends = depends || dirty.count(sector) > 0;
+
+			if (!depends)
+				continue;
+
+			for (auto sector : deps.targets)
+				changed = dirty.insert(sector).second || changed;
+		}
+	}
+
+	// Slopes are applied in a specific order, and some specials read the
+	// intermediate planes of other sectors. Any (unchanged) sector the dirty
+	// sectors read from must be recomputed too so those intermediate planes
+	// are reproduced exactly
+	auto recompute = dirty;
+	changed        = true;
+	while (changed)
+	{
+		changed = false;
+		for (auto& i : special_deps_)
+		{
+			auto& deps    = i.second;
+			bool  targets = false;
+			for (auto sector : deps.targets)
+				targets = targets || recompute.count(sector) > 0;
+
+			if (!targets)
+				continue;
+
+			for (auto sector : deps.inputs)
+				changed = recompute.insert(sector).second || changed;
+			for (auto sector : deps.targets)
+				changed = recompute.insert(sector).second || changed;
+		}
+	}
+
+	// Just do a full pass if most of the map is affected anyway
+	if (recompute.size() * 2 > map->nSectors())
+	{
+		processMapSpecials(map);
+		return;
+	}
+
+	Log::info(
+		3,
+		wxString::Format(
+			"Updating map specials: %lu modified objects, %lu sectors affected",
+			modified.size(),
+			recompute.size()));
+
+	if (port == "zdoom")
+	{
+		// Line specials
+		for (auto line : translucent_lines_)
+			if (modified_lines.count(line) || (line->arg(0) > 0 && dirty_line_ids.count(line->arg(0))))
+				processZDoomLineSpecial(line);
+
+		processZDoomSlopes(map, &recompute);
+	}
+	else
+		processEternitySlopes(map, &recompute);
+
+	finishPass(map);
+}
+
+// -----------------------------------------------------------------------------
+// Builds the lists of lines and things with specials to process in [map]
+// -----------------------------------------------------------------------------
+void MapSpecials::collectSpecials(SLADEMap* map)
+{
+	slope_lines_.clear();
+	slope_things_.clear();
+	translucent_lines_.clear();
+	special_deps_.clear();
+
+	for (auto line : map->lines())
+	{
+		if (line->special() == 208)
+			translucent_lines_.push_back(line);
+		if (isSlopeSpecial(line))
+		{
+			slope_lines_.push_back(line);
+			special_deps_[line] = {};
+		}
+	}
+
+	for (auto thing : map->things())
+	{
+		if (isSlopeSpecial(thing))
+		{
+			slope_things_.push_back(thing);
+			special_deps_[thing] = {};
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Adds or removes [object] (a line or thing) to/from the special lists if its
+// special or type changed.
+// Lists are kept in map index order, which is the order specials are applied
+// -----------------------------------------------------------------------------
+void MapSpecials::updateSpecialLists(MapObject* object)
+{
+	auto updateList = [](auto& list, auto item, bool in_list) {
+		auto pos = std::find(list.begin(), list.end(), item);
+		if (in_list && pos == list.end())
+		{
+			list.push_back(item);
+			std::sort(list.begin(), list.end(), [](auto left, auto right) { return left->index() < right->index(); });
+		}
+		else if (!in_list && pos != list.end())
+			list.erase(pos);
+	};
+
+	if (object->objType() == MapObject::Type::Line)
+	{
+		auto line = dynamic_cast<MapLine*>(object);
+		updateList(translucent_lines_, line, line->special() == 208);
+		updateList(slope_lines_, line, isSlopeSpecial(line));
+	}
+	else if (object->objType() == MapObject::Type::Thing)
+		updateList(slope_things_, dynamic_cast<MapThing*>(object), isSlopeSpecial(object));
+}
+
+// -----------------------------------------------------------------------------
+// Records the state of [map] at the end of a specials pass
+// -----------------------------------------------------------------------------
+void MapSpecials::finishPass(SLADEMap* map)
+{
+	last_pass_time_      = App::runTimer();
+	last_pass_structure_ = map->mapData().structureVersion();
+	last_pass_port_      = Game::configuration().currentPort();
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [object] is a line or thing with a slope special for the
+// current port
+// -----------------------------------------------------------------------------
+bool MapSpecials::isSlopeSpecial(MapObject* object) const
+{
+	auto port = Game::configuration().currentPort();
+	if (port != "zdoom" && port != "eternity")
+		return false;
+
+	// Plane_Align and Plane_Copy
+	if (object->objType() == MapObject::Type::Line)
+	{
+		int special = dynamic_cast<MapLine*>(object)->special();
+		return special == 181 || special == 118;
+	}
+
+	// Slope things (ZDoom only)
+	if (object->objType() == MapObject::Type::Thing && port == "zdoom")
+	{
+		switch (dynamic_cast<MapThing*>(object)->type())
+		{
+		case 9500:
+		case 9501:
+		case 9502:
+		case 9503:
+		case 1500:
+		case 1501:
+		case 9510:
+		case 9511:
+		case 1504:
+		case 1505: return true;
+		default: return false;
+		}
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [special] can change the planes of any sector in [sectors].
+// Always returns true if [sectors] is null (full pass)
+// -----------------------------------------------------------------------------
+bool MapSpecials::specialAffects(MapObject* special, const SectorSet* sectors) const
+{
+	if (!sectors)
+		return true;
+
+	auto deps = special_deps_.find(special);
+	if (deps == special_deps_.end())
+		return false;
+
+	for (auto sector : deps->second.targets)
+		if (sectors->count(sector))
+			return true;
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Adds the sectors, tags and line ids slope [special] currently depends on to
+// [deps]. This can include more sectors than are actually affected, but never
+// fewer
+// -----------------------------------------------------------------------------
+void MapSpecials::putSpecialDeps(SLADEMap* map, MapObject* special, SpecialDeps& deps) const
+{
+	auto addLineSectors = [](MapLine* line, vector<MapSector*>& list) {
+		if (line->frontSector())
+			list.push_back(line->frontSector());
+		if (line->backSector())
+			list.push_back(line->backSector());
+	};
+
+	if (special->objType() == MapObject::Type::Line)
+	{
+		auto line = dynamic_cast<MapLine*>(special);
+
+		// Plane_Align, target and model are the sectors on either side
+		if (line->special() == 181)
+		{
+			addLineSectors(line, deps.targets);
+			addLineSectors(line, deps.inputs);
+		}
+
+		// Plane_Copy, copies planes from tagged sectors to either side
+		else if (line->special() == 118)
+		{
+			addLineSectors(line, deps.targets);
+			addLineSectors(line, deps.inputs);
+			for (unsigned arg = 0; arg < 4; arg++)
+			{
+				if (!line->arg(arg))
+					continue;
+
+				deps.tags.push_back(line->arg(arg));
+				if (auto sector = map->sectors().firstWithId(line->arg(arg)))
+					deps.inputs.push_back(sector);
+			}
+		}
+	}
+	else if (special->objType() == MapObject::Type::Thing)
+	{
+		auto thing = dynamic_cast<MapThing*>(special);
+		auto type  = thing->type();
+
+		// Line slope things, slope the sectors beside lines with the given id
+		// using the height of the sector containing the thing
+		if (type == 9500 || type == 9501)
+		{
+			if (thing->arg(0))
+				deps.line_ids.push_back(thing->arg(0));
+			for (auto line : map->lines().allWithId(thing->arg(0)))
+				addLineSectors(line, deps.targets);
+			if (auto sector = map->sectors().atPos(thing->position()))
+				deps.inputs.push_back(sector);
+		}
+
+		// Vertex height things, affect all sectors around the vertex
+		else if (type == 1504 || type == 1505)
+		{
+			if (auto vertex = map->vertices().vertexAt(thing->xPos(), thing->yPos()))
+				for (auto line : vertex->connectedLines())
+					addLineSectors(line, deps.targets);
+		}
+
+		// Tilt, vavoom and slope copy things, affect the containing sector
+		else if (auto sector = map->sectors().atPos(thing->position()))
+		{
+			deps.targets.push_back(sector);
+
+			// Slope copy things, copy the plane of a tagged sector
+			if (type == 9510 || type == 9511)
+			{
+				if (thing->arg(0))
+					deps.tags.push_back(thing->arg(0));
+				if (auto tagged = map->sectors().firstWithId(thing->arg(0)))
+					deps.inputs.push_back(tagged);
+			}
+		}
+	}
 }
 
 // -----------------------------------------------------------------------------
@@ -182,8 +613,8 @@ void MapSpecials::updateTaggedSectors(SLADEMap* map)
 void MapSpecials::processZDoomMapSpecials(SLADEMap* map) const
 {
 	// Line specials
-	for (unsigned a = 0; a < map->nLines(); a++)
-		processZDoomLineSpecial(map->line(a));
+	for (auto line : translucent_lines_)
+		processZDoomLineSpecial(line);
 
 	// All slope specials, which must be done in a particular order
 	processZDoomSlopes(map);
@@ -359,7 +790,7 @@ void MapSpecials::processACSScripts(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Process ZDoom slope specials
 // -----------------------------------------------------------------------------
-void MapSpecials::processZDoomSlopes(SLADEMap* map) const
+void MapSpecials::processZDoomSlopes(SLADEMap* map, const SectorSet* sectors) const
 {
 	// ZDoom has a variety of slope mechanisms, which must be evaluated in a
 	// specific order.
@@ -371,52 +802,19 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map) const
 	//  - Plane_Copy, in line order
 
 	// First things first: reset every sector to flat planes
-	for (unsigned a = 0; a < map->nSectors(); a++)
-	{
-		auto target = map->sector(a);
-		target->setPlane<SurfaceType::Floor>(Plane::flat(target->planeHeight<SurfaceType::Floor>()));
-		target->setPlane<SurfaceType::Ceiling>(Plane::flat(target->planeHeight<SurfaceType::Ceiling>()));
-	}
+	resetPlanes(map, sectors);
 
 	// Plane_Align (line special 181)
-	for (unsigned a = 0; a < map->nLines(); a++)
-	{
-		auto line = map->line(a);
-		if (line->special() != 181)
-			continue;
-
-		auto sector1 = line->frontSector();
-		auto sector2 = line->backSector();
-		if (!sector1 || !sector2)
-		{
-			Log::warning(wxString::Format("Ignoring Plane_Align on one-sided line %d", line->index()));
-			continue;
-		}
-		if (sector1 == sector2)
-		{
-			Log::warning(wxString::Format(
-				"Ignoring Plane_Align on line %d, which has the same sector on both sides", line->index()));
-			continue;
-		}
-
-		int floor_arg = line->arg(0);
-		if (floor_arg == 1)
-			applyPlaneAlign<SurfaceType::Floor>(line, sector1, sector2);
-		else if (floor_arg == 2)
-			applyPlaneAlign<SurfaceType::Floor>(line, sector2, sector1);
-
-		int ceiling_arg = line->arg(1);
-		if (ceiling_arg == 1)
-			applyPlaneAlign<SurfaceType::Ceiling>(line, sector1, sector2);
-		else if (ceiling_arg == 2)
-			applyPlaneAlign<SurfaceType::Ceiling>(line, sector2, sector1);
-	}
+	for (auto line : slope_lines_)
+		if (line->special() == 181 && specialAffects(line, sectors))
+			applyPlaneAlignSpecial(line);
 
 	// Line slope things (9500/9501), sector tilt things (9502/9503), and
 	// vavoom things (1500/1501), all in the same pass
-	for (unsigned a = 0; a < map->nThings(); a++)
+	for (auto thing : slope_things_)
 	{
-		auto thing = map->thing(a);
+		if (!specialAffects(thing, sectors))
+			continue;
 
 		// Line slope things
 		if (thing->type() == 9500)
@@ -436,11 +834,9 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map) const
 	}
 
 	// Slope copy things (9510/9511)
-	for (unsigned a = 0; a < map->nThings(); a++)
+	for (auto thing : slope_things_)
 	{
-		auto thing = map->thing(a);
-
-		if (thing->type() == 9510 || thing->type() == 9511)
+		if ((thing->type() == 9510 || thing->type() == 9511) && specialAffects(thing, sectors))
 		{
 			auto target = map->sectors().atPos(thing->position());
 			if (!target)
@@ -476,9 +872,8 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map) const
 	// we store them in a hashmap.
 	VertexHeightMap vertex_floor_heights;
 	VertexHeightMap vertex_ceiling_heights;
-	for (unsigned a = 0; a < map->nThings(); a++)
+	for (auto thing : slope_things_)
 	{
-		auto thing = map->thing(a);
 		if (thing->type() == 1504 || thing->type() == 1505)
 		{
 			// TODO there could be more than one vertex at this point
@@ -496,10 +891,14 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map) const
 	// Vertex heights -- only applies for sectors with exactly three vertices.
 	// Heights may be set by UDMF properties, or by a vertex height thing
 	// placed exactly on the vertex (which takes priority over the prop).
+	vector<MapSector*> targets;
+	if (sectors)
+		targets.assign(sectors->begin(), sectors->end());
+	else
+		targets.assign(map->sectors().begin(), map->sectors().end());
 	vector<MapVertex*> vertices;
-	for (unsigned a = 0; a < map->nSectors(); a++)
+	for (auto target : targets)
 	{
-		auto target = map->sector(a);
 		vertices.clear();
 		target->putVertices(vertices);
 		if (vertices.size() != 3)
@@ -510,59 +909,15 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map) const
 	}
 
 	// Plane_Copy
-	for (unsigned a = 0; a < map->nLines(); a++)
-	{
-		auto line = map->line(a);
-		if (line->special() != 118)
-			continue;
-
-		int  tag;
-		auto front = line->frontSector();
-		auto back  = line->backSector();
-		if ((tag = line->arg(0)) && front)
-		{
-			if (auto sector = map->sectors().firstWithId(tag))
-				front->setFloorPlane(sector->floor().plane);
-		}
-		if ((tag = line->arg(1)) && front)
-		{
-			if (auto sector = map->sectors().firstWithId(tag))
-				front->setCeilingPlane(sector->ceiling().plane);
-		}
-		if ((tag = line->arg(2)) && back)
-		{
-			if (auto sector = map->sectors().firstWithId(tag))
-				front->setFloorPlane(sector->floor().plane);
-		}
-		if ((tag = line->arg(3)) && back)
-		{
-			if (auto sector = map->sectors().firstWithId(tag))
-				front->setCeilingPlane(sector->ceiling().plane);
-		}
-
-		// The fifth "share" argument copies from one side of the line to the
-		// other
-		if (front && back)
-		{
-			int share = line->arg(4);
-
-			if ((share & 3) == 1)
-				back->setFloorPlane(front->floor().plane);
-			else if ((share & 3) == 2)
-				front->setFloorPlane(back->floor().plane);
-
-			if ((share & 12) == 4)
-				back->setCeilingPlane(front->ceiling().plane);
-			else if ((share & 12) == 8)
-				front->setCeilingPlane(back->ceiling().plane);
-		}
-	}
+	for (auto line : slope_lines_)
+		if (line->special() == 118 && specialAffects(line, sectors))
+			applyPlaneCopySpecial(map, line);
 }
 
 // -----------------------------------------------------------------------------
 // Process Eternity slope specials
 // -----------------------------------------------------------------------------
-void MapSpecials::processEternitySlopes(SLADEMap* map) const
+void MapSpecials::processEternitySlopes(SLADEMap* map, const SectorSet* sectors) const
 {
 	// Eternity plans on having a few slope mechanisms,
 	// which must be evaluated in a specific order.
@@ -571,95 +926,118 @@ void MapSpecials::processEternitySlopes(SLADEMap* map) const
 	//  - Plane_Copy, in line order
 
 	// First things first: reset every sector to flat planes
-	for (unsigned a = 0; a < map->nSectors(); a++)
-	{
-		auto target = map->sector(a);
-		target->setPlane<SurfaceType::Floor>(Plane::flat(target->planeHeight<SurfaceType::Floor>()));
-		target->setPlane<SurfaceType::Ceiling>(Plane::flat(target->planeHeight<SurfaceType::Ceiling>()));
-	}
+	resetPlanes(map, sectors);
 
 	// Plane_Align (line special 181)
-	for (unsigned a = 0; a < map->nLines(); a++)
-	{
-		auto line = map->line(a);
-		if (line->special() != 181)
-			continue;
+	for (auto line : slope_lines_)
+		if (line->special() == 181 && specialAffects(line, sectors))
+			applyPlaneAlignSpecial(line);
 
-		auto sector1 = line->frontSector();
-		auto sector2 = line->backSector();
-		if (!sector1 || !sector2)
-		{
-			Log::warning(wxString::Format("Ignoring Plane_Align on one-sided line %d", line->index()));
-			continue;
-		}
-		if (sector1 == sector2)
-		{
-			Log::warning(wxString::Format(
-				"Ignoring Plane_Align on line %d, which has the same sector on both sides", line->index()));
-			continue;
-		}
+	// Plane_Copy
+	for (auto line : slope_lines_)
+		if (line->special() == 118 && specialAffects(line, sectors))
+			applyPlaneCopySpecial(map, line);
+}
 
-		int floor_arg = line->arg(0);
-		if (floor_arg == 1)
-			applyPlaneAlign<SurfaceType::Floor>(line, sector1, sector2);
-		else if (floor_arg == 2)
-			applyPlaneAlign<SurfaceType::Floor>(line, sector2, sector1);
+// -----------------------------------------------------------------------------
+// Resets the floor and ceiling planes of all [sectors] to flat planes, or every
+// sector in [map] if [sectors] is null
+// -----------------------------------------------------------------------------
+void MapSpecials::resetPlanes(SLADEMap* map, const SectorSet* sectors) const
+{
+	auto reset = [](MapSector* target) {
+		target->setPlane<SurfaceType::Floor>(Plane::flat(target->planeHeight<SurfaceType::Floor>()));
+		target->setPlane<SurfaceType::Ceiling>(Plane::flat(target->planeHeight<SurfaceType::Ceiling>()));
+	};
 
-		int ceiling_arg = line->arg(1);
-		if (ceiling_arg == 1)
-			applyPlaneAlign<SurfaceType::Ceiling>(line, sector1, sector2);
-		else if (ceiling_arg == 2)
-			applyPlaneAlign<SurfaceType::Ceiling>(line, sector2, sector1);
+	if (sectors)
+	{
+		for (auto target : *sectors)
+			reset(target);
 	}
+	else
+	{
+		for (auto target : map->sectors())
+			reset(target);
+	}
+}
 
-	// Plane_Copy
-	vector<MapSector*> sectors;
-	for (unsigned a = 0; a < map->nLines(); a++)
+// -----------------------------------------------------------------------------
+// Applies the Plane_Align special (181) on [line]
+// -----------------------------------------------------------------------------
+void MapSpecials::applyPlaneAlignSpecial(MapLine* line) const
+{
+	auto sector1 = line->frontSector();
+	auto sector2 = line->backSector();
+	if (!sector1 || !sector2)
 	{
-		auto line = map->line(a);
-		if (line->special() != 118)
-			continue;
+		Log::warning(wxString::Format("Ignoring Plane_Align on one-sided line %d", line->index()));
+		return;
+	}
+	if (sector1 == sector2)
+	{
+		Log::warning(wxString::Format(
+			"Ignoring Plane_Align on line %d, which has the same sector on both sides", line->index()));
+		return;
+	}
 
-		int  tag;
-		auto front = line->frontSector();
-		auto back  = line->backSector();
-		if ((tag = line->arg(0)) && front)
-		{
-			if (auto sector = map->sectors().firstWithId(tag))
-				front->setFloorPlane(sector->floor().plane);
-		}
-		if ((tag = line->arg(1)) && front)
-		{
-			if (auto sector = map->sectors().firstWithId(tag))
-				front->setCeilingPlane(sector->ceiling().plane);
-		}
-		if ((tag = line->arg(2)) && back)
-		{
-			if (auto sector = map->sectors().firstWithId(tag))
-				front->setFloorPlane(sector->floor().plane);
-		}
-		if ((tag = line->arg(3)) && back)
-		{
-			if (auto sector = map->sectors().firstWithId(tag))
-				front->setCeilingPlane(sector->ceiling().plane);
-		}
+	int floor_arg = line->arg(0);
+	if (floor_arg == 1)
+		applyPlaneAlign<SurfaceType::Floor>(line, sector1, sector2);
+	else if (floor_arg == 2)
+		applyPlaneAlign<SurfaceType::Floor>(line, sector2, sector1);
+
+	int ceiling_arg = line->arg(1);
+	if (ceiling_arg == 1)
+		applyPlaneAlign<SurfaceType::Ceiling>(line, sector1, sector2);
+	else if (ceiling_arg == 2)
+		applyPlaneAlign<SurfaceType::Ceiling>(line, sector2, sector1);
+}
 
-		// The fifth "share" argument copies from one side of the line to the
-		// other
-		if (front && back)
-		{
-			int share = line->arg(4);
+// -----------------------------------------------------------------------------
+// Applies the Plane_Copy special (118) on [line]
+// -----------------------------------------------------------------------------
+void MapSpecials::applyPlaneCopySpecial(SLADEMap* map, MapLine* line) const
+{
+	int  tag;
+	auto front = line->frontSector();
+	auto back  = line->backSector();
+	if ((tag = line->arg(0)) && front)
+	{
+		if (auto sector = map->sectors().firstWithId(tag))
+			front->setFloorPlane(sector->floor().plane);
+	}
+	if ((tag = line->arg(1)) && front)
+	{
+		if (auto sector = map->sectors().firstWithId(tag))
+			front->setCeilingPlane(sector->ceiling().plane);
+	}
+	if ((tag = line->arg(2)) && back)
+	{
+		if (auto sector = map->sectors().firstWithId(tag))
+			front->setFloorPlane(sector->floor().plane);
+	}
+	if ((tag = line->arg(3)) && back)
+	{
+		if (auto sector = map->sectors().firstWithId(tag))
+			front->setCeilingPlane(sector->ceiling().plane);
+	}
 
-			if ((share & 3) == 1)
-				back->setFloorPlane(front->floor().plane);
-			else if ((share & 3) == 2)
-				front->setFloorPlane(back->floor().plane);
+	// The fifth "share" argument copies from one side of the line to the
+	// other
+	if (front && back)
+	{
+		int share = line->arg(4);
 
-			if ((share & 12) == 4)
-				back->setCeilingPlane(front->ceiling().plane);
-			else if ((share & 12) == 8)
-				front->setCeilingPlane(back->ceiling().plane);
-		}
+		if ((share & 3) == 1)
+			back->setFloorPlane(front->floor().plane);
+		else if ((share & 3) == 2)
+			front->setFloorPlane(back->floor().plane);
+
+		if ((share & 12) == 4)
+			back->setCeilingPlane(front->ceiling().plane);
+		else if ((share & 12) == 8)
+			front->setCeilingPlane(back->ceiling().plane);
 	}
 }
 
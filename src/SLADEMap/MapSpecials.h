@@ -13,7 +13,8 @@ class MapSpecials
 public:
 	void reset();
 
-	void processMapSpecials(SLADEMap* map) const;
+	void processMapSpecials(SLADEMap* map);
+	void updateMapSpecials(SLADEMap* map);
 	void processLineSpecial(MapLine* line) const;
 
 	bool tagColour(int tag, ColRGBA* colour);
@@ -23,7 +24,6 @@ public:
 	void updateTaggedSectors(SLADEMap* map);
 
 	// ZDoom
-	void processZDoomMapSpecials(SLADEMap* map) const;
 	void processZDoomLineSpecial(MapLine* line) const;
 	void updateZDoomSector(MapSector* line);
 	void processACSScripts(ArchiveEntry* entry);
@@ -36,13 +36,44 @@ private:
 		ColRGBA colour;
 	};
 
+	// Sectors and ids a slope special depends on, recorded so that only the
+	// specials affected by a map edit need to be processed again
+	struct SpecialDeps
+	{
+		vector<MapSector*> targets;  // Sectors the special may change the planes of
+		vector<MapSector*> inputs;   // Sectors the special reads from
+		vector<int>        tags;     // Sector tags the special looks up
+		vector<int>        line_ids; // Line ids the special looks up
+	};
+
 	typedef std::map<MapVertex*, double> VertexHeightMap;
+	typedef std::set<MapSector*>         SectorSet;
 
 	vector<SectorColour> sector_colours_;
 	vector<SectorColour> sector_fadecolours_;
 
-	void processZDoomSlopes(SLADEMap* map) const;
-	void processEternitySlopes(SLADEMap* map) const;
+	// Specials from the last pass
+	vector<MapLine*>                  slope_lines_;
+	vector<MapThing*>                 slope_things_;
+	vector<MapLine*>                  translucent_lines_;
+	std::map<MapObject*, SpecialDeps> special_deps_;
+	long                              last_pass_time_      = -1;
+	unsigned                          last_pass_structure_ = 0;
+	wxString                          last_pass_port_;
+
+	void collectSpecials(SLADEMap* map);
+	void updateSpecialLists(MapObject* object);
+	void finishPass(SLADEMap* map);
+	bool isSlopeSpecial(MapObject* object) const;
+	bool specialAffects(MapObject* special, const SectorSet* sectors) const;
+	void putSpecialDeps(SLADEMap* map, MapObject* special, SpecialDeps& deps) const;
+
+	void processZDoomMapSpecials(SLADEMap* map) const;
+	void processZDoomSlopes(SLADEMap* map, const SectorSet* sectors = nullptr) const;
+	void processEternitySlopes(SLADEMap* map, const SectorSet* sectors = nullptr) const;
+	void resetPlanes(SLADEMap* map, const SectorSet* sectors) const;
+	void applyPlaneAlignSpecial(MapLine* line) const;
+	void applyPlaneCopySpecial(SLADEMap* map, MapLine* line) const;
 
 	template<MapSector::SurfaceType>
 	void applyPlaneAlign(MapLine* line, MapSector* target, MapSector* model_sector) const;
@@ -37,6 +37,7 @@
 #include "MapEditor/SectorBuilder.h"
 #include "MapFormat/MapFormatHandler.h"
 #include "Utility/MathStuff.h"
+#include "Utility/Profiler.h"
 
 
 // -----------------------------------------------------------------------------
@@ -108,6 +109,8 @@ void SLADEMap::setThingsUpdated()
 // -----------------------------------------------------------------------------
 bool SLADEMap::readMap(Archive::MapDesc map)
 {
+	PROFILE_ZONE("SLADEMap::readMap");
+
 	auto omap = map;
 
 	// Check for map archive
@@ -289,11 +292,12 @@ void SLADEMap::putThingsWithIdInSectorTag(int id, int tag, vector<MapThing*>& li
 		return;
 
 	// Find things with matching id contained in sector with matching tag
+	auto& geometry = data_.geometry();
 	for (auto& thing : data_.things())
 	{
 		if (thing->id() == id)
 		{
-			auto sector = data_.sectors().atPos(thing->position());
+			auto sector = this->sector(geometry.sectorAt(thing->position()));
 			if (sector && sector->id_ == tag)
 				list.push_back(thing);
 		}
@@ -489,10 +493,12 @@ void SLADEMap::setOpenedTime()
 // this just means ZDoom slopes).
 // Since this needs to be done anytime the map changes, it's called whenever a
 // map is read, an undo record ends, or an undo/redo is performed.
+// Only specials affected by objects modified since the last time this was
+// called are recomputed, see MapSpecials::updateMapSpecials
 // -----------------------------------------------------------------------------
 void SLADEMap::recomputeSpecials()
 {
-	map_specials_.processMapSpecials(this);
+	map_specials_.updateMapSpecials(this);
 }
 
 // -----------------------------------------------------------------------------
@@ -500,6 +506,8 @@ void SLADEMap::recomputeSpecials()
 // -----------------------------------------------------------------------------
 bool SLADEMap::writeMap(vector<ArchiveEntry*>& map_entries) const
 {
+	PROFILE_ZONE("SLADEMap::writeMap");
+
 	auto out = MapFormatHandler::get(current_format_)->writeMap(data_, udmf_props_);
 	if (out.empty())
 		return false;
@@ -533,7 +541,7 @@ MapVertex* SLADEMap::createVertex(Vec2d pos, double split_dist)
 		return overlap;
 
 	// Create the vertex
-	auto nv = data_.addVertex(std::make_unique<MapVertex>(pos));
+	auto nv = data_.createVertex(pos);
 
 	// Check if this vertex splits any lines (if needed)
 	if (split_dist >= 0)
@@ -608,7 +616,7 @@ MapLine* SLADEMap::createLine(MapVertex* vertex1, MapVertex* vertex2, bool force
 			return existing;
 
 	// Create new line between vertices
-	auto nl = data_.addLine(std::make_unique<MapLine>(vertex1, vertex2, nullptr, nullptr));
+	auto nl = data_.createLine(vertex1, vertex2, nullptr, nullptr);
 
 	// Connect line to vertices
 	vertex1->connectLine(nl);
@@ -626,7 +634,7 @@ MapLine* SLADEMap::createLine(MapVertex* vertex1, MapVertex* vertex2, bool force
 MapThing* SLADEMap::createThing(Vec2d pos, int type)
 {
 	// Create the thing
-	return data_.addThing(std::make_unique<MapThing>(pos, type));
+	return data_.createThing(pos, type);
 }
 
 // -----------------------------------------------------------------------------
@@ -634,7 +642,7 @@ MapThing* SLADEMap::createThing(Vec2d pos, int type)
 // -----------------------------------------------------------------------------
 MapSector* SLADEMap::createSector()
 {
-	return data_.addSector(std::make_unique<MapSector>());
+	return data_.createSector();
 }
 
 // -----------------------------------------------------------------------------
@@ -646,7 +654,7 @@ MapSide* SLADEMap::createSide(MapSector* sector)
 	if (!sector)
 		return nullptr;
 
-	return data_.addSide(std::make_unique<MapSide>(sector));
+	return data_.createSide(sector);
 }
 
 // -----------------------------------------------------------------------------
@@ -772,7 +780,7 @@ MapLine* SLADEMap::splitLine(MapLine* line, MapVertex* vertex)
 	}
 
 	// Create and add new line
-	auto nl = data_.addLine(std::make_unique<MapLine>(vertex, v2, s1, s2));
+	auto nl = data_.createLine(vertex, v2, s1, s2);
 	nl->copy(line);
 	nl->setModified();
 
@@ -1234,6 +1242,7 @@ void SLADEMap::correctSectors(vector<MapLine*> lines, bool existing_only)
 
 	// Create a list of line sides (edges) to perform sector creation with
 	vector<Edge> edges;
+	auto&        geometry = data_.geometry();
 	for (auto& line : lines)
 	{
 		if (existing_only)
@@ -1249,7 +1258,7 @@ void SLADEMap::correctSectors(vector<MapLine*> lines, bool existing_only)
 		{
 			edges.emplace_back(line, true);
 			auto mid = line->getPoint(MapObject::Point::Mid);
-			if (sectors().atPos(mid))
+			if (geometry.sectorAt(mid) >= 0)
 				edges.emplace_back(line, false);
 		}
 	}
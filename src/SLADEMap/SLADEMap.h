@@ -36,6 +36,7 @@ public:
 
 	void setGeometryUpdated();
 	void setThingsUpdated();
+	void invalidateGeometry() { data_.invalidateGeometry(); }
 
 	// MapObject access
 	MapVertex*        vertex(unsigned index) const { return data_.vertices().at(index); }
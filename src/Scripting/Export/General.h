@@ -5,6 +5,53 @@ void logMessage(const char* message)
 	Log::message(Log::MessageType::Script, message);
 }
 
+#ifdef HEADLESS
+// There is no UI to show in headless builds: messages go to the log and
+// prompts get their default (or an empty/negative) answer
+
+// Show a message box
+void messageBox(const wxString& title, const wxString& message)
+{
+	Log::message(Log::MessageType::Script, (title + ": " + message).ToStdString());
+}
+
+// Show an extended message box
+void messageBoxExtended(const wxString& title, const wxString& message, const wxString& extra)
+{
+	Log::message(Log::MessageType::Script, (title + ": " + message + "\n" + extra).ToStdString());
+}
+
+// Prompt for a string
+wxString promptString(const wxString& title, const wxString& message, const wxString& default_value)
+{
+	return default_value;
+}
+
+// Prompt for a number
+int promptNumber(const wxString& title, const wxString& message, int default_value, int min, int max)
+{
+	return default_value;
+}
+
+// Prompt for a yes/no answer
+bool promptYesNo(const wxString& title, const wxString& message)
+{
+	return false;
+}
+
+// Browse for a single file
+wxString browseFile(const wxString& title, const wxString& extensions, const wxString& filename)
+{
+	return "";
+}
+
+// Browse for multiple files
+vector<wxString> browseFiles(const wxString& title, const wxString& extensions)
+{
+	return {};
+}
+
+#else
 // Show a message box
 void messageBox(const wxString& title, const wxString& message)
 {
@@ -57,6 +104,8 @@ vector<wxString> browseFiles(const wxString& title, const wxString& extensions)
 	return filenames;
 }
 
+#endif
+
 // Switch to the tab for [archive], opening it if necessary
 bool showArchive(Archive* archive)
 {
@@ -134,7 +183,9 @@ void registerAppNamespace(sol::state& lua)
 	app.set_function("currentEntrySelection", &MainEditor::currentEntrySelection);
 	app.set_function("showArchive", &showArchive);
 	app.set_function("showEntry", &MainEditor::openEntry);
+#ifndef HEADLESS
 	app.set_function("mapEditor", &MapEditor::editContext);
+#endif
 }
 
 void registerSplashWindowNamespace(sol::state& lua)
@@ -72,6 +72,7 @@ void registerSLADEMap(sol::state& lua)
 		sol::property(&SLADEMap::things));
 }
 
+#ifndef HEADLESS
 void selectMapObject(MapEditContext& self, MapObject* object, bool select)
 {
 	if (object)
@@ -172,6 +173,7 @@ void registerMapEditor(sol::state& lua)
 		"Ceiling",
 		MapEditor::SectorMode::Ceiling);
 }
+#endif
 
 void registerMapVertex(sol::state& lua)
 {
@@ -469,7 +471,9 @@ void registerMapObject(sol::state& lua)
 
 void registerMapEditorTypes(sol::state& lua)
 {
+#ifndef HEADLESS
 	registerMapEditor(lua);
+#endif
 	registerSLADEMap(lua);
 	registerMapObject(lua);
 	registerMapVertex(lua);
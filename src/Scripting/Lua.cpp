@@ -33,7 +33,6 @@
 #define SOL_CHECK_ARGUMENTS 1
 #include "Archive/ArchiveManager.h"
 #include "Archive/Formats/All.h"
-#include "Dialogs/ExtMessageDialog.h"
 #include "thirdparty/sol/sol.hpp"
 #include "Game/Configuration.h"
 #include "Game/ThingType.h"
@@ -42,10 +41,13 @@
 #include "General/UI.h"
 #include "Lua.h"
 #include "MainEditor/MainEditor.h"
-#include "MapEditor/MapEditContext.h"
 #include "SLADEMap/SLADEMap.h"
 #include "Utility/SFileDialog.h"
 #include "Utility/StringUtils.h"
+#ifndef HEADLESS
+#include "Dialogs/ExtMessageDialog.h"
+#include "MapEditor/MapEditContext.h"
+#endif
 
 
 // -----------------------------------------------------------------------------
@@ -233,11 +235,15 @@ Lua::Error& Lua::error()
 // -----------------------------------------------------------------------------
 void Lua::showErrorDialog(wxWindow* parent, const wxString& title, const wxString& message)
 {
+#ifdef HEADLESS
+	// No dialogs in headless builds, the error has already been logged
+	return;
+#else
 	// Get script log messages since the last script was started
 	auto     log = Log::since(script_start_time, Log::MessageType::Script);
 	wxString output;
-	for (auto msg : log)
-		output += msg->formattedMessageLine() + "\n";
+	for (auto& msg : log)
+		output += msg.formattedMessageLine() + "\n";
 
 	ExtMessageDialog dlg(parent ? parent : current_window, title);
 	dlg.setMessage(message);
@@ -249,6 +255,7 @@ void Lua::showErrorDialog(wxWindow* parent, const wxString& title, const wxStrin
 		CHR(output)));
 	dlg.CenterOnParent();
 	dlg.ShowModal();
+#endif
 }
 
 // -----------------------------------------------------------------------------
@@ -119,7 +119,7 @@ void TLFunction::addContext(
 	{
 		while (!tz.check(","))
 		{
-			arg_tokens.push_back(tz.current().text);
+			arg_tokens.push_back(tz.current().text());
 			if (tz.atEnd())
 				break;
 			tz.adv();
@@ -146,7 +146,7 @@ void TLFunction::addContext(
 				tz.adv();
 
 			bool is_replacement = true;
-			for (auto&& c : tz.current().text)
+			for (auto&& c : tz.current().text())
 			{
 				char chr = c;
 				if (isdigit(chr) || chr == '.')
@@ -157,9 +157,9 @@ void TLFunction::addContext(
 			}
 
 			if (is_replacement)
-				ctx.deprecated_f = tz.current().text;
+				ctx.deprecated_f = tz.current().text();
 			else
-				ctx.deprecated_v = tz.current().text;
+				ctx.deprecated_v = tz.current().text();
 
 			if (tz.atEnd())
 				break;
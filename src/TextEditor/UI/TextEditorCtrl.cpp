@@ -35,6 +35,7 @@
 #include "TextEditorCtrl.h"
 #include "App.h"
 #include "FindReplacePanel.h"
+#include "Game/Game.h"
 #include "General/KeyBind.h"
 #include "Graphics/Icons.h"
 #include "SCallTip.h"
@@ -357,7 +358,12 @@ bool TextEditorCtrl::setLanguage(TextLanguage* lang)
 	{
 		// Create correct lexer type for language
 		if (lang->id() == "zscript")
+		{
+			// Wait for the base ZScript definitions (if still loading) so
+			// they are included in the language
+			Game::zscriptBaseDefinitions();
 			lexer_ = std::make_unique<ZScriptLexer>();
+		}
 		else
 			lexer_ = std::make_unique<Lexer>();
 
@@ -68,6 +68,14 @@ BrowserCanvas::BrowserCanvas(wxWindow* parent) :
 	Bind(wxEVT_MOUSEWHEEL, &BrowserCanvas::onMouseEvent, this);
 	Bind(wxEVT_LEFT_DOWN, &BrowserCanvas::onMouseEvent, this);
 	Bind(wxEVT_KEY_DOWN, &BrowserCanvas::onKeyDown, this);
+
+	// Redraw when images decoded in the background are ready to upload
+	decode_timer_.Bind(wxEVT_TIMER, [&](wxTimerEvent&) {
+		if (decode_queue_.hasResults())
+			Refresh();
+		else if (decode_queue_.nPending() == 0)
+			decode_timer_.Stop();
+	});
 }
 
 // -----------------------------------------------------------------------------
@@ -105,6 +113,10 @@ void BrowserCanvas::addItem(BrowserItem* item)
 // -----------------------------------------------------------------------------
 void BrowserCanvas::clearItems()
 {
+	decode_queue_.cancelAll();
+	for (auto item : items_)
+		item->decoding_ = false;
+
 	items_.clear();
 }
 
@@ -196,6 +208,11 @@ void BrowserCanvas::draw()
 	if (browser_bg_type == 0)
 		drawCheckeredBackground();
 
+	// Upload any item images decoded in the background
+	for (auto& result : decode_queue_.takeResults())
+		if (result.id < items_.size())
+			items_[result.id]->imageDecodeFinished(*result.image, result.ok);
+
 	// Init for texture drawing
 	glEnable(GL_TEXTURE_2D);
 	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
@@ -207,6 +224,7 @@ void BrowserCanvas::draw()
 	int col_width = GetSize().x / num_cols_;
 	int col       = 0;
 	top_index_    = -1;
+	vector<unsigned> visible;
 	for (unsigned a = 0; a < items_filter_.size(); a++)
 	{
 		// If we're not yet into the viewable area, skip
@@ -269,6 +287,11 @@ void BrowserCanvas::draw()
 			glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
 		}
 
+		// Decode the item image in the background if needed, visible items
+		// first in drawing order
+		queueImageDecode(items_filter_[a], visible.size());
+		visible.push_back(items_filter_[a]);
+
 		// Draw item
 		if (item_size_ <= 0)
 			items_[items_filter_[a]]->draw(
@@ -290,6 +313,9 @@ void BrowserCanvas::draw()
 		}
 	}
 
+	// Don't decode images for items that are no longer visible
+	updateImageDecoding(visible);
+
 	// Swap Buffers
 	SwapBuffers();
 }
@@ -570,6 +596,47 @@ int BrowserCanvas::longestItemTextWidth() const
 	// return longest_text;
 }
 
+// -----------------------------------------------------------------------------
+// Queues the image for the item at [index] to be decoded in the background
+// with [priority], if it needs loading and supports it. If it is already being
+// decoded, its priority is updated
+// -----------------------------------------------------------------------------
+void BrowserCanvas::queueImageDecode(unsigned index, int priority)
+{
+	auto item = items_[index];
+	if (item->blank_ || item->decode_failed_ || item->imageLoaded())
+		return;
+
+	// Already queued
+	if (item->decoding_)
+	{
+		decode_queue_.setPriority(index, priority);
+		return;
+	}
+
+	// Items that can't be decoded in the background are loaded when drawn
+	auto decoder = item->imageDecoder();
+	if (!decoder)
+		return;
+
+	decode_queue_.request(index, priority, decoder);
+	item->decoding_ = true;
+}
+
+// -----------------------------------------------------------------------------
+// Cancels background decoding of any item images other than those for the
+// [visible] items, and starts polling for decoded images if any are pending
+// -----------------------------------------------------------------------------
+void BrowserCanvas::updateImageDecoding(const vector<unsigned>& visible)
+{
+	for (auto index : decode_queue_.cancelExcept(visible))
+		if (index < items_.size())
+			items_[index]->decoding_ = false;
+
+	if (decode_queue_.nPending() > 0 && !decode_timer_.IsRunning())
+		decode_timer_.Start(15);
+}
+
 
 // -----------------------------------------------------------------------------
 //
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Graphics/ImageDecodeQueue.h"
 #include "OpenGL/Drawing.h"
 #include "UI/Canvas/OGLCanvas.h"
 
@@ -77,6 +78,13 @@ private:
 	int           top_y_       = 0;
 	ItemView      item_type_   = ItemView::Normal;
 	int           num_cols_    = -1;
+
+	// Background image decoding (item index is the job id)
+	ImageDecodeQueue decode_queue_;
+	wxTimer          decode_timer_;
+
+	void queueImageDecode(unsigned index, int priority);
+	void updateImageDecoding(const vector<unsigned>& visible);
 };
 
 DECLARE_EVENT_TYPE(wxEVT_BROWSERCANVAS_SELECTION_CHANGED, -1)
@@ -35,6 +35,7 @@
 #include "BrowserItem.h"
 #include "BrowserWindow.h"
 #include "General/UI.h"
+#include "Graphics/SImage/SImage.h"
 #include "OpenGL/Drawing.h"
 #include "OpenGL/GLTexture.h"
 #include "OpenGL/OpenGL.h"
@@ -62,12 +63,36 @@ BrowserItem::BrowserItem(const wxString& name, unsigned index, const wxString& t
 }
 
 // -----------------------------------------------------------------------------
-// Loads the item image (base class does nothing, must be overridden by child
-// classes to be useful at all)
+// Loads the item image. The base class decodes the image immediately via the
+// background decoding functions, so child classes must override either this
+// or imageDecoder and imageDecoded to be useful at all
 // -----------------------------------------------------------------------------
 bool BrowserItem::loadImage()
 {
-	return false;
+	auto decode = imageDecoder();
+	if (!decode)
+		return false;
+
+	SImage image;
+	return imageDecoded(image, decode(image));
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the item image is loaded
+// -----------------------------------------------------------------------------
+bool BrowserItem::imageLoaded() const
+{
+	return image_tex_ && OpenGL::Texture::isLoaded(image_tex_);
+}
+
+// -----------------------------------------------------------------------------
+// Called when the item image has finished decoding in the background, to
+// [image] if [ok] is true
+// -----------------------------------------------------------------------------
+void BrowserItem::imageDecodeFinished(SImage& image, bool ok)
+{
+	decoding_      = false;
+	decode_failed_ = !imageDecoded(image, ok);
 }
 
 // -----------------------------------------------------------------------------
@@ -141,16 +166,21 @@ void BrowserItem::draw(
 	if (blank_)
 		return;
 
-	// Try to load image if it isn't already
-	if (!image_tex_ || (image_tex_ && !OpenGL::Texture::isLoaded(image_tex_)))
+	// Try to load image if it isn't already (and isn't being or failed to be
+	// decoded in the background)
+	if (!imageLoaded() && !decoding_ && !decode_failed_)
 		loadImage();
 
-	// If it still isn't just draw a red box with an X
-	if (!image_tex_ || (image_tex_ && !OpenGL::Texture::isLoaded(image_tex_)))
+	// If it still isn't just draw a red box with an X, or a faint box if it's
+	// still being decoded
+	if (!imageLoaded())
 	{
 		glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT);
 
-		glColor3f(1, 0, 0);
+		if (decoding_)
+			glColor4f(colour.fr(), colour.fg(), colour.fb(), 0.3f);
+		else
+			glColor3f(1, 0, 0);
 		glDisable(GL_TEXTURE_2D);
 
 		// Outline
@@ -162,12 +192,15 @@ void BrowserItem::draw(
 		glEnd();
 
 		// X
-		glBegin(GL_LINES);
-		glVertex2i(x, y);
-		glVertex2i(x + size, y + size);
-		glVertex2i(x, y + size);
-		glVertex2i(x + size, y);
-		glEnd();
+		if (!decoding_)
+		{
+			glBegin(GL_LINES);
+			glVertex2i(x, y);
+			glVertex2i(x + size, y + size);
+			glVertex2i(x, y + size);
+			glVertex2i(x + size, y);
+			glEnd();
+		}
 
 		glPopAttrib();
 
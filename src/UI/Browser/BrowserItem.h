@@ -8,6 +8,7 @@ class BrowserWindow;
 class BrowserItem
 {
 	friend class BrowserWindow;
+	friend class BrowserCanvas;
 
 public:
 	BrowserItem(const wxString& name, unsigned index = 0, const wxString& type = "item");
@@ -17,6 +18,7 @@ public:
 	unsigned index() const { return index_; }
 
 	virtual bool loadImage();
+	bool         imageLoaded() const;
 	void         draw(
 				int                     size,
 				int                     x,
@@ -29,6 +31,11 @@ public:
 	virtual void     clearImage() {}
 	virtual wxString itemInfo() { return ""; }
 
+	// Background image decoding (see BrowserCanvas)
+	virtual ImageDecodeQueue::DecodeFunc imageDecoder() { return {}; }
+	virtual bool                         imageDecoded(SImage& image, bool ok) { return false; }
+	void                                 imageDecodeFinished(SImage& image, bool ok);
+
 	typedef std::unique_ptr<BrowserItem> UPtr;
 
 protected:
@@ -39,4 +46,6 @@ protected:
 	BrowserWindow*           parent_    = nullptr;
 	bool                     blank_     = false;
 	std::unique_ptr<TextBox> text_box_;
+	bool                     decoding_      = false; // Image is queued for decoding in the background
+	bool                     decode_failed_ = false;
 };
@@ -15,7 +15,7 @@ private:
 	wxTextCtrl*       text_command_  = nullptr;
 	int               cmd_log_index_ = 0;
 	wxTimer           timer_update_;
-	unsigned          next_message_index_ = 0;
+	uint64_t          next_message_ = 0; // Log message cursor, see Log::newMessages
 
 	// Events
 	void onCommandEnter(wxCommandEvent& e);
@@ -109,6 +109,9 @@ ArchiveEntryList::ArchiveEntryList(wxWindow* parent) : VirtualListView(parent)
 	// Setup flags
 	SetSingleStyle(wxLC_HRULES, elist_hrules);
 	SetSingleStyle(wxLC_VRULES, elist_vrules);
+
+	// Only update the list once for entries added/removed/etc. in a batch
+	setTakesBatches(true);
 }
 
 // -----------------------------------------------------------------------------
@@ -0,0 +1,497 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2019 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    BVH.cpp
+// Description: BVH class - a bounding volume hierarchy over a list of items,
+//              each with a 3d axis-aligned bounding box, for quickly finding
+//              the items a ray might hit (nearest first).
+//              Item boxes can be changed at any time - the tree is refit around
+//              changed boxes, and only rebuilt once it has been refit too many
+//              times or new items were added
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "BVH.h"
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Clips the ray interval [t_min]-[t_max] to the slab between [min] and [max] on
+// one axis, where [origin] and [inv_dir] are the ray origin and (inverse)
+// direction on that axis. Returns false if the ray misses the slab
+// -----------------------------------------------------------------------------
+bool clipSlab(double origin, double inv_dir, double min, double max, double& t_min, double& t_max)
+{
+	// Parallel to the slab
+	if (std::isinf(inv_dir))
+		return origin >= min && origin <= max;
+
+	double t1 = (min - origin) * inv_dir;
+	double t2 = (max - origin) * inv_dir;
+	if (t1 > t2)
+		std::swap(t1, t2);
+	t_min = std::max(t_min, t1);
+	t_max = std::min(t_max, t2);
+
+	return t_min <= t_max;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if boxes [a] and [b] are identical
+// -----------------------------------------------------------------------------
+bool sameBox(const BVH::Box& a, const BVH::Box& b)
+{
+	return a.min.x == b.min.x && a.min.y == b.min.y && a.min.z == b.min.z && a.max.x == b.max.x
+		   && a.max.y == b.max.y && a.max.z == b.max.z;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// BVH::Box Struct Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Extends the box to contain [box]
+// -----------------------------------------------------------------------------
+void BVH::Box::extend(const Box& box)
+{
+	if (!box.valid())
+		return;
+	if (!valid())
+	{
+		*this = box;
+		return;
+	}
+
+	min.set(std::min(min.x, box.min.x), std::min(min.y, box.min.y), std::min(min.z, box.min.z));
+	max.set(std::max(max.x, box.max.x), std::max(max.y, box.max.y), std::max(max.z, box.max.z));
+}
+
+// -----------------------------------------------------------------------------
+// Extends the box to contain [point]
+// -----------------------------------------------------------------------------
+void BVH::Box::extend(Vec3d point)
+{
+	extend(Box(point, point));
+}
+
+// -----------------------------------------------------------------------------
+// Grows the box by [amount] in each direction
+// -----------------------------------------------------------------------------
+void BVH::Box::pad(double amount)
+{
+	if (!valid())
+		return;
+
+	min.set(min.x - amount, min.y - amount, min.z - amount);
+	max.set(max.x + amount, max.y + amount, max.z + amount);
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [box] is entirely within the box
+// -----------------------------------------------------------------------------
+bool BVH::Box::contains(const Box& box) const
+{
+	return box.min.x >= min.x && box.min.y >= min.y && box.min.z >= min.z && box.max.x <= max.x
+		   && box.max.y <= max.y && box.max.z <= max.z;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the surface area of the box
+// -----------------------------------------------------------------------------
+double BVH::Box::surfaceArea() const
+{
+	if (!valid())
+		return 0.;
+
+	auto size = max - min;
+	return 2. * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the distance along the ray from [origin] (with inverse direction
+// [inv_dir]) at which it enters the box, 0 if it starts within the box, or -1
+// if it doesn't hit the box within [max_dist]
+// -----------------------------------------------------------------------------
+double BVH::Box::rayEntry(Vec3d origin, Vec3d inv_dir, double max_dist) const
+{
+	double t_min = 0.;
+	double t_max = max_dist;
+	if (!clipSlab(origin.x, inv_dir.x, min.x, max.x, t_min, t_max)
+		|| !clipSlab(origin.y, inv_dir.y, min.y, max.y, t_min, t_max)
+		|| !clipSlab(origin.z, inv_dir.z, min.z, max.z, t_min, t_max))
+		return -1.;
+
+	return t_min;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// BVH Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Removes all items and nodes
+// -----------------------------------------------------------------------------
+void BVH::clear()
+{
+	items_.clear();
+	nodes_.clear();
+	item_order_.clear();
+	item_leaf_.clear();
+	needs_build_ = true;
+	n_refits_    = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Sets the number of items to [n_items]. Any new items have no box (and are
+// never hit) until set with setItem
+// -----------------------------------------------------------------------------
+void BVH::resize(unsigned n_items)
+{
+	if (n_items < items_.size())
+		needs_build_ = true;
+
+	items_.resize(n_items);
+	item_leaf_.resize(n_items, -1);
+}
+
+// -----------------------------------------------------------------------------
+// Sets the bounding box of the item at [index] to [box] (an invalid box
+// removes the item), refitting the tree around it
+// -----------------------------------------------------------------------------
+void BVH::setItem(unsigned index, const Box& box)
+{
+	if (index >= items_.size())
+		return;
+
+	items_[index] = box;
+	if (needs_build_)
+		return;
+
+	// Item isn't in the tree yet, needs a rebuild
+	int leaf = item_leaf_[index];
+	if (leaf < 0)
+	{
+		if (box.valid())
+			needs_build_ = true;
+		return;
+	}
+
+	// Refit, rebuilding later if the item has grown out of its leaf too many
+	// times since the tree was built (the tree gets less efficient as leaves grow)
+	if (!nodes_[leaf].box.contains(box) && ++n_refits_ > std::max<unsigned>(items_.size() / 8, 64))
+		needs_build_ = true;
+	refit(leaf);
+}
+
+// -----------------------------------------------------------------------------
+// (Re)builds the tree from all items with a valid box
+// -----------------------------------------------------------------------------
+void BVH::build()
+{
+	nodes_.clear();
+	item_order_.clear();
+	item_leaf_.assign(items_.size(), -1);
+	for (unsigned a = 0; a < items_.size(); a++)
+		if (items_[a].valid())
+			item_order_.push_back(a);
+
+	if (!item_order_.empty())
+	{
+		nodes_.reserve(item_order_.size() / 2 + 1);
+		buildNode(0, item_order_.size(), -1);
+	}
+
+	needs_build_ = false;
+	n_refits_    = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Builds a node containing the [count] items from [first] in item_order_,
+// splitting them in half along the longest axis of their centres.
+// Returns the index of the new node
+// -----------------------------------------------------------------------------
+int BVH::buildNode(unsigned first, unsigned count, int parent)
+{
+	int index = nodes_.size();
+	nodes_.emplace_back();
+	nodes_[index].parent = parent;
+
+	// Get bounds of items and their centres
+	Box bounds, centres;
+	for (unsigned a = first; a < first + count; a++)
+	{
+		auto& box = items_[item_order_[a]];
+		bounds.extend(box);
+		centres.extend((box.min + box.max) * 0.5);
+	}
+	nodes_[index].box = bounds;
+
+	// Leaf node
+	if (count <= MAX_LEAF_ITEMS)
+	{
+		nodes_[index].first = first;
+		nodes_[index].count = count;
+		for (unsigned a = first; a < first + count; a++)
+			item_leaf_[item_order_[a]] = index;
+		return index;
+	}
+
+	// Split at the median centre along the longest axis
+	auto size = centres.max - centres.min;
+	int  axis = 0;
+	if (size.y > size.x && size.y >= size.z)
+		axis = 1;
+	else if (size.z > size.x && size.z > size.y)
+		axis = 2;
+	auto centre = [this, axis](unsigned item) {
+		auto& box = items_[item];
+		return axis == 0 ? box.min.x + box.max.x : axis == 1 ? box.min.y + box.max.y : box.min.z + box.max.z;
+	};
+	auto begin = item_order_.begin() + first;
+	std::nth_element(
+		begin, begin + count / 2, begin + count, [&](unsigned a, unsigned b) { return centre(a) < centre(b); });
+
+	int left            = buildNode(first, count / 2, index);
+	int right           = buildNode(first + count / 2, count - count / 2, index);
+	nodes_[index].left  = left;
+	nodes_[index].right = right;
+
+	return index;
+}
+
+// -----------------------------------------------------------------------------
+// Recalculates the box of [node] and its parents, stopping once a box doesn't
+// change
+// -----------------------------------------------------------------------------
+void BVH::refit(int node)
+{
+	while (node >= 0)
+	{
+		auto& n = nodes_[node];
+
+		Box box;
+		if (n.count > 0)
+		{
+			for (unsigned a = n.first; a < n.first + n.count; a++)
+				box.extend(items_[item_order_[a]]);
+		}
+		else
+		{
+			box = nodes_[n.left].box;
+			box.extend(nodes_[n.right].box);
+		}
+
+		if (sameBox(box, n.box))
+			return;
+
+		n.box = box;
+		node  = n.parent;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Calls [visit] for each item whose box is hit by the ray from [origin] in
+// [dir] within [max_dist], roughly nearest first.
+// [visit] can lower [max_dist] (eg. when it finds a hit), which excludes any
+// items further away from then on
+// -----------------------------------------------------------------------------
+void BVH::intersectRay(Vec3d origin, Vec3d dir, double& max_dist, const std::function<void(unsigned)>& visit)
+{
+	if (needs_build_)
+		build();
+	if (nodes_.empty())
+		return;
+
+	Vec3d inv_dir(1. / dir.x, 1. / dir.y, 1. / dir.z);
+	double dist = nodes_[0].box.rayEntry(origin, inv_dir, max_dist);
+	if (dist < 0)
+		return;
+
+	struct Entry
+	{
+		int    node;
+		double dist;
+	};
+	vector<Entry> stack;
+	stack.push_back({ 0, dist });
+	while (!stack.empty())
+	{
+		auto entry = stack.back();
+		stack.pop_back();
+		if (entry.dist > max_dist)
+			continue;
+
+		// Leaf node, check items
+		auto& node = nodes_[entry.node];
+		if (node.count > 0)
+		{
+			for (unsigned a = node.first; a < node.first + node.count; a++)
+			{
+				auto item = item_order_[a];
+				if (items_[item].rayEntry(origin, inv_dir, max_dist) >= 0)
+					visit(item);
+			}
+			continue;
+		}
+
+		// Add hit children, nearest last so it's checked first
+		double dist_left  = nodes_[node.left].box.rayEntry(origin, inv_dir, max_dist);
+		double dist_right = nodes_[node.right].box.rayEntry(origin, inv_dir, max_dist);
+		if (dist_left >= 0 && dist_right >= 0)
+		{
+			if (dist_left < dist_right)
+			{
+				stack.push_back({ node.right, dist_right });
+				stack.push_back({ node.left, dist_left });
+			}
+			else
+			{
+				stack.push_back({ node.left, dist_left });
+				stack.push_back({ node.right, dist_right });
+			}
+		}
+		else if (dist_left >= 0)
+			stack.push_back({ node.left, dist_left });
+		else if (dist_right >= 0)
+			stack.push_back({ node.right, dist_right });
+	}
+}
+
+
+// Testing
+
+#include "General/Console/Console.h"
+#include "Utility/StringUtils.h"
+
+CONSOLE_COMMAND(test_bvh, 0, false)
+{
+	// Casts random rays at random boxes, checking the nearest box hit found via
+	// the BVH matches a brute force search, before and after moving some boxes.
+	// Doesn't need a map or OpenGL context
+	unsigned n_items = args.empty() ? 100000 : StrUtil::toInt(args[0]);
+	unsigned n_rays  = args.size() < 2 ? 10000 : StrUtil::toInt(args[1]);
+	if (n_items == 0)
+		return;
+
+	auto rand_range = [](double min, double max) { return min + (max - min) * (rand() % 100000) * 0.00001; };
+	auto random_box = [&]() {
+		Vec3d pos(rand_range(-32768, 32768), rand_range(-32768, 32768), rand_range(-1024, 1024));
+		Vec3d size(rand_range(1, 512), rand_range(1, 512), rand_range(1, 256));
+		return BVH::Box(pos, pos + size);
+	};
+
+	BVH       bvh;
+	sf::Clock clock;
+	bvh.resize(n_items);
+	for (unsigned a = 0; a < n_items; a++)
+		bvh.setItem(a, random_box());
+	bvh.build();
+	Log::info(wxString::Format(
+		"Built BVH of %d items (%d nodes) in %dms", n_items, bvh.nNodes(), clock.getElapsedTime().asMilliseconds()));
+
+	auto test = [&](const wxString& pass) {
+		double   time_bvh = 0, time_brute = 0;
+		unsigned mismatches = 0, visited = 0;
+		for (unsigned r = 0; r < n_rays; r++)
+		{
+			Vec3d origin(rand_range(-32768, 32768), rand_range(-32768, 32768), rand_range(-1024, 1024));
+			Vec3d dir(rand_range(-1, 1), rand_range(-1, 1), rand_range(-0.2, 0.2));
+			dir.normalize();
+			Vec3d inv_dir(1. / dir.x, 1. / dir.y, 1. / dir.z);
+
+			// BVH
+			clock.restart();
+			double nearest_bvh = 9999999;
+			int    item_bvh    = -1;
+			bvh.intersectRay(origin, dir, nearest_bvh, [&](unsigned item) {
+				visited++;
+				double dist = bvh.itemBox(item).rayEntry(origin, inv_dir, nearest_bvh);
+				if (dist >= 0 && dist < nearest_bvh)
+				{
+					nearest_bvh = dist;
+					item_bvh    = item;
+				}
+			});
+			time_bvh += clock.getElapsedTime().asMicroseconds() / 1000.;
+
+			// Brute force
+			clock.restart();
+			double nearest_brute = 9999999;
+			int    item_brute    = -1;
+			for (unsigned a = 0; a < n_items; a++)
+			{
+				double dist = bvh.itemBox(a).rayEntry(origin, inv_dir, nearest_brute);
+				if (dist >= 0 && dist < nearest_brute)
+				{
+					nearest_brute = dist;
+					item_brute    = a;
+				}
+			}
+			time_brute += clock.getElapsedTime().asMicroseconds() / 1000.;
+
+			if (item_bvh != item_brute && nearest_bvh != nearest_brute)
+				mismatches++;
+		}
+
+		Log::info(wxString::Format(
+			"%s: BVH %1.2fms (%1.1f items checked per ray), brute force %1.2fms, %d mismatches",
+			pass,
+			time_bvh,
+			(double)visited / n_rays,
+			time_brute,
+			mismatches));
+	};
+
+	test("Built");
+
+	// Move some items a little, as when editing (refit)
+	clock.restart();
+	for (unsigned a = 0; a < n_items / 10; a++)
+	{
+		auto  index = rand() % n_items;
+		auto  box   = bvh.itemBox(index);
+		Vec3d offset(rand_range(-64, 64), rand_range(-64, 64), rand_range(-64, 64));
+		bvh.setItem(index, BVH::Box(box.min + offset, box.max + offset));
+	}
+	Log::info(wxString::Format("Moved %d items in %dms", n_items / 10, clock.getElapsedTime().asMilliseconds()));
+	test("Refit");
+}
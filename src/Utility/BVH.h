@@ -0,0 +1,60 @@
+#pragma once
+
+class BVH
+{
+public:
+	struct Box
+	{
+		Vec3d min = { 1, 1, 1 };
+		Vec3d max = { 0, 0, 0 };
+
+		Box() = default;
+		Box(Vec3d min, Vec3d max) : min{ min }, max{ max } {}
+
+		bool   valid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+		void   extend(const Box& box);
+		void   extend(Vec3d point);
+		void   pad(double amount);
+		bool   contains(const Box& box) const;
+		double surfaceArea() const;
+		double rayEntry(Vec3d origin, Vec3d inv_dir, double max_dist) const;
+	};
+
+	BVH()  = default;
+	~BVH() = default;
+
+	unsigned   nItems() const { return items_.size(); }
+	unsigned   nNodes() const { return nodes_.size(); }
+	const Box& itemBox(unsigned index) const { return items_[index]; }
+
+	void clear();
+	void resize(unsigned n_items);
+	void setItem(unsigned index, const Box& box);
+	void removeItem(unsigned index) { setItem(index, {}); }
+	void build();
+
+	void intersectRay(Vec3d origin, Vec3d dir, double& max_dist, const std::function<void(unsigned)>& visit);
+
+private:
+	static const unsigned MAX_LEAF_ITEMS = 4;
+
+	struct Node
+	{
+		Box      box;
+		int      parent = -1;
+		int      left   = -1;
+		int      right  = -1;
+		unsigned first  = 0; // Range in item_order_ (leaf nodes only)
+		unsigned count  = 0;
+	};
+
+	vector<Box>      items_;
+	vector<Node>     nodes_;
+	vector<unsigned> item_order_;
+	vector<int>      item_leaf_;
+	bool             needs_build_ = true;
+	unsigned         n_refits_    = 0;
+
+	int  buildNode(unsigned first, unsigned count, int parent);
+	void refit(int node);
+};
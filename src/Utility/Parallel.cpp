@@ -0,0 +1,78 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2019 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    Parallel.cpp
+// Description: Helpers for spreading independent work across threads
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "Parallel.h"
+#include <atomic>
+#include <thread>
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Calls [func] for chunks of [chunk] items out of [count], on up to
+// [n_threads] threads (or one per hardware thread if 0). Each thread takes the
+// next unprocessed chunk until there are none left, and the calling thread
+// processes chunks too, so anything that must only be done on it (eg. progress
+// updates) can check std::this_thread::get_id
+// -----------------------------------------------------------------------------
+void parallelFor(
+	unsigned                                        count,
+	unsigned                                        chunk,
+	unsigned                                        n_threads,
+	const std::function<void(unsigned, unsigned)>& func)
+{
+	if (count == 0)
+		return;
+
+	chunk = std::max(1u, chunk);
+	if (n_threads == 0)
+		n_threads = std::thread::hardware_concurrency();
+	n_threads = std::max(1u, std::min(n_threads, (count - 1) / chunk + 1));
+
+	std::atomic<unsigned> next(0);
+	auto                  worker = [&]() {
+		for (auto start = next.fetch_add(chunk); start < count; start = next.fetch_add(chunk))
+			func(start, std::min(start + chunk, count));
+	};
+
+	vector<std::thread> workers;
+	for (unsigned t = 1; t < n_threads; ++t)
+		workers.emplace_back(worker);
+	worker();
+	for (auto& thread : workers)
+		thread.join();
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+// Calls [func] for chunks of [chunk] items out of [count], on up to
+// [n_threads] threads (or one per hardware thread if 0), including the calling
+// thread. [func] is given the start and end of each chunk, and must be safe to
+// call concurrently
+void parallelFor(
+	unsigned                                        count,
+	unsigned                                        chunk,
+	unsigned                                        n_threads,
+	const std::function<void(unsigned, unsigned)>& func);
@@ -38,6 +38,46 @@
 #include "StringUtils.h"
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Appends [value] to [out] as raw binary data
+// -----------------------------------------------------------------------------
+template<typename T> void writeBinaryValue(std::string& out, T value)
+{
+	out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// -----------------------------------------------------------------------------
+// Appends [str] to [out], prefixed with its length
+// -----------------------------------------------------------------------------
+void writeBinaryString(std::string& out, std::string_view str)
+{
+	writeBinaryValue<uint32_t>(out, str.size());
+	out.append(str);
+}
+
+// -----------------------------------------------------------------------------
+// Reads a length-prefixed string from [mc] into [str].
+// Returns false if there isn't enough data left in [mc]
+// -----------------------------------------------------------------------------
+bool readBinaryString(MemChunk& mc, std::string& str)
+{
+	uint32_t len;
+	if (!mc.read(&len, 4) || len > mc.size() - mc.currentPos())
+		return false;
+
+	str.resize(len);
+	return len == 0 || mc.read(&str[0], len);
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // ParseTreeNode Class Functions
@@ -173,7 +213,7 @@ bool ParseTreeNode::parsePreprocessor(Tokenizer& tz)
 
 	// #define
 	if (tz.current() == "#define")
-		parser_->define(tz.next().text);
+		parser_->define(tz.next().text());
 
 	// #if(n)def
 	else if (tz.current() == "#ifdef" || tz.current() == "#ifndef")
@@ -182,7 +222,7 @@ bool ParseTreeNode::parsePreprocessor(Tokenizer& tz)
 		bool test = true;
 		if (tz.current() == "#ifndef")
 			test = false;
-		auto define = tz.next().text;
+		auto define = tz.next().text();
 		if (parser_->defined(define) == test)
 			return true;
 
@@ -211,7 +251,7 @@ bool ParseTreeNode::parsePreprocessor(Tokenizer& tz)
 		if (archive_dir_)
 		{
 			// Get entry to include
-			auto inc_path  = tz.next().text;
+			auto inc_path  = tz.next().text();
 			auto archive   = archive_dir_->archive();
 			auto inc_entry = archive->entryAtPath(archive_dir_->path() + inc_path);
 			if (!inc_entry) // Try absolute path
@@ -227,7 +267,7 @@ bool ParseTreeNode::parsePreprocessor(Tokenizer& tz)
 
 				// Parse text in the entry
 				Tokenizer inc_tz;
-				inc_tz.openMem(inc_entry->data(), inc_entry->name());
+				inc_tz.openView(inc_entry->data(), inc_entry->name());
 				bool ok = parse(inc_tz);
 
 				// Reset dir and abort if parsing failed
@@ -250,7 +290,7 @@ bool ParseTreeNode::parsePreprocessor(Tokenizer& tz)
 
 	// Unrecognised
 	else
-		logError(tz, fmt::format("Unrecognised preprocessor directive \"{}\"", tz.current().text));
+		logError(tz, fmt::format("Unrecognised preprocessor directive \"{}\"", tz.current().text()));
 
 	return true;
 }
@@ -282,7 +322,7 @@ bool ParseTreeNode::parseAssignment(Tokenizer& tz, ParseTreeNode* child) const
 
 		// Detect value type
 		if (token.quoted_string) // Quoted string
-			value = token.text;
+			value = token.text();
 		else if (token == "true") // Boolean (true)
 			value = true;
 		else if (token == "false") // Boolean (false)
@@ -294,7 +334,7 @@ bool ParseTreeNode::parseAssignment(Tokenizer& tz, ParseTreeNode* child) const
 		else if (token.isFloat()) // Floating point
 			value = token.asFloat();
 		else // Unknown, just treat as string
-			value = token.text;
+			value = token.text();
 
 		// Add value
 		child->values_.push_back(value);
@@ -304,7 +344,7 @@ bool ParseTreeNode::parseAssignment(Tokenizer& tz, ParseTreeNode* child) const
 			tz.adv(); // Skip it
 		else if (tz.peek() != list_end)
 		{
-			logError(tz, fmt::format(R"(Expected "," or "{}", got "{}")", list_end, tz.peek().text));
+			logError(tz, fmt::format(R"(Expected "," or "{}", got "{}")", list_end, tz.peek().text()));
 			return false;
 		}
 
@@ -342,14 +382,14 @@ bool ParseTreeNode::parse(Tokenizer& tz)
 		}
 
 		// If it's a special character (ie not a valid name), parsing fails
-		if (tz.isSpecialCharacter(tz.current().text[0]))
+		if (tz.isSpecialCharacter(tz.current().text()[0]))
 		{
-			logError(tz, fmt::format("Unexpected special character '{}'", tz.current().text));
+			logError(tz, fmt::format("Unexpected special character '{}'", tz.current().text()));
 			return false;
 		}
 
 		// So we have either a node or property name
-		name = tz.current().text;
+		name = tz.current().text();
 		type.clear();
 		if (name.empty())
 		{
@@ -361,7 +401,7 @@ bool ParseTreeNode::parse(Tokenizer& tz)
 		if (tz.peek() != '=' && tz.peek() != '{' && tz.peek() != ';' && tz.peek() != ':')
 		{
 			type = name;
-			name = tz.next().text;
+			name = tz.next().text();
 
 			if (name.empty())
 			{
@@ -403,7 +443,7 @@ bool ParseTreeNode::parse(Tokenizer& tz)
 			{
 				// Add child node
 				auto child      = addChildPTN(name, type);
-				child->inherit_ = tz.current().text;
+				child->inherit_ = tz.current().text();
 
 				// Skip {
 				tz.adv(2);
@@ -416,7 +456,7 @@ bool ParseTreeNode::parse(Tokenizer& tz)
 			{
 				// Add child node
 				auto child      = addChildPTN(name, type);
-				child->inherit_ = tz.current().text;
+				child->inherit_ = tz.current().text();
 
 				// Skip ;
 				tz.adv(2);
@@ -425,7 +465,7 @@ bool ParseTreeNode::parse(Tokenizer& tz)
 			}
 			else
 			{
-				logError(tz, fmt::format(R"(Expecting "{{" or ";", got "{}")", tz.next().text));
+				logError(tz, fmt::format(R"(Expecting "{{" or ";", got "{}")", tz.next().text()));
 				return false;
 			}
 		}
@@ -433,7 +473,7 @@ bool ParseTreeNode::parse(Tokenizer& tz)
 		// Unexpected token
 		else
 		{
-			logError(tz, fmt::format("Unexpected token \"{}\"", tz.next().text));
+			logError(tz, fmt::format("Unexpected token \"{}\"", tz.next().text()));
 			return false;
 		}
 
@@ -518,6 +558,125 @@ void ParseTreeNode::write(std::string& out, int indent) const
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Writes this node and all its children to [out] in a compact binary format,
+// that can be read back with readBinary.
+// Unlike write, this preserves all node types, inherits and value types
+// -----------------------------------------------------------------------------
+void ParseTreeNode::writeBinary(std::string& out) const
+{
+	writeBinaryString(out, name_);
+	writeBinaryString(out, type_);
+	writeBinaryString(out, inherit_);
+
+	// Values
+	writeBinaryValue<uint32_t>(out, values_.size());
+	for (auto& value : values_)
+	{
+		writeBinaryValue<uint8_t>(out, static_cast<uint8_t>(value.type()));
+		switch (value.type())
+		{
+		case Property::Type::Boolean: writeBinaryValue<uint8_t>(out, value.boolValue() ? 1 : 0); break;
+		case Property::Type::Int: writeBinaryValue<int32_t>(out, value.intValue()); break;
+		case Property::Type::Float: writeBinaryValue<double>(out, value.floatValue()); break;
+		case Property::Type::String: writeBinaryString(out, value.stringValue()); break;
+		case Property::Type::UInt: writeBinaryValue<uint32_t>(out, value.unsignedValue()); break;
+		default: break;
+		}
+	}
+
+	// Children
+	writeBinaryValue<uint32_t>(out, children_.size());
+	for (auto node : children_)
+		dynamic_cast<ParseTreeNode*>(node)->writeBinary(out);
+}
+
+// -----------------------------------------------------------------------------
+// Reads this node and all its children from [mc] (at its current position),
+// as written by writeBinary.
+// Returns false if the data is invalid or incomplete, in which case this node
+// may be left partially read
+// -----------------------------------------------------------------------------
+bool ParseTreeNode::readBinary(MemChunk& mc)
+{
+	if (!readBinaryString(mc, name_) || !readBinaryString(mc, type_) || !readBinaryString(mc, inherit_))
+		return false;
+
+	// Values
+	uint32_t n_values;
+	if (!mc.read(&n_values, 4) || n_values > mc.size() - mc.currentPos())
+		return false;
+	values_.clear();
+	values_.reserve(n_values);
+	std::string str_val;
+	for (unsigned a = 0; a < n_values; a++)
+	{
+		uint8_t type;
+		if (!mc.read(&type, 1))
+			return false;
+
+		switch (static_cast<Property::Type>(type))
+		{
+		case Property::Type::Boolean:
+		{
+			uint8_t val;
+			if (!mc.read(&val, 1))
+				return false;
+			values_.emplace_back(val != 0);
+			break;
+		}
+		case Property::Type::Int:
+		{
+			int32_t val;
+			if (!mc.read(&val, 4))
+				return false;
+			values_.emplace_back(static_cast<int>(val));
+			break;
+		}
+		case Property::Type::Float:
+		{
+			double val;
+			if (!mc.read(&val, 8))
+				return false;
+			values_.emplace_back(val);
+			break;
+		}
+		case Property::Type::String:
+			if (!readBinaryString(mc, str_val))
+				return false;
+			values_.emplace_back(std::string_view{ str_val });
+			break;
+		case Property::Type::Flag: values_.emplace_back(Property::Type::Flag); break;
+		case Property::Type::UInt:
+		{
+			uint32_t val;
+			if (!mc.read(&val, 4))
+				return false;
+			values_.emplace_back(static_cast<unsigned>(val));
+			break;
+		}
+		default: return false;
+		}
+	}
+
+	// Children
+	uint32_t n_children;
+	if (!mc.read(&n_children, 4) || n_children > mc.size() - mc.currentPos())
+		return false;
+	for (unsigned a = 0; a < n_children; a++)
+	{
+		// Add the child directly rather than via addChild, which would split
+		// names containing path separators into multiple nodes
+		auto child     = new ParseTreeNode();
+		child->parser_ = parser_;
+		STreeNode::addChild(child);
+		if (!child->readBinary(mc))
+			return false;
+	}
+
+	return true;
+}
+
 
 // -----------------------------------------------------------------------------
 //
@@ -573,9 +732,10 @@ bool Parser::parseText(MemChunk& mc, std::string_view source) const
 {
 	Tokenizer tz;
 
-	// Open the given text data
+	// Open the given text data (in view mode, the data isn't modified or freed
+	// while parsing)
 	tz.setReadLowerCase(!case_sensitive_);
-	if (!tz.openMem(mc, source))
+	if (!tz.openView(mc, source))
 	{
 		Log::error("Unable to open text data for parsing");
 		return false;
@@ -590,7 +750,7 @@ bool Parser::parseText(std::string_view text, std::string_view source) const
 
 	// Open the given text data
 	tz.setReadLowerCase(!case_sensitive_);
-	if (!tz.openString(text, 0, 0, source))
+	if (!tz.openView(text, source))
 	{
 		Log::error("Unable to open text data for parsing");
 		return false;
@@ -47,6 +47,8 @@ public:
 
 	bool parse(Tokenizer& tz);
 	void write(std::string& out, int indent = 0) const;
+	void writeBinary(std::string& out) const;
+	bool readBinary(MemChunk& mc);
 
 	typedef std::unique_ptr<ParseTreeNode> UPtr;
 
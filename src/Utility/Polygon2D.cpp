@@ -7,8 +7,9 @@
 // Web:         http://slade.mancubus.net
 // Filename:    Polygon2D.cpp
 // Description: Polygon2D and related classes for representing and handling a
-//              2-dimensional polygon, including PolygonSplitter class which
-//              splits a polygon into multiple convex sub-polygons
+//              2-dimensional polygon, including PolygonTriangulator and
+//              PolygonSplitter classes which split a polygon into multiple
+//              convex sub-polygons
 //
 // This program is free software; you can redistribute it and/or modify it
 // under the terms of the GNU General Public License as published by the Free
@@ -119,30 +120,17 @@ bool Polygon2D::openSector(MapSector* sector)
 		return false;
 
 	// Init
-	PolygonSplitter splitter;
+	PolygonTriangulator triangulator;
 	clear();
 
-	// Get list of sides connected to this sector
-	auto& sides = sector->connectedSides();
-
-	// Go through sides
-	MapLine* line;
-	for (auto& side : sides)
-	{
-		line = side->parentLine();
-
-		// Ignore this side if its parent line has the same sector on both sides
-		if (!line || line->doubleSector())
-			continue;
-
-		// Add the edge to the splitter (direction depends on what side of the line this is)
-		if (line->s1() == side)
-			splitter.addEdge(line->v1()->xPos(), line->v1()->yPos(), line->v2()->xPos(), line->v2()->yPos());
-		else
-			splitter.addEdge(line->v2()->xPos(), line->v2()->yPos(), line->v1()->xPos(), line->v1()->yPos());
-	}
+	// Triangulate the sector outlines into convex sub-polygons
+	triangulator.openSector(sector);
+	if (triangulator.doTriangulation(this))
+		return true;
 
-	// Split the polygon into convex sub-polygons
+	// Triangulation failed, fall back to the (slower) splitter
+	PolygonSplitter splitter;
+	splitter.openSector(sector);
 	return splitter.doSplitting(this);
 }
 
@@ -1078,3 +1066,1217 @@ void PolygonSplitter::testRender()
 	}
 	glEnd();
 }
+
+
+// -----------------------------------------------------------------------------
+//
+// EarClipper Class
+//
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+// EarClipper is a port of earcut (https://github.com/mapbox/earcut), which is
+// distributed under the following licence:
+//
+// ISC License
+//
+// Copyright (c) 2016, Mapbox
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Ear clipping triangulation of a single outer ring with any number of holes.
+// Like earcut (see the licence above): holes are bridged into the outer ring, ears are looked up via a z-order curve for large
+// rings, and self-intersecting or otherwise broken rings are cured or split
+// rather than rejected. Nodes are linked by index so the pool can grow while
+// the ring is being split.
+// -----------------------------------------------------------------------------
+class EarClipper
+{
+public:
+	EarClipper(const vector<Vec2d>& points, vector<int>& triangles) : points_{ points }, triangles_{ triangles } {}
+
+	// Triangulates the rings in [points], each ring starting at an index in
+	// [ring_starts]. The first ring is the outer ring, the rest are holes
+	void triangulate(const vector<int>& ring_starts)
+	{
+		nodes_.reserve(points_.size() * 3 / 2 + 8);
+
+		int outer_end = ring_starts.size() > 1 ? ring_starts[1] : points_.size();
+		int outer     = linkedList(0, outer_end, true);
+		if (outer < 0 || nodes_[outer].next == nodes_[outer].prev)
+			return;
+
+		if (ring_starts.size() > 1)
+			outer = eliminateHoles(ring_starts, outer);
+
+		// Use z-order hashing to find ears for larger polygons
+		if (points_.size() > 80)
+		{
+			double max_x = points_[0].x;
+			double max_y = points_[0].y;
+			min_x_       = points_[0].x;
+			min_y_       = points_[0].y;
+			for (auto& point : points_)
+			{
+				min_x_ = std::min(min_x_, point.x);
+				min_y_ = std::min(min_y_, point.y);
+				max_x  = std::max(max_x, point.x);
+				max_y  = std::max(max_y, point.y);
+			}
+			inv_size_ = std::max(max_x - min_x_, max_y - min_y_);
+			inv_size_ = inv_size_ != 0 ? 32767. / inv_size_ : 0;
+		}
+
+		earcutLinked(outer, 0);
+	}
+
+private:
+	struct Node
+	{
+		int      i       = 0; // Index into points
+		double   x       = 0.;
+		double   y       = 0.;
+		int      prev    = -1;
+		int      next    = -1;
+		unsigned z       = 0;
+		int      prev_z  = -1;
+		int      next_z  = -1;
+		bool     steiner = false;
+	};
+
+	const vector<Vec2d>& points_;
+	vector<int>&         triangles_;
+	vector<Node>         nodes_;
+	double               min_x_    = 0.;
+	double               min_y_    = 0.;
+	double               inv_size_ = 0.;
+
+	int prev(int n) const { return nodes_[n].prev; }
+	int next(int n) const { return nodes_[n].next; }
+
+	int newNode(int i)
+	{
+		nodes_.emplace_back();
+		auto& node = nodes_.back();
+		node.i     = i;
+		node.x     = points_[i].x;
+		node.y     = points_[i].y;
+		return nodes_.size() - 1;
+	}
+
+	int insertNode(int i, int last)
+	{
+		int p = newNode(i);
+		if (last < 0)
+		{
+			nodes_[p].prev = p;
+			nodes_[p].next = p;
+		}
+		else
+		{
+			nodes_[p].next                 = nodes_[last].next;
+			nodes_[p].prev                 = last;
+			nodes_[nodes_[last].next].prev = p;
+			nodes_[last].next              = p;
+		}
+		return p;
+	}
+
+	void removeNode(int p)
+	{
+		auto& node             = nodes_[p];
+		nodes_[node.next].prev = node.prev;
+		nodes_[node.prev].next = node.next;
+		if (node.prev_z >= 0)
+			nodes_[node.prev_z].next_z = node.next_z;
+		if (node.next_z >= 0)
+			nodes_[node.next_z].prev_z = node.prev_z;
+	}
+
+	void addTriangle(int a, int b, int c)
+	{
+		triangles_.push_back(nodes_[a].i);
+		triangles_.push_back(nodes_[b].i);
+		triangles_.push_back(nodes_[c].i);
+	}
+
+	// Signed area of the triangle [p,q,r], negative if it turns left
+	double area(int p, int q, int r) const
+	{
+		auto& a = nodes_[p];
+		auto& b = nodes_[q];
+		auto& c = nodes_[r];
+		return (b.y - a.y) * (c.x - b.x) - (b.x - a.x) * (c.y - b.y);
+	}
+
+	bool equals(int p1, int p2) const { return nodes_[p1].x == nodes_[p2].x && nodes_[p1].y == nodes_[p2].y; }
+
+	double signedArea(int start, int end) const
+	{
+		double sum = 0.;
+		for (int i = start, j = end - 1; i < end; j = i++)
+			sum += (points_[j].x - points_[i].x) * (points_[i].y + points_[j].y);
+		return sum;
+	}
+
+	// Creates a circular linked list from the ring [start,end) in the given winding order
+	int linkedList(int start, int end, bool clockwise)
+	{
+		int last = -1;
+		if (clockwise == (signedArea(start, end) > 0))
+		{
+			for (int i = start; i < end; ++i)
+				last = insertNode(i, last);
+		}
+		else
+		{
+			for (int i = end - 1; i >= start; --i)
+				last = insertNode(i, last);
+		}
+
+		if (last >= 0 && equals(last, next(last)))
+		{
+			removeNode(last);
+			last = next(last);
+		}
+
+		return last;
+	}
+
+	// Removes duplicate and collinear points
+	int filterPoints(int start, int end = -1)
+	{
+		if (start < 0)
+			return start;
+		if (end < 0)
+			end = start;
+
+		int  p = start;
+		bool again;
+		do
+		{
+			again = false;
+			if (!nodes_[p].steiner && (equals(p, next(p)) || area(prev(p), p, next(p)) == 0))
+			{
+				removeNode(p);
+				p = end = prev(p);
+				if (p == next(p))
+					break;
+				again = true;
+			}
+			else
+				p = next(p);
+		} while (again || p != end);
+
+		return end;
+	}
+
+	// Main ear slicing loop, with increasingly desperate passes for broken rings
+	void earcutLinked(int ear, int pass)
+	{
+		if (ear < 0)
+			return;
+
+		if (pass == 0 && inv_size_ != 0)
+			indexCurve(ear);
+
+		int stop = ear;
+		while (prev(ear) != next(ear))
+		{
+			int p = prev(ear);
+			int n = next(ear);
+
+			if (inv_size_ != 0 ? isEarHashed(ear) : isEar(ear))
+			{
+				addTriangle(p, ear, n);
+				removeNode(ear);
+
+				// Skip the next vertex, this leads to less sliver triangles
+				ear  = next(n);
+				stop = next(n);
+				continue;
+			}
+
+			ear = n;
+
+			// Looped through the whole remaining polygon without finding an ear
+			if (ear == stop)
+			{
+				if (pass == 0)
+					earcutLinked(filterPoints(ear), 1);
+				else if (pass == 1)
+					earcutLinked(cureLocalIntersections(filterPoints(ear)), 2);
+				else
+					splitEarcut(ear);
+				break;
+			}
+		}
+	}
+
+	static bool inBox(const Node& p, double x0, double y0, double x1, double y1)
+	{
+		return p.x >= x0 && p.x <= x1 && p.y >= y0 && p.y <= y1;
+	}
+
+	static bool pointInTriangle(
+		double ax,
+		double ay,
+		double bx,
+		double by,
+		double cx,
+		double cy,
+		double px,
+		double py)
+	{
+		return (cx - px) * (ay - py) >= (ax - px) * (cy - py) && (ax - px) * (by - py) >= (bx - px) * (ay - py)
+			   && (bx - px) * (cy - py) >= (cx - px) * (by - py);
+	}
+
+	// Checks whether [p] lies in the triangle [a,b,c] and is a reflex vertex
+	bool blocksEar(int p, const Node& a, const Node& b, const Node& c) const
+	{
+		return pointInTriangle(a.x, a.y, b.x, b.y, c.x, c.y, nodes_[p].x, nodes_[p].y)
+			   && area(prev(p), p, next(p)) >= 0;
+	}
+
+	bool isEar(int ear) const
+	{
+		auto& a = nodes_[prev(ear)];
+		auto& b = nodes_[ear];
+		auto& c = nodes_[next(ear)];
+		if (area(prev(ear), ear, next(ear)) >= 0)
+			return false; // Reflex, can't be an ear
+
+		double x0 = std::min({ a.x, b.x, c.x });
+		double y0 = std::min({ a.y, b.y, c.y });
+		double x1 = std::max({ a.x, b.x, c.x });
+		double y1 = std::max({ a.y, b.y, c.y });
+
+		// Make sure we don't have other points inside the potential ear
+		int p = c.next;
+		while (p != b.prev)
+		{
+			if (inBox(nodes_[p], x0, y0, x1, y1) && blocksEar(p, a, b, c))
+				return false;
+			p = next(p);
+		}
+
+		return true;
+	}
+
+	bool isEarHashed(int ear) const
+	{
+		auto& a = nodes_[prev(ear)];
+		auto& b = nodes_[ear];
+		auto& c = nodes_[next(ear)];
+		if (area(prev(ear), ear, next(ear)) >= 0)
+			return false;
+
+		double x0 = std::min({ a.x, b.x, c.x });
+		double y0 = std::min({ a.y, b.y, c.y });
+		double x1 = std::max({ a.x, b.x, c.x });
+		double y1 = std::max({ a.y, b.y, c.y });
+
+		// Z-order range for the current triangle bbox
+		unsigned min_z = zOrder(x0, y0);
+		unsigned max_z = zOrder(x1, y1);
+
+		auto blocks = [&](int p) {
+			return inBox(nodes_[p], x0, y0, x1, y1) && p != b.prev && p != b.next && blocksEar(p, a, b, c);
+		};
+
+		// Look for points inside the triangle in both directions
+		int p = b.prev_z;
+		int n = b.next_z;
+		while (p >= 0 && nodes_[p].z >= min_z && n >= 0 && nodes_[n].z <= max_z)
+		{
+			if (blocks(p))
+				return false;
+			p = nodes_[p].prev_z;
+
+			if (blocks(n))
+				return false;
+			n = nodes_[n].next_z;
+		}
+
+		// Look for remaining points in decreasing z-order
+		while (p >= 0 && nodes_[p].z >= min_z)
+		{
+			if (blocks(p))
+				return false;
+			p = nodes_[p].prev_z;
+		}
+
+		// Look for remaining points in increasing z-order
+		while (n >= 0 && nodes_[n].z <= max_z)
+		{
+			if (blocks(n))
+				return false;
+			n = nodes_[n].next_z;
+		}
+
+		return true;
+	}
+
+	// Goes through all polygon nodes and cures small local self-intersections
+	int cureLocalIntersections(int start)
+	{
+		if (start < 0)
+			return start;
+
+		int p = start;
+		do
+		{
+			int a = prev(p);
+			int b = next(next(p));
+
+			if (!equals(a, b) && intersects(a, p, next(p), b) && locallyInside(a, b) && locallyInside(b, a))
+			{
+				addTriangle(a, p, b);
+
+				// Remove two nodes involved
+				removeNode(p);
+				removeNode(next(p));
+
+				p = start = b;
+			}
+			p = next(p);
+		} while (p != start);
+
+		return filterPoints(p);
+	}
+
+	// Tries splitting the polygon into two and triangulating them independently
+	void splitEarcut(int start)
+	{
+		// Look for a valid diagonal that divides the polygon into two
+		int a = start;
+		do
+		{
+			int b = next(next(a));
+			while (b != prev(a))
+			{
+				if (nodes_[a].i != nodes_[b].i && isValidDiagonal(a, b))
+				{
+					// Split the polygon in two by the diagonal
+					int c = splitPolygon(a, b);
+
+					// Filter colinear points around the cuts
+					a = filterPoints(a, next(a));
+					c = filterPoints(c, next(c));
+
+					// Run earcut on each half
+					earcutLinked(a, 0);
+					earcutLinked(c, 0);
+					return;
+				}
+				b = next(b);
+			}
+			a = next(a);
+		} while (a != start);
+	}
+
+	// Links every hole into the outer loop, producing a single-ring polygon without holes
+	int eliminateHoles(const vector<int>& ring_starts, int outer)
+	{
+		vector<int> queue;
+		for (unsigned r = 1; r < ring_starts.size(); ++r)
+		{
+			int start = ring_starts[r];
+			int end   = r + 1 < ring_starts.size() ? ring_starts[r + 1] : points_.size();
+			int list  = linkedList(start, end, false);
+			if (list < 0)
+				continue;
+			if (list == next(list))
+				nodes_[list].steiner = true;
+			queue.push_back(getLeftmost(list));
+		}
+
+		// Process holes from left to right
+		std::sort(queue.begin(), queue.end(), [&](int a, int b) {
+			return nodes_[a].x < nodes_[b].x || (nodes_[a].x == nodes_[b].x && nodes_[a].y < nodes_[b].y);
+		});
+		for (int hole : queue)
+			outer = eliminateHole(hole, outer);
+
+		return outer;
+	}
+
+	int eliminateHole(int hole, int outer)
+	{
+		int bridge = findHoleBridge(hole, outer);
+		if (bridge < 0)
+			return outer;
+
+		int bridge_reverse = splitPolygon(bridge, hole);
+
+		// Filter collinear points around the cuts
+		filterPoints(bridge_reverse, next(bridge_reverse));
+		return filterPoints(bridge, next(bridge));
+	}
+
+	// David Eberly's algorithm for finding a bridge between hole and outer polygon
+	int findHoleBridge(int hole, int outer) const
+	{
+		int    p  = outer;
+		double hx = nodes_[hole].x;
+		double hy = nodes_[hole].y;
+		double qx = -std::numeric_limits<double>::infinity();
+		int    m  = -1;
+
+		// Find a segment intersected by a ray from the hole's leftmost point to the left;
+		// segment's endpoint with lesser x will be potential connection point
+		do
+		{
+			auto& pn = nodes_[p];
+			auto& nn = nodes_[pn.next];
+			if (hy <= pn.y && hy >= nn.y && nn.y != pn.y)
+			{
+				double x = pn.x + (hy - pn.y) * (nn.x - pn.x) / (nn.y - pn.y);
+				if (x <= hx && x > qx)
+				{
+					qx = x;
+					m  = pn.x < nn.x ? p : pn.next;
+					if (x == hx)
+						return m; // Hole touches outer segment; pick leftmost endpoint
+				}
+			}
+			p = pn.next;
+		} while (p != outer);
+
+		if (m < 0)
+			return -1;
+
+		// Look for points inside the triangle of hole point, segment intersection and endpoint;
+		// if there are no points found, we have a valid connection;
+		// otherwise choose the point of the minimum angle with the ray as connection point
+		int    stop    = m;
+		double mx      = nodes_[m].x;
+		double my      = nodes_[m].y;
+		double tan_min = std::numeric_limits<double>::infinity();
+
+		p = m;
+		do
+		{
+			auto& pn = nodes_[p];
+			if (hx >= pn.x && pn.x >= mx && hx != pn.x
+				&& pointInTriangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, pn.x, pn.y))
+			{
+				double tan = std::fabs(hy - pn.y) / (hx - pn.x);
+				if (locallyInside(p, hole)
+					&& (tan < tan_min
+						|| (tan == tan_min
+							&& (pn.x > nodes_[m].x || (pn.x == nodes_[m].x && sectorContainsSector(m, p))))))
+				{
+					m       = p;
+					tan_min = tan;
+				}
+			}
+			p = pn.next;
+		} while (p != stop);
+
+		return m;
+	}
+
+	// Whether sector in vertex m contains sector in vertex p in the same coordinates
+	bool sectorContainsSector(int m, int p) const
+	{
+		return area(prev(m), m, prev(p)) < 0 && area(next(p), m, next(m)) < 0;
+	}
+
+	// Interlinks polygon nodes in z-order
+	void indexCurve(int start)
+	{
+		int p = start;
+		do
+		{
+			auto& node = nodes_[p];
+			if (node.z == 0)
+				node.z = zOrder(node.x, node.y);
+			node.prev_z = node.prev;
+			node.next_z = node.next;
+			p           = node.next;
+		} while (p != start);
+
+		nodes_[nodes_[p].prev_z].next_z = -1;
+		nodes_[p].prev_z                = -1;
+
+		sortLinked(p);
+	}
+
+	// Simon Tatham's linked list merge sort algorithm, on the z-order links
+	int sortLinked(int list)
+	{
+		int in_size = 1;
+		int num_merges;
+		do
+		{
+			int p      = list;
+			int tail   = -1;
+			list       = -1;
+			num_merges = 0;
+
+			while (p >= 0)
+			{
+				num_merges++;
+				int q      = p;
+				int p_size = 0;
+				for (int i = 0; i < in_size; i++)
+				{
+					p_size++;
+					q = nodes_[q].next_z;
+					if (q < 0)
+						break;
+				}
+				int q_size = in_size;
+
+				while (p_size > 0 || (q_size > 0 && q >= 0))
+				{
+					int e;
+					if (p_size != 0 && (q_size == 0 || q < 0 || nodes_[p].z <= nodes_[q].z))
+					{
+						e = p;
+						p = nodes_[p].next_z;
+						p_size--;
+					}
+					else
+					{
+						e = q;
+						q = nodes_[q].next_z;
+						q_size--;
+					}
+
+					if (tail >= 0)
+						nodes_[tail].next_z = e;
+					else
+						list = e;
+
+					nodes_[e].prev_z = tail;
+					tail             = e;
+				}
+
+				p = q;
+			}
+
+			nodes_[tail].next_z = -1;
+			in_size *= 2;
+		} while (num_merges > 1);
+
+		return list;
+	}
+
+	// Z-order of a point given coords and inverse of the longer side of data bbox
+	unsigned zOrder(double px, double py) const
+	{
+		// Coords are transformed into non-negative 15-bit integer range
+		auto x = static_cast<unsigned>((px - min_x_) * inv_size_);
+		auto y = static_cast<unsigned>((py - min_y_) * inv_size_);
+
+		x = (x | (x << 8)) & 0x00FF00FF;
+		x = (x | (x << 4)) & 0x0F0F0F0F;
+		x = (x | (x << 2)) & 0x33333333;
+		x = (x | (x << 1)) & 0x55555555;
+
+		y = (y | (y << 8)) & 0x00FF00FF;
+		y = (y | (y << 4)) & 0x0F0F0F0F;
+		y = (y | (y << 2)) & 0x33333333;
+		y = (y | (y << 1)) & 0x55555555;
+
+		return x | (y << 1);
+	}
+
+	int getLeftmost(int start) const
+	{
+		int p        = start;
+		int leftmost = start;
+		do
+		{
+			if (nodes_[p].x < nodes_[leftmost].x
+				|| (nodes_[p].x == nodes_[leftmost].x && nodes_[p].y < nodes_[leftmost].y))
+				leftmost = p;
+			p = next(p);
+		} while (p != start);
+
+		return leftmost;
+	}
+
+	// Checks if a diagonal between two polygon nodes is valid (lies in polygon interior)
+	bool isValidDiagonal(int a, int b) const
+	{
+		// Doesn't intersect other edges
+		if (nodes_[next(a)].i == nodes_[b].i || nodes_[prev(a)].i == nodes_[b].i || intersectsPolygon(a, b))
+			return false;
+
+		// Locally visible, not opposite-facing sectors and not zero-length
+		if (locallyInside(a, b) && locallyInside(b, a) && middleInside(a, b)
+			&& (area(prev(a), a, prev(b)) != 0 || area(a, prev(b), b) != 0))
+			return true;
+
+		// Special zero-length case
+		return equals(a, b) && area(prev(a), a, next(a)) > 0 && area(prev(b), b, next(b)) > 0;
+	}
+
+	static int sign(double val) { return val > 0 ? 1 : val < 0 ? -1 : 0; }
+
+	// For collinear points p, q, r, checks if point q lies on segment pr
+	bool onSegment(int p, int q, int r) const
+	{
+		auto& pn = nodes_[p];
+		auto& qn = nodes_[q];
+		auto& rn = nodes_[r];
+		return qn.x <= std::max(pn.x, rn.x) && qn.x >= std::min(pn.x, rn.x) && qn.y <= std::max(pn.y, rn.y)
+			   && qn.y >= std::min(pn.y, rn.y);
+	}
+
+	// Checks if two segments intersect
+	bool intersects(int p1, int q1, int p2, int q2) const
+	{
+		int o1 = sign(area(p1, q1, p2));
+		int o2 = sign(area(p1, q1, q2));
+		int o3 = sign(area(p2, q2, p1));
+		int o4 = sign(area(p2, q2, q1));
+
+		if (o1 != o2 && o3 != o4)
+			return true; // General case
+
+		if (o1 == 0 && onSegment(p1, p2, q1))
+			return true; // p1, q1 and p2 are collinear and p2 lies on p1q1
+		if (o2 == 0 && onSegment(p1, q2, q1))
+			return true; // p1, q1 and q2 are collinear and q2 lies on p1q1
+		if (o3 == 0 && onSegment(p2, p1, q2))
+			return true; // p2, q2 and p1 are collinear and p1 lies on p2q2
+		if (o4 == 0 && onSegment(p2, q1, q2))
+			return true; // p2, q2 and q1 are collinear and q1 lies on p2q2
+
+		return false;
+	}
+
+	// Checks if a polygon diagonal intersects any polygon segments
+	bool intersectsPolygon(int a, int b) const
+	{
+		int ai = nodes_[a].i;
+		int bi = nodes_[b].i;
+		int p  = a;
+		do
+		{
+			int pi = nodes_[p].i;
+			int ni = nodes_[next(p)].i;
+			if (pi != ai && ni != ai && pi != bi && ni != bi && intersects(p, next(p), a, b))
+				return true;
+			p = next(p);
+		} while (p != a);
+
+		return false;
+	}
+
+	// Checks if a polygon diagonal is locally inside the polygon
+	bool locallyInside(int a, int b) const
+	{
+		return area(prev(a), a, next(a)) < 0 ? area(a, b, next(a)) >= 0 && area(a, prev(a), b) >= 0 :
+											   area(a, b, prev(a)) < 0 || area(a, next(a), b) < 0;
+	}
+
+	// Checks if the middle point of a polygon diagonal is inside the polygon
+	bool middleInside(int a, int b) const
+	{
+		int    p      = a;
+		bool   inside = false;
+		double px     = (nodes_[a].x + nodes_[b].x) / 2;
+		double py     = (nodes_[a].y + nodes_[b].y) / 2;
+		do
+		{
+			auto& pn = nodes_[p];
+			auto& nn = nodes_[pn.next];
+			if (((pn.y > py) != (nn.y > py)) && nn.y != pn.y && (px < (nn.x - pn.x) * (py - pn.y) / (nn.y - pn.y) + pn.x))
+				inside = !inside;
+			p = pn.next;
+		} while (p != a);
+
+		return inside;
+	}
+
+	// Links two polygon vertices with a bridge; if the vertices belong to the same ring,
+	// it splits polygon into two; if one belongs to the outer ring and another to a hole,
+	// it merges it into a single ring
+	int splitPolygon(int a, int b)
+	{
+		int a2 = newNode(nodes_[a].i);
+		int b2 = newNode(nodes_[b].i);
+		int an = next(a);
+		int bp = prev(b);
+
+		nodes_[a].next  = b;
+		nodes_[b].prev  = a;
+		nodes_[a2].next = an;
+		nodes_[an].prev = a2;
+		nodes_[b2].next = a2;
+		nodes_[a2].prev = b2;
+		nodes_[bp].next = b2;
+		nodes_[b2].prev = bp;
+
+		return b2;
+	}
+};
+
+// -----------------------------------------------------------------------------
+// Returns true if the corner [p0,p1,p2] of an anticlockwise polygon is convex
+// (or straight, but not folding back on itself)
+// -----------------------------------------------------------------------------
+bool convexCorner(const Vec2d& p0, const Vec2d& p1, const Vec2d& p2)
+{
+	double cross = (p1.x - p0.x) * (p2.y - p1.y) - (p1.y - p0.y) * (p2.x - p1.x);
+	if (cross != 0)
+		return cross > 0;
+
+	return (p1.x - p0.x) * (p2.x - p1.x) + (p1.y - p0.y) * (p2.y - p1.y) > 0;
+}
+
+// -----------------------------------------------------------------------------
+// Greedily merges adjacent [triangles] (indices into [points]) into larger
+// convex polygons, which are added to [polys]. Triangles are expected to be
+// anticlockwise, and merged polygons keep the same winding. Merged polygons are
+// limited to [max_vertices] so that merging stays linear for huge sectors
+// -----------------------------------------------------------------------------
+void mergeTriangles(
+	const vector<Vec2d>& points,
+	const vector<int>&   triangles,
+	vector<vector<int>>& polys,
+	unsigned             max_vertices = 64)
+{
+	// Add (non-degenerate) triangles as initial polygons
+	polys.clear();
+	for (unsigned a = 0; a + 2 < triangles.size(); a += 3)
+	{
+		int v1 = triangles[a];
+		int v2 = triangles[a + 1];
+		int v3 = triangles[a + 2];
+		if (v1 == v2 || v2 == v3 || v1 == v3)
+			continue;
+
+		auto& p1 = points[v1];
+		auto& p2 = points[v2];
+		auto& p3 = points[v3];
+		if ((p2.x - p1.x) * (p3.y - p1.y) - (p2.y - p1.y) * (p3.x - p1.x) == 0)
+			continue;
+
+		polys.push_back({ v1, v2, v3 });
+	}
+
+	// Map each directed edge to the polygon it belongs to
+	std::map<std::pair<int, int>, unsigned> edge_poly;
+	for (unsigned p = 0; p < polys.size(); ++p)
+		for (unsigned a = 0; a < 3; ++a)
+			edge_poly[{ polys[p][a], polys[p][(a + 1) % 3] }] = p;
+
+	// Go through polygons, absorbing neighbours while the result stays convex
+	vector<bool> merged(polys.size(), false);
+	for (unsigned p = 0; p < polys.size(); ++p)
+	{
+		if (merged[p])
+			continue;
+
+		bool absorbed = true;
+		while (absorbed)
+		{
+			absorbed    = false;
+			auto& poly  = polys[p];
+			auto  count = poly.size();
+			for (unsigned k = 0; k < count && !absorbed; ++k)
+			{
+				int  a     = poly[k];
+				int  b     = poly[(k + 1) % count];
+				auto other = edge_poly.find({ b, a });
+				if (other == edge_poly.end() || other->second == p || merged[other->second])
+					continue;
+
+				// Find the shared edge in the neighbour
+				auto&    npoly  = polys[other->second];
+				auto     ncount = npoly.size();
+				unsigned m      = 0;
+				if (count + ncount - 2 > max_vertices)
+					continue;
+				while (m < ncount && !(npoly[m] == b && npoly[(m + 1) % ncount] == a))
+					++m;
+				if (m == ncount)
+					continue;
+
+				// Check both corners at the ends of the shared edge stay convex
+				auto& prev_a = points[poly[(k + count - 1) % count]];
+				auto& next_a = points[npoly[(m + 2) % ncount]];
+				auto& prev_b = points[npoly[(m + ncount - 1) % ncount]];
+				auto& next_b = points[poly[(k + 2) % count]];
+				if (!convexCorner(prev_a, points[a], next_a) || !convexCorner(prev_b, points[b], next_b))
+					continue;
+
+				// Build the merged polygon: b..a from this polygon, then the neighbour's vertices after a
+				vector<int> verts;
+				verts.reserve(count + ncount - 2);
+				for (unsigned i = 0; i < count; ++i)
+					verts.push_back(poly[(k + 1 + i) % count]);
+				for (unsigned i = 2; i < ncount; ++i)
+					verts.push_back(npoly[(m + i) % ncount]);
+
+				// Reject if a vertex would appear twice (polygons sharing more than one edge)
+				vector<int> sorted = verts;
+				std::sort(sorted.begin(), sorted.end());
+				if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end())
+					continue;
+
+				// Update edge owners and absorb the neighbour
+				edge_poly.erase({ a, b });
+				edge_poly.erase({ b, a });
+				for (unsigned i = 0; i < ncount; ++i)
+				{
+					auto edge = edge_poly.find({ npoly[i], npoly[(i + 1) % ncount] });
+					if (edge != edge_poly.end())
+						edge->second = p;
+				}
+				merged[other->second] = true;
+				poly.swap(verts);
+				absorbed = true;
+			}
+		}
+	}
+
+	// Remove absorbed polygons
+	unsigned n_polys = 0;
+	for (unsigned p = 0; p < polys.size(); ++p)
+		if (!merged[p])
+			polys[n_polys++].swap(polys[p]);
+	polys.resize(n_polys);
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// PolygonTriangulator Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Clears all vertices, edges and outlines
+// -----------------------------------------------------------------------------
+void PolygonTriangulator::clear()
+{
+	vertices_.clear();
+	edges_.clear();
+	outlines_.clear();
+	vertex_map_.clear();
+	edge_set_.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Adds a vertex at [x,y] if one doesn't already exist there, and returns its
+// index
+// -----------------------------------------------------------------------------
+int PolygonTriangulator::addVertex(double x, double y)
+{
+	auto existing = vertex_map_.find({ x, y });
+	if (existing != vertex_map_.end())
+		return existing->second;
+
+	vertices_.emplace_back(x, y);
+	vertex_map_[{ x, y }] = vertices_.size() - 1;
+	return vertices_.size() - 1;
+}
+
+// -----------------------------------------------------------------------------
+// Adds a directed edge from [x1,y1] to [x2,y2] (ignoring duplicates and zero
+// length edges), and returns its index
+// -----------------------------------------------------------------------------
+int PolygonTriangulator::addEdge(double x1, double y1, double x2, double y2)
+{
+	int v1 = addVertex(x1, y1);
+	int v2 = addVertex(x2, y2);
+	if (v1 == v2 || !edge_set_.insert({ v1, v2 }).second)
+		return -1;
+
+	edges_.push_back({ v1, v2 });
+	vertices_[v1].edges_out.push_back(edges_.size() - 1);
+	return edges_.size() - 1;
+}
+
+// -----------------------------------------------------------------------------
+// Adds edges for all lines bordering [sector]
+// -----------------------------------------------------------------------------
+void PolygonTriangulator::openSector(MapSector* sector)
+{
+	// Check sector was given
+	if (!sector)
+		return;
+
+	// Init
+	clear();
+
+	// Go through sides
+	for (auto& side : sector->connectedSides())
+	{
+		auto line = side->parentLine();
+
+		// Ignore this side if its parent line has the same sector on both sides
+		if (!line || line->doubleSector())
+			continue;
+
+		// Add the edge (direction depends on what side of the line this is)
+		if (line->s1() == side)
+			addEdge(line->v1()->xPos(), line->v1()->yPos(), line->v2()->xPos(), line->v2()->yPos());
+		else
+			addEdge(line->v2()->xPos(), line->v2()->yPos(), line->v1()->xPos(), line->v1()->yPos());
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the untraced edge following [edge] with the lowest angle, or -1 if
+// there is none (same rule as PolygonSplitter::findNextEdge)
+// -----------------------------------------------------------------------------
+int PolygonTriangulator::findNextEdge(int edge) const
+{
+	auto& e  = edges_[edge];
+	auto& v1 = vertices_[e.v1];
+	auto& v2 = vertices_[e.v2];
+
+	double min_angle = 2 * MathStuff::PI;
+	int    next      = -1;
+	for (int out_index : v2.edges_out)
+	{
+		auto& out = edges_[out_index];
+
+		// Ignore traced edges and the reverse of this edge
+		if (out.traced || out.v2 == e.v1)
+			continue;
+
+		double angle = MathStuff::angle2DRad(
+			Vec2d(v1.x, v1.y), Vec2d(v2.x, v2.y), Vec2d(vertices_[out.v2].x, vertices_[out.v2].y));
+		if (angle < min_angle)
+		{
+			min_angle = angle;
+			next      = out_index;
+		}
+	}
+
+	return next;
+}
+
+// -----------------------------------------------------------------------------
+// Traces all closed outlines from the edges. Edges that can't be part of a
+// closed outline (eg. in unclosed sectors) are discarded
+// -----------------------------------------------------------------------------
+void PolygonTriangulator::traceOutlines()
+{
+	vector<int> trace_pos(edges_.size(), -1);
+	vector<int> trace;
+	for (unsigned start = 0; start < edges_.size();)
+	{
+		if (edges_[start].traced)
+		{
+			++start;
+			continue;
+		}
+
+		// Follow edges until we hit a dead end or an edge already in this trace
+		int loop_start = -1;
+		int edge       = start;
+		trace.clear();
+		while (true)
+		{
+			trace_pos[edge] = trace.size();
+			trace.push_back(edge);
+
+			int next = findNextEdge(edge);
+			if (next < 0)
+				break;
+			if (trace_pos[next] >= 0)
+			{
+				loop_start = trace_pos[next];
+				break;
+			}
+			edge = next;
+		}
+		for (int e : trace)
+			trace_pos[e] = -1;
+
+		// Dead end, discard the last edge and try again (the trace may find another way around)
+		if (loop_start < 0)
+		{
+			edges_[trace.back()].traced = true;
+			continue;
+		}
+
+		// Any edges leading into the loop are left for later traces
+		for (unsigned a = loop_start; a < trace.size(); ++a)
+			edges_[trace[a]].traced = true;
+
+		// Add outline
+		Outline outline;
+		auto&   first    = vertices_[edges_[trace[loop_start]].v1];
+		outline.bbox_min = { first.x, first.y };
+		outline.bbox_max = { first.x, first.y };
+		for (unsigned a = loop_start; a < trace.size(); ++a)
+		{
+			auto& v1 = vertices_[edges_[trace[a]].v1];
+			auto& v2 = vertices_[edges_[trace[a]].v2];
+			outline.vertices.push_back(edges_[trace[a]].v1);
+			outline.area += v1.x * v2.y - v2.x * v1.y;
+			outline.bbox_min.x = std::min(outline.bbox_min.x, v1.x);
+			outline.bbox_min.y = std::min(outline.bbox_min.y, v1.y);
+			outline.bbox_max.x = std::max(outline.bbox_max.x, v1.x);
+			outline.bbox_max.y = std::max(outline.bbox_max.y, v1.y);
+		}
+		outline.area *= 0.5;
+
+		if (outline.vertices.size() >= 3 && outline.area != 0)
+			outlines_.push_back(std::move(outline));
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [hole] is inside [outline], tested using the first vertex of
+// [hole] that isn't shared with [outline]
+// -----------------------------------------------------------------------------
+bool PolygonTriangulator::outlineContains(const Outline& outline, const Outline& hole) const
+{
+	// Check bboxes first
+	if (hole.bbox_min.x < outline.bbox_min.x || hole.bbox_min.y < outline.bbox_min.y
+		|| hole.bbox_max.x > outline.bbox_max.x || hole.bbox_max.y > outline.bbox_max.y)
+		return false;
+
+	auto count = outline.vertices.size();
+	for (int vertex : hole.vertices)
+	{
+		if (VECTOR_EXISTS(outline.vertices, vertex))
+			continue;
+
+		// Point-in-polygon test
+		double x      = vertices_[vertex].x;
+		double y      = vertices_[vertex].y;
+		bool   inside = false;
+		for (unsigned a = 0, b = count - 1; a < count; b = a++)
+		{
+			auto& va = vertices_[outline.vertices[a]];
+			auto& vb = vertices_[outline.vertices[b]];
+			if ((va.y > y) != (vb.y > y) && x < (vb.x - va.x) * (y - va.y) / (vb.y - va.y) + va.x)
+				inside = !inside;
+		}
+		return inside;
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Assigns each inner (anticlockwise) outline to the smallest outer (clockwise)
+// outline containing it. Inner outlines outside of any outer outline are
+// invalid and ignored
+// -----------------------------------------------------------------------------
+void PolygonTriangulator::assignHoles()
+{
+	for (unsigned h = 0; h < outlines_.size(); ++h)
+	{
+		auto& hole = outlines_[h];
+		if (hole.area < 0)
+			continue;
+
+		int    best      = -1;
+		double best_area = 0;
+		for (unsigned o = 0; o < outlines_.size(); ++o)
+		{
+			auto& outer = outlines_[o];
+			if (outer.area >= 0 || -outer.area < hole.area)
+				continue;
+			if (best >= 0 && -outer.area >= best_area)
+				continue;
+
+			if (outlineContains(outer, hole))
+			{
+				best      = o;
+				best_area = -outer.area;
+			}
+		}
+
+		if (best >= 0)
+			outlines_[best].holes.push_back(h);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Triangulates [outer] along with its holes, adding the resulting (clockwise)
+// sub-polygons to [poly]
+// -----------------------------------------------------------------------------
+void PolygonTriangulator::triangulateOutline(const Outline& outer, Polygon2D* poly) const
+{
+	// Gather points for each ring
+	vector<Vec2d> points;
+	vector<int>   ring_starts;
+	auto          add_ring = [&](const Outline& outline) {
+		ring_starts.push_back(points.size());
+		for (int vertex : outline.vertices)
+			points.emplace_back(vertices_[vertex].x, vertices_[vertex].y);
+	};
+	add_ring(outer);
+	for (unsigned hole : outer.holes)
+		add_ring(outlines_[hole]);
+
+	// Triangulate
+	vector<int> triangles;
+	EarClipper  clipper(points, triangles);
+	clipper.triangulate(ring_starts);
+
+	// Merge into convex polygons if needed
+	vector<vector<int>> polys;
+	if (merge_convex_)
+		mergeTriangles(points, triangles, polys);
+	else
+		for (unsigned a = 0; a + 2 < triangles.size(); a += 3)
+			polys.push_back({ triangles[a], triangles[a + 1], triangles[a + 2] });
+
+	// Add sub-polygons (reversing the winding to match the map outlines)
+	for (auto& verts : polys)
+	{
+		poly->addSubPoly();
+		auto subpoly = poly->subPoly(poly->nSubPolys() - 1);
+		subpoly->vertices.resize(verts.size());
+		for (unsigned a = 0; a < verts.size(); ++a)
+		{
+			auto& point            = points[verts[verts.size() - 1 - a]];
+			subpoly->vertices[a].x = point.x;
+			subpoly->vertices[a].y = point.y;
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Traces outlines from the added edges and triangulates them into [poly].
+// Returns false if there were valid outlines but nothing could be built
+// -----------------------------------------------------------------------------
+bool PolygonTriangulator::doTriangulation(Polygon2D* poly)
+{
+	traceOutlines();
+	assignHoles();
+
+	bool has_outer = false;
+	for (auto& outline : outlines_)
+	{
+		if (outline.area >= 0)
+			continue;
+
+		has_outer = true;
+		triangulateOutline(outline, poly);
+	}
+
+	return !has_outer || poly->hasPolygon();
+}
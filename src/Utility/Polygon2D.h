@@ -141,3 +141,56 @@ private:
 	bool            verbose_           = false;
 	double          last_angle_        = 0.;
 };
+
+
+class PolygonTriangulator
+{
+public:
+	PolygonTriangulator()  = default;
+	~PolygonTriangulator() = default;
+
+	void clear();
+	void setMergeConvex(bool merge) { merge_convex_ = merge; }
+
+	int addVertex(double x, double y);
+	int addEdge(double x1, double y1, double x2, double y2);
+
+	void openSector(MapSector* sector);
+	bool doTriangulation(Polygon2D* poly);
+
+private:
+	// Structs
+	struct Edge
+	{
+		int  v1, v2;
+		bool traced = false;
+	};
+	struct Vertex
+	{
+		double      x, y;
+		vector<int> edges_out;
+		Vertex(double x = 0, double y = 0) : x{ x }, y{ y } {}
+	};
+	struct Outline
+	{
+		vector<int>      vertices;
+		double           area = 0.;
+		Vec2d            bbox_min;
+		Vec2d            bbox_max;
+		vector<unsigned> holes;
+	};
+
+	// Triangulator data
+	vector<Vertex>                           vertices_;
+	vector<Edge>                             edges_;
+	vector<Outline>                          outlines_;
+	std::map<std::pair<double, double>, int> vertex_map_;
+	std::set<std::pair<int, int>>            edge_set_;
+	bool                                     merge_convex_ = true;
+
+	int  findNextEdge(int edge) const;
+	void traceOutlines();
+	bool outlineContains(const Outline& outline, const Outline& hole) const;
+	void assignHoles();
+	void triangulateOutline(const Outline& outer, Polygon2D* poly) const;
+};
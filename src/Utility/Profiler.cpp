@@ -0,0 +1,409 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2019 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    Profiler.cpp
+// Description: Lightweight instrumentation profiler. Scoped zones are recorded
+//              into a buffer per thread while profiling is enabled, and can be
+//              dumped to the log as aggregated per-zone stats or exported as a
+//              Chrome trace (chrome://tracing) JSON file
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "Profiler.h"
+#include "App.h"
+#include "General/Console/Console.h"
+#include "Utility/StringUtils.h"
+#include <chrono>
+#include <map>
+#include <mutex>
+
+
+// -----------------------------------------------------------------------------
+//
+// Structs
+//
+// -----------------------------------------------------------------------------
+namespace Profiler
+{
+struct Event
+{
+	const char* name;
+	int64_t     start; // Microseconds since the profiling epoch
+	int64_t     end;   // -1 if the zone hasn't ended yet
+	int         parent;
+};
+
+struct ThreadBuffer
+{
+	std::mutex    mutex;
+	vector<Event> events;
+	int           current    = -1; // Index of the innermost open zone
+	unsigned      generation = 0;  // Incremented whenever the buffer is cleared
+	unsigned      id         = 0;
+	bool          main       = false;
+};
+
+struct ZoneStats
+{
+	unsigned                         count    = 0;
+	double                           total_ms = 0.;
+	double                           self_ms  = 0.;
+	double                           min_ms   = 0.;
+	double                           max_ms   = 0.;
+	std::map<std::string, ZoneStats> children;
+};
+} // namespace Profiler
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace Profiler
+{
+std::atomic<bool>                     enabled_flag{ false };
+std::mutex                            buffers_mutex;
+vector<std::unique_ptr<ThreadBuffer>> buffers;
+thread_local ThreadBuffer*            thread_buffer = nullptr;
+std::chrono::steady_clock::time_point epoch         = std::chrono::steady_clock::now();
+} // namespace Profiler
+
+
+// -----------------------------------------------------------------------------
+//
+// Profiler Namespace Functions
+//
+// -----------------------------------------------------------------------------
+namespace Profiler
+{
+// -----------------------------------------------------------------------------
+// Returns the current time in microseconds since the profiling epoch
+// -----------------------------------------------------------------------------
+int64_t now()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the event buffer for the current thread, creating it if needed.
+// Buffers are owned by the profiler rather than the thread so that events
+// recorded by short-lived worker threads are kept
+// -----------------------------------------------------------------------------
+ThreadBuffer* threadBuffer()
+{
+	if (!thread_buffer)
+	{
+		std::lock_guard<std::mutex> lock(buffers_mutex);
+		auto                        buffer = std::make_unique<ThreadBuffer>();
+		buffer->id                         = buffers.size() + 1;
+		buffer->main                       = std::this_thread::get_id() == App::mainThreadId();
+		thread_buffer                      = buffer.get();
+		buffers.push_back(std::move(buffer));
+	}
+
+	return thread_buffer;
+}
+
+// -----------------------------------------------------------------------------
+// Copies the recorded events of all threads to [events] (as [buffer, events]
+// pairs), so they can be processed without holding any locks
+// -----------------------------------------------------------------------------
+void copyEvents(vector<std::pair<ThreadBuffer*, vector<Event>>>& events)
+{
+	std::lock_guard<std::mutex> lock(buffers_mutex);
+	for (auto& buffer : buffers)
+	{
+		std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+		if (!buffer->events.empty())
+			events.emplace_back(buffer.get(), buffer->events);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Writes stats for the child zones of [stats] (and their children) to the
+// console, sorted by total time and indented by [depth]. Zones taking less than
+// [min_ms] in total are omitted
+// -----------------------------------------------------------------------------
+void logChildStats(const ZoneStats& stats, int depth, double min_ms)
+{
+	vector<std::pair<const std::string*, const ZoneStats*>> children;
+	for (auto& child : stats.children)
+		children.emplace_back(&child.first, &child.second);
+	std::sort(children.begin(), children.end(), [](auto& left, auto& right) {
+		return left.second->total_ms > right.second->total_ms;
+	});
+
+	for (auto& [name, child] : children)
+	{
+		if (child->total_ms < min_ms)
+			continue;
+
+		Log::console(wxString::Format(
+			"%-48s %7u %10.2f %10.2f %9.3f %9.3f %9.3f",
+			std::string(depth * 2, ' ') + *name,
+			child->count,
+			child->total_ms,
+			child->self_ms,
+			child->total_ms / child->count,
+			child->min_ms,
+			child->max_ms));
+
+		logChildStats(*child, depth + 1, min_ms);
+	}
+}
+} // namespace Profiler
+
+// -----------------------------------------------------------------------------
+// Enables profiling, clearing any previously recorded data if [clear_data] is
+// true
+// -----------------------------------------------------------------------------
+void Profiler::start(bool clear_data)
+{
+	if (clear_data)
+		clear();
+
+	enabled_flag.store(true);
+}
+
+// -----------------------------------------------------------------------------
+// Disables profiling. Recorded data is kept until the next start or clear
+// -----------------------------------------------------------------------------
+void Profiler::stop()
+{
+	enabled_flag.store(false);
+}
+
+// -----------------------------------------------------------------------------
+// Clears all recorded profiling data
+// -----------------------------------------------------------------------------
+void Profiler::clear()
+{
+	std::lock_guard<std::mutex> lock(buffers_mutex);
+	for (auto& buffer : buffers)
+	{
+		std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+		buffer->events.clear();
+		buffer->current = -1;
+		buffer->generation++;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Writes aggregated stats for all recorded zones to the console, as a tree per
+// thread. Zones taking less than [min_ms] in total are omitted
+// -----------------------------------------------------------------------------
+void Profiler::dumpStats(double min_ms)
+{
+	vector<std::pair<ThreadBuffer*, vector<Event>>> thread_events;
+	copyEvents(thread_events);
+	if (thread_events.empty())
+	{
+		Log::console("No profiling data recorded");
+		return;
+	}
+
+	for (auto& [buffer, events] : thread_events)
+	{
+		// Build the zone tree. Events are added when their zone begins, so a
+		// parent always comes before its children
+		ZoneStats          root;
+		vector<ZoneStats*> event_stats(events.size(), nullptr);
+		for (unsigned a = 0; a < events.size(); ++a)
+		{
+			auto& event = events[a];
+			if (event.end < 0 || (event.parent >= 0 && !event_stats[event.parent]))
+				continue;
+
+			auto   parent = event.parent >= 0 ? event_stats[event.parent] : &root;
+			auto&  stats  = parent->children[event.name];
+			double time   = (event.end - event.start) * 0.001;
+			if (stats.count == 0 || time < stats.min_ms)
+				stats.min_ms = time;
+			if (time > stats.max_ms)
+				stats.max_ms = time;
+			stats.count++;
+			stats.total_ms += time;
+			stats.self_ms += time;
+			if (parent != &root)
+				parent->self_ms -= time;
+			event_stats[a] = &stats;
+		}
+
+		Log::console(wxString::Format("Thread %u%s:", buffer->id, buffer->main ? " (main)" : ""));
+		Log::console(wxString::Format(
+			"%-48s %7s %10s %10s %9s %9s %9s", "Zone", "Count", "Total ms", "Self ms", "Avg ms", "Min ms", "Max ms"));
+		logChildStats(root, 0, min_ms);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Writes all recorded zones to [filename] in Chrome trace event format, which
+// can be loaded in chrome://tracing or other compatible trace viewers.
+// Returns false if the file couldn't be written
+// -----------------------------------------------------------------------------
+bool Profiler::exportTrace(std::string_view filename)
+{
+	vector<std::pair<ThreadBuffer*, vector<Event>>> thread_events;
+	copyEvents(thread_events);
+
+	std::string json = "{\"traceEvents\":[\n";
+	bool        first = true;
+	auto        add   = [&](const std::string& line) {
+		if (!first)
+			json += ",\n";
+		json += line;
+		first = false;
+	};
+
+	for (auto& [buffer, events] : thread_events)
+	{
+		// Thread name
+		add(fmt::format(
+			R"({{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":"{}"}}}})",
+			buffer->id,
+			buffer->main ? "Main" : fmt::format("Worker {}", buffer->id)));
+
+		// Complete events
+		for (auto& event : events)
+		{
+			if (event.end < 0)
+				continue;
+
+			std::string name = event.name;
+			StrUtil::replaceIP(name, "\\", "\\\\");
+			StrUtil::replaceIP(name, "\"", "\\\"");
+			add(fmt::format(
+				R"({{"name":"{}","ph":"X","pid":1,"tid":{},"ts":{},"dur":{}}})",
+				name,
+				buffer->id,
+				event.start,
+				event.end - event.start));
+		}
+	}
+	json += "\n]}\n";
+
+	wxFile file(wxString::FromUTF8(filename.data(), filename.size()), wxFile::write);
+	if (!file.IsOpened())
+	{
+		Log::error("Unable to open file \"{}\" for writing", filename);
+		return false;
+	}
+	file.Write(json.data(), json.size());
+
+	return true;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Profiler::Zone Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Begins recording the zone [name] on the current thread
+// -----------------------------------------------------------------------------
+void Profiler::Zone::begin(const char* name)
+{
+	auto buffer = threadBuffer();
+	auto time   = now();
+
+	std::lock_guard<std::mutex> lock(buffer->mutex);
+	buffer_     = buffer;
+	index_      = buffer->events.size();
+	generation_ = buffer->generation;
+	buffer->events.push_back({ name, time, -1, buffer->current });
+	buffer->current = index_;
+}
+
+// -----------------------------------------------------------------------------
+// Ends recording the zone. Does nothing if the profiling data was cleared since
+// the zone began
+// -----------------------------------------------------------------------------
+void Profiler::Zone::end()
+{
+	auto time = now();
+
+	std::lock_guard<std::mutex> lock(buffer_->mutex);
+	if (buffer_->generation != generation_ || index_ >= buffer_->events.size())
+		return;
+
+	auto& event      = buffer_->events[index_];
+	event.end        = time;
+	buffer_->current = event.parent;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Starts profiling (clearing any previous data unless 'keep' is given)
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(prof_start, 0, true)
+{
+	Profiler::start(args.empty() || args[0] != "keep");
+	Log::console("Profiling started");
+}
+
+// -----------------------------------------------------------------------------
+// Stops profiling
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(prof_stop, 0, true)
+{
+	Profiler::stop();
+	Log::console("Profiling stopped");
+}
+
+// -----------------------------------------------------------------------------
+// Dumps aggregated profiling stats to the console, omitting any zones taking
+// less than the (optional) given number of milliseconds in total
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(prof_dump, 0, true)
+{
+	Profiler::dumpStats(args.empty() ? 0. : StrUtil::toDouble(args[0]));
+}
+
+// -----------------------------------------------------------------------------
+// Exports recorded profiling data as a Chrome trace JSON file. If no path is
+// given (or it is relative) it is written to the user data directory
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(prof_trace, 0, true)
+{
+	wxFileName fn(args.empty() ? "profile_trace.json" : args[0]);
+	if (fn.IsRelative())
+		fn.Assign(App::path(fn.GetFullPath().ToStdString(), App::Dir::User));
+
+	if (Profiler::exportTrace(fn.GetFullPath().ToStdString()))
+		Log::console(wxString::Format("Exported profiling trace to %s", fn.GetFullPath()));
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+
+// Profiling zones
+// -----------------------------------------------------------------------------
+// Put PROFILE_ZONE("Name") at the start of a scope to record the time taken by
+// that scope while profiling is enabled (via the prof_start console command).
+// Zones nest, so the recorded stats form a tree per thread. [name] must be a
+// string literal (or otherwise outlive the profiling data).
+// When profiling is disabled a zone costs a single relaxed atomic load
+// -----------------------------------------------------------------------------
+#define PROFILE_ZONE_CAT2(a, b) a##b
+#define PROFILE_ZONE_CAT(a, b) PROFILE_ZONE_CAT2(a, b)
+#define PROFILE_ZONE(name) Profiler::Zone PROFILE_ZONE_CAT(profile_zone_, __LINE__)(name)
+
+namespace Profiler
+{
+struct ThreadBuffer;
+extern std::atomic<bool> enabled_flag;
+
+inline bool enabled()
+{
+	return enabled_flag.load(std::memory_order_relaxed);
+}
+
+void start(bool clear_data = true);
+void stop();
+void clear();
+void dumpStats(double min_ms = 0.);
+bool exportTrace(std::string_view filename);
+
+class Zone
+{
+public:
+	Zone(const char* name)
+	{
+		if (enabled())
+			begin(name);
+	}
+	~Zone()
+	{
+		if (buffer_)
+			end();
+	}
+
+	Zone(const Zone&) = delete;
+	Zone& operator=(const Zone&) = delete;
+
+private:
+	ThreadBuffer* buffer_     = nullptr;
+	unsigned      index_      = 0;
+	unsigned      generation_ = 0;
+
+	void begin(const char* name);
+	void end();
+};
+} // namespace Profiler
@@ -39,10 +39,10 @@
 
 // -----------------------------------------------------------------------------
 //
-// External Variables
+// Variables
 //
 // -----------------------------------------------------------------------------
-EXTERN_CVAR(String, dir_last)
+CVAR(String, dir_last, "", CVar::Flag::Save)
 
 
 // -----------------------------------------------------------------------------
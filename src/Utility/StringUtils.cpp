@@ -865,7 +865,7 @@ void StrUtil::processIncludes(const std::string& filename, std::string& out)
 			tz.adv(); // Skip #include
 
 			// Process the file
-			processIncludes(fmt::format("{}{}", path, tz.next().text), out);
+			processIncludes(fmt::format("{}{}", path, tz.next().text()), out);
 		}
 		else
 			out.append(line + "\n");
@@ -908,14 +908,14 @@ void StrUtil::processIncludes(ArchiveEntry* entry, std::string& out, bool use_re
 		{
 			// Get name of entry to include
 			tz.openString(line);
-			auto name = entry->path() + tz.next().text;
+			auto name = entry->path() + tz.next().text();
 
 			// Get the entry
 			bool          done      = false;
 			ArchiveEntry* entry_inc = entry->parent()->entryAtPath(name);
 			// DECORATE paths start from the root, not from the #including entry's directory
 			if (!entry_inc)
-				entry_inc = entry->parent()->entryAtPath(tz.current().text);
+				entry_inc = entry->parent()->entryAtPath(tz.current().text());
 			if (entry_inc)
 			{
 				processIncludes(entry_inc, out);
@@ -927,7 +927,7 @@ void StrUtil::processIncludes(ArchiveEntry* entry, std::string& out, bool use_re
 			// Look in resource pack
 			if (use_res && !done && App::archiveManager().programResourceArchive())
 			{
-				name      = "config/games/" + tz.current().text;
+				name      = "config/games/" + tz.current().text();
 				entry_inc = App::archiveManager().programResourceArchive()->entryAtPath(name);
 				if (entry_inc)
 				{
@@ -1184,7 +1184,7 @@ void wxStringUtils::processIncludes(const wxString& filename, wxString& out)
 			tz.adv(); // Skip #include
 
 			// Process the file
-			processIncludes(path + tz.next().text, out);
+			processIncludes(path + tz.next().text(), out);
 		}
 		else
 			out.Append(line + "\n");
@@ -1225,14 +1225,14 @@ void wxStringUtils::processIncludes(ArchiveEntry* entry, wxString& out, bool use
 		{
 			// Get name of entry to include
 			tz.openString(line.ToStdString());
-			wxString name = entry->path() + tz.next().text;
+			wxString name = entry->path() + tz.next().text();
 
 			// Get the entry
 			bool done      = false;
 			auto entry_inc = entry->parent()->entryAtPath(name.ToStdString());
 			// DECORATE paths start from the root, not from the #including entry's directory
 			if (!entry_inc)
-				entry_inc = entry->parent()->entryAtPath(tz.current().text);
+				entry_inc = entry->parent()->entryAtPath(tz.current().text());
 			if (entry_inc)
 			{
 				processIncludes(entry_inc, out);
@@ -1244,7 +1244,7 @@ void wxStringUtils::processIncludes(ArchiveEntry* entry, wxString& out, bool use
 			// Look in resource pack
 			if (use_res && !done && App::archiveManager().programResourceArchive())
 			{
-				name      = "config/games/" + tz.current().text;
+				name      = "config/games/" + tz.current().text();
 				entry_inc = App::archiveManager().programResourceArchive()->entryAtPath(name.ToStdString());
 				if (entry_inc)
 				{
@@ -0,0 +1,322 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2019 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    TaskGraph.cpp
+// Description: TaskGraph class - runs a set of named tasks, each only once all
+//              the tasks it depends on have completed. Tasks that can run on
+//              any thread are spread across a pool of worker threads, while
+//              the calling thread runs any tasks that must be on it (and helps
+//              out with the others when it has nothing else to do).
+//              If a task fails, any tasks depending on it are skipped
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "TaskGraph.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+
+// -----------------------------------------------------------------------------
+//
+// TaskGraph Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Adds a task [name] that runs [func] on [thread], once all tasks named in
+// [depends] have completed successfully. [func] should return false if the
+// task failed.
+// Dependencies must already have been added, so there can't be any cycles.
+// Returns false if the name is already taken or a dependency wasn't found
+// -----------------------------------------------------------------------------
+bool TaskGraph::add(
+	std::string_view             name,
+	Thread                       thread,
+	const vector<std::string>&   depends,
+	const std::function<bool()>& func)
+{
+	if (taskIndex(name) >= 0)
+	{
+		Log::error("TaskGraph: Task \"{}\" already exists", name);
+		invalid_ = true;
+		return false;
+	}
+
+	// Check dependencies
+	vector<unsigned> depend_indices;
+	for (auto& depend : depends)
+	{
+		auto index = taskIndex(depend);
+		if (index < 0)
+		{
+			Log::error("TaskGraph: Task \"{}\" depends on unknown task \"{}\"", name, depend);
+			invalid_ = true;
+			return false;
+		}
+		depend_indices.push_back(index);
+	}
+
+	// Add task
+	Task task;
+	task.name      = name;
+	task.thread    = thread;
+	task.func      = func;
+	task.n_depends = depend_indices.size();
+	for (auto index : depend_indices)
+		tasks_[index].dependents.push_back(tasks_.size());
+	tasks_.push_back(task);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Checks that all tasks were added successfully and that every task can be
+// reached from a task without dependencies (ie. there are no cycles).
+// Returns false and logs an error if not
+// -----------------------------------------------------------------------------
+bool TaskGraph::validate() const
+{
+	if (invalid_)
+	{
+		Log::error("TaskGraph: One or more tasks failed to be added");
+		return false;
+	}
+
+	// Walk the graph from the tasks without dependencies, each task becoming
+	// ready once all its dependencies have been visited
+	vector<unsigned> n_waiting(tasks_.size());
+	vector<unsigned> ready;
+	for (unsigned a = 0; a < tasks_.size(); ++a)
+	{
+		n_waiting[a] = tasks_[a].n_depends;
+		if (n_waiting[a] == 0)
+			ready.push_back(a);
+	}
+	while (!ready.empty())
+	{
+		auto index = ready.back();
+		ready.pop_back();
+		for (auto dependent : tasks_[index].dependents)
+		{
+			if (dependent >= tasks_.size() || n_waiting[dependent] == 0)
+			{
+				Log::error("TaskGraph: Task \"{}\" has an invalid dependent", tasks_[index].name);
+				return false;
+			}
+			if (--n_waiting[dependent] == 0)
+				ready.push_back(dependent);
+		}
+	}
+
+	// Anything not visited is waiting on a cycle
+	for (unsigned a = 0; a < tasks_.size(); ++a)
+		if (n_waiting[a] > 0)
+		{
+			Log::error("TaskGraph: Task \"{}\" can never run (cyclic dependency)", tasks_[a].name);
+			return false;
+		}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Runs all tasks, using up to [n_threads] threads (including this one) for
+// tasks that can run on any thread. If [n_threads] is 0, one thread per
+// hardware thread is used.
+// Returns false if any task failed, or the graph isn't valid (see validate)
+// -----------------------------------------------------------------------------
+bool TaskGraph::run(unsigned n_threads)
+{
+	typedef std::chrono::steady_clock Clock;
+
+	// Don't run anything if some tasks would never run
+	if (!validate())
+		return false;
+
+	std::mutex              mutex;
+	std::condition_variable cv;
+	std::deque<unsigned>    ready_main;
+	std::deque<unsigned>    ready_any;
+	vector<unsigned>        n_waiting(tasks_.size());
+	vector<bool>            skipped(tasks_.size(), false);
+	unsigned                n_remaining = tasks_.size();
+	unsigned                n_any       = 0;
+	bool                    ok          = true;
+	auto                    start       = Clock::now();
+	auto                    elapsed_ms  = [start](Clock::time_point time) {
+		return std::chrono::duration<double, std::milli>(time - start).count();
+	};
+
+	// Queues the task at [index] to be run
+	auto queue = [&](unsigned index) {
+		if (tasks_[index].thread == Thread::Main)
+			ready_main.push_back(index);
+		else
+			ready_any.push_back(index);
+	};
+
+	// Skips the task at [index] and everything depending on it
+	std::function<void(unsigned)> skip = [&](unsigned index) {
+		if (skipped[index])
+			return;
+		skipped[index] = true;
+		--n_remaining;
+		for (auto dependent : tasks_[index].dependents)
+			skip(dependent);
+	};
+
+	// Reset and queue any tasks without dependencies
+	for (unsigned a = 0; a < tasks_.size(); ++a)
+	{
+		auto& task   = tasks_[a];
+		task.ran     = false;
+		task.ok      = false;
+		n_waiting[a] = task.n_depends;
+		if (task.thread == Thread::Any)
+			++n_any;
+		if (task.n_depends == 0)
+			queue(a);
+	}
+
+	// Runs the task at [index] (without the lock held), then queues any tasks
+	// that were waiting only on it
+	auto run_task = [&](unsigned index) {
+		auto& task       = tasks_[index];
+		auto  task_start = Clock::now();
+		bool  result     = task.func ? task.func() : true;
+		auto  task_end   = Clock::now();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		task.ran      = true;
+		task.ok       = result;
+		task.start_ms = elapsed_ms(task_start);
+		task.time_ms  = elapsed_ms(task_end) - task.start_ms;
+		--n_remaining;
+		if (!result)
+		{
+			ok = false;
+			for (auto dependent : task.dependents)
+				skip(dependent);
+		}
+		else
+		{
+			for (auto dependent : task.dependents)
+				if (!skipped[dependent] && --n_waiting[dependent] == 0)
+					queue(dependent);
+		}
+		cv.notify_all();
+	};
+
+	// Start worker threads
+	if (n_threads == 0)
+		n_threads = std::thread::hardware_concurrency();
+	n_threads = std::max(1u, std::min(n_threads, n_any + 1));
+	vector<std::thread> workers;
+	for (unsigned t = 1; t < n_threads; ++t)
+		workers.emplace_back([&]() {
+			while (true)
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				cv.wait(lock, [&]() { return !ready_any.empty() || n_remaining == 0; });
+				if (ready_any.empty())
+					return;
+
+				auto index = ready_any.front();
+				ready_any.pop_front();
+				lock.unlock();
+				run_task(index);
+			}
+		});
+
+	// Run tasks on this thread, preferring those that must be run here
+	while (true)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		cv.wait(lock, [&]() { return !ready_main.empty() || !ready_any.empty() || n_remaining == 0; });
+
+		unsigned index;
+		if (!ready_main.empty())
+		{
+			index = ready_main.front();
+			ready_main.pop_front();
+		}
+		else if (!ready_any.empty())
+		{
+			index = ready_any.front();
+			ready_any.pop_front();
+		}
+		else
+			break;
+
+		lock.unlock();
+		run_task(index);
+	}
+
+	for (auto& worker : workers)
+		worker.join();
+
+	total_ms_ = elapsed_ms(Clock::now());
+
+	return ok;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the timings of all tasks in the last run to the log, under [title]
+// -----------------------------------------------------------------------------
+void TaskGraph::logTimings(std::string_view title) const
+{
+	Log::info("{} took {:.1f}ms", title, total_ms_);
+	for (auto& task : tasks_)
+	{
+		if (!task.ran)
+			Log::info(2, "  {:<16} skipped (a dependency failed)", task.name);
+		else
+			Log::info(
+				2,
+				"  {:<16} {:7.1f}ms (at {:7.1f}ms){}",
+				task.name,
+				task.time_ms,
+				task.start_ms,
+				task.ok ? "" : " FAILED");
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the index of the task named [name], or -1 if it doesn't exist
+// -----------------------------------------------------------------------------
+int TaskGraph::taskIndex(std::string_view name) const
+{
+	for (unsigned a = 0; a < tasks_.size(); ++a)
+		if (tasks_[a].name == name)
+			return a;
+
+	return -1;
+}
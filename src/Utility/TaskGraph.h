@@ -0,0 +1,48 @@
+#pragma once
+
+class TaskGraph
+{
+public:
+	enum class Thread
+	{
+		Main, // Must run on the thread calling run (eg. anything touching the UI)
+		Any   // Can run on a worker thread
+	};
+
+	struct Task
+	{
+		std::string           name;
+		Thread                thread = Thread::Any;
+		std::function<bool()> func;
+		vector<unsigned>      dependents;
+		unsigned              n_depends = 0;
+
+		// Result of the last run
+		bool   ran      = false;
+		bool   ok       = false;
+		double start_ms = 0.; // Relative to the start of the run
+		double time_ms  = 0.;
+	};
+
+	TaskGraph()  = default;
+	~TaskGraph() = default;
+
+	const vector<Task>& tasks() const { return tasks_; }
+	double              totalTime() const { return total_ms_; }
+
+	bool add(
+		std::string_view             name,
+		Thread                       thread,
+		const vector<std::string>&   depends,
+		const std::function<bool()>& func);
+	bool validate() const;
+	bool run(unsigned n_threads = 0);
+	void logTimings(std::string_view title) const;
+
+private:
+	vector<Task> tasks_;
+	double       total_ms_ = 0.;
+	bool         invalid_  = false; // True if a task failed to be added
+
+	int taskIndex(std::string_view name) const;
+};
@@ -40,25 +40,7 @@
 //
 // -----------------------------------------------------------------------------
 const std::string Tokenizer::DEFAULT_SPECIAL_CHARACTERS = ";,:|={}/";
-Tokenizer::Token  Tokenizer::invalid_token_{ "", 0, false, 0, 0, 0, false };
-
-
-// -----------------------------------------------------------------------------
-//
-// Local Functions
-//
-// -----------------------------------------------------------------------------
-namespace
-{
-// -----------------------------------------------------------------------------
-// Returns true if [p] is a whitespace character
-// -----------------------------------------------------------------------------
-bool isWhitespace(char p)
-{
-	// Whitespace is either a newline, tab character or space
-	return p == '\n' || p == 13 || p == ' ' || p == '\t';
-}
-} // namespace
+Tokenizer::Token  Tokenizer::invalid_token_;
 
 
 // -----------------------------------------------------------------------------
@@ -74,7 +56,7 @@ bool isWhitespace(char p)
 // -----------------------------------------------------------------------------
 bool Tokenizer::Token::isInteger(bool allow_hex) const
 {
-	return StrUtil::isInteger(text, allow_hex);
+	return StrUtil::isInteger(view(), allow_hex);
 }
 
 // -----------------------------------------------------------------------------
@@ -82,7 +64,7 @@ bool Tokenizer::Token::isInteger(bool allow_hex) const
 // -----------------------------------------------------------------------------
 bool Tokenizer::Token::isHex() const
 {
-	return StrUtil::isHex(text);
+	return StrUtil::isHex(view());
 }
 
 // -----------------------------------------------------------------------------
@@ -90,7 +72,7 @@ bool Tokenizer::Token::isHex() const
 // -----------------------------------------------------------------------------
 bool Tokenizer::Token::isFloat() const
 {
-	return StrUtil::isFloat(text);
+	return StrUtil::isFloat(view());
 }
 
 // ----------------------------------------------------------------------------
@@ -98,7 +80,7 @@ bool Tokenizer::Token::isFloat() const
 // ----------------------------------------------------------------------------
 int Tokenizer::Token::asInt() const
 {
-	return StrUtil::toInt(text);
+	return StrUtil::toInt(view());
 }
 
 // -----------------------------------------------------------------------------
@@ -107,6 +89,7 @@ int Tokenizer::Token::asInt() const
 // -----------------------------------------------------------------------------
 bool Tokenizer::Token::asBool() const
 {
+	auto text = view();
 	return !(
 		text.empty() || StrUtil::equalCI(text, "false") || StrUtil::equalCI(text, "no") || StrUtil::equalCI(text, "0"));
 }
@@ -116,7 +99,7 @@ bool Tokenizer::Token::asBool() const
 // ----------------------------------------------------------------------------
 double Tokenizer::Token::asFloat() const
 {
-	return StrUtil::toDouble(text);
+	return StrUtil::toDouble(view());
 }
 
 // ----------------------------------------------------------------------------
@@ -124,7 +107,7 @@ double Tokenizer::Token::asFloat() const
 // ----------------------------------------------------------------------------
 void Tokenizer::Token::toInt(int& val) const
 {
-	val = StrUtil::toInt(text);
+	val = StrUtil::toInt(view());
 }
 
 // -----------------------------------------------------------------------------
@@ -133,7 +116,8 @@ void Tokenizer::Token::toInt(int& val) const
 // -----------------------------------------------------------------------------
 void Tokenizer::Token::toBool(bool& val) const
 {
-	val = !(
+	auto text = view();
+	val       = !(
 		text.empty() || StrUtil::equalCI(text, "false") || StrUtil::equalCI(text, "no") || StrUtil::equalCI(text, "0"));
 }
 
@@ -142,7 +126,7 @@ void Tokenizer::Token::toBool(bool& val) const
 // ----------------------------------------------------------------------------
 void Tokenizer::Token::toFloat(double& val) const
 {
-	val = StrUtil::toDouble(text);
+	val = StrUtil::toDouble(view());
 }
 
 // ----------------------------------------------------------------------------
@@ -150,7 +134,7 @@ void Tokenizer::Token::toFloat(double& val) const
 // ----------------------------------------------------------------------------
 void Tokenizer::Token::toFloat(float& val) const
 {
-	val = StrUtil::toFloat(text);
+	val = StrUtil::toFloat(view());
 }
 
 
@@ -164,10 +148,30 @@ void Tokenizer::Token::toFloat(float& val) const
 // -----------------------------------------------------------------------------
 // Tokenizer class constructor
 // -----------------------------------------------------------------------------
-Tokenizer::Tokenizer(int comments, const std::string& special_characters) :
-	comment_types_{ comments },
-	special_characters_{ special_characters.begin(), special_characters.end() }
+Tokenizer::Tokenizer(int comments, const std::string& special_characters) : comment_types_{ comments }
 {
+	setSpecialCharacters(special_characters);
+}
+
+// -----------------------------------------------------------------------------
+// Sets the special characters (always read as separate tokens) to [characters]
+// -----------------------------------------------------------------------------
+void Tokenizer::setSpecialCharacters(std::string_view characters)
+{
+	// Rebuild character class table
+	for (unsigned a = 0; a < 256; a++)
+		char_class_[a] = 0;
+
+	// Whitespace is either a newline, tab character or space
+	for (auto c : { '\n', '\r', ' ', '\t' })
+		char_class_[(uint8_t)c] |= Whitespace;
+
+	// Characters that can begin comments (/* // ## # ;)
+	for (auto c : { '/', '#', ';' })
+		char_class_[(uint8_t)c] |= CommentStart;
+
+	for (auto c : characters)
+		char_class_[(uint8_t)c] |= Special;
 }
 
 // -----------------------------------------------------------------------------
@@ -189,7 +193,7 @@ const Tokenizer::Token& Tokenizer::next()
 	if (!token_next_.valid)
 		return invalid_token_;
 
-	token_current_ = token_next_;
+	std::swap(token_current_, token_next_);
 	readNext();
 	return token_current_;
 }
@@ -205,7 +209,7 @@ void Tokenizer::adv(size_t inc)
 	for (size_t a = 0; a < inc - 1; a++)
 		readNext();
 
-	token_current_ = token_next_;
+	std::swap(token_current_, token_next_);
 	readNext();
 }
 
@@ -248,7 +252,7 @@ bool Tokenizer::advIf(char check, size_t inc)
 // -----------------------------------------------------------------------------
 bool Tokenizer::advIfNC(const char* check, size_t inc)
 {
-	if (StrUtil::equalCI(token_current_.text, check))
+	if (StrUtil::equalCI(token_current_.view(), check))
 	{
 		adv(inc);
 		return true;
@@ -258,7 +262,7 @@ bool Tokenizer::advIfNC(const char* check, size_t inc)
 }
 bool Tokenizer::advIfNC(const std::string& check, size_t inc)
 {
-	if (StrUtil::equalCI(token_current_.text, check))
+	if (StrUtil::equalCI(token_current_.view(), check))
 	{
 		adv(inc);
 		return true;
@@ -318,7 +322,7 @@ bool Tokenizer::advIfNextNC(const char* check, size_t inc)
 	if (!token_next_.valid)
 		return false;
 
-	if (StrUtil::equalCI(token_next_.text, check))
+	if (StrUtil::equalCI(token_next_.view(), check))
 	{
 		adv(inc);
 		return true;
@@ -515,7 +519,7 @@ bool Tokenizer::checkOrEnd(char check) const
 
 bool Tokenizer::checkNC(const char* check) const
 {
-	return StrUtil::equalCI(token_current_.text, check);
+	return StrUtil::equalCI(token_current_.view(), check);
 }
 
 bool Tokenizer::checkOrEndNC(const char* check) const
@@ -524,7 +528,7 @@ bool Tokenizer::checkOrEndNC(const char* check) const
 	if (!token_next_.valid)
 		return true;
 
-	return StrUtil::equalCI(token_current_.text, check);
+	return StrUtil::equalCI(token_current_.view(), check);
 }
 
 // -----------------------------------------------------------------------------
@@ -557,7 +561,7 @@ bool Tokenizer::checkNextNC(const char* check) const
 	if (!token_next_.valid)
 		return false;
 
-	return StrUtil::equalCI(token_next_.text, check);
+	return StrUtil::equalCI(token_next_.view(), check);
 }
 
 // -----------------------------------------------------------------------------
@@ -585,9 +589,11 @@ bool Tokenizer::openFile(std::string_view filename, size_t offset, size_t length
 		length = (size_t)file.Length() - offset;
 
 	// Read the file portion
-	data_.resize((size_t)length, 0);
+	data_owned_.resize((size_t)length, 0);
 	file.Seek(offset, wxFromStart);
-	file.Read(data_.data(), (size_t)length);
+	file.Read(data_owned_.data(), (size_t)length);
+	data_      = { data_owned_.data(), data_owned_.size() };
+	view_mode_ = false;
 
 	reset();
 
@@ -600,17 +606,13 @@ bool Tokenizer::openFile(std::string_view filename, size_t offset, size_t length
 // -----------------------------------------------------------------------------
 bool Tokenizer::openString(std::string_view text, size_t offset, size_t length, std::string_view source)
 {
-	source_ = source;
-
 	// If length isn't specified or exceeds the string's length,
 	// only copy to the end of the string
 	if (offset + length > text.length() || length == 0)
 		length = text.length() - offset;
 
 	// Copy the string portion
-	data_.assign(text.data() + offset, text.data() + offset + length);
-
-	reset();
+	openData(text.data() + offset, length, source);
 
 	return true;
 }
@@ -620,10 +622,7 @@ bool Tokenizer::openString(std::string_view text, size_t offset, size_t length,
 // -----------------------------------------------------------------------------
 bool Tokenizer::openMem(const char* mem, size_t length, std::string_view source)
 {
-	source_ = source;
-	data_.assign(mem, mem + length);
-
-	reset();
+	openData(mem, length, source);
 
 	return true;
 }
@@ -632,15 +631,37 @@ bool Tokenizer::openMem(const char* mem, size_t length, std::string_view source)
 // Opens text from a MemChunk [mc]
 // -----------------------------------------------------------------------------
 bool Tokenizer::openMem(const MemChunk& mc, std::string_view source)
+{
+	openData((const char*)mc.data(), mc.size(), source);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Opens [text] in view mode - the text isn't copied, and tokens view it
+// directly where possible (see Token::view), so [text] must remain valid and
+// unchanged while the tokenizer and its tokens are in use
+// -----------------------------------------------------------------------------
+bool Tokenizer::openView(std::string_view text, std::string_view source)
 {
 	source_ = source;
-	data_.assign(mc.data(), mc.data() + mc.size());
+	data_owned_.clear();
+	data_      = text;
+	view_mode_ = true;
 
 	reset();
 
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Opens the data in [mc] in view mode (see above)
+// -----------------------------------------------------------------------------
+bool Tokenizer::openView(const MemChunk& mc, std::string_view source)
+{
+	return openView({ (const char*)mc.data(), mc.size() }, source);
+}
+
 // -----------------------------------------------------------------------------
 // Resets the tokenizer to the beginning of the data
 // -----------------------------------------------------------------------------
@@ -655,6 +676,19 @@ void Tokenizer::reset()
 	readNext(&token_next_);
 }
 
+// -----------------------------------------------------------------------------
+// Opens a copy of [length] bytes of [data] from [source]
+// -----------------------------------------------------------------------------
+void Tokenizer::openData(const char* data, size_t length, std::string_view source)
+{
+	source_ = source;
+	data_owned_.assign(data, data + length);
+	data_      = { data_owned_.data(), data_owned_.size() };
+	view_mode_ = false;
+
+	reset();
+}
+
 // -----------------------------------------------------------------------------
 // Checks if a comment begins at the current position and returns the comment
 // type if one does (0 otherwise)
@@ -694,7 +728,8 @@ unsigned Tokenizer::checkCommentBegin()
 void Tokenizer::tokenizeUnknown()
 {
 	// Whitespace
-	if (isWhitespace(data_[state_.position]))
+	auto char_class = charClass(data_[state_.position]);
+	if (char_class & Whitespace)
 	{
 		state_.state = TokenizeState::State::Whitespace;
 		++state_.position;
@@ -702,7 +737,7 @@ void Tokenizer::tokenizeUnknown()
 	}
 
 	// Comment
-	state_.comment_type = checkCommentBegin();
+	state_.comment_type = char_class & CommentStart ? checkCommentBegin() : 0;
 	if (state_.comment_type > 0)
 	{
 		state_.state = TokenizeState::State::Comment;
@@ -715,7 +750,7 @@ void Tokenizer::tokenizeUnknown()
 	}
 
 	// Special character
-	if (isSpecialCharacter(data_[state_.position]))
+	if (char_class & Special)
 	{
 		// End token
 		state_.current_token.line_no       = state_.current_line;
@@ -769,16 +804,17 @@ void Tokenizer::tokenizeToken()
 		if (data_[state_.position] == '\\')
 			++state_.position;
 
-		// Continue token
+		// Continue token (skipping ahead to the next " or \)
 		++state_.position;
+		while (state_.position < state_.size && data_[state_.position] != '\"' && data_[state_.position] != '\\')
+			++state_.position;
 
 		return;
 	}
 
-	// Check for end of token
-	if (isWhitespace(data_[state_.position]) ||       // Whitespace
-		isSpecialCharacter(data_[state_.position]) || // Special character
-		checkCommentBegin() > 0)                      // Comment
+	// Check for end of token (whitespace, special character or comment)
+	auto char_class = charClass(data_[state_.position]);
+	if (char_class & (Whitespace | Special) || (char_class & CommentStart && checkCommentBegin() > 0))
 	{
 		// End token
 		state_.state = TokenizeState::State::Unknown;
@@ -787,8 +823,10 @@ void Tokenizer::tokenizeToken()
 		return;
 	}
 
-	// Continue token
+	// Continue token (skipping ahead to the next character that could end it)
 	++state_.position;
+	while (state_.position < state_.size && !(charClass(data_[state_.position]) & TokenEnd))
+		++state_.position;
 }
 
 // -----------------------------------------------------------------------------
@@ -829,8 +867,15 @@ void Tokenizer::tokenizeComment()
 		}
 	}
 
-	// Continue comment
+	// Continue comment (skipping ahead to the next character that could end it,
+	// or start a decorate //$ token)
 	++state_.position;
+	if (state_.comment_type == CStyle)
+		while (state_.position < state_.size && data_[state_.position] != '*' && data_[state_.position] != '\n')
+			++state_.position;
+	else
+		while (state_.position < state_.size && data_[state_.position] != '\n' && data_[state_.position] != '$')
+			++state_.position;
 }
 
 // -----------------------------------------------------------------------------
@@ -838,7 +883,7 @@ void Tokenizer::tokenizeComment()
 // -----------------------------------------------------------------------------
 void Tokenizer::tokenizeWhitespace()
 {
-	if (isWhitespace(data_[state_.position]))
+	if (charClass(data_[state_.position]) & Whitespace)
 		++state_.position;
 	else
 		state_.state = TokenizeState::State::Unknown;
@@ -877,13 +922,33 @@ bool Tokenizer::readNext(Token* target)
 	// Write to target token (if specified)
 	if (target)
 	{
-		target->text.clear();
-		for (unsigned a = state_.current_token.pos_start; a < state_.position; ++a)
+		auto text    = data_.substr(state_.current_token.pos_start, state_.position - state_.current_token.pos_start);
+		bool escaped = state_.current_token.quoted_string && text.find('\\') != std::string_view::npos;
+		bool lower   = read_lowercase_ && !state_.current_token.quoted_string;
+		if (view_mode_ && !escaped && !lower)
 		{
-			if (state_.current_token.quoted_string && data_[a] == '\\')
-				++a;
-
-			target->text += data_[a];
+			// View the token text in the source data
+			target->text_.clear();
+			target->source_text = text;
+		}
+		else if (escaped)
+		{
+			// Copy the token text, removing escape backslashes
+			target->text_.clear();
+			target->source_text = {};
+			for (unsigned a = 0; a < text.size(); ++a)
+			{
+				if (text[a] == '\\')
+					++a;
+				if (a < text.size())
+					target->text_ += text[a];
+			}
+		}
+		else
+		{
+			// Copy the token text
+			target->text_.assign(text.data(), text.size());
+			target->source_text = {};
 		}
 
 		target->line_no       = state_.current_token.line_no;
@@ -894,8 +959,8 @@ bool Tokenizer::readNext(Token* target)
 		target->valid         = true;
 
 		// Convert to lowercase if configured to and it isn't a quoted string
-		if (read_lowercase_ && !target->quoted_string)
-			StrUtil::lowerIP(target->text);
+		if (lower)
+			StrUtil::lowerIP(target->text_);
 	}
 
 	// Skip closing " if it was a quoted string
@@ -903,7 +968,7 @@ bool Tokenizer::readNext(Token* target)
 		++state_.position;
 
 	if (debug_)
-		Log::debug("{}: \"{}\"", token_current_.line_no, token_current_.text);
+		Log::debug("{}: \"{}\"", token_current_.line_no, token_current_.view());
 
 	return true;
 }
@@ -933,7 +998,7 @@ void Tokenizer::resetToLineStart()
 // Testing
 
 #include "App.h"
-#include "Archive/ArchiveEntry.h"
+#include "Archive/ArchiveManager.h"
 #include "General/Console/Console.h"
 #include "MainEditor/MainEditor.h"
 
@@ -968,7 +1033,8 @@ CONSOLE_COMMAND(test_tokenizer, 0, false)
 		while (!tz.atEnd())
 		{
 			if (a == 0)
-				t_new.push_back({ tz.current().text, tz.current().quoted_string, tz.current().line_no });
+				t_new.push_back(
+					{ std::string{ tz.current().view() }, tz.current().quoted_string, tz.current().line_no });
 
 			tz.next();
 		}
@@ -1009,3 +1075,71 @@ CONSOLE_COMMAND(test_tokenizer, 0, false)
 			Log::debug("{}: \"{}\"{}", token.line_no, token.text, token.quoted_string ? " (quoted)" : "");
 	}
 }
+
+CONSOLE_COMMAND(test_tokenizer_speed, 0, false)
+{
+	// Get text entries to tokenize (from the current archive, or the base resource
+	// archive if none)
+	auto archive = MainEditor::currentArchive();
+	if (!archive)
+		archive = App::archiveManager().baseResourceArchive();
+	if (!archive)
+		return;
+	vector<ArchiveEntry*> entries;
+	size_t                total_size = 0;
+	for (auto& entry : archive->rootDir()->allEntries())
+		if (entry->type()->category() == "Text" && entry->size() > 0)
+		{
+			entries.push_back(entry.get());
+			total_size += entry->size();
+		}
+	if (entries.empty())
+		return;
+
+	int num = 5;
+	if (!args.empty())
+		num = StrUtil::toInt(args[0]);
+
+	// Tokenizes all entries [num] times in view mode or not, returning the time
+	// taken in ms. If [tokens] is given, the token texts are added to it (once)
+	auto tokenize = [&](bool view, vector<std::string>* tokens) {
+		Tokenizer tz;
+		long      time = App::runTimer();
+		for (int a = 0; a < num; a++)
+			for (auto entry : entries)
+			{
+				if (view)
+					tz.openView(entry->data(), entry->name());
+				else
+					tz.openMem(entry->data(), entry->name());
+
+				while (!tz.atEnd())
+				{
+					if (tokens && a == 0)
+						tokens->emplace_back(tz.current().view());
+					tz.adv();
+				}
+			}
+		return App::runTimer() - time;
+	};
+
+	// Check both modes give the same tokens
+	vector<std::string> tokens_copy, tokens_view;
+	tokenize(false, &tokens_copy);
+	tokenize(true, &tokens_view);
+
+	auto   time_copy = tokenize(false, nullptr);
+	auto   time_view = tokenize(true, nullptr);
+	double mb        = (double)total_size * num / (1024. * 1024.);
+	Log::info(
+		"Tokenized {} entries ({:.2f}MB, {} tokens) x{}: copy {}ms ({:.1f}MB/s), view {}ms ({:.1f}MB/s), tokens {}",
+		entries.size(),
+		total_size / (1024. * 1024.),
+		tokens_copy.size(),
+		num,
+		time_copy,
+		mb * 1000. / std::max<long>(time_copy, 1),
+		time_view,
+		mb * 1000. / std::max<long>(time_view, 1),
+		tokens_copy == tokens_view ? "match" : "DIFFER");
+}
@@ -16,24 +16,36 @@ public:
 
 	struct Token
 	{
-		std::string text;
-		unsigned    line_no;
-		bool        quoted_string;
-		unsigned    pos_start;
-		unsigned    pos_end;
-		unsigned    length;
-		bool        valid;
-
-		explicit operator std::string() const { return text; }
-		explicit operator const std::string() const { return text; }
-		explicit operator const char*() const { return text.c_str(); }
-		bool     operator==(const std::string& cmp) const { return text == cmp; }
-		bool     operator==(const char* cmp) const { return text == cmp; }
-		bool     operator==(char cmp) const { return length == 1 && text[0] == cmp; }
-		bool     operator!=(const std::string& cmp) const { return text != cmp; }
-		bool     operator!=(const char* cmp) const { return text != cmp; }
-		bool     operator!=(char cmp) const { return length != 1 || text[0] != cmp; }
-		char     operator[](unsigned index) const { return text[index]; }
+		unsigned         line_no       = 0;
+		bool             quoted_string = false;
+		unsigned         pos_start     = 0;
+		unsigned         pos_end       = 0;
+		unsigned         length        = 0;
+		bool             valid         = false;
+		std::string_view source_text; // The token text within the source data (view mode only)
+
+		// Returns the token text (valid only as long as the tokenizer's data in view mode)
+		std::string_view view() const { return source_text.data() ? source_text : std::string_view{ text_ }; }
+
+		// Returns the token text as a string. In view mode this is copied from the
+		// source data the first time it is needed, prefer view() where possible
+		const std::string& text() const
+		{
+			if (text_.empty() && !source_text.empty())
+				text_.assign(source_text.data(), source_text.size());
+			return text_;
+		}
+
+		explicit operator std::string() const { return std::string{ view() }; }
+		explicit operator const std::string() const { return std::string{ view() }; }
+		explicit operator const char*() const { return text().c_str(); }
+		bool     operator==(const std::string& cmp) const { return view() == cmp; }
+		bool     operator==(const char* cmp) const { return view() == cmp; }
+		bool     operator==(char cmp) const { return length == 1 && view()[0] == cmp; }
+		bool     operator!=(const std::string& cmp) const { return view() != cmp; }
+		bool     operator!=(const char* cmp) const { return view() != cmp; }
+		bool     operator!=(char cmp) const { return length != 1 || view()[0] != cmp; }
+		char     operator[](unsigned index) const { return view()[index]; }
 
 		bool isInteger(bool allow_hex = false) const;
 		bool isHex() const;
@@ -47,6 +59,11 @@ public:
 		void toBool(bool& val) const;
 		void toFloat(double& val) const;
 		void toFloat(float& val) const;
+
+	private:
+		mutable std::string text_; // Token text (in view mode, only set if the text differs from the source)
+
+		friend class Tokenizer;
 	};
 
 	struct TokenizeState
@@ -73,6 +90,7 @@ public:
 
 	// Accessors
 	const std::string& source() const { return source_; }
+	bool               viewMode() const { return view_mode_; }
 	bool               decorate() const { return decorate_; }
 	bool               readLowerCase() const { return read_lowercase_; }
 	const Token&       current() const { return token_current_; }
@@ -80,10 +98,7 @@ public:
 
 	// Modifiers
 	void setCommentTypes(int types) { comment_types_ = types; }
-	void setSpecialCharacters(std::string_view characters)
-	{
-		special_characters_.assign(characters.data(), characters.data() + characters.size());
-	}
+	void setSpecialCharacters(std::string_view characters);
 	void setSource(const wxString& source) { source_ = source; }
 	void setReadLowerCase(bool lower) { read_lowercase_ = lower; }
 	void enableDecorate(bool enable) { decorate_ = enable; }
@@ -133,9 +148,11 @@ public:
 	bool openString(std::string_view text, size_t offset = 0, size_t length = 0, std::string_view source = "unknown");
 	bool openMem(const char* mem, size_t length, std::string_view source);
 	bool openMem(const MemChunk& mc, std::string_view source);
+	bool openView(std::string_view text, std::string_view source);
+	bool openView(const MemChunk& mc, std::string_view source);
 
 	// General
-	bool isSpecialCharacter(char p) const { return VECTOR_EXISTS(special_characters_, p); }
+	bool isSpecialCharacter(char p) const { return char_class_[(uint8_t)p] & Special; }
 	bool atEnd() const { return !token_next_.valid; }
 	void reset();
 
@@ -144,7 +161,7 @@ public:
 	{
 		if (atEnd())
 			return "";
-		std::string t = token_current_.text;
+		std::string t{ token_current_.view() };
 		adv();
 		return t;
 	}
@@ -153,14 +170,14 @@ public:
 		if (atEnd())
 			*str = "";
 		else
-			*str = token_current_.text;
+			*str = token_current_.view();
 		adv();
 	}
 	std::string peekToken() const
 	{
 		if (atEnd())
 			return "";
-		return token_next_.text;
+		return std::string{ token_next_.view() };
 	}
 	int getInteger()
 	{
@@ -200,24 +217,38 @@ public:
 	static const Token&      invalidToken() { return invalid_token_; }
 
 private:
-	vector<char>  data_;
-	Token         token_current_ = {};
-	Token         token_next_    = {};
-	TokenizeState state_         = {};
+	// Character classes (see char_class_)
+	enum CharClass : uint8_t
+	{
+		Whitespace   = 1,
+		Special      = 2,
+		CommentStart = 4, // May begin a comment, depending on comment_types_
+
+		TokenEnd = Whitespace | Special | CommentStart,
+	};
+
+	std::string_view data_;                  // The data being tokenized
+	vector<char>     data_owned_;            // Copy of the data (unless in view mode)
+	bool             view_mode_     = false; // If true, data_ and tokens view the source data directly
+	Token            token_current_ = {};
+	Token            token_next_    = {};
+	TokenizeState    state_         = {};
 
 	// Configuration
-	int          comment_types_;          // Types of comments to skip
-	vector<char> special_characters_;     // These will always be read as separate tokens
-	std::string  source_;                 // What file/entry/chunk is being tokenized
-	bool         decorate_       = false; // Special handling for //$ comments
-	bool         read_lowercase_ = false; // If true, tokens will all be read in lowercase
-										  // (except for quoted strings, obviously)
-	bool debug_ = false;                  // Log each token read
+	int         comment_types_;          // Types of comments to skip
+	uint8_t     char_class_[256];        // CharClass flags for each character
+	std::string source_;                 // What file/entry/chunk is being tokenized
+	bool        decorate_       = false; // Special handling for //$ comments
+	bool        read_lowercase_ = false; // If true, tokens will all be read in lowercase
+										 // (except for quoted strings, obviously)
+	bool debug_ = false;                 // Log each token read
 
 	// Static
 	static Token invalid_token_;
 
 	// Tokenizing
+	uint8_t  charClass(char p) const { return char_class_[(uint8_t)p]; }
+	void     openData(const char* data, size_t length, std::string_view source);
 	unsigned checkCommentBegin();
 	void     tokenizeUnknown();
 	void     tokenizeToken();